@@ -7,6 +7,138 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"       // Include semaphore header
+#include "binlog.h"                 // Binary logging (components/binlog)
+#include "notify_dispatch.h"        // Direct-to-task signalling (components/notify_dispatch)
+#include "signal_sem.h"             // Counting semaphore with lost-signal accounting (components/signal_sem)
+#include "event_broadcast.h"        // Wake-all on an event group (components/event_broadcast)
+#include "wake_latency.h"           // Give-to-take latency histogram (components/wake_latency)
+#include "timer_signal.h"           // Periodic give from a timer interrupt (components/timer_signal)
+#include "stack_profile.h"          // Stack high-water-mark profiling (components/stack_profile)
+#include "sched_trace.h"            // Scheduler trace for Perfetto (components/sched_trace)
+#include "static_arena.h"           // Static allocation arena (components/static_arena)
+
+// Stack sizes measured by a profiling run (EX3_STACK_PROFILE=1), if include/stack_sizes.h was generated
+#if __has_include("stack_sizes.h")
+#include "stack_sizes.h"
+#endif
+
+// How Task A signals Task B / Task C, selected at build time
+// (e.g. platformio.ini -> build_flags = -DEX3_SIGNAL=EX3_SIGNAL_NOTIFY)
+#define EX3_SIGNAL_SEMAPHORE    0   // Binary semaphore: xSemaphoreGive / xSemaphoreTake (default)
+#define EX3_SIGNAL_NOTIFY       1   // Task notifications: Task A's dispatcher picks Task B or Task C, no semaphore object
+#define EX3_SIGNAL_COUNTING     2   // Counting semaphore: up to EX3_SEM_CEILING gives wait, lost gives are counted
+#define EX3_SIGNAL_BROADCAST    3   // Event group: Task B AND Task C wake for every signal and acknowledge it
+
+#ifndef EX3_SIGNAL
+#define EX3_SIGNAL EX3_SIGNAL_SEMAPHORE
+#endif
+
+// EX3_SIGNAL_NOTIFY: who gets the next signal (NOTIFY_DISPATCH_ROUND_ROBIN or NOTIFY_DISPATCH_LEAST_RECENT)
+#ifndef EX3_DISPATCH_POLICY
+#define EX3_DISPATCH_POLICY NOTIFY_DISPATCH_ROUND_ROBIN
+#endif
+
+// EX3_SIGNAL_COUNTING: how many gives may wait for Task B / Task C (1 = binary, but with lost-give counting)
+#ifndef EX3_SEM_CEILING
+#define EX3_SEM_CEILING 4
+#endif
+
+#define EX3_STATS_EVERY         10  // NOTIFY / COUNTING / BROADCAST / TIMER_ISR: counters printed every N signals
+
+// 1 = no Task A: a hardware timer interrupt gives the semaphore every EX3_TIMER_PERIOD_US (xSemaphoreGiveFromISR),
+// Task B / Task C print the timer's counters every EX3_STATS_EVERY signals (see components/timer_signal)
+#ifndef EX3_TIMER_ISR
+#define EX3_TIMER_ISR 0
+#endif
+#ifndef EX3_TIMER_PERIOD_US
+#define EX3_TIMER_PERIOD_US 1000000
+#endif
+
+#if EX3_TIMER_ISR && EX3_SIGNAL != EX3_SIGNAL_SEMAPHORE
+#error "EX3_TIMER_ISR replaces Task A's xSemaphoreGive(): use it with EX3_SIGNAL_SEMAPHORE"
+#endif
+
+// 1 = Task A timestamps every give, Task B / Task C record the time until their take returned, and Task A
+// prints p50 / p99 / max every EX3_STATS_EVERY signals (see components/wake_latency)
+#ifndef EX3_WAKE_LATENCY
+#define EX3_WAKE_LATENCY 0
+#endif
+
+// Where the tasks run (ESP32; the single-core host build ignores it)
+#define EX3_PLACE_ANY           0   // xTaskCreate: the scheduler picks the core (default)
+#define EX3_PLACE_SAME_CORE     1   // all three tasks pinned to core 0
+#define EX3_PLACE_CROSS_CORE    2   // Task A on core 0, Task B / Task C on core 1
+
+#ifndef EX3_PLACEMENT
+#define EX3_PLACEMENT EX3_PLACE_ANY
+#endif
+
+// Priorities: Task A above the waiters by default, e.g. -DEX3_PRIO_WAITERS=3 lets the give switch to them at once
+#ifndef EX3_PRIO_A
+#define EX3_PRIO_A 2
+#endif
+#ifndef EX3_PRIO_WAITERS
+#define EX3_PRIO_WAITERS 1
+#endif
+
+// 1 = every printf below sends a binary record (format ID, timestamp, arguments) instead of text.
+// Decode on the PC: binlog_tool decode firmware.elf < capture.bin (see components/binlog)
+#ifndef EX3_BINARY_LOG
+#define EX3_BINARY_LOG 0
+#endif
+
+#if EX3_BINARY_LOG
+#define printf(...) BINLOG_PRINTF(__VA_ARGS__)
+#endif
+
+// 1 = profiling build: the tasks get STACK_PROFILE_RUN_DEPTH, after EX3_STACK_PROFILE_MS their peak stack use
+// and a generated stack_sizes.h are printed (see components/stack_profile)
+#ifndef EX3_STACK_PROFILE
+#define EX3_STACK_PROFILE 0
+#endif
+#ifndef EX3_STACK_PROFILE_MS
+#define EX3_STACK_PROFILE_MS 30000
+#endif
+
+// 1 = record every context switch and give / take for EX3_SCHED_TRACE_MS, then print the trace as hex lines;
+// on the PC: sched_trace_tool json capture.txt -o trace.json -> ui.perfetto.dev (see components/sched_trace).
+// ESP32: build with EX3_SCHED_TRACE=1 in the environment, CMakeLists.txt then adds the kernel hooks;
+// host: -DEX3_SCHED_TRACE=1 (the host kernel always has them)
+#ifndef EX3_SCHED_TRACE
+#define EX3_SCHED_TRACE 0
+#endif
+#ifndef EX3_SCHED_TRACE_MS
+#define EX3_SCHED_TRACE_MS 5000
+#endif
+
+#if EX3_SCHED_TRACE && !defined(SCHED_TRACE_HOOKS)
+#error "EX3_SCHED_TRACE needs the kernel trace hooks: set EX3_SCHED_TRACE=1 in the environment, not as a build flag"
+#endif
+
+// 1 = no heap for the example's own objects: Task A / B / C (TCB + stack) and, in the semaphore mode, the binary
+// semaphore are carved from one static arena sized at compile time; its footprint is printed at boot
+#ifndef EX3_STATIC_ALLOC
+#define EX3_STATIC_ALLOC 0
+#endif
+
+// Stack depth per task function: the generated one, else the blanket EX3_BASELINE_STACK. The profiler compares
+// against the blanket depth, not against a previously generated one.
+#define EX3_BASELINE_STACK 2048
+#ifndef STACK_DEPTH_taskA
+#define STACK_DEPTH_taskA EX3_BASELINE_STACK
+#endif
+#ifndef STACK_DEPTH_taskB
+#define STACK_DEPTH_taskB EX3_BASELINE_STACK
+#endif
+#ifndef STACK_DEPTH_taskC
+#define STACK_DEPTH_taskC EX3_BASELINE_STACK
+#endif
+
+#if EX3_STACK_PROFILE
+#define EX3_STACK(fn) STACK_PROFILE_RUN_DEPTH
+#else
+#define EX3_STACK(fn) STACK_DEPTH_##fn
+#endif
 
 /*
 What is Semaphore?
@@ -25,24 +157,228 @@ In RTOS this tool means a shared resource like a printer, a sensor, or a communi
 What happens if both workers try to use the tool at the same time without a semaphore?
 In this case, both workers might try to use the tool simultaneously, leading to conflicts, errors, or even damage to the tool. 
 The semaphore ensures that only one worker can use the tool at a time, preventing such issues.
+
+FAQ : Why would EX3_SIGNAL_NOTIFY be better here?
+Ans : Task A only wants to wake a task, and FreeRTOS can do that without any object: every task has a notification
+value in its TCB. xTaskNotifyGive() readies the task directly, ulTaskNotifyTake() waits for it. That saves the
+semaphore allocation and is faster (see host/bench/notify_bench). The difference: with a semaphore "someone" wakes,
+with a notification Task A must name the task - so Task A becomes a dispatcher that picks Task B or Task C itself.
+
+FAQ : Which of Task B / Task C gets the semaphore?
+Ans : Whichever the kernel finds first. Both wait on the same semaphore with the same priority; if one of them is
+still busy when the next give comes, the other one gets it, and a task that loops back while the semaphore is still
+given takes it again at once. Over time the split depends on timing, not on any rule. With EX3_SIGNAL_NOTIFY the
+dispatcher decides (round robin = strictly in turn, least recent = the idle task served longest ago) and counts
+gives / wakes / merged gives per task, so the split is visible (see host/bench/fair_dispatch_sim).
+
+FAQ : What happens to a give when Task B and Task C are both still busy?
+Ans : The binary semaphore is already given, so xSemaphoreGive() fails and the event is simply gone - two events
+became one. EX3_SIGNAL_COUNTING uses a counting semaphore instead: up to EX3_SEM_CEILING gives wait and are taken
+one by one later, and a give beyond that is still lost, but counted and reported (see host/bench/signal_loss_stress).
+
+FAQ : What if Task B AND Task C must both react to every signal?
+Ans : A semaphore (or a notification) wakes one task per give. EX3_SIGNAL_BROADCAST uses an event group: Task A
+sets a bit and every task waiting for it wakes in the same call. Each task acknowledges when it is done; the last
+acknowledgement clears the bit, and Task A skips (and counts) a signal if someone has not acknowledged the previous
+one yet. Wake-all latency for 2 .. 32 subscribers: host/bench/broadcast_bench.
+
+FAQ : How long does it take from the give in Task A until Task B / Task C runs?
+Ans : Build with EX3_WAKE_LATENCY=1. Task A takes a timestamp right before each give, the waiter reads the clock
+as soon as its take returns, and the difference goes into a histogram. With the default priorities (Task A above
+the waiters) the waiter can only run once Task A blocks in vTaskDelay(), so the number includes Task A's printf;
+with EX3_PRIO_WAITERS above EX3_PRIO_A the give switches to the waiter at once. On one core the timestamps come
+from CCOUNT (cycle resolution); with EX3_PLACE_CROSS_CORE from esp_timer (1 us), because the two CCOUNTs are
+not synchronised. Priority sweep on the host: host/bench/wake_latency_bench.
+
+FAQ : Why replace Task A with a timer interrupt (EX3_TIMER_ISR)?
+Ans : Task A does nothing but sleep and give, yet it needs a TCB and a 2048-byte stack, and vTaskDelay() can only
+count ticks (10 ms at CONFIG_FREERTOS_HZ=100) starting from whenever Task A got to run - every delay adds up. A
+gptimer alarm with auto-reload fires every EX3_TIMER_PERIOD_US on the hardware clock; the interrupt gives with
+xSemaphoreGiveFromISR() and, if that woke a higher-priority task, switches to it on return (portYIELD_FROM_ISR).
+Jitter and RAM of both variants: host/bench/isr_signal_bench.
+
+FAQ : Do Task A / Task B / Task C need 2048 bytes of stack each?
+Ans : Measure instead of guessing: with EX3_STACK_PROFILE=1 each task starts with a large stack, the kernel's
+high-water marks are sampled for EX3_STACK_PROFILE_MS, and a stack_sizes.h (peak + margin per task) is printed.
+Saved in include/, the next build creates each task with its own size. Profile with the signal mode and flags
+you ship - EX3_WAKE_LATENCY or the broadcast counters change how deep the printf calls go.
+
+FAQ : Task B printed 40 ms late - what ran in between?
+Ans : The log only shows that something was late. Build with EX3_SCHED_TRACE=1: the kernel's trace macros record
+every context switch and every give / take (with the core, the task and a microsecond timestamp) into a ring per
+core, and after EX3_SCHED_TRACE_MS the ring is printed. sched_trace_tool turns the captured console output into a
+Chrome trace: one lane per core, a bar for every time a task ran, a marker per give / take and an arrow from each
+give to the take it released. Open it in ui.perfetto.dev. Check on the host: host/bench/sched_trace_check.
+
+FAQ : What does EX3_STATIC_ALLOC change?
+Ans : The tasks are created with xTaskCreateStatic (pinned like EX3_PLACEMENT says) and the binary semaphore with
+xSemaphoreCreateBinaryStatic, all of them laid out in ex3_arena, a static array sized from exactly these objects.
+Nothing of them is on the heap, so boot cannot fail on a fragmented heap and the table printed at boot is the
+footprint. The dispatcher, counting semaphore, broadcast, histogram and timer of the other modes are created by
+their components and stay on the heap. Boot time and heap, dynamic vs static: host/bench/static_arena_boot.
 */
 
 
 
+#if EX3_SIGNAL == EX3_SIGNAL_NOTIFY
+// Dispatcher: Task B is waiter 0, Task C is waiter 1
+static notify_dispatch_t *dispatcher;
+#define EX3_TAKE(waiter, ticks)     notify_dispatch_wait(dispatcher, (waiter), (ticks))
+#elif EX3_SIGNAL == EX3_SIGNAL_COUNTING
+// Counting semaphore with counters for given / lost / taken
+static signal_sem_t *counting_sem;
+#define EX3_TAKE(waiter, ticks)     signal_sem_take(counting_sem, (ticks))
+#elif EX3_SIGNAL == EX3_SIGNAL_BROADCAST
+// Broadcast: Task B is subscriber 0, Task C is subscriber 1
+static event_broadcast_t *broadcast;
+#define EX3_TAKE(waiter, ticks)     event_broadcast_wait(broadcast, (waiter), (ticks))
+#define EX3_DONE(waiter)            event_broadcast_ack(broadcast, (waiter))
+#else
 // Declare a binary semaphore handle
 SemaphoreHandle_t xSemaphore;
+#define EX3_TAKE(waiter, ticks)     xSemaphoreTake(xSemaphore, (ticks))
+#endif
+#ifndef EX3_DONE
+#define EX3_DONE(waiter)            ((void)0)   // only the broadcast is acknowledged
+#endif
+
+#if EX3_WAKE_LATENCY
+static wake_latency_t *wake_lat;
+#define EX3_STAMP_GIVE()            wake_latency_give(wake_lat)
+#define EX3_STAMP_TAKE()            wake_latency_take(wake_lat)
+#else
+#define EX3_STAMP_GIVE()            ((void)0)
+#define EX3_STAMP_TAKE()            ((void)0)
+#endif
+
+#if EX3_TIMER_ISR
+static timer_signal_t *timer_sig;
+
+#if EX3_WAKE_LATENCY
+static void stamp_from_isr(void *arg)
+{
+    wake_latency_give(arg);             // the interrupt's give is timestamped like Task A's
+}
+#endif
+
+//Called by Task B / Task C after each signal: the one that took every EX3_STATS_EVERY-th fire prints
+static void timer_report(void)
+{
+    timer_signal_stats_t st;
+    timer_signal_get(timer_sig, &st);
+    if (st.fires % EX3_STATS_EVERY == 0) {
+        printf("Timer: %u fired, %u lost, interval %u..%u us\n", (unsigned)st.fires, (unsigned)st.lost,
+               (unsigned)st.min_interval_us, (unsigned)st.max_interval_us);
+#if EX3_WAKE_LATENCY
+        wake_latency_report_t lat;
+        wake_latency_report(wake_lat, &lat);
+        printf("Timer: wake p50 %u p99 %u max %u ns (%u)\n", (unsigned)lat.p50_ns,
+               (unsigned)lat.p99_ns, (unsigned)lat.max_ns, (unsigned)lat.samples);
+#endif
+    }
+}
+#define EX3_TIMER_REPORT()          timer_report()
+#else
+#define EX3_TIMER_REPORT()          ((void)0)
+#endif
+
+#if EX3_STATIC_ALLOC
+// The arena holds exactly the tasks (and the semaphore) this configuration creates
+#define EX3_ARENA_TASKS     (STATIC_ARENA_TASK_BYTES(EX3_STACK(taskB)) + STATIC_ARENA_TASK_BYTES(EX3_STACK(taskC)) + \
+                             (EX3_TIMER_ISR ? 0 : STATIC_ARENA_TASK_BYTES(EX3_STACK(taskA))))
+#define EX3_ARENA_SEM       ((EX3_SIGNAL == EX3_SIGNAL_SEMAPHORE) ? STATIC_ARENA_SEMAPHORE_BYTES : 0)
+STATIC_ARENA_DEFINE(ex3_arena, EX3_ARENA_TASKS + EX3_ARENA_SEM);
+
+#if EX3_PLACEMENT != EX3_PLACE_ANY && configNUMBER_OF_CORES > 1
+#define EX3_CREATE(fn, name, prio, handle, core)    static_arena_task(&ex3_arena, fn, name, EX3_STACK(fn), NULL, prio, core, handle)
+#else
+#define EX3_CREATE(fn, name, prio, handle, core)    static_arena_task(&ex3_arena, fn, name, EX3_STACK(fn), NULL, prio, STATIC_ARENA_ANY_CORE, handle)
+#endif
+#elif EX3_PLACEMENT != EX3_PLACE_ANY && configNUMBER_OF_CORES > 1
+#define EX3_CREATE(fn, name, prio, handle, core)    xTaskCreatePinnedToCore(fn, name, EX3_STACK(fn), NULL, prio, handle, core)
+#else
+#define EX3_CREATE(fn, name, prio, handle, core)    xTaskCreate(fn, name, EX3_STACK(fn), NULL, prio, handle)
+#endif
+#define EX3_CORE_A          0
+#define EX3_CORE_WAITERS    ((EX3_PLACEMENT == EX3_PLACE_CROSS_CORE) ? 1 : 0)
+#define EX3_WAITER_B    0
+#define EX3_WAITER_C    1
 
 
 
 //-------------------------------------------------------------------------------------------------
 //TASK-A : Give the semaphore every second
 void taskA(void *pvParameters) {
+#if EX3_SIGNAL != EX3_SIGNAL_SEMAPHORE
+    uint32_t signals = 0;
+#endif
+#if EX3_WAKE_LATENCY
+    uint32_t stamped = 0;
+#endif
     while (1) {
 
+#if EX3_SIGNAL == EX3_SIGNAL_NOTIFY
+        //notify_dispatch_give_next() = xTaskNotifyGive() to the task the policy picks
+        //If that task was already notified, the give merges into the pending one (counted as coalesced).
+        EX3_STAMP_GIVE();
+        int woken = notify_dispatch_give_next(dispatcher);  // Signal exactly one task
+        printf("Task A: Notified Task %c\n", woken == EX3_WAITER_B ? 'B' : 'C');
+
+        if (++signals % EX3_STATS_EVERY == 0) {
+            notify_dispatch_counters_t b, c;
+            notify_dispatch_get_counters(dispatcher, EX3_WAITER_B, &b);
+            notify_dispatch_get_counters(dispatcher, EX3_WAITER_C, &c);
+            // woke = signals received, given = signals sent to it, merged = given while still pending
+            printf("Task A: B woke %u/%u given, C woke %u/%u given, merged %u/%u\n",
+                   (unsigned)b.wakes, (unsigned)b.gives, (unsigned)c.wakes, (unsigned)c.gives,
+                   (unsigned)b.coalesced, (unsigned)c.coalesced);
+        }
+#elif EX3_SIGNAL == EX3_SIGNAL_COUNTING
+        //signal_sem_give() = xSemaphoreGive() on a counting semaphore: up to EX3_SEM_CEILING gives can wait.
+        //Past the ceiling the give is lost - and counted, instead of silently having no effect.
+        printf("Task A: Giving semaphore\n");
+        EX3_STAMP_GIVE();
+        if (signal_sem_give(counting_sem) != pdPASS) {
+            printf("Task A: Signal lost, Task B and Task C are behind\n");
+        }
+
+        if (++signals % EX3_STATS_EVERY == 0) {
+            signal_sem_stats_t st;
+            signal_sem_get(counting_sem, &st);
+            printf("Task A: %u given, %u lost, max %u of %u pending\n", (unsigned)st.gives, (unsigned)st.lost,
+                   (unsigned)st.high_water, (unsigned)st.ceiling);
+        }
+#elif EX3_SIGNAL == EX3_SIGNAL_BROADCAST
+        //event_broadcast_publish() = xEventGroupSetBits(): every waiting task wakes, not just one.
+        //Timeout 0: if Task B or Task C has not acknowledged the last signal yet, skip this one (counted).
+        printf("Task A: Broadcasting\n");
+        EX3_STAMP_GIVE();
+        if (event_broadcast_publish(broadcast, 0) != pdPASS) {
+            printf("Task A: Broadcast skipped, Task B or Task C still busy\n");
+        }
+
+        if (++signals % EX3_STATS_EVERY == 0) {
+            event_broadcast_stats_t st;
+            event_broadcast_get(broadcast, &st);
+            printf("Task A: %u published, %u skipped, %u acks\n", (unsigned)st.published,
+                   (unsigned)st.skipped, (unsigned)st.acks);
+        }
+#else
         //xSemaphoreGive() = Function to give the semaphore
-        //If the semaphore is already given, this function has no effect.
+        //If the semaphore is already given, this function has no effect (the event is lost, see EX3_SIGNAL_COUNTING).
         printf("Task A: Giving semaphore\n");
+        EX3_STAMP_GIVE();                     // timestamp right before the give (EX3_WAKE_LATENCY)
         xSemaphoreGive(xSemaphore);           // Signal the semaphore
+#endif
+
+#if EX3_WAKE_LATENCY
+        if (++stamped % EX3_STATS_EVERY == 0) {
+            wake_latency_report_t lat;
+            wake_latency_report(wake_lat, &lat);
+            printf("Task A: wake p50 %u p99 %u max %u ns (%u)\n", (unsigned)lat.p50_ns,
+                   (unsigned)lat.p99_ns, (unsigned)lat.max_ns, (unsigned)lat.samples);
+        }
+#endif
 
         vTaskDelay(pdMS_TO_TICKS(1000));      // Wait 1 second
     }
@@ -55,8 +391,11 @@ void taskA(void *pvParameters) {
 void taskB(void *pvParameters) {
     while (1) {
         // Wait indefinitely until Task A gives the semaphore
-        if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE) {
+        if (EX3_TAKE(EX3_WAITER_B, portMAX_DELAY) == pdTRUE) {
+            EX3_STAMP_TAKE();                 // first thing after the take (EX3_WAKE_LATENCY)
             printf("Task B: Received semaphore!\n");
+            EX3_DONE(EX3_WAITER_B);
+            EX3_TIMER_REPORT();
         }
     }
 }
@@ -68,8 +407,11 @@ void taskB(void *pvParameters) {
 void taskC(void *pvParameters) {
     while (1) {
         // Wait indefinitely until Task A gives the semaphore
-        if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE) {
+        if (EX3_TAKE(EX3_WAITER_C, portMAX_DELAY) == pdTRUE) {
+            EX3_STAMP_TAKE();                 // first thing after the take (EX3_WAKE_LATENCY)
             printf("Task C: Received semaphore!\n");
+            EX3_DONE(EX3_WAITER_C);
+            EX3_TIMER_REPORT();
         }
     }
 }
@@ -78,18 +420,108 @@ void taskC(void *pvParameters) {
 
 //-------------------------------------------------------------------------------------------------
 void app_main(void) {
+#if EX3_BINARY_LOG
+    BaseType_t log_started = binlog_start(NULL);      // before the first printf
+    configASSERT(log_started == pdPASS);
+#endif
+
+#if EX3_SIGNAL == EX3_SIGNAL_NOTIFY
+    //Create the dispatcher (no semaphore: each waiter is notified directly)
+    dispatcher = notify_dispatch_create(2, EX3_DISPATCH_POLICY);
+
+    if (dispatcher == NULL) {
+        printf("Failed to create dispatcher\n");
+        return;
+    }
+#elif EX3_SIGNAL == EX3_SIGNAL_COUNTING
+    //Create a counting semaphore (initially empty) that holds up to EX3_SEM_CEILING gives
+    counting_sem = signal_sem_create(EX3_SEM_CEILING);
+
+    if (counting_sem == NULL) {
+        printf("Failed to create semaphore\n");
+        return;
+    }
+#elif EX3_SIGNAL == EX3_SIGNAL_BROADCAST
+    //Create the broadcast for two subscribers (Task B and Task C)
+    broadcast = event_broadcast_create(2);
+
+    if (broadcast == NULL) {
+        printf("Failed to create broadcast\n");
+        return;
+    }
+#else
     //Create a binary semaphore (initially empty)
+#if EX3_STATIC_ALLOC
+    xSemaphore = static_arena_binary(&ex3_arena, "xSemaphore");
+#else
     xSemaphore = xSemaphoreCreateBinary();
+#endif
 
     if (xSemaphore == NULL) {
         printf("Failed to create semaphore\n");
         return;
     }
+#endif
+
+#if EX3_WAKE_LATENCY
+    //CCOUNT is per core: cycle resolution only if Task A and the waiters share a core
+    wake_lat = wake_latency_create((EX3_PLACEMENT == EX3_PLACE_SAME_CORE || configNUMBER_OF_CORES == 1)
+                                   ? WAKE_LATENCY_CYCLES : WAKE_LATENCY_TIMER);
 
+    if (wake_lat == NULL) {
+        printf("Failed to create latency histogram\n");
+        return;
+    }
+#endif
+
+
+#if EX3_SCHED_TRACE
+    // Before the tasks exist, so the trace starts with their first give / take
+#if EX3_SIGNAL == EX3_SIGNAL_SEMAPHORE
+    sched_trace_name_queue(xSemaphore, "xSemaphore");
+#endif
+    BaseType_t trace_started = sched_trace_capture(SCHED_TRACE_ONE_SHOT, EX3_SCHED_TRACE_MS);
+    configASSERT(trace_started == pdPASS);
+#endif
+
+    // Create the waiting tasks first: by default Task A has the higher priority and signals as soon as it exists
+    TaskHandle_t task_b = NULL, task_c = NULL;
+    EX3_CREATE(taskB, "TaskB", EX3_PRIO_WAITERS, &task_b, EX3_CORE_WAITERS);
+    EX3_CREATE(taskC, "TaskC", EX3_PRIO_WAITERS, &task_c, EX3_CORE_WAITERS);
+#if EX3_SIGNAL == EX3_SIGNAL_NOTIFY
+    notify_dispatch_add(dispatcher, task_b);  // EX3_WAITER_B
+    notify_dispatch_add(dispatcher, task_c);  // EX3_WAITER_C
+#endif
+#if EX3_TIMER_ISR
+    //No Task A: the timer interrupt gives the semaphore
+    timer_signal_config_t timer_config = { .period_us = EX3_TIMER_PERIOD_US, .sem = xSemaphore };
+#if EX3_WAKE_LATENCY
+    timer_config.on_fire = stamp_from_isr;
+    timer_config.arg = wake_lat;
+#endif
+    timer_sig = timer_signal_start(&timer_config);
+
+    if (timer_sig == NULL) {
+        printf("Failed to start timer\n");
+    }
+#else
+    TaskHandle_t task_a = NULL;
+    EX3_CREATE(taskA, "TaskA", EX3_PRIO_A, &task_a, EX3_CORE_A);
+#endif
+#if EX3_STATIC_ALLOC
+    if (static_arena_report(&ex3_arena) != pdPASS) {
+        printf("Static arena too small\n");
+    }
+#endif
 
-    // Create the two tasks
-    xTaskCreate(taskA, "TaskA", 2048, NULL, 2, NULL);
-    xTaskCreate(taskB, "TaskB", 2048, NULL, 1, NULL);
-    xTaskCreate(taskC, "TaskC", 2048, NULL, 1, NULL);
+#if EX3_STACK_PROFILE
+    // The ids become STACK_DEPTH_taskA .. STACK_DEPTH_taskC in the generated header
+#if !EX3_TIMER_ISR
+    stack_profile_watch(task_a, "taskA", EX3_STACK(taskA), EX3_BASELINE_STACK);
+#endif
+    stack_profile_watch(task_b, "taskB", EX3_STACK(taskB), EX3_BASELINE_STACK);
+    stack_profile_watch(task_c, "taskC", EX3_STACK(taskC), EX3_BASELINE_STACK);
+    stack_profile_start(100, EX3_STACK_PROFILE_MS);
+#endif
 }
 //-------------------------------------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,24 @@
+//producer_task / consumer_task on a typed C++ queue (EX2_TRANSPORT_TYPED_QUEUE, src/typed_queue_tasks.cpp)
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Items the queue can hold - shared by main.c and StaticQueue<int, EX2_QUEUE_DEPTH> in typed_queue_tasks.cpp
+#define EX2_QUEUE_DEPTH             10
+
+//Construct the StaticQueue<int, EX2_QUEUE_DEPTH> (static storage, on the first call) and return its handle
+QueueHandle_t typed_queue_create(void);
+
+//Same behaviour as producer_task / consumer_task with the default flags, on the typed queue
+void typed_producer_task(void *pv);
+void typed_consumer_task(void *pv);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,8 +1,26 @@
 #include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"          //TASK FUNCTIONS LIB
 #include "freertos/queue.h"         //QUEUE FUNCTIONS LIB
 #include "esp_log.h"
+#include "spsc_ring.h"              //LOCK-FREE SPSC RING (components/spsc_ring)
+#include "queue_batch.h"            //BATCHED QUEUE SEND/RECEIVE (components/queue_batch)
+#include "msg_pool.h"               //ZERO-COPY MESSAGE POOL (components/msg_pool)
+#include "rate_ctrl.h"              //ADAPTIVE PRODUCER RATE (components/rate_ctrl)
+#include "queue_stats.h"            //QUEUE TELEMETRY REGISTRY (components/queue_stats)
+#include "async_log.h"              //DEFERRED LOGGING (components/async_log)
+#include "binlog.h"                 //BINARY LOGGING (components/binlog)
+#include "stack_profile.h"          //STACK PROFILING (components/stack_profile)
+#include "runtime_stats.h"          //CPU RUNTIME STATS (components/runtime_stats)
+#include "static_arena.h"           //STATIC ALLOCATION ARENA (components/static_arena)
+#include "typed_queue_tasks.h"      //C++ TYPED QUEUE PRODUCER / CONSUMER (src/typed_queue_tasks.cpp)
+#include "sharded_queue.h"          //SHARDED MPMC QUEUE (components/sharded_queue)
+
+//Stack sizes measured by a profiling run (EX2_STACK_PROFILE=1), if include/stack_sizes.h was generated
+#if __has_include("stack_sizes.h")
+#include "stack_sizes.h"
+#endif
 
 
 /*
@@ -21,13 +39,276 @@ This is particularly important in real-time systems where timing and responsiven
 */
 
 
+//---------------------------------------------------------------------------------------------------
+//Transport between producer_task and consumer_task, selected at build time
+//(e.g. platformio.ini -> build_flags = -DEX2_TRANSPORT=EX2_TRANSPORT_SPSC_RING)
+#define EX2_TRANSPORT_QUEUE         0       //FreeRTOS queue: xQueueSend / xQueueReceive (default)
+#define EX2_TRANSPORT_SPSC_RING     1       //Lock-free ring: spsc_ring_send / spsc_ring_receive
+#define EX2_TRANSPORT_MSG_POOL      2       //Zero-copy: frames live in a msg_pool, the queue carries pointers
+#define EX2_TRANSPORT_TYPED_QUEUE   3       //C++ StaticQueue<int, EX2_QUEUE_DEPTH>: typed send / receive, std::chrono timeouts
+#define EX2_TRANSPORT_SHARDED_QUEUE 4       //One queue shard per core: sharded_queue_send / sharded_queue_receive
+
+#ifndef EX2_TRANSPORT
+#define EX2_TRANSPORT EX2_TRANSPORT_QUEUE
+#endif
+
+//EX2_QUEUE_DEPTH (items the queue can hold) is in typed_queue_tasks.h: the C++ queue needs it at compile time
+#define EX2_RING_DEPTH              16      //SPSC ring capacity (power of two)
+
+//Frame payload for EX2_TRANSPORT_MSG_POOL (real frames are 256..1500 bytes)
+#ifndef EX2_MSG_SIZE
+#define EX2_MSG_SIZE                256
+#endif
+
+//Items sent per call (1 = one xQueueSend per item). With > 1 the producer sends EX2_BATCH_SIZE values
+//per period with queue_batch_send and the consumer drains everything pending on each wake-up.
+#ifndef EX2_BATCH_SIZE
+#define EX2_BATCH_SIZE              1
+#endif
+
+//1 = producer delay adapts to queue occupancy and drops (rate_ctrl), 0 = fixed 200 ms
+#ifndef EX2_ADAPTIVE_PRODUCER
+#define EX2_ADAPTIVE_PRODUCER       0
+#endif
+
+//1 = the queue is created through queue_stats (registered as "ex2_q") and the consumer prints
+//occupancy / drop / blocking-time telemetry every EX2_STATS_PRINT_EVERY items
+#ifndef EX2_QUEUE_STATS
+#define EX2_QUEUE_STATS             0
+#endif
+#define EX2_STATS_PRINT_EVERY       25
+
+//1 = ESP_LOGI only queues the line; the async_log drain task formats and prints it later
+#ifndef EX2_ASYNC_LOG
+#define EX2_ASYNC_LOG               0
+#endif
+
+//1 = ESP_LOGI sends a binary record (format ID, timestamp, arguments); decode with host/tools/binlog_tool
+#ifndef EX2_BINARY_LOG
+#define EX2_BINARY_LOG              0
+#endif
+
+//1 = profiling build: producer / consumer get STACK_PROFILE_RUN_DEPTH, after EX2_STACK_PROFILE_MS their
+//peak stack use and a generated stack_sizes.h are printed (see components/stack_profile)
+#ifndef EX2_STACK_PROFILE
+#define EX2_STACK_PROFILE           0
+#endif
+#ifndef EX2_STACK_PROFILE_MS
+#define EX2_STACK_PROFILE_MS        30000
+#endif
+
+//Stack depth per task: the generated one, else the blanket EX2_BASELINE_STACK. The profiler compares against
+//the blanket depth, not against a previously generated one.
+#define EX2_BASELINE_STACK          2048
+#ifndef STACK_DEPTH_producer
+#define STACK_DEPTH_producer        EX2_BASELINE_STACK
+#endif
+#ifndef STACK_DEPTH_consumer
+#define STACK_DEPTH_consumer        EX2_BASELINE_STACK
+#endif
+
+//1 = print per-task / per-core CPU use every EX2_RUNTIME_STATS_MS (see components/runtime_stats)
+#ifndef EX2_RUNTIME_STATS
+#define EX2_RUNTIME_STATS           0
+#endif
+#ifndef EX2_RUNTIME_STATS_MS
+#define EX2_RUNTIME_STATS_MS        5000
+#endif
+
+//1 = no heap for the example's own objects: producer / consumer (TCB + stack) and the queue are carved
+//from one static arena sized below at compile time, and its footprint is printed at boot
+#ifndef EX2_STATIC_ALLOC
+#define EX2_STATIC_ALLOC            0
+#endif
+
+#if EX2_STACK_PROFILE
+#define EX2_STACK(id)               STACK_PROFILE_RUN_DEPTH
+#else
+#define EX2_STACK(id)               STACK_DEPTH_##id
+#endif
+
+#if EX2_BATCH_SIZE > 1 && EX2_TRANSPORT != EX2_TRANSPORT_QUEUE
+#error "EX2_BATCH_SIZE > 1 works on the FreeRTOS queue only (EX2_TRANSPORT_QUEUE)"
+#endif
+
+#if EX2_ASYNC_LOG && EX2_BINARY_LOG
+#error "EX2_ASYNC_LOG and EX2_BINARY_LOG both replace ESP_LOGI, pick one"
+#endif
+
+#if EX2_TRANSPORT == EX2_TRANSPORT_TYPED_QUEUE && (EX2_ADAPTIVE_PRODUCER || EX2_ASYNC_LOG || EX2_BINARY_LOG)
+#error "EX2_TRANSPORT_TYPED_QUEUE ports the plain producer / consumer: not with EX2_ADAPTIVE_PRODUCER, EX2_ASYNC_LOG or EX2_BINARY_LOG"
+#endif
+
+#if EX2_QUEUE_STATS && (EX2_BATCH_SIZE > 1 || EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING || \
+                        EX2_TRANSPORT == EX2_TRANSPORT_TYPED_QUEUE || EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE)
+#error "EX2_QUEUE_STATS instruments single-item xQueueSend / xQueueReceive (queue or msg-pool transport)"
+#endif
+
+#if EX2_STATIC_ALLOC && EX2_QUEUE_STATS
+#error "EX2_QUEUE_STATS creates the queue itself (on the heap); EX2_STATIC_ALLOC needs the plain queue"
+#endif
+
+#if EX2_RUNTIME_STATS && !RUNTIME_STATS_AVAILABLE
+#error "EX2_RUNTIME_STATS needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (host: cmake -DHOST_RUNTIME_STATS=ON)"
+#endif
+
+/*
+FAQ : Why is the SPSC ring faster than the queue?
+Ans : xQueueSend / xQueueReceive enter a critical section on every call, even when no task is waiting.
+The ring has exactly one writer per index (producer -> head, consumer -> tail), so plain atomic loads/stores
+are enough, and the scheduler is only involved when the other side is really asleep (task notification).
+It is only valid for ONE producer task and ONE consumer task, which is exactly this example.
+
+FAQ : When does zero-copy (EX2_TRANSPORT_MSG_POOL) help?
+Ans : A queue copies the item by value twice per hop (in on send, out on receive). For an int that is nothing,
+for a 1500 byte frame it is two large memcpy inside a critical section. With the pool the producer fills a
+block in place and only the pointer (4 bytes) is queued; the consumer gives the block back with msg_pool_free().
+
+FAQ : What does EX2_ADAPTIVE_PRODUCER change?
+Ans : The fixed vTaskDelay(200 ms) becomes the delay returned by rate_ctrl_update(). It shrinks while the queue
+stays nearly empty and grows when the queue fills up or a send fails, and every failed send is counted as a drop
+instead of being silently ignored. Statistics are logged every EX2_RATE_LOG_EVERY sends.
+
+FAQ : What does EX2_QUEUE_STATS cost?
+Ans : queue_stats_send / queue_stats_receive first try the queue without blocking and only read the clock when
+they really have to wait, so an uncontended call adds a few atomic counter increments (see host/bench/queue_stats_bench).
+The queue is also added to the FreeRTOS queue registry (CONFIG_FREERTOS_QUEUE_REGISTRY_SIZE), so a debugger
+shows it as "ex2_q".
+
+FAQ : Why is EX2_ASYNC_LOG useful here?
+Ans : consumer_task logs every item. ESP_LOGI formats the line and waits for the UART (115200 baud, ~3 ms per line)
+before the next xQueueReceive, so the consumer - not the queue - sets the throughput. With EX2_ASYNC_LOG the call
+only copies the arguments into a per-core ring (a few hundred ns) and the printing happens at priority 1.
+
+FAQ : What does EX2_BINARY_LOG save?
+Ans : "Got value: 42" goes out as ~6 bytes (site ID, time delta, tag index, value) instead of ~44 bytes of coloured
+text, so the UART is busy ~7x less per item. The format strings stay in the firmware ELF, where binlog_tool finds them.
+Queue telemetry (EX2_QUEUE_STATS) still prints text; the decoder shows it as-is and picks up at the next SYNC record.
+
+FAQ : How much stack do producer / consumer need?
+Ans : Depends on the mode: the MSG_POOL transport and ESP_LOGI formatting need more than the ring with
+EX2_ASYNC_LOG. Profile the mode you ship: with EX2_STACK_PROFILE=1 the printed stack_sizes.h (peak + margin
+per task) goes into include/, and the next build creates both tasks with those sizes instead of 2048.
+
+FAQ : Where does the CPU time go - producer, consumer or logging?
+Ans : EX2_RUNTIME_STATS=1 prints, every EX2_RUNTIME_STATS_MS, how much of the last window each task ran (from
+the kernel's run-time counters, CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) and how busy each core was. Run it
+once as is and once with EX2_ASYNC_LOG=1: the consumer's share moves to the "async_log" task, which runs at
+priority 1 when nothing else wants the CPU. The sampler's own cost: host/bench/runtime_stats_overhead.
+
+FAQ : What does EX2_STATIC_ALLOC change?
+Ans : xTaskCreate / xQueueCreate become their ...Static versions, with TCBs, stacks and the queue storage laid
+out one after the other in ex2_arena, a static array whose size is the sum of exactly those objects. Boot does
+not touch the heap for them, the free heap after boot is known at link time (.bss instead of heap), and the
+printed table shows what each object costs. The SPSC ring and the message pool are allocated by their
+components and stay on the heap. Boot time and heap, dynamic vs static: host/bench/static_arena_boot.
+
+FAQ : What does EX2_TRANSPORT_TYPED_QUEUE add?
+Ans : xQueueSend(q, &value, ...) takes a void * and trusts that it points to sizeof(int) bytes - a short or a
+pointer compiles just as well. The typed transport runs the producer / consumer from src/typed_queue_tasks.cpp
+on StaticQueue<int, EX2_QUEUE_DEPTH> (components/static_queue): the item type is part of the queue's type, its
+storage is a static object, and timeouts are std::chrono durations (10ms, not pdMS_TO_TICKS(10)). The same
+xQueueSend / xQueueReceive run underneath; cost vs the C calls: host/bench/static_queue_bench.
+
+FAQ : What is EX2_TRANSPORT_SHARDED_QUEUE for?
+Ans : One queue shared by several producers on both cores is one spinlock that every send and receive fights
+over. The sharded queue (components/sharded_queue) keeps one queue per core: a producer sends into its home
+shard, a consumer takes from its own shard first and steals from the other one only when its own is empty.
+Each producer's values still arrive in order. The example's tasks are not pinned, so their home shards come
+from their task handles, not from a core. With the single producer / consumer of this example there is
+nothing to contend for, so this mainly shows the API; throughput for 1..8 producers and 1..4 consumers against
+one shared queue: host/bench/sharded_queue_bench.
+*/
+//---------------------------------------------------------------------------------------------------
+
+
+//Message passed by pointer in EX2_TRANSPORT_MSG_POOL mode
+typedef struct {
+    int value;
+    size_t len;
+    uint8_t data[EX2_MSG_SIZE];
+} ex2_msg_t;
+
+
 static const char* TAG = "EX2";
+#if EX2_STATIC_ALLOC
+#if EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING || EX2_TRANSPORT == EX2_TRANSPORT_TYPED_QUEUE || \
+    EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE
+#define EX2_ARENA_QUEUE_BYTES       0       //Ring / shards on the heap, StaticQueue already static
+#else
+#define EX2_ARENA_QUEUE_BYTES       STATIC_ARENA_QUEUE_BYTES(EX2_QUEUE_DEPTH, \
+                                        EX2_TRANSPORT == EX2_TRANSPORT_MSG_POOL ? sizeof(ex2_msg_t *) : sizeof(int))
+#endif
+STATIC_ARENA_DEFINE(ex2_arena, STATIC_ARENA_TASK_BYTES(EX2_STACK(producer)) +
+                               STATIC_ARENA_TASK_BYTES(EX2_STACK(consumer)) + EX2_ARENA_QUEUE_BYTES);
+#endif
+#if EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING
+static spsc_ring_t *ring;
+#elif EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE
+static sharded_queue_t *sq;
+#else
 static QueueHandle_t q;
+#endif
+#if EX2_TRANSPORT == EX2_TRANSPORT_MSG_POOL
+static msg_pool_t *pool;
+#endif
+#if EX2_QUEUE_STATS
+static queue_stats_t *q_stats;
+
+#define EX2_QUEUE_SEND(item, ticks)       queue_stats_send(q_stats, (item), (ticks))
+#define EX2_QUEUE_RECEIVE(item, ticks)    queue_stats_receive(q_stats, (item), (ticks))
+#elif EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE
+#define EX2_QUEUE_SEND(item, ticks)       sharded_queue_send(sq, (item), (ticks))
+#define EX2_QUEUE_RECEIVE(item, ticks)    sharded_queue_receive(sq, (item), (ticks))
+#else
+#define EX2_QUEUE_SEND(item, ticks)       xQueueSend(q, (item), (ticks))
+#define EX2_QUEUE_RECEIVE(item, ticks)    xQueueReceive(q, (item), (ticks))
+#endif
+
+#define EX2_RATE_LOG_EVERY          50      //Adaptive producer: log statistics every N sends
+
+#if EX2_ASYNC_LOG
+//Every ESP_LOGI below becomes a deferred call with the same arguments
+#undef ESP_LOGI
+#define ESP_LOGI ASYNC_LOGI
+#elif EX2_BINARY_LOG
+//Every ESP_LOGI below becomes a binary record with the same arguments
+#undef ESP_LOGI
+#define ESP_LOGI BINLOG_LOGI
+#endif
+
+
+//Items currently waiting between producer and consumer (feeds the adaptive producer)
+static inline UBaseType_t ex2_pending(void) {
+#if EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING
+    return (UBaseType_t)spsc_ring_count(ring);
+#elif EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE
+    return sharded_queue_count(sq);
+#else
+    return uxQueueMessagesWaiting(q);
+#endif
+}
+
+//Items the transport can hold: the same scale as ex2_pending() (all shards together for the sharded queue)
+static inline UBaseType_t ex2_capacity(void) {
+#if EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING
+    return EX2_RING_DEPTH;
+#elif EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE
+    return sharded_queue_capacity(sq);
+#else
+    return EX2_QUEUE_DEPTH;
+#endif
+}
 
 
 //---------------------------------------------------------------------------------------------------
 void producer_task(void *pv) {
     int value = 0;
+#if EX2_ADAPTIVE_PRODUCER
+    rate_ctrl_t rate;
+    rate_ctrl_config_t rate_cfg = RATE_CTRL_DEFAULT_CONFIG();
+    rate_ctrl_init(&rate, &rate_cfg);
+#endif
     while (1) {
         value++;
         //-----------------------------------------------------------------------------------------
@@ -44,14 +325,53 @@ void producer_task(void *pv) {
         >> Returns: pdPASS if the item was successfully sent to the queue, otherwise errQUEUE_FULL.
             */
         //-----------------------------------------------------------------------------------------
-        if (xQueueSend(q, &value, pdMS_TO_TICKS(10)) == pdPASS) {
+#if EX2_BATCH_SIZE > 1
+        //Batch mode: EX2_BATCH_SIZE consecutive values in ONE call -> the consumer is woken once per batch
+        int batch[EX2_BATCH_SIZE];
+        for (int i = 0; i < EX2_BATCH_SIZE; i++) {
+            batch[i] = value + i;
+        }
+        value += EX2_BATCH_SIZE - 1;
+        size_t batch_sent = queue_batch_send(q, batch, EX2_BATCH_SIZE, sizeof(int), pdMS_TO_TICKS(10));
+        BaseType_t sent = (batch_sent == EX2_BATCH_SIZE) ? pdPASS : errQUEUE_FULL;
+#elif EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING
+        BaseType_t sent = spsc_ring_send(ring, &value, pdMS_TO_TICKS(10));      //Same timeout / return values as xQueueSend
+#elif EX2_TRANSPORT == EX2_TRANSPORT_MSG_POOL
+        //Zero-copy: fill a pool block in place, then queue only its pointer
+        BaseType_t sent = errQUEUE_FULL;
+        ex2_msg_t *msg = msg_pool_alloc(pool, pdMS_TO_TICKS(10));
+        if (msg != NULL) {
+            msg->value = value;
+            msg->len = sizeof(msg->data);
+            memset(msg->data, value & 0xff, sizeof(msg->data));
+            sent = EX2_QUEUE_SEND(&msg, pdMS_TO_TICKS(10));
+            if (sent != pdPASS) {
+                msg_pool_free(pool, msg);       //Not sent -> we still own it, give it back
+            }
+        }
+#else
+        BaseType_t sent = EX2_QUEUE_SEND(&value, pdMS_TO_TICKS(10));
+#endif
+        if (sent == pdPASS) {
             // sent sucessfully
         }
         else
         {
             //If the queue is full and xTicksToWait == 0: the call returns immediately with failure
         }
+#if EX2_ADAPTIVE_PRODUCER
+        //Backpressure: the next delay depends on how full the queue is and on whether this send was dropped
+        TickType_t next_delay = rate_ctrl_update(&rate, ex2_pending(), ex2_capacity(), sent);
+        if ((rate.attempts % EX2_RATE_LOG_EVERY) == 0) {
+            uint32_t loss = rate_ctrl_loss_permille(&rate);
+            ESP_LOGI(TAG, "Rate: period %u ms, sent %u, dropped %u (%u.%u%% loss)",
+                     (unsigned)(next_delay * portTICK_PERIOD_MS), (unsigned)rate.sent, (unsigned)rate.dropped,
+                     (unsigned)(loss / 10), (unsigned)(loss % 10));
+        }
+        vTaskDelay(next_delay);
+#else
         vTaskDelay(pdMS_TO_TICKS(200));
+#endif
     }
 }
 //---------------------------------------------------------------------------------------------------
@@ -59,7 +379,16 @@ void producer_task(void *pv) {
 
 //---------------------------------------------------------------------------------------------------
 void consumer_task(void *pv) {
+#if EX2_BATCH_SIZE > 1
+    int rx_batch[EX2_QUEUE_DEPTH];
+#elif EX2_TRANSPORT == EX2_TRANSPORT_MSG_POOL
+    ex2_msg_t *rx_msg = NULL;
+#else
     int rx = 0;
+#endif
+#if EX2_QUEUE_STATS
+    uint32_t stats_countdown = EX2_STATS_PRINT_EVERY;
+#endif
     while (1) {
         //-----------------------------------------------------------------------------------------
         /*
@@ -74,9 +403,34 @@ void consumer_task(void *pv) {
             If the queue is empty and xTicksToWait == 0: the call returns immediately with failure
         >> Returns: pdPASS if an item was successfully received from the queue, otherwise errQUEUE_EMPTY.
         */
-        if (xQueueReceive(q, &rx, portMAX_DELAY) == pdPASS) {
+#if EX2_BATCH_SIZE > 1
+        //Drain mode: block for the first item, then take everything already pending (one wake-up)
+        size_t received = queue_batch_receive(q, rx_batch, EX2_QUEUE_DEPTH, sizeof(int), portMAX_DELAY);
+        for (size_t i = 0; i < received; i++) {
+            ESP_LOGI(TAG, "Got value: %d", rx_batch[i]);
+        }
+#elif EX2_TRANSPORT == EX2_TRANSPORT_MSG_POOL
+        //Zero-copy: only the pointer is copied out; the block is ours until msg_pool_free()
+        if (EX2_QUEUE_RECEIVE(&rx_msg, portMAX_DELAY) == pdPASS) {
+            ESP_LOGI(TAG, "Got value: %d (%u byte frame)", rx_msg->value, (unsigned)rx_msg->len);
+            msg_pool_free(pool, rx_msg);
+        }
+#else
+#if EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING
+        BaseType_t received = spsc_ring_receive(ring, &rx, portMAX_DELAY);     //Sleeps on a task notification while empty
+#else
+        BaseType_t received = EX2_QUEUE_RECEIVE(&rx, portMAX_DELAY);
+#endif
+        if (received == pdPASS) {
             ESP_LOGI(TAG, "Got value: %d", rx);
         }
+#endif
+#if EX2_QUEUE_STATS
+        if (--stats_countdown == 0) {
+            stats_countdown = EX2_STATS_PRINT_EVERY;
+            queue_stats_print_all();
+        }
+#endif
     }
 }
 //---------------------------------------------------------------------------------------------------
@@ -85,19 +439,91 @@ void consumer_task(void *pv) {
 
 void app_main(void) 
 {
+#if EX2_ASYNC_LOG
+    BaseType_t log_started = async_log_start();     //before the first ESP_LOGI
+    configASSERT(log_started == pdPASS);
+#elif EX2_BINARY_LOG
+    BaseType_t log_started = binlog_start(NULL);        //before the first ESP_LOGI
+    configASSERT(log_started == pdPASS);
+#endif
 
     //------------------------------------------------------------------------------------------------
+#if EX2_TRANSPORT == EX2_TRANSPORT_SPSC_RING
+    //spsc_ring_create Function to create the lock-free ring
+    //Capacity must be a power of two, so 16 is used instead of the queue depth of 10.
+    ring = spsc_ring_create(EX2_RING_DEPTH, sizeof(int));
+    configASSERT(ring != NULL);
+#elif EX2_TRANSPORT == EX2_TRANSPORT_MSG_POOL
+    //Pool: one block per queue slot + one held by the producer + one held by the consumer
+    pool = msg_pool_create(sizeof(ex2_msg_t), EX2_QUEUE_DEPTH + 2);
+    configASSERT(pool != NULL);
+#if EX2_QUEUE_STATS
+    q_stats = queue_stats_create("ex2_q", EX2_QUEUE_DEPTH, sizeof(ex2_msg_t *));
+    configASSERT(q_stats != NULL);
+    q = queue_stats_handle(q_stats);
+#elif EX2_STATIC_ALLOC
+    q = static_arena_queue(&ex2_arena, "ex2_q", EX2_QUEUE_DEPTH, sizeof(ex2_msg_t *));
+#else
+    q = xQueueCreate(EX2_QUEUE_DEPTH, sizeof(ex2_msg_t *));    //The queue carries pointers only
+#endif
+    configASSERT(q != NULL);
+#elif EX2_TRANSPORT == EX2_TRANSPORT_TYPED_QUEUE
+    //StaticQueue<int, EX2_QUEUE_DEPTH>: created by its constructor (xQueueCreateStatic), q is only kept for
+    //uxQueueMessagesWaiting and friends
+    q = typed_queue_create();
+#elif EX2_TRANSPORT == EX2_TRANSPORT_SHARDED_QUEUE
+    //EX2_QUEUE_DEPTH ints per shard, one shard per core. producer / consumer are created unpinned, so each one's
+    //home shard is picked from its task handle (sharded_queue.h); when the homes differ the consumer steals
+    sq = sharded_queue_create(&(sharded_queue_config_t){ .depth = EX2_QUEUE_DEPTH, .item_size = sizeof(int) });
+    configASSERT(sq != NULL);
+#else
     //xQueueCreate Function to create a queue
     //Parameters: uxQueueLength: The maximum number of items the queue can hold at any one time.
     //uxItemSize: The size, in bytes, of each item that can be stored in the queue.
     //Returns: If the queue is created successfully, a handle to the queue is returned. If the queue cannot be created, NULL is returned.
-    q = xQueueCreate(10, sizeof(int));          //Depth = 10, because your send/receive queue function calls / pass pointers to int values in our example.
+#if EX2_QUEUE_STATS
+    //Same queue, created through the telemetry registry so it can be looked up as "ex2_q"
+    q_stats = queue_stats_create("ex2_q", EX2_QUEUE_DEPTH, sizeof(int));
+    configASSERT(q_stats != NULL);
+    q = queue_stats_handle(q_stats);
+#elif EX2_STATIC_ALLOC
+    //Same queue, storage from the arena: xQueueCreateStatic
+    q = static_arena_queue(&ex2_arena, "ex2_q", EX2_QUEUE_DEPTH, sizeof(int));
+#else
+    q = xQueueCreate(EX2_QUEUE_DEPTH, sizeof(int));     //Depth = 10, because your send/receive queue function calls / pass pointers to int values in our example.
+#endif
     configASSERT(q != NULL);
     //q is The handle of the queue to which the item is being sent / or receive.
+#endif
     //------------------------------------------------------------------------------------------------
 
 
     //Create Producer and Consumer Tasks
-    xTaskCreate(producer_task, "producer", 2048, NULL, 5, NULL);
-    xTaskCreate(consumer_task, "consumer", 2048, NULL, 5, NULL);
+    TaskHandle_t producer = NULL, consumer = NULL;
+#if EX2_TRANSPORT == EX2_TRANSPORT_TYPED_QUEUE
+    TaskFunction_t producer_fn = typed_producer_task, consumer_fn = typed_consumer_task;
+#else
+    TaskFunction_t producer_fn = producer_task, consumer_fn = consumer_task;
+#endif
+#if EX2_STATIC_ALLOC
+    static_arena_task(&ex2_arena, producer_fn, "producer", EX2_STACK(producer), NULL, 5, STATIC_ARENA_ANY_CORE, &producer);
+    static_arena_task(&ex2_arena, consumer_fn, "consumer", EX2_STACK(consumer), NULL, 5, STATIC_ARENA_ANY_CORE, &consumer);
+    BaseType_t arena_fits = static_arena_report(&ex2_arena);
+    configASSERT(arena_fits == pdPASS);
+#else
+    xTaskCreate(producer_fn, "producer", EX2_STACK(producer), NULL, 5, &producer);
+    xTaskCreate(consumer_fn, "consumer", EX2_STACK(consumer), NULL, 5, &consumer);
+#endif
+
+#if EX2_STACK_PROFILE
+    //The ids become STACK_DEPTH_producer / STACK_DEPTH_consumer in the generated header
+    stack_profile_watch(producer, "producer", EX2_STACK(producer), EX2_BASELINE_STACK);
+    stack_profile_watch(consumer, "consumer", EX2_STACK(consumer), EX2_BASELINE_STACK);
+    stack_profile_start(100, EX2_STACK_PROFILE_MS);
+#endif
+#if EX2_RUNTIME_STATS
+    BaseType_t stats_started = runtime_stats_start(&(runtime_stats_config_t){ .period_ms = EX2_RUNTIME_STATS_MS,
+                                                                              .print_every = 1 });
+    configASSERT(stats_started == pdPASS);
+#endif
 }
@@ -0,0 +1,65 @@
+//producer_task / consumer_task of main.c on StaticQueue<int, EX2_QUEUE_DEPTH> (EX2_TRANSPORT_TYPED_QUEUE)
+
+#include <chrono>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "static_queue.hpp"         //TYPED STATIC QUEUE (components/static_queue)
+#include "typed_queue_tasks.h"
+
+using namespace std::chrono_literals;
+
+/*
+---------------------------------------------------------------------------------------------------
+What changes against xQueueSend(q, &value, pdMS_TO_TICKS(10)) / xQueueReceive(q, &rx, portMAX_DELAY)?
+>> The item type is part of the queue's type: q->send_for(&value, 10ms) or sending a long does not
+   compile (StaticQueue deletes the overloads for other types, nothing is narrowed), and nothing can
+   disagree with the sizeof(int) the queue was created with.
+>> The storage (EX2_QUEUE_DEPTH x 4 bytes) and the queue's control block are one static object, no heap.
+>> 10ms is 10 ms whatever CONFIG_FREERTOS_HZ is (rounded up to whole ticks).
+The calls compile to the same xQueueSend / xQueueReceive: host/bench/static_queue_bench.
+---------------------------------------------------------------------------------------------------
+*/
+
+static const char *TAG = "EX2";
+
+using Ex2Queue = StaticQueue<int, EX2_QUEUE_DEPTH>;
+static Ex2Queue *q;
+
+
+//---------------------------------------------------------------------------------------------------
+QueueHandle_t typed_queue_create(void)
+{
+    static Ex2Queue queue;          //Constructed here, from app_main, not before the scheduler is up
+    q = &queue;
+    return queue.handle();
+}
+//---------------------------------------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------------------------------------
+void typed_producer_task(void *pv)
+{
+    int value = 0;
+    while (1) {
+        value++;
+        if (!q->send_for(value, 10ms)) {
+            //Still full after 10 ms: the value is dropped, as with errQUEUE_FULL
+        }
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+}
+//---------------------------------------------------------------------------------------------------
+
+
+//---------------------------------------------------------------------------------------------------
+void typed_consumer_task(void *pv)
+{
+    int rx = 0;
+    while (1) {
+        if (q->receive(rx)) {       //Waits forever (portMAX_DELAY)
+            ESP_LOGI(TAG, "Got value: %d", rx);
+        }
+    }
+}
+//---------------------------------------------------------------------------------------------------
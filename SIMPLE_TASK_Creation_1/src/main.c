@@ -4,6 +4,19 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "binlog.h"                 //BINARY LOGGING (components/binlog)
+#include "periodic_task.h"          //PERIODIC TASKS (components/periodic_task)
+#include "rm_sched.h"               //RATE-MONOTONIC ADMISSION (components/rm_sched)
+#include "stack_profile.h"          //STACK PROFILING (components/stack_profile)
+#include "runtime_stats.h"          //CPU RUNTIME STATS (components/runtime_stats)
+#include "power_mode.h"             //POWER-MANAGED MODE (components/power_mode)
+#include "timer_wheel.h"            //SHARED PERIODIC EXECUTOR (components/timer_wheel)
+#include "static_arena.h"           //STATIC ALLOCATION ARENA (components/static_arena)
+
+//Stack sizes measured by a profiling run (EX1_STACK_PROFILE=1), if include/stack_sizes.h was generated
+#if __has_include("stack_sizes.h")
+#include "stack_sizes.h"
+#endif
 
 //Note
 /*
@@ -53,17 +66,202 @@ FAQ: About stack size allocation for tasks in FreeRTOS
 >> Check remaining stack (high water mark) for a task during testing:
 UBaseType_t hi = uxTaskGetStackHighWaterMark(NULL); // returns words remaining
 ESP_LOGI("STACK", "High water mark: %u words (%u bytes)", hi, (unsigned)(hi * sizeof(StackType_t)));
+
+
+FAQ: Why does a vTaskDelay(pdMS_TO_TICKS(1000)) loop not run exactly once per second?
+>> vTaskDelay() starts counting at the tick in which it is called. If the log line (or waiting for the CPU
+   before it) runs past a tick boundary, that round is one tick longer - and nothing ever catches up.
+>> xTaskDelayUntil(&last_wake, period) counts from the previous release instead: releases stay on a fixed
+   grid, a late round does not move the next one. EX1_PERIODIC=1 runs task1 / task2 that way
+   (components/periodic_task); the drift over an hour: host/bench/periodic_drift_sim.
+
+
+FAQ: Which priority should task1 / task2 get?
+>> For periodic tasks: the shorter the period (deadline), the higher the priority - rate monotonic. With
+   EX1_RM_ADMISSION=1 the priorities are derived from the periods, and the response-time analysis checks
+   at startup that every task meets its deadline with the declared WCET; otherwise nothing starts.
+   Hand-picked vs. rate-monotonic priorities, measured: host/bench/rm_admission_check.
+
+
+FAQ: Is 2048 right for task1 / task2?
+>> On ESP-IDF the depth is in bytes (StackType_t is uint8_t), so 2048 is 2 KB, not 2048 words - and still
+   a guess. Build once with EX1_STACK_PROFILE=1: the tasks start with a large stack, their high-water marks
+   are sampled for EX1_STACK_PROFILE_MS and a stack_sizes.h (peak + margin per task) is printed between
+   "//>>> stack_sizes.h" and "//<<< stack_sizes.h". Saved as include/stack_sizes.h it replaces the 2048
+   below; a task it does not list keeps 2048. Re-profile after changing what a task logs.
+
+
+FAQ: How much CPU do task1 / task2 actually use?
+>> With run-time stats enabled (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, set in sdkconfig.esp32dev) the
+   kernel adds up how long each task ran. EX1_RUNTIME_STATS=1 samples those counters every
+   EX1_RUNTIME_STATS_MS and prints the last window as a table: CPU share per task, busy share per core
+   (100 % minus that core's IDLE task), free stack. Two log lines a second should be well below 1 %; what
+   the sampling itself costs: host/bench/runtime_stats_overhead.
+
+
+FAQ: Why keep the CPU at full speed for two log lines a second?
+>> No reason to: EX1_POWER_SAVE=1 turns on power management (CONFIG_PM_ENABLE and
+   CONFIG_FREERTOS_USE_TICKLESS_IDLE, set in sdkconfig.esp32dev). The CPU runs at EX1_PM_MIN_MHZ; each log
+   line takes a PM lock (power_mode_work_begin / _end) and runs at EX1_PM_MAX_MHZ; when both tasks are
+   blocked the tick stops and the chip goes to light sleep until the next release.
+>> Every EX1_POWER_REPORT_MS the time at each frequency / asleep, the wakes and an estimated average
+   current vs the always-on build are printed. The estimate uses datasheet currents; measure with a power
+   meter before trusting the mAh. Duty cycle and wakes per hour on the host: host/bench/power_model_sim.
+>> The console UART does not receive during light sleep: input typed into the monitor is lost.
+
+
+FAQ: Does every periodic job need its own task?
+>> No. A task is a TCB plus its own stack, and task1 / task2 use theirs for one log line a second.
+   EX1_TIMER_WHEEL=1 registers both lines as callbacks on one executor task (components/timer_wheel):
+   each job is a 36-byte record, and the executor's stack is shared by all of them. The price: jobs run
+   one after the other at one priority, so a slow job delays the rest. RAM and scheduling cost for 2, 100
+   and 1000 jobs against one task per job: host/bench/timer_wheel_bench.
+
+
+FAQ: Where do the TCB and the stack of task1 / task2 come from?
+>> xTaskCreate() allocates both from the heap when it is called. EX1_STATIC_ALLOC=1 creates the tasks with
+   xTaskCreateStatic() instead, with TCBs and stacks laid out in ex1_arena: one static array whose size is
+   computed at compile time from exactly these two tasks (components/static_arena). The memory shows up in
+   .bss at link time, boot does not touch the heap for them, and a table with each task's bytes and the free
+   heap is printed at startup. Boot time and heap use, dynamic vs static: host/bench/static_arena_boot.
 */
 //---------------------------------------------------------------------------------------------------
 
 
+//1 = ESP_LOGI sends a binary record (format ID, timestamp, arguments) instead of text.
+//Decode on the PC: binlog_tool decode firmware.elf < capture.bin (see components/binlog)
+#ifndef EX1_BINARY_LOG
+#define EX1_BINARY_LOG 0
+#endif
+
+#if EX1_BINARY_LOG
+#undef ESP_LOGI
+#define ESP_LOGI BINLOG_LOGI
+#endif
+
+//1 = task1 / task2 run on periodic_task (xTaskDelayUntil): fixed releases every 1000 / 500 ms instead of
+//vTaskDelay() after each log line, plus release jitter, execution time and deadline misses every EX1_STATS_EVERY jobs
+#ifndef EX1_PERIODIC
+#define EX1_PERIODIC 0
+#endif
+#ifndef EX1_STATS_EVERY
+#define EX1_STATS_EVERY 10
+#endif
+
+//1 = (with EX1_PERIODIC) no hand-picked priorities: task1 / task2 declare a worst-case execution time, get
+//rate-monotonic priorities and start only if the response-time analysis says both meet their deadlines
+#ifndef EX1_RM_ADMISSION
+#define EX1_RM_ADMISSION 0
+#endif
+#ifndef EX1_WCET_US
+#define EX1_WCET_US 5000            //one log line over the UART at 115200 baud, with margin
+#endif
+
+//1 = profiling build: task1 / task2 get STACK_PROFILE_RUN_DEPTH, after EX1_STACK_PROFILE_MS their peak
+//stack use and a generated stack_sizes.h are printed (see components/stack_profile)
+#ifndef EX1_STACK_PROFILE
+#define EX1_STACK_PROFILE 0
+#endif
+#ifndef EX1_STACK_PROFILE_MS
+#define EX1_STACK_PROFILE_MS 30000
+#endif
+
+//Stack depth per task: the generated one, else the blanket EX1_BASELINE_STACK. The profiler compares against
+//the blanket depth, not against a previously generated one.
+#define EX1_BASELINE_STACK 2048
+#ifndef STACK_DEPTH_task1
+#define STACK_DEPTH_task1 EX1_BASELINE_STACK
+#endif
+#ifndef STACK_DEPTH_task2
+#define STACK_DEPTH_task2 EX1_BASELINE_STACK
+#endif
+
+//1 = print per-task / per-core CPU use every EX1_RUNTIME_STATS_MS (see components/runtime_stats)
+#ifndef EX1_RUNTIME_STATS
+#define EX1_RUNTIME_STATS 0
+#endif
+#ifndef EX1_RUNTIME_STATS_MS
+#define EX1_RUNTIME_STATS_MS 5000
+#endif
+
+//1 = power-managed mode: CPU at EX1_PM_MIN_MHZ except while a task logs (EX1_PM_MAX_MHZ), light sleep when
+//every task is blocked; time per state and an energy estimate every EX1_POWER_REPORT_MS (see components/power_mode)
+#ifndef EX1_POWER_SAVE
+#define EX1_POWER_SAVE 0
+#endif
+#ifndef EX1_PM_MAX_MHZ
+#ifdef CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define EX1_PM_MAX_MHZ CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#else
+#define EX1_PM_MAX_MHZ 160
+#endif
+#endif
+#ifndef EX1_PM_MIN_MHZ
+#define EX1_PM_MIN_MHZ 80           //40 (XTAL) saves more, but the UART baud rate and esp_timer get coarser
+#endif
+#ifndef EX1_PM_LIGHT_SLEEP
+#define EX1_PM_LIGHT_SLEEP 1
+#endif
+#ifndef EX1_POWER_REPORT_MS
+#define EX1_POWER_REPORT_MS 10000
+#endif
+
+//1 = task1 / task2 are not tasks but two jobs on one timer-wheel executor task (see components/timer_wheel)
+#ifndef EX1_TIMER_WHEEL
+#define EX1_TIMER_WHEEL 0
+#endif
+#define EX1_TW_EXEC_BASELINE_STACK 2048     //as CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH, the other shared-callback task
+#ifndef STACK_DEPTH_tw_exec
+#define STACK_DEPTH_tw_exec EX1_TW_EXEC_BASELINE_STACK
+#endif
+
+#if EX1_POWER_SAVE
+#define EX1_WORK_BEGIN() power_mode_work_begin()
+#define EX1_WORK_END() power_mode_work_end()
+#else
+#define EX1_WORK_BEGIN() ((void)0)
+#define EX1_WORK_END() ((void)0)
+#endif
+
+//1 = task1 / task2 get their TCB and stack from a static arena instead of the heap (see components/static_arena)
+#ifndef EX1_STATIC_ALLOC
+#define EX1_STATIC_ALLOC 0
+#endif
+
+#if EX1_STACK_PROFILE
+#define EX1_STACK(id) STACK_PROFILE_RUN_DEPTH
+#else
+#define EX1_STACK(id) STACK_DEPTH_##id
+#endif
+
+#if EX1_RM_ADMISSION && !EX1_PERIODIC
+#error "EX1_RM_ADMISSION starts periodic tasks: set EX1_PERIODIC=1 as well"
+#endif
+
+#if EX1_RUNTIME_STATS && !RUNTIME_STATS_AVAILABLE
+#error "EX1_RUNTIME_STATS needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (host: cmake -DHOST_RUNTIME_STATS=ON)"
+#endif
+
+#if EX1_TIMER_WHEEL && EX1_PERIODIC
+#error "EX1_TIMER_WHEEL and EX1_PERIODIC both replace task1 / task2: pick one"
+#endif
+
+#if EX1_STATIC_ALLOC && (EX1_PERIODIC || EX1_TIMER_WHEEL)
+#error "EX1_STATIC_ALLOC covers the plain task1 / task2: periodic_task and timer_wheel allocate their own tasks"
+#endif
+
+#if EX1_POWER_SAVE && !POWER_MODE_IDLE_AVAILABLE
+#error "EX1_POWER_SAVE measures idle time: it needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (host: cmake -DHOST_RUNTIME_STATS=ON)"
+#endif
 
 
 //---------------------------------------------------------------------------------------------------
 //Create Task -1
 void task1(void *pv) {
   while (1) {
+    EX1_WORK_BEGIN();
     ESP_LOGI("TASK1", "Running...");
+    EX1_WORK_END();
     vTaskDelay(pdMS_TO_TICKS(1000));
   }
 }
@@ -75,7 +273,9 @@ void task1(void *pv) {
 //Create Task - 2
 void task2(void *pv) {
   while (1) {
+    EX1_WORK_BEGIN();
     ESP_LOGI("TASK2", "Running...");
+    EX1_WORK_END();
     vTaskDelay(pdMS_TO_TICKS(500));
   }
 }
@@ -83,8 +283,123 @@ void task2(void *pv) {
 
 
 
+#if EX1_PERIODIC
+//---------------------------------------------------------------------------------------------------
+//Job of task1 / task2: one round of the loop above, the framework calls it once per period
+static void log_job(periodic_task_t *pt, void *tag) {
+  EX1_WORK_BEGIN();
+  ESP_LOGI((const char *)tag, "Running...");
+
+  periodic_task_stats_t st;
+  periodic_task_get(pt, &st);
+  if (st.releases % EX1_STATS_EVERY == 0) {
+    ESP_LOGI((const char *)tag, "jitter max %u us, exec max %u us, %u misses, %u overruns",
+             (unsigned)st.jitter_max_us, (unsigned)st.exec_max_us, (unsigned)st.deadline_misses,
+             (unsigned)st.overruns);
+  }
+  EX1_WORK_END();
+}
+//---------------------------------------------------------------------------------------------------
+#endif
+
+
+
+#if EX1_TIMER_WHEEL
+//---------------------------------------------------------------------------------------------------
+//Body of task1 / task2 without the loop: the executor calls it once per period, on its own stack
+static void wheel_log_job(timer_wheel_job_t *job, void *tag) {
+  (void)job;
+  EX1_WORK_BEGIN();
+  ESP_LOGI((const char *)tag, "Running...");
+  EX1_WORK_END();
+}
+//---------------------------------------------------------------------------------------------------
+#endif
+
+
+
+#if EX1_STATIC_ALLOC
+//TCB + stack of task1 and task2, sized at compile time
+STATIC_ARENA_DEFINE(ex1_arena, STATIC_ARENA_TASK_BYTES(EX1_STACK(task1)) + STATIC_ARENA_TASK_BYTES(EX1_STACK(task2)));
+#endif
+
+
+
 //Main
 void app_main(void) {
-  xTaskCreate(task1, "task1", 2048, NULL, 1, NULL);
-  xTaskCreate(task2, "task2", 2048, NULL, 1, NULL);
+#if EX1_BINARY_LOG
+  BaseType_t log_started = binlog_start(NULL);      //before the first ESP_LOGI
+  configASSERT(log_started == pdPASS);
+#endif
+#if EX1_POWER_SAVE
+  //Before the tasks: their first log lines already count
+  BaseType_t power_started = power_mode_start(&(power_mode_config_t){ .max_freq_mhz = EX1_PM_MAX_MHZ,
+      .min_freq_mhz = EX1_PM_MIN_MHZ, .light_sleep = EX1_PM_LIGHT_SLEEP, .report_ms = EX1_POWER_REPORT_MS });
+  configASSERT(power_started == pdPASS);
+#endif
+  TaskHandle_t task1_handle = NULL, task2_handle = NULL;
+#if EX1_RM_ADMISSION
+  //Period + WCET in, priorities and the schedulability verdict out (static: the handles outlive app_main)
+  static rm_task_t rm_set[] = {
+    { .config = { .name = "task1", .job = log_job, .arg = "TASK1", .period_ms = 1000,
+                  .stack_depth = EX1_STACK(task1) }, .wcet_us = EX1_WCET_US },
+    { .config = { .name = "task2", .job = log_job, .arg = "TASK2", .period_ms = 500,
+                  .stack_depth = EX1_STACK(task2) }, .wcet_us = EX1_WCET_US },
+  };
+  rm_sched_report_t report;
+  BaseType_t admitted = rm_sched_start(rm_set, 2, 1, &report);
+  rm_sched_print(rm_set, 2, &report);
+  if (admitted != pdPASS) {
+    ESP_LOGE("MAIN", "Task set rejected, nothing started");
+  } else {
+    task1_handle = periodic_task_handle(rm_set[0].task);
+    task2_handle = periodic_task_handle(rm_set[1].task);
+  }
+#elif EX1_PERIODIC
+  //Same name, priority and stack as below; deadline 0 = period
+  periodic_task_t *pt1 = periodic_task_create(&(periodic_task_config_t){ .name = "task1", .job = log_job,
+      .arg = "TASK1", .period_ms = 1000, .priority = 1, .stack_depth = EX1_STACK(task1) });
+  periodic_task_t *pt2 = periodic_task_create(&(periodic_task_config_t){ .name = "task2", .job = log_job,
+      .arg = "TASK2", .period_ms = 500, .priority = 1, .stack_depth = EX1_STACK(task2) });
+  task1_handle = pt1 ? periodic_task_handle(pt1) : NULL;
+  task2_handle = pt2 ? periodic_task_handle(pt2) : NULL;
+#elif EX1_TIMER_WHEEL
+  //Same periods and priority as below; one stack for both
+  timer_wheel_t *tw = timer_wheel_create(&(timer_wheel_config_t){ .name = "tw_exec", .priority = 1,
+                                                                  .stack_depth = EX1_STACK(tw_exec) });
+  configASSERT(tw != NULL);
+  timer_wheel_job_t *job1 = timer_wheel_add(tw, &(timer_wheel_job_config_t){ .name = "task1",
+      .job = wheel_log_job, .arg = "TASK1", .period_ms = 1000 });
+  timer_wheel_job_t *job2 = timer_wheel_add(tw, &(timer_wheel_job_config_t){ .name = "task2",
+      .job = wheel_log_job, .arg = "TASK2", .period_ms = 500 });
+  configASSERT(job1 != NULL && job2 != NULL);
+  task1_handle = timer_wheel_handle(tw);            //both jobs run here
+#elif EX1_STATIC_ALLOC
+  static_arena_task(&ex1_arena, task1, "task1", EX1_STACK(task1), NULL, 1, STATIC_ARENA_ANY_CORE, &task1_handle);
+  static_arena_task(&ex1_arena, task2, "task2", EX1_STACK(task2), NULL, 1, STATIC_ARENA_ANY_CORE, &task2_handle);
+  BaseType_t arena_fits = static_arena_report(&ex1_arena);
+  configASSERT(arena_fits == pdPASS);
+#else
+  xTaskCreate(task1, "task1", EX1_STACK(task1), NULL, 1, &task1_handle);
+  xTaskCreate(task2, "task2", EX1_STACK(task2), NULL, 1, &task2_handle);
+#endif
+#if EX1_STACK_PROFILE && EX1_TIMER_WHEEL
+  //task1 / task2 run on the executor's stack: its id becomes STACK_DEPTH_tw_exec
+  stack_profile_watch(task1_handle, "tw_exec", EX1_STACK(tw_exec), EX1_TW_EXEC_BASELINE_STACK);
+  stack_profile_start(100, EX1_STACK_PROFILE_MS);
+  (void)task2_handle;
+#elif EX1_STACK_PROFILE
+  //The ids become STACK_DEPTH_task1 / STACK_DEPTH_task2 in the generated header
+  stack_profile_watch(task1_handle, "task1", EX1_STACK(task1), EX1_BASELINE_STACK);
+  stack_profile_watch(task2_handle, "task2", EX1_STACK(task2), EX1_BASELINE_STACK);
+  stack_profile_start(100, EX1_STACK_PROFILE_MS);
+#else
+  (void)task1_handle;
+  (void)task2_handle;
+#endif
+#if EX1_RUNTIME_STATS
+  BaseType_t stats_started = runtime_stats_start(&(runtime_stats_config_t){ .period_ms = EX1_RUNTIME_STATS_MS,
+                                                                            .print_every = 1 });
+  configASSERT(stats_started == pdPASS);
+#endif
 }
@@ -0,0 +1,512 @@
+//Deferred (asynchronous) logging engine (see async_log.h)
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "async_log.h"
+
+#if defined(configNUMBER_OF_CORES)
+#define ASYNC_LOG_CORES     configNUMBER_OF_CORES
+#elif defined(portNUM_PROCESSORS)
+#define ASYNC_LOG_CORES     portNUM_PROCESSORS
+#else
+#define ASYNC_LOG_CORES     1
+#endif
+
+#if (ASYNC_LOG_RING_SIZE & (ASYNC_LOG_RING_SIZE - 1)) != 0
+#error "ASYNC_LOG_RING_SIZE must be a power of two"
+#endif
+
+#if ASYNC_LOG_ARG_BYTES > 255
+#error "ASYNC_LOG_ARG_BYTES must fit in a uint8_t"
+#endif
+
+/*
+Slot protocol (bounded MPMC ring with per-slot sequence numbers, single consumer here):
+>> slot.seq == pos                      : free for the writer that reserves position "pos"
+>> slot.seq == pos + 1                  : written, ready for the drain task
+>> slot.seq == pos + ASYNC_LOG_RING_SIZE: drained, free for the writer one lap later
+A writer that is preempted between reserving and publishing only holds up the drain task, never other writers.
+*/
+typedef struct {
+    atomic_uint seq;
+    uint32_t timestamp;
+    const char *tag;
+    const char *format;
+    uint8_t level;
+    uint8_t arg_len;
+    uint8_t args[ASYNC_LOG_ARG_BYTES];      //raw argument bytes in format order (unaligned, use memcpy)
+} log_record_t;
+
+typedef struct {
+    atomic_uint head;                       //next position to reserve (all writers on this core)
+    atomic_uint tail;                       //next position to drain (drain task only)
+    atomic_uint dropped;
+    log_record_t slots[ASYNC_LOG_RING_SIZE];
+} log_ring_t;
+
+static log_ring_t *rings[ASYNC_LOG_CORES];
+static TaskHandle_t drain_handle;
+
+
+//-------------------------------------------------------------------------------------------------
+//printf conversion parsing, shared by the writer (to pull arguments off the va_list) and the drain task
+
+typedef enum {
+    ARG_INT, ARG_LONG, ARG_LLONG, ARG_INTMAX, ARG_SIZE, ARG_PTRDIFF,
+    ARG_PTR, ARG_DOUBLE, ARG_LDOUBLE, ARG_STR, ARG_UNSUPPORTED
+} arg_kind_t;
+
+typedef struct {
+    const char *start;                      //the '%'
+    const char *end;                        //one past the conversion character
+    uint8_t stars;                          //'*' width / precision: int arguments before the value
+    arg_kind_t kind;
+} fmt_spec_t;
+
+static const char *skip_digits(const char *s)
+{
+    while (*s >= '0' && *s <= '9') {
+        s++;
+    }
+    return s;
+}
+
+//Next conversion at or after p ("%%" is literal text), NULL when there are none left
+static const char *next_spec(const char *p, fmt_spec_t *spec)
+{
+    while ((p = strchr(p, '%')) != NULL) {
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        const char *s = p + 1;
+        spec->start = p;
+        spec->stars = 0;
+
+        while (*s != '\0' && strchr("-+ #0", *s) != NULL) {
+            s++;
+        }
+        if (*s == '*') {
+            spec->stars++;
+            s++;
+        } else {
+            s = skip_digits(s);
+        }
+        if (*s == '.') {
+            s++;
+            if (*s == '*') {
+                spec->stars++;
+                s++;
+            } else {
+                s = skip_digits(s);
+            }
+        }
+
+        arg_kind_t integer = ARG_INT;       //hh / h are promoted to int
+        int long_double = 0;
+        if (*s == 'h') {
+            s += (s[1] == 'h') ? 2 : 1;
+        } else if (*s == 'l') {
+            integer = (s[1] == 'l') ? ARG_LLONG : ARG_LONG;
+            s += (s[1] == 'l') ? 2 : 1;
+        } else if (*s == 'j') {
+            integer = ARG_INTMAX;
+            s++;
+        } else if (*s == 'z') {
+            integer = ARG_SIZE;
+            s++;
+        } else if (*s == 't') {
+            integer = ARG_PTRDIFF;
+            s++;
+        } else if (*s == 'L') {
+            long_double = 1;
+            s++;
+        }
+
+        switch (*s) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            spec->kind = integer;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = long_double ? ARG_LDOUBLE : ARG_DOUBLE;
+            break;
+        case 'p':
+            spec->kind = ARG_PTR;
+            break;
+        case 's':
+            spec->kind = (integer == ARG_INT) ? ARG_STR : ARG_UNSUPPORTED;     //no %ls
+            break;
+        default:
+            spec->kind = ARG_UNSUPPORTED;   //%n, unknown or truncated conversion
+            break;
+        }
+        spec->end = (*s != '\0') ? s + 1 : s;
+        return p;
+    }
+    return NULL;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Writer side
+
+#define PACK_ARG(type, promoted)                                                                \
+    do {                                                                                        \
+        type v = (type)va_arg(ap, promoted);                                                    \
+        if (used + sizeof(v) > ASYNC_LOG_ARG_BYTES) {                                           \
+            return used;                                                                        \
+        }                                                                                       \
+        memcpy(&rec->args[used], &v, sizeof(v));                                                \
+        used += sizeof(v);                                                                      \
+    } while (0)
+
+//Copy the raw arguments into the record; stops at the first one that does not fit
+static size_t pack_args(log_record_t *rec, const char *format, va_list ap)
+{
+    size_t used = 0;
+    fmt_spec_t spec;
+    const char *p = format;
+
+    while ((p = next_spec(p, &spec)) != NULL) {
+        for (uint8_t i = 0; i < spec.stars; i++) {
+            PACK_ARG(int, int);
+        }
+        switch (spec.kind) {
+        case ARG_INT:       PACK_ARG(int, int);                     break;
+        case ARG_LONG:      PACK_ARG(long, long);                   break;
+        case ARG_LLONG:     PACK_ARG(long long, long long);         break;
+        case ARG_INTMAX:    PACK_ARG(intmax_t, intmax_t);           break;
+        case ARG_SIZE:      PACK_ARG(size_t, size_t);               break;
+        case ARG_PTRDIFF:   PACK_ARG(ptrdiff_t, ptrdiff_t);         break;
+        case ARG_PTR:       PACK_ARG(void *, void *);               break;
+        case ARG_DOUBLE:    PACK_ARG(double, double);               break;
+        case ARG_LDOUBLE:   PACK_ARG(long double, long double);     break;
+        case ARG_STR: {
+            //Copied, not referenced: the caller's buffer may be gone by the time the drain task runs
+            const char *s = va_arg(ap, const char *);
+            if (s == NULL) {
+                s = "(null)";
+            }
+            if (used >= ASYNC_LOG_ARG_BYTES) {
+                return used;
+            }
+            size_t n = 0;
+            while (n < ASYNC_LOG_ARG_BYTES - used - 1 && s[n] != '\0') {
+                n++;
+            }
+            memcpy(&rec->args[used], s, n);
+            rec->args[used + n] = '\0';
+            used += n + 1;
+            break;
+        }
+        default:
+            return used;
+        }
+        p = spec.end;
+    }
+    return used;
+}
+
+static inline unsigned current_core(void)
+{
+#if ASYNC_LOG_CORES > 1
+    return (unsigned)xPortGetCoreID();      //a task may migrate right after this: harmless, the ring is MPMC-safe
+#else
+    return 0;
+#endif
+}
+
+static const char level_letter[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+
+void async_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    va_list ap;
+    log_ring_t *ring = rings[current_core()];
+
+    if (ring == NULL) {
+        //async_log_start() not called (yet): behave like ESP_LOGx
+        va_start(ap, format);
+        printf("%c (%u) %s: ", level_letter[level], (unsigned)esp_log_timestamp(), tag);
+        vprintf(format, ap);
+        printf("\n");
+        va_end(ap);
+        return;
+    }
+
+    //Reserve a slot: one CAS on head, retried only when another task on this core got there first
+    unsigned pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    log_record_t *rec;
+    while (1) {
+        rec = &ring->slots[pos & (ASYNC_LOG_RING_SIZE - 1)];
+        unsigned seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);    //full: drop, never block
+            return;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    rec->timestamp = esp_log_timestamp();
+    rec->tag = tag;
+    rec->format = format;
+    rec->level = (uint8_t)level;
+    va_start(ap, format);
+    rec->arg_len = (uint8_t)pack_args(rec, format, ap);
+    va_end(ap);
+    atomic_store_explicit(&rec->seq, pos + 1, memory_order_release);
+
+    //Wake the drain task early when this ring reaches half full, instead of waiting for its period
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (pos - tail == ASYNC_LOG_RING_SIZE / 2) {
+        xTaskNotifyGive(drain_handle);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Drain side
+
+static void append(char *line, size_t *len, const char *text, size_t n)
+{
+    if (n > ASYNC_LOG_LINE_MAX - 2 - *len) {
+        n = ASYNC_LOG_LINE_MAX - 2 - *len;  //keep room for '\n' and '\0'
+    }
+    memcpy(&line[*len], text, n);
+    *len += n;
+}
+
+static void append_formatted(size_t *len, int written)
+{
+    if (written > 0) {
+        *len += (size_t)written;
+        if (*len > ASYNC_LOG_LINE_MAX - 2) {
+            *len = ASYNC_LOG_LINE_MAX - 2;
+        }
+    }
+}
+
+//Literal text between conversions, "%%" -> "%"
+static void append_literal(char *line, size_t *len, const char *from, const char *to)
+{
+    while (from < to) {
+        const char *pct = memchr(from, '%', (size_t)(to - from));
+        if (pct == NULL) {
+            append(line, len, from, (size_t)(to - from));
+            return;
+        }
+        append(line, len, from, (size_t)(pct - from) + 1);     //text plus one '%'
+        from = pct + 2;
+    }
+}
+
+#define UNPACK_ARG(type)                                                                        \
+    do {                                                                                        \
+        type v;                                                                                 \
+        if (used + sizeof(v) > rec->arg_len) {                                                  \
+            goto truncated;                                                                     \
+        }                                                                                       \
+        memcpy(&v, &rec->args[used], sizeof(v));                                                \
+        used += sizeof(v);                                                                      \
+        append_formatted(&len, snprintf(&line[len], ASYNC_LOG_LINE_MAX - 1 - len, conv, v)); \
+    } while (0)
+
+static size_t format_record(const log_record_t *rec, char *line)
+{
+    size_t len = 0;
+    size_t used = 0;
+    fmt_spec_t spec;
+    const char *p = rec->format;
+    const char *literal = p;
+    char conv[24];
+
+    append_formatted(&len, snprintf(line, ASYNC_LOG_LINE_MAX - 1, "%c (%u) %s: ",
+                                    level_letter[rec->level], (unsigned)rec->timestamp, rec->tag));
+
+    while ((p = next_spec(p, &spec)) != NULL) {
+        append_literal(line, &len, literal, spec.start);
+
+        //Rebuild the conversion with '*' replaced by the stored width / precision
+        size_t c = 0;
+        for (const char *s = spec.start; s < spec.end; s++) {
+            if (*s == '*') {
+                int star;
+                if (used + sizeof(star) > rec->arg_len) {
+                    goto truncated;
+                }
+                memcpy(&star, &rec->args[used], sizeof(star));
+                used += sizeof(star);
+                c += (size_t)snprintf(&conv[c], sizeof(conv) - c, "%d", star);
+            } else {
+                conv[c++] = *s;
+            }
+            if (c >= sizeof(conv) - 1) {
+                goto truncated;
+            }
+        }
+        conv[c] = '\0';
+
+        switch (spec.kind) {
+        case ARG_INT:       UNPACK_ARG(int);            break;
+        case ARG_LONG:      UNPACK_ARG(long);           break;
+        case ARG_LLONG:     UNPACK_ARG(long long);      break;
+        case ARG_INTMAX:    UNPACK_ARG(intmax_t);       break;
+        case ARG_SIZE:      UNPACK_ARG(size_t);         break;
+        case ARG_PTRDIFF:   UNPACK_ARG(ptrdiff_t);      break;
+        case ARG_PTR:       UNPACK_ARG(void *);         break;
+        case ARG_DOUBLE:    UNPACK_ARG(double);         break;
+        case ARG_LDOUBLE:   UNPACK_ARG(long double);    break;
+        case ARG_STR: {
+            if (used >= rec->arg_len) {
+                goto truncated;
+            }
+            const char *s = (const char *)&rec->args[used];
+            used += strlen(s) + 1;
+            append_formatted(&len, snprintf(&line[len], ASYNC_LOG_LINE_MAX - 1 - len, conv, s));
+            break;
+        }
+        default:
+            goto truncated;
+        }
+        p = spec.end;
+        literal = p;
+    }
+    append_literal(line, &len, literal, literal + strlen(literal));
+    line[len++] = '\n';
+    return len;
+
+truncated:
+    append(line, &len, "...", 3);
+    line[len++] = '\n';
+    return len;
+}
+
+//Print everything that is ready in every ring; returns the number of lines written
+static size_t drain_rings(char *line)
+{
+    size_t lines = 0;
+    for (unsigned core = 0; core < ASYNC_LOG_CORES; core++) {
+        log_ring_t *ring = rings[core];
+        if (ring == NULL) {
+            continue;                       //async_log_start() still running
+        }
+        unsigned pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        while (1) {
+            log_record_t *rec = &ring->slots[pos & (ASYNC_LOG_RING_SIZE - 1)];
+            if (atomic_load_explicit(&rec->seq, memory_order_acquire) != pos + 1) {
+                break;                      //empty, or the writer of this slot has not finished yet
+            }
+            fwrite(line, 1, format_record(rec, line), stdout);
+            atomic_store_explicit(&rec->seq, pos + ASYNC_LOG_RING_SIZE, memory_order_release);
+            pos++;
+            atomic_store_explicit(&ring->tail, pos, memory_order_relaxed);
+            lines++;
+        }
+    }
+    return lines;
+}
+
+static void drain_task(void *pv)
+{
+    (void)pv;
+    static char line[ASYNC_LOG_LINE_MAX];   //only this task formats, so one buffer is enough
+    uint32_t reported = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, ASYNC_LOG_DRAIN_PERIOD);
+        if (drain_rings(line) != 0) {
+            fflush(stdout);
+        }
+        uint32_t dropped = async_log_dropped();
+        if (dropped != reported) {
+            printf("W (%u) async_log: %u messages dropped (ring full)\n",
+                   (unsigned)esp_log_timestamp(), (unsigned)(dropped - reported));
+            reported = dropped;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t async_log_start(void)
+{
+    configASSERT(drain_handle == NULL);     //call once
+    log_ring_t *mem = pvPortMalloc(sizeof(log_ring_t) * ASYNC_LOG_CORES);
+    if (mem == NULL) {
+        return pdFAIL;
+    }
+    for (unsigned core = 0; core < ASYNC_LOG_CORES; core++) {
+        log_ring_t *ring = &mem[core];
+        atomic_init(&ring->head, 0);
+        atomic_init(&ring->tail, 0);
+        atomic_init(&ring->dropped, 0);
+        for (unsigned i = 0; i < ASYNC_LOG_RING_SIZE; i++) {
+            atomic_init(&ring->slots[i].seq, i);
+        }
+    }
+    if (xTaskCreate(drain_task, "async_log", ASYNC_LOG_TASK_STACK, NULL, ASYNC_LOG_TASK_PRIORITY,
+                    &drain_handle) != pdPASS) {
+        vPortFree(mem);
+        return pdFAIL;
+    }
+    //Publish the rings last: from here on writers stop printing synchronously
+    for (unsigned core = 0; core < ASYNC_LOG_CORES; core++) {
+        rings[core] = &mem[core];
+    }
+    return pdPASS;
+}
+
+static int rings_empty(void)
+{
+    for (unsigned core = 0; core < ASYNC_LOG_CORES; core++) {
+        if (rings[core] != NULL && atomic_load(&rings[core]->head) != atomic_load(&rings[core]->tail)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+BaseType_t async_log_flush(TickType_t ticks_to_wait)
+{
+    if (drain_handle == NULL) {
+        return pdTRUE;                      //synchronous mode, nothing pending
+    }
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+    while (!rings_empty()) {
+        if (xTaskCheckForTimeOut(&timeout, &ticks_to_wait) != pdFALSE) {
+            return pdFALSE;
+        }
+        xTaskNotifyGive(drain_handle);
+        vTaskDelay(1);
+    }
+    return pdTRUE;
+}
+
+uint32_t async_log_dropped(void)
+{
+    uint32_t total = 0;
+    for (unsigned core = 0; core < ASYNC_LOG_CORES; core++) {
+        if (rings[core] != NULL) {
+            total += atomic_load_explicit(&rings[core]->dropped, memory_order_relaxed);
+        }
+    }
+    return total;
+}
+//-------------------------------------------------------------------------------------------------
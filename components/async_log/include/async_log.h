@@ -0,0 +1,101 @@
+//Deferred (asynchronous) logging: callers queue the format pointer and raw arguments, a low-priority
+//drain task formats and prints them later. Same line format as ESP_LOGx: "I (ms) TAG: message".
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why defer logging?
+ESP_LOGI formats the message (vsnprintf) and writes it to the UART in the caller's context. At 115200 baud
+one 40 character line takes ~3.5 ms, so a task that logs every item runs at the speed of the UART.
+ASYNC_LOGI only stores: timestamp, level, TAG pointer, format pointer and the raw argument bytes.
+Formatting and output happen in the drain task, which runs at a low priority when nothing else is ready.
+
+How it works:
+>> One ring per core (ASYNC_LOG_RING_SIZE fixed-size records), so the two ESP32 cores do not contend.
+>> Writers reserve a slot with one compare-and-swap and publish it with a per-slot sequence number:
+   lock-free, no critical section, safe when a task is preempted by another logging task on the same core.
+>> Ring full: the record is dropped and counted; the drain task prints "N messages dropped" once it catches up.
+>> The drain task wakes up every ASYNC_LOG_DRAIN_PERIOD, or earlier when a ring is half full.
+
+Rules:
+1) Format strings and TAG must be string literals (or at least outlive the drain), only the pointer is stored.
+2) "%s" arguments are copied into the record (truncated to the free argument space), so stack buffers are fine.
+3) Up to ASYNC_LOG_ARG_BYTES of arguments per call; an argument that does not fit ends the line with "...".
+4) Task context only (not from ISRs). Before async_log_start() calls fall back to printing synchronously.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef ASYNC_LOG_RING_SIZE
+#define ASYNC_LOG_RING_SIZE         64                  //records per core, power of two
+#endif
+
+#ifndef ASYNC_LOG_ARG_BYTES
+#define ASYNC_LOG_ARG_BYTES         40                  //argument bytes per record (10 ints on ESP32)
+#endif
+
+#ifndef ASYNC_LOG_TASK_PRIORITY
+#define ASYNC_LOG_TASK_PRIORITY     1                   //just above idle
+#endif
+
+#ifndef ASYNC_LOG_TASK_STACK
+#define ASYNC_LOG_TASK_STACK        3072
+#endif
+
+#ifndef ASYNC_LOG_DRAIN_PERIOD
+#define ASYNC_LOG_DRAIN_PERIOD      pdMS_TO_TICKS(20)
+#endif
+
+#ifndef ASYNC_LOG_LINE_MAX
+#define ASYNC_LOG_LINE_MAX          160                 //longer lines are truncated by the drain task
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : async_log_start
+>> Description: Allocate the per-core rings and create the drain task. Call once, e.g. first thing in app_main.
+>> Returns: pdPASS, or pdFAIL when memory is exhausted (logging then stays synchronous).
+*/
+BaseType_t async_log_start(void);
+
+/*
+Function : async_log_write
+>> Description: Queue one log line. Normally called through the ASYNC_LOGx macros below.
+>> Returns: nothing; when the ring is full the line is dropped and counted.
+*/
+void async_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+//Wait until every queued line has been printed (e.g. before a restart). pdFALSE on timeout.
+BaseType_t async_log_flush(TickType_t ticks_to_wait);
+
+//Lines dropped because a ring was full, since boot.
+uint32_t async_log_dropped(void);
+//-------------------------------------------------------------------------------------------------
+
+
+#define ASYNC_LOG_LEVEL(level, tag, format, ...)                                                \
+    do {                                                                                        \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                                       \
+            async_log_write((level), (tag), format, ##__VA_ARGS__);                             \
+        }                                                                                       \
+    } while (0)
+
+#define ASYNC_LOGE(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_ERROR,   tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGW(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_WARN,    tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGI(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_INFO,    tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGD(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_DEBUG,   tag, format, ##__VA_ARGS__)
+#define ASYNC_LOGV(tag, format, ...)    ASYNC_LOG_LEVEL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,310 @@
+//Compact binary logging (see binlog.h, wire format in binlog_wire.h)
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "binlog.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#include "driver/uart_vfs.h"
+//linker.lf places the sites in flash rodata and surrounds them with _binlog_fmt_start / _binlog_fmt_end
+extern const binlog_site_t _binlog_fmt_start[], _binlog_fmt_end[];
+#define BINLOG_FIRST_SITE   _binlog_fmt_start
+#define BINLOG_END_SITE     _binlog_fmt_end
+#else
+//GNU ld defines __start_ / __stop_<section> for every section whose name is a C identifier
+extern const binlog_site_t __start_binlog_fmt[], __stop_binlog_fmt[];
+#define BINLOG_FIRST_SITE   __start_binlog_fmt
+#define BINLOG_END_SITE     __stop_binlog_fmt
+#endif
+
+static binlog_config_t cfg;
+static SemaphoreHandle_t lock;
+static StaticSemaphore_t lock_buf;
+
+//Protected by lock
+static uint32_t last_timestamp;
+static uint32_t since_sync;
+static const char *tags[BINLOG_MAX_TAGS];   //tag index on the wire = array index + 1
+static uint8_t tag_count;
+
+static atomic_uint dropped;
+
+
+//-------------------------------------------------------------------------------------------------
+//Encoding (caller's stack, no lock)
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+} out_t;
+
+static int put_varint(out_t *o, uint64_t v)
+{
+    if (o->cap - o->len < BINLOG_VARINT_MAX) {
+        return 0;
+    }
+    o->len += binlog_put_varint(&o->buf[o->len], v);
+    return 1;
+}
+
+//length + bytes, truncated to "max" and to the space left
+static int put_string(out_t *o, const char *s, size_t max)
+{
+    size_t n = 0;
+    while (n < max && s[n] != '\0') {
+        n++;
+    }
+    if (o->cap - o->len < n + 1) {
+        if (o->cap - o->len < 2) {
+            return 0;
+        }
+        n = o->cap - o->len - 2;
+    }
+    o->len += binlog_put_varint(&o->buf[o->len], n);    //n < 128: one byte
+    memcpy(&o->buf[o->len], s, n);
+    o->len += n;
+    return 1;
+}
+
+static int64_t get_signed(binlog_len_t len, va_list *ap)
+{
+    switch (len) {
+    case BINLOG_LEN_HH:     return (signed char)va_arg(*ap, int);
+    case BINLOG_LEN_H:      return (short)va_arg(*ap, int);
+    case BINLOG_LEN_L:      return va_arg(*ap, long);
+    case BINLOG_LEN_LL:     return va_arg(*ap, long long);
+    case BINLOG_LEN_J:      return va_arg(*ap, intmax_t);
+    case BINLOG_LEN_Z:      return (int64_t)(ptrdiff_t)va_arg(*ap, size_t);
+    case BINLOG_LEN_T:      return va_arg(*ap, ptrdiff_t);
+    default:                return va_arg(*ap, int);
+    }
+}
+
+static uint64_t get_unsigned(binlog_len_t len, va_list *ap)
+{
+    switch (len) {
+    case BINLOG_LEN_HH:     return (unsigned char)va_arg(*ap, unsigned int);
+    case BINLOG_LEN_H:      return (unsigned short)va_arg(*ap, unsigned int);
+    case BINLOG_LEN_L:      return va_arg(*ap, unsigned long);
+    case BINLOG_LEN_LL:     return va_arg(*ap, unsigned long long);
+    case BINLOG_LEN_J:      return va_arg(*ap, uintmax_t);
+    case BINLOG_LEN_Z:      return va_arg(*ap, size_t);
+    case BINLOG_LEN_T:      return (uint64_t)(size_t)va_arg(*ap, ptrdiff_t);
+    default:                return va_arg(*ap, unsigned int);
+    }
+}
+
+//Arguments in wire format; 0 when they do not fit in the record
+static int encode_args(out_t *o, const char *format, va_list *ap)
+{
+    binlog_spec_t spec;
+    const char *p = format;
+
+    while ((p = binlog_next_spec(p, &spec)) != NULL) {
+        if (spec.kind == BINLOG_ARG_UNSUPPORTED) {
+            return 1;                           //the decoder stops at the same conversion
+        }
+        for (uint8_t i = 0; i < spec.stars; i++) {
+            if (!put_varint(o, binlog_zigzag(va_arg(*ap, int)))) {
+                return 0;
+            }
+        }
+        int ok;
+        switch (spec.kind) {
+        case BINLOG_ARG_SIGNED:
+            ok = put_varint(o, binlog_zigzag(get_signed(spec.len, ap)));
+            break;
+        case BINLOG_ARG_UNSIGNED:
+            ok = put_varint(o, get_unsigned(spec.len, ap));
+            break;
+        case BINLOG_ARG_CHAR:
+            ok = put_varint(o, (unsigned char)va_arg(*ap, int));
+            break;
+        case BINLOG_ARG_POINTER:
+            ok = put_varint(o, (uintptr_t)va_arg(*ap, void *));
+            break;
+        case BINLOG_ARG_DOUBLE: {
+            double d = (spec.len == BINLOG_LEN_BIG_L) ? (double)va_arg(*ap, long double) : va_arg(*ap, double);
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            ok = (o->cap - o->len >= sizeof(bits));
+            for (unsigned i = 0; ok && i < sizeof(bits); i++) {
+                o->buf[o->len++] = (uint8_t)(bits >> (8 * i));      //little endian on every host
+            }
+            break;
+        }
+        default: {
+            const char *s = va_arg(*ap, const char *);
+            ok = put_string(o, (s != NULL) ? s : "(null)", BINLOG_STR_MAX);
+            break;
+        }
+        }
+        if (!ok) {
+            return 0;
+        }
+        p = spec.end;
+    }
+    return 1;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Output (under lock)
+
+static void send_sync(uint32_t now)
+{
+    uint8_t rec[BINLOG_SYNC_MAGIC_LEN + 1 + BINLOG_VARINT_MAX];
+    memcpy(rec, BINLOG_SYNC_MAGIC, BINLOG_SYNC_MAGIC_LEN);
+    rec[BINLOG_SYNC_MAGIC_LEN] = BINLOG_WIRE_VERSION;
+    size_t len = BINLOG_SYNC_MAGIC_LEN + 1 + binlog_put_varint(&rec[BINLOG_SYNC_MAGIC_LEN + 1], now);
+    cfg.write(rec, len);
+
+    last_timestamp = now;
+    since_sync = 0;
+    tag_count = 0;                              //the decoder may have just attached: define tags again
+}
+
+//Index of "tag" on the wire, sending a TAG record the first time; 0 = table full, send inline
+static unsigned tag_index(const char *tag)
+{
+    for (unsigned i = 0; i < tag_count; i++) {
+        if (tags[i] == tag || strcmp(tags[i], tag) == 0) {
+            return i + 1;
+        }
+    }
+    if (tag_count == BINLOG_MAX_TAGS) {
+        return 0;
+    }
+    tags[tag_count++] = tag;
+
+    uint8_t rec[1 + 2 * BINLOG_VARINT_MAX + BINLOG_TAG_MAX];
+    out_t o = { rec, 0, sizeof(rec) };
+    put_varint(&o, BINLOG_REC_TAG);
+    put_varint(&o, tag_count);
+    put_string(&o, tag, BINLOG_TAG_MAX);
+    cfg.write(rec, o.len);
+    return tag_count;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+void binlog_write(const binlog_site_t *site, const char *tag, ...)
+{
+    va_list ap;
+
+    if (tag == NULL) {
+        tag = "";
+    }
+    if (lock == NULL) {
+        //binlog_start() not called (yet): behave like printf / ESP_LOGx
+        va_start(ap, tag);
+        if (site->level != 0) {
+            printf("%c (%u) %s: ", site->level, (unsigned)esp_log_timestamp(), tag);
+        }
+        vprintf(site->format, ap);
+        if (site->level != 0) {
+            printf("\n");
+        }
+        va_end(ap);
+        return;
+    }
+
+    configASSERT(site >= BINLOG_FIRST_SITE && site < BINLOG_END_SITE);     //site outside binlog_fmt: linker setup
+
+    //Arguments first, outside the lock: this is the expensive part of the call
+    uint8_t args[BINLOG_RECORD_MAX];
+    out_t a = { args, 0, sizeof(args) };
+    va_start(ap, tag);
+    int fits = encode_args(&a, site->format, &ap);
+    va_end(ap);
+    if (!fits) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint8_t rec[BINLOG_RECORD_MAX + 3 * BINLOG_VARINT_MAX + BINLOG_TAG_MAX];
+    out_t o = { rec, 0, sizeof(rec) };
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t now = cfg.timestamp();
+    if (cfg.sync_every != 0 && since_sync >= cfg.sync_every) {
+        send_sync(now);
+    }
+    unsigned tag_idx = (site->level != 0) ? tag_index(tag) : 0;
+
+    put_varint(&o, BINLOG_REC_SITE_BASE + (uint64_t)(site - BINLOG_FIRST_SITE));
+    put_varint(&o, (uint32_t)(now - last_timestamp));
+    if (site->level != 0) {
+        put_varint(&o, tag_idx);
+        if (tag_idx == 0) {
+            put_string(&o, tag, BINLOG_TAG_MAX);
+        }
+    }
+    memcpy(&rec[o.len], args, a.len);
+    o.len += a.len;
+    cfg.write(rec, o.len);
+
+    last_timestamp = now;
+    since_sync++;
+    xSemaphoreGive(lock);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void binlog_write_stdout(const void *data, size_t len)
+{
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+}
+
+BaseType_t binlog_start(const binlog_config_t *config)
+{
+    configASSERT(lock == NULL);                 //call once
+    if (config != NULL) {
+        cfg = *config;
+    } else {
+        cfg = (binlog_config_t)BINLOG_DEFAULT_CONFIG();
+    }
+#ifdef ESP_PLATFORM
+    if (cfg.write == binlog_write_stdout) {
+        //Newlines inside records must stay single 0x0A bytes
+        uart_vfs_dev_port_set_tx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, ESP_LINE_ENDINGS_LF);
+    }
+#endif
+
+    SemaphoreHandle_t m = xSemaphoreCreateMutexStatic(&lock_buf);
+    if (m == NULL) {
+        return pdFAIL;
+    }
+    xSemaphoreTake(m, portMAX_DELAY);
+    lock = m;                                   //from here on BINLOG_x calls wait for the first SYNC
+    send_sync(cfg.timestamp());
+    xSemaphoreGive(m);
+    return pdPASS;
+}
+
+void binlog_sync(void)
+{
+    if (lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    send_sync(cfg.timestamp());
+    xSemaphoreGive(lock);
+}
+
+uint32_t binlog_dropped(void)
+{
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+//Compact binary logging: call sites send a format ID, a timestamp and packed arguments instead of text.
+//The host tool (host/tools/binlog_tool) turns the stream back into the usual "I (ms) TAG: message" lines.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "binlog_wire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why binary?
+At 115200 baud the console moves ~11.5 bytes per millisecond. "I (12345) EX2: Got value: 42" plus colour codes
+and CRLF is ~41 bytes; the same line as a record is 5 bytes: site ID, timestamp delta, tag index, value.
+
+How it works:
+>> BINLOG_LOGI(tag, "fmt", ...) / BINLOG_PRINTF("fmt", ...) place the format in the "binlog_fmt" linker
+   section (one binlog_site_t per call site). The site ID is the index in that section; the string table
+   is produced by the linker, and the host tool reads it back from the ELF (or from the .binlog table
+   written after every host build).
+>> Tags are sent once (TAG record) and then referred to by a 1 byte index.
+>> A SYNC record (absolute timestamp) is sent at start and every sync_every records, so the decoder can
+   attach to a running device; text printed before the first SYNC is passed through unchanged.
+>> Records are encoded on the caller's stack and written with one call to the sink under a mutex, so
+   lines from different tasks never interleave.
+
+Rules:
+1) Format strings must be literals of at most BINLOG_SITE_SIZE - 2 characters (checked at compile time).
+2) Task context only, after binlog_start(). Before that the calls print text like printf / ESP_LOGx.
+3) Other text on the same console (ESP_LOGx from components, printf) costs the decoder a resync:
+   it is shown as-is up to the next SYNC record.
+4) ESP32: binlog_start() switches the console to LF line endings (CRLF would corrupt the records).
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef BINLOG_SYNC_EVERY
+#define BINLOG_SYNC_EVERY           64          //records between SYNC records (0 = only at start)
+#endif
+
+#ifndef BINLOG_MAX_TAGS
+#define BINLOG_MAX_TAGS             16          //tags with a 1 byte index, later tags are sent inline
+#endif
+
+#define BINLOG_RECORD_MAX           128         //encoded record size limit (bigger records are dropped)
+
+typedef struct {
+    void (*write)(const void *data, size_t len);    //receives complete records
+    uint32_t (*timestamp)(void);                    //milliseconds
+    uint32_t sync_every;
+} binlog_config_t;
+
+//Console output, ESP-IDF log timestamp
+#define BINLOG_DEFAULT_CONFIG() {               \
+    .write = binlog_write_stdout,               \
+    .timestamp = esp_log_timestamp,             \
+    .sync_every = BINLOG_SYNC_EVERY,            \
+}
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : binlog_start
+>> Description: Switch every BINLOG_x call to binary output and send the first SYNC record.
+>> config: sink, clock and sync interval; NULL = BINLOG_DEFAULT_CONFIG().
+>> Returns: pdPASS, or pdFAIL if the mutex could not be created (output stays text).
+*/
+BaseType_t binlog_start(const binlog_config_t *config);
+
+//Called by the BINLOG_x macros; the arguments follow site->format.
+void binlog_write(const binlog_site_t *site, const char *tag, ...);
+
+//Send a SYNC record now (e.g. when a decoder is attached later). The tag table starts over.
+void binlog_sync(void);
+
+//Records that did not fit in BINLOG_RECORD_MAX and were dropped, since boot.
+uint32_t binlog_dropped(void);
+
+//Default sink: fwrite to stdout + fflush, so records leave in one piece.
+void binlog_write_stdout(const void *data, size_t len);
+//-------------------------------------------------------------------------------------------------
+
+
+//Never called: lets the compiler check the arguments against the format like it does for printf
+static inline __attribute__((format(printf, 1, 2))) void binlog_check_format(const char *format, ...)
+{
+    (void)format;
+}
+
+//Fixed alignment: sites must follow each other without padding (BINLOG_SITE_SIZE is a multiple of 4)
+#define BINLOG_SITE_ATTR    __attribute__((section("binlog_fmt"), used, aligned(4)))
+
+#define BINLOG_EMIT(letter, tag, format, ...)                                                   \
+    do {                                                                                        \
+        _Static_assert(sizeof(format) <= BINLOG_SITE_SIZE - 1, "binlog: format string too long"); \
+        static const binlog_site_t binlog_site_ BINLOG_SITE_ATTR = { (letter), format };       \
+        if (0) {                                                                                \
+            binlog_check_format(format, ##__VA_ARGS__);                                         \
+        }                                                                                       \
+        binlog_write(&binlog_site_, (tag), ##__VA_ARGS__);                                      \
+    } while (0)
+
+#define BINLOG_LEVEL(level, letter, tag, format, ...)                                           \
+    do {                                                                                        \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                                       \
+            BINLOG_EMIT(letter, tag, format, ##__VA_ARGS__);                                    \
+        }                                                                                       \
+    } while (0)
+
+#define BINLOG_LOGE(tag, format, ...)   BINLOG_LEVEL(ESP_LOG_ERROR,   'E', tag, format, ##__VA_ARGS__)
+#define BINLOG_LOGW(tag, format, ...)   BINLOG_LEVEL(ESP_LOG_WARN,    'W', tag, format, ##__VA_ARGS__)
+#define BINLOG_LOGI(tag, format, ...)   BINLOG_LEVEL(ESP_LOG_INFO,    'I', tag, format, ##__VA_ARGS__)
+#define BINLOG_LOGD(tag, format, ...)   BINLOG_LEVEL(ESP_LOG_DEBUG,   'D', tag, format, ##__VA_ARGS__)
+#define BINLOG_LOGV(tag, format, ...)   BINLOG_LEVEL(ESP_LOG_VERBOSE, 'V', tag, format, ##__VA_ARGS__)
+
+//printf replacement: the format carries its own "\n", no tag and no "I (ms)" prefix
+#define BINLOG_PRINTF(format, ...)      BINLOG_EMIT(0, NULL, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
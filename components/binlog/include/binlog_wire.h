@@ -0,0 +1,203 @@
+//Binary log wire format, shared by the encoder (binlog.c) and the host decoder (host/tools)
+//Plain C, no FreeRTOS / ESP-IDF includes, so the host tool can use it as-is.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Call sites:
+Every BINLOG_x() call site puts one binlog_site_t (level letter + format string, BINLOG_SITE_SIZE bytes)
+into the "binlog_fmt" linker section. The site ID is its index in that section, so the firmware never sends
+the format text; the host reads the same section back from the ELF to get the string table.
+
+Stream = sequence of records, every number is an unsigned LEB128 varint:
+>> SYNC  : 0x00 'B' 'L' 'G' version, timestamp_ms                       (absolute, restarts delta coding)
+>> TAG   : 0x01, tag_index, length, bytes                              (defines a tag index for ESP_LOGx)
+>> SITE  : 0x02 + site_id, timestamp delta_ms, [tag_index], arguments  (tag only for ESP_LOGx sites)
+   tag_index 0 = tag sent inline (length, bytes) because the tag table is full.
+
+Arguments, one per conversion in format order ('*' width / precision first):
+>> %d %i                 : zigzag varint (so small negative numbers stay small)
+>> %u %o %x %X %c        : varint
+>> %p                    : varint of the address
+>> %f %e %g %a (any)     : 8 byte IEEE double, little endian
+>> %s                    : length, bytes (not NUL terminated, truncated to BINLOG_STR_MAX)
+>> anything else (%n...): ends argument encoding, the rest of the format is printed as literal text
+---------------------------------------------------------------------------------------------------
+*/
+
+#define BINLOG_WIRE_VERSION         1
+#define BINLOG_SITE_SIZE            64          //bytes per call site: level + format (max 62 chars) + NUL
+
+#define BINLOG_REC_SYNC             0
+#define BINLOG_REC_TAG              1
+#define BINLOG_REC_SITE_BASE        2
+
+#define BINLOG_SYNC_MAGIC           "\x00" "BLG"
+#define BINLOG_SYNC_MAGIC_LEN       4
+
+#define BINLOG_VARINT_MAX           10          //bytes for a 64-bit value
+#define BINLOG_TAG_MAX              24          //longer tags are truncated
+#define BINLOG_STR_MAX              48          //longer %s arguments are truncated
+
+typedef struct {
+    char level;                                 //'E' 'W' 'I' 'D' 'V' = ESP_LOGx line, 0 = raw printf
+    char format[BINLOG_SITE_SIZE - 1];
+} binlog_site_t;
+
+
+//-------------------------------------------------------------------------------------------------
+//Varints
+
+static inline size_t binlog_put_varint(uint8_t *out, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+//Bytes consumed, 0 when "in" ends before the varint does (or it is longer than 10 bytes)
+static inline size_t binlog_get_varint(const uint8_t *in, size_t len, uint64_t *v)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < len && i < BINLOG_VARINT_MAX; i++) {
+        value |= (uint64_t)(in[i] & 0x7f) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            *v = value;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static inline uint64_t binlog_zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t binlog_unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//printf conversion parsing: the encoder uses it to pull arguments off the va_list, the decoder to
+//know what follows on the wire. Both sides MUST agree, so there is exactly one copy.
+
+typedef enum {
+    BINLOG_ARG_SIGNED, BINLOG_ARG_UNSIGNED, BINLOG_ARG_CHAR, BINLOG_ARG_POINTER,
+    BINLOG_ARG_DOUBLE, BINLOG_ARG_STRING, BINLOG_ARG_UNSUPPORTED
+} binlog_arg_t;
+
+typedef enum {
+    BINLOG_LEN_NONE, BINLOG_LEN_HH, BINLOG_LEN_H, BINLOG_LEN_L, BINLOG_LEN_LL,
+    BINLOG_LEN_J, BINLOG_LEN_Z, BINLOG_LEN_T, BINLOG_LEN_BIG_L
+} binlog_len_t;
+
+typedef struct {
+    const char *start;                          //the '%'
+    const char *length;                         //first length modifier character (or the conversion)
+    const char *end;                            //one past the conversion character
+    uint8_t stars;                              //'*' width / precision: int arguments before the value
+    binlog_len_t len;
+    binlog_arg_t kind;
+} binlog_spec_t;
+
+static inline const char *binlog_skip_digits(const char *s)
+{
+    while (*s >= '0' && *s <= '9') {
+        s++;
+    }
+    return s;
+}
+
+//Next conversion at or after p ("%%" is literal text), NULL when there are none left
+static inline const char *binlog_next_spec(const char *p, binlog_spec_t *spec)
+{
+    while ((p = strchr(p, '%')) != NULL) {
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        const char *s = p + 1;
+        spec->start = p;
+        spec->stars = 0;
+
+        while (*s != '\0' && strchr("-+ #0", *s) != NULL) {
+            s++;
+        }
+        if (*s == '*') {
+            spec->stars++;
+            s++;
+        } else {
+            s = binlog_skip_digits(s);
+        }
+        if (*s == '.') {
+            s++;
+            if (*s == '*') {
+                spec->stars++;
+                s++;
+            } else {
+                s = binlog_skip_digits(s);
+            }
+        }
+
+        spec->length = s;
+        spec->len = BINLOG_LEN_NONE;
+        switch (*s) {
+        case 'h': spec->len = (s[1] == 'h') ? BINLOG_LEN_HH : BINLOG_LEN_H; s += (s[1] == 'h') ? 2 : 1; break;
+        case 'l': spec->len = (s[1] == 'l') ? BINLOG_LEN_LL : BINLOG_LEN_L; s += (s[1] == 'l') ? 2 : 1; break;
+        case 'j': spec->len = BINLOG_LEN_J;     s++; break;
+        case 'z': spec->len = BINLOG_LEN_Z;     s++; break;
+        case 't': spec->len = BINLOG_LEN_T;     s++; break;
+        case 'L': spec->len = BINLOG_LEN_BIG_L; s++; break;
+        default: break;
+        }
+
+        switch (*s) {
+        case 'd': case 'i':
+            spec->kind = BINLOG_ARG_SIGNED;
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            spec->kind = BINLOG_ARG_UNSIGNED;
+            break;
+        case 'c':
+            spec->kind = (spec->len == BINLOG_LEN_NONE) ? BINLOG_ARG_CHAR : BINLOG_ARG_UNSUPPORTED;
+            break;
+        case 'p':
+            spec->kind = BINLOG_ARG_POINTER;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = BINLOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->kind = (spec->len == BINLOG_LEN_NONE) ? BINLOG_ARG_STRING : BINLOG_ARG_UNSUPPORTED;
+            break;
+        default:
+            spec->kind = BINLOG_ARG_UNSUPPORTED;        //%n, wide characters, unknown or truncated
+            break;
+        }
+        spec->end = (*s != '\0') ? s + 1 : s;
+        return p;
+    }
+    return NULL;
+}
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
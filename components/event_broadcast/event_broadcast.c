@@ -0,0 +1,133 @@
+//Broadcast wake on an event group (see event_broadcast.h)
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "event_broadcast.h"
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> Three bits: TICK_EVEN / TICK_ODD carry the tick (published tick k sets TICK_BIT(k)), IDLE is set while
+   no tick is outstanding. publish() takes IDLE with clear-on-exit, so it cannot start a tick before the
+   last ack has cleared the previous one.
+>> The last ack clears the tick bit BEFORE setting IDLE: tick k + 2 reuses the bit of tick k, and must not
+   be cleared by a late clear of tick k.
+>> "outstanding" counts the acks still missing (acq_rel: the ack that reaches 0 sees every subscriber's
+   work before it). "epoch" of a subscriber is only touched by its own task.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define TICK_EVEN       ((EventBits_t)1 << 0)
+#define TICK_ODD        ((EventBits_t)1 << 1)
+#define IDLE            ((EventBits_t)1 << 2)
+#define TICK_BIT(k)     (((k) & 1u) ? TICK_ODD : TICK_EVEN)
+
+typedef struct {
+    uint32_t epoch;                         //last tick received
+    bool owes_ack;                          //received, not acknowledged yet
+} subscriber_t;
+
+struct event_broadcast {
+    EventGroupHandle_t group;
+    size_t subscribers;
+    uint32_t epoch;                         //last tick published (publisher only)
+    atomic_uint outstanding;
+    atomic_uint published;
+    atomic_uint skipped;
+    atomic_uint acks;
+    subscriber_t subs[];
+};
+
+
+//-------------------------------------------------------------------------------------------------
+event_broadcast_t *event_broadcast_create(size_t subscribers)
+{
+    if (subscribers == 0) {
+        return NULL;
+    }
+    event_broadcast_t *b = pvPortMalloc(sizeof(*b) + subscribers * sizeof(subscriber_t));
+    if (b == NULL) {
+        return NULL;
+    }
+    b->group = xEventGroupCreate();
+    if (b->group == NULL) {
+        vPortFree(b);
+        return NULL;
+    }
+    b->subscribers = subscribers;
+    b->epoch = 0;
+    atomic_init(&b->outstanding, 0);
+    atomic_init(&b->published, 0);
+    atomic_init(&b->skipped, 0);
+    atomic_init(&b->acks, 0);
+    for (size_t i = 0; i < subscribers; i++) {
+        b->subs[i] = (subscriber_t){ .epoch = 0, .owes_ack = false };
+    }
+    xEventGroupSetBits(b->group, IDLE);
+    return b;
+}
+
+void event_broadcast_delete(event_broadcast_t *b)
+{
+    vEventGroupDelete(b->group);
+    vPortFree(b);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t event_broadcast_publish(event_broadcast_t *b, TickType_t ticks_to_wait)
+{
+    EventBits_t bits = xEventGroupWaitBits(b->group, IDLE, pdTRUE, pdTRUE, ticks_to_wait);
+    if ((bits & IDLE) == 0) {
+        atomic_fetch_add_explicit(&b->skipped, 1, memory_order_relaxed);
+        return pdFAIL;
+    }
+    atomic_store_explicit(&b->outstanding, (unsigned)b->subscribers, memory_order_relaxed);
+    atomic_fetch_add_explicit(&b->published, 1, memory_order_relaxed);
+    b->epoch++;
+    xEventGroupSetBits(b->group, TICK_BIT(b->epoch));  //readies every subscriber waiting for it
+    return pdPASS;
+}
+
+BaseType_t event_broadcast_wait(event_broadcast_t *b, size_t index, TickType_t ticks_to_wait)
+{
+    configASSERT(index < b->subscribers);
+    subscriber_t *s = &b->subs[index];
+    configASSERT(!s->owes_ack);
+    EventBits_t tick = TICK_BIT(s->epoch + 1);
+    //No clear on exit: the bit stays set until every subscriber has acknowledged
+    if ((xEventGroupWaitBits(b->group, tick, pdFALSE, pdTRUE, ticks_to_wait) & tick) == 0) {
+        return pdFALSE;
+    }
+    s->epoch++;
+    s->owes_ack = true;
+    return pdTRUE;
+}
+
+void event_broadcast_ack(event_broadcast_t *b, size_t index)
+{
+    configASSERT(index < b->subscribers);
+    subscriber_t *s = &b->subs[index];
+    configASSERT(s->owes_ack);
+    s->owes_ack = false;
+    atomic_fetch_add_explicit(&b->acks, 1, memory_order_relaxed);
+    if (atomic_fetch_sub_explicit(&b->outstanding, 1, memory_order_acq_rel) == 1) {
+        xEventGroupClearBits(b->group, TICK_BIT(s->epoch));
+        xEventGroupSetBits(b->group, IDLE);     //may wake the publisher
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+void event_broadcast_get(const event_broadcast_t *b, event_broadcast_stats_t *out)
+{
+    out->subscribers = b->subscribers;
+    out->published = atomic_load_explicit(&b->published, memory_order_relaxed);
+    out->skipped = atomic_load_explicit(&b->skipped, memory_order_relaxed);
+    out->acks = atomic_load_explicit(&b->acks, memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+//Broadcast wake: one publish wakes every subscriber, the next publish waits until all have acknowledged
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why an event group?
+A semaphore or a task notification wakes ONE task per give. To wake N subscribers with them the publisher
+has to give N times (N kernel calls, N context switches while it is still giving). xEventGroupSetBits()
+readies every task waiting for the bit in one call: all subscribers see the same tick.
+
+The hard part is clearing the bit again. Cleared too early, a subscriber that was not scheduled yet misses
+the tick; left set, a fast subscriber that comes back wakes a second time for the same tick. Here the bit
+is cleared by the LAST subscriber to acknowledge, and the next publish waits for that:
+
+Flow:
+1) Publisher : b = event_broadcast_create(n);                  -> subscribers 0 .. n-1
+2) Subscriber: if (event_broadcast_wait(b, my_index, portMAX_DELAY) == pdTRUE) {
+                   ... react to the tick ...
+                   event_broadcast_ack(b, my_index);           -> the last ack clears the bit
+               }
+3) Publisher : event_broadcast_publish(b, 0);                  -> pdFAIL (counted as skipped) if some
+                                                                  subscriber has not acknowledged the last one
+
+>> Every subscriber sees every published tick exactly once; nothing is merged or lost silently.
+>> Ticks alternate between two bits, so a subscriber that acknowledged and waits again blocks on the
+   other bit and cannot see the current tick twice.
+>> The subscriber count is fixed at create and does not use one bit per subscriber, so N is not limited
+   by the 24 bits of an event group.
+
+Rules:
+1) One publisher task. Publishing from an ISR is not supported (xEventGroupSetBitsFromISR() goes through
+   the timer task anyway - notify the publisher task from the ISR instead).
+2) Every subscriber must acknowledge every tick it received, otherwise the next publish never succeeds.
+3) Subscriber "index" is used by one task only.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct event_broadcast event_broadcast_t;
+
+typedef struct {
+    size_t subscribers;
+    uint32_t published;                     //ticks every subscriber was woken for
+    uint32_t skipped;                       //publish calls that timed out waiting for the acknowledgements
+    uint32_t acks;                          //event_broadcast_ack() calls, all subscribers together
+} event_broadcast_stats_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : event_broadcast_create
+>> Description: Create the broadcast (one event group) for "subscribers" subscribers, indexes 0 .. n-1.
+>> Returns: handle, or NULL if subscribers is 0 or memory is exhausted.
+*/
+event_broadcast_t *event_broadcast_create(size_t subscribers);
+
+//Free the broadcast. Nobody may be waiting on it.
+void event_broadcast_delete(event_broadcast_t *b);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : event_broadcast_publish
+>> Description: Wait up to ticks_to_wait until every subscriber has acknowledged the previous tick, then
+                wake all subscribers (task context, publisher only).
+>> Returns: pdPASS, or pdFAIL if the previous tick was still not acknowledged (counted as skipped).
+*/
+BaseType_t event_broadcast_publish(event_broadcast_t *b, TickType_t ticks_to_wait);
+
+/*
+Function : event_broadcast_wait
+>> Description: Block subscriber "index" until the next tick it has not seen yet.
+>> Returns: pdTRUE if a tick arrived (acknowledge it with event_broadcast_ack()), pdFALSE on timeout.
+*/
+BaseType_t event_broadcast_wait(event_broadcast_t *b, size_t index, TickType_t ticks_to_wait);
+
+//Subscriber "index" is done with the tick it received. The last acknowledgement clears the tick.
+void event_broadcast_ack(event_broadcast_t *b, size_t index);
+//-------------------------------------------------------------------------------------------------
+
+
+//Copy the counters (any task; each field is read atomically on its own).
+void event_broadcast_get(const event_broadcast_t *b, event_broadcast_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+//Fixed-block message pool for zero-copy message passing
+
+#pragma once
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why a message pool?
+xQueueSend copies the whole item into the queue and xQueueReceive copies it out again, both inside a
+critical section. For 256..1500 byte frames that is two large memcpy per hop.
+
+Zero-copy flow:
+1) Producer: msg = msg_pool_alloc(pool, timeout)   -> gets a free block (blocks while the pool is empty)
+2) Producer: fills msg in place, then xQueueSend(q, &msg, ...) -> only the POINTER goes through the queue
+3) Consumer: xQueueReceive(q, &msg, ...), uses the data, then msg_pool_free(pool, msg)
+
+Whoever holds the pointer owns the block. After sending it the producer must not touch it any more.
+
+Debug builds (MSG_POOL_DEBUG = 1, the default unless NDEBUG is defined):
+>> msg_pool_free() asserts on pointers that are not a block of this pool and on double frees.
+>> Each block remembers the task that allocated it, so msg_pool_report_leaks() can name the owners.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef MSG_POOL_DEBUG
+#ifdef NDEBUG
+#define MSG_POOL_DEBUG 0
+#else
+#define MSG_POOL_DEBUG 1
+#endif
+#endif
+
+typedef struct msg_pool msg_pool_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : msg_pool_create
+>> Description: Allocate "block_count" blocks of at least "block_size" bytes each in one chunk.
+>> Returns: handle of the pool, or NULL if memory is exhausted.
+*/
+msg_pool_t *msg_pool_create(size_t block_size, size_t block_count);
+
+//Free the pool. All blocks must have been returned (checked in debug builds).
+void msg_pool_delete(msg_pool_t *pool);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : msg_pool_alloc
+>> Description: Take one free block from the pool.
+>> ticks_to_wait: how long to block while every block is in use (0 = return NULL at once).
+>> Returns: pointer to the block (block_size bytes, not cleared), or NULL on timeout.
+*/
+void *msg_pool_alloc(msg_pool_t *pool, TickType_t ticks_to_wait);
+
+/*
+Function : msg_pool_free
+>> Description: Give a block back to the pool. Can be called by any task, not only the allocator.
+*/
+void msg_pool_free(msg_pool_t *pool, void *block);
+//-------------------------------------------------------------------------------------------------
+
+
+//Number of blocks currently allocated (not yet returned).
+size_t msg_pool_in_use(const msg_pool_t *pool);
+
+//Usable size of one block in bytes (block_size rounded up for alignment).
+size_t msg_pool_block_size(const msg_pool_t *pool);
+
+//Print every block that is still allocated and its owner task (debug builds). Returns the count.
+size_t msg_pool_report_leaks(const msg_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,170 @@
+//Fixed-block message pool for zero-copy message passing (see msg_pool.h)
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "msg_pool.h"
+
+
+/*
+---------------------------------------------------------------------------------------------------
+The free list is itself a FreeRTOS queue of block pointers:
+>> alloc = xQueueReceive of a pointer, so an empty pool blocks the caller exactly like an empty queue.
+>> free  = xQueueSend of the pointer back (never blocks: the queue has one slot per block).
+Only one pointer is copied per operation, whatever the block size.
+
+Debug state per block: FREE / IN_USE, changed with compare-and-swap so that two tasks freeing the
+same block at the same time are still caught.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define MSG_POOL_ALIGN      8u
+
+enum { BLOCK_FREE = 0, BLOCK_IN_USE = 1 };
+
+struct msg_pool {
+    QueueHandle_t free_list;
+    uint8_t *blocks;
+    size_t block_size;
+    size_t block_count;
+#if MSG_POOL_DEBUG
+    atomic_uchar *state;
+    TaskHandle_t *owner;
+#endif
+};
+
+
+//-------------------------------------------------------------------------------------------------
+msg_pool_t *msg_pool_create(size_t block_size, size_t block_count)
+{
+    if (block_size == 0 || block_count == 0) {
+        return NULL;
+    }
+    block_size = (block_size + MSG_POOL_ALIGN - 1) & ~(size_t)(MSG_POOL_ALIGN - 1);
+
+    size_t header = (sizeof(msg_pool_t) + MSG_POOL_ALIGN - 1) & ~(size_t)(MSG_POOL_ALIGN - 1);
+#if MSG_POOL_DEBUG
+    size_t debug = block_count * (sizeof(TaskHandle_t) + sizeof(atomic_uchar));
+    debug = (debug + MSG_POOL_ALIGN - 1) & ~(size_t)(MSG_POOL_ALIGN - 1);
+#else
+    size_t debug = 0;
+#endif
+
+    uint8_t *mem = pvPortMalloc(header + debug + block_size * block_count);
+    if (mem == NULL) {
+        return NULL;
+    }
+
+    msg_pool_t *pool = (msg_pool_t *)mem;
+    pool->free_list = xQueueCreate(block_count, sizeof(void *));
+    if (pool->free_list == NULL) {
+        vPortFree(mem);
+        return NULL;
+    }
+    pool->block_size = block_size;
+    pool->block_count = block_count;
+    pool->blocks = mem + header + debug;
+#if MSG_POOL_DEBUG
+    pool->owner = (TaskHandle_t *)(mem + header);
+    pool->state = (atomic_uchar *)(pool->owner + block_count);
+#endif
+
+    for (size_t i = 0; i < block_count; i++) {
+        void *block = pool->blocks + i * block_size;
+#if MSG_POOL_DEBUG
+        pool->owner[i] = NULL;
+        atomic_init(&pool->state[i], BLOCK_FREE);
+#endif
+        xQueueSend(pool->free_list, &block, 0);
+    }
+    return pool;
+}
+
+void msg_pool_delete(msg_pool_t *pool)
+{
+#if MSG_POOL_DEBUG
+    size_t leaks = msg_pool_report_leaks(pool);
+    configASSERT(leaks == 0);
+    (void)leaks;
+#endif
+    vQueueDelete(pool->free_list);
+    vPortFree(pool);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void *msg_pool_alloc(msg_pool_t *pool, TickType_t ticks_to_wait)
+{
+    void *block = NULL;
+    if (xQueueReceive(pool->free_list, &block, ticks_to_wait) != pdPASS) {
+        return NULL;
+    }
+
+#if MSG_POOL_DEBUG
+    size_t index = (size_t)((uint8_t *)block - pool->blocks) / pool->block_size;
+    unsigned char expected = BLOCK_FREE;
+    //A block on the free list must be free, otherwise someone kept using it after msg_pool_free()
+    bool was_free = atomic_compare_exchange_strong(&pool->state[index], &expected, BLOCK_IN_USE);
+    configASSERT(was_free);
+    (void)was_free;
+    pool->owner[index] = xTaskGetCurrentTaskHandle();
+#endif
+    return block;
+}
+
+void msg_pool_free(msg_pool_t *pool, void *block)
+{
+#if MSG_POOL_DEBUG
+    size_t offset = (size_t)((uint8_t *)block - pool->blocks);
+    //Must point at the start of one of our blocks
+    configASSERT((uint8_t *)block >= pool->blocks);
+    configASSERT(offset < pool->block_size * pool->block_count);
+    configASSERT(offset % pool->block_size == 0);
+
+    size_t index = offset / pool->block_size;
+    unsigned char expected = BLOCK_IN_USE;
+    if (!atomic_compare_exchange_strong(&pool->state[index], &expected, BLOCK_FREE)) {
+        printf("msg_pool: double free of block %u (%p)\n", (unsigned)index, block);
+        configASSERT(0);
+    }
+    pool->owner[index] = NULL;
+#endif
+    BaseType_t ok = xQueueSend(pool->free_list, &block, 0);
+    configASSERT(ok == pdPASS);     //cannot be full unless a foreign pointer was freed
+    (void)ok;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+size_t msg_pool_in_use(const msg_pool_t *pool)
+{
+    return pool->block_count - uxQueueMessagesWaiting(pool->free_list);
+}
+
+size_t msg_pool_block_size(const msg_pool_t *pool)
+{
+    return pool->block_size;
+}
+
+size_t msg_pool_report_leaks(const msg_pool_t *pool)
+{
+#if MSG_POOL_DEBUG
+    size_t leaks = 0;
+    for (size_t i = 0; i < pool->block_count; i++) {
+        if (atomic_load(&pool->state[i]) == BLOCK_IN_USE) {
+            TaskHandle_t owner = pool->owner[i];
+            printf("msg_pool: block %u still allocated by %s\n", (unsigned)i,
+                   owner != NULL ? pcTaskGetName(owner) : "?");
+            leaks++;
+        }
+    }
+    return leaks;
+#else
+    return msg_pool_in_use(pool);
+#endif
+}
@@ -0,0 +1,133 @@
+//Direct-to-task signalling: a dispatcher that wakes one chosen waiter with a task notification
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why task notifications instead of a binary semaphore?
+A semaphore is a queue object of its own (heap allocation, its own lock and waiting list). Giving it
+locks the queue, moves a waiter from the queue's event list to the ready list, and the waiter then locks
+the queue again to take the count. Every task already has a notification value in its TCB:
+xTaskNotifyGive() increments it and readies the task directly, ulTaskNotifyTake(pdTRUE, ...) reads and
+clears it - no extra object, no queue lock, nothing to allocate.
+
+The catch: a notification has exactly one receiver, so the giver must say WHICH task to wake.
+That is what the dispatcher is for: waiters are registered once and the giver picks one by index.
+
+Flow:
+1) Giver : d = notify_dispatch_create(2, policy); notify_dispatch_add(d, task_b); notify_dispatch_add(d, task_c);
+2) Waiter: if (notify_dispatch_wait(d, my_index, portMAX_DELAY) == pdTRUE) { ... }   -> like xSemaphoreTake()
+3) Giver : notify_dispatch_give(d, 0);          -> wakes task_b only
+           notify_dispatch_give_next(d);        -> wakes the waiter the policy picks
+
+Fair dispatch:
+With a semaphore, equal-priority waiters get whatever the event list and timing decide: a waiter that comes
+back to xSemaphoreTake() while the semaphore is still given takes it again, so faster waiters win more often.
+notify_dispatch_give_next() decides instead:
+>> NOTIFY_DISPATCH_ROUND_ROBIN  : waiter 0, 1, 2, ... in turn, whether or not it is waiting. Exact split;
+                                  a busy waiter picks its give up when it comes back (later, or merged).
+>> NOTIFY_DISPATCH_LEAST_RECENT : the waiting task that was served longest ago (if nobody waits: the one
+                                  served longest ago). No give is parked on a busy waiter while another one
+                                  is idle, and idle waiters still take turns.
+Per waiter the dispatcher counts gives, wakes and coalesced gives (notify_dispatch_get_counters()).
+
+Rules:
+1) A wake clears the value, so several gives before the waiter runs count as one (coalesced), exactly like
+   a binary semaphore.
+2) Notification index 0 is used; the waiter must not also receive other notifications on it.
+3) Give from one task at a time (the giver owns the selection state); wait only from the registered task.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct notify_dispatch notify_dispatch_t;
+
+typedef enum {
+    NOTIFY_DISPATCH_ROUND_ROBIN = 0,
+    NOTIFY_DISPATCH_LEAST_RECENT,
+} notify_dispatch_policy_t;
+
+typedef struct {
+    uint32_t gives;                 //gives addressed to this waiter
+    uint32_t wakes;                 //notify_dispatch_wait() calls that returned pdTRUE
+    uint32_t coalesced;             //gives that found the waiter already notified (merged into one wake)
+} notify_dispatch_counters_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : notify_dispatch_create
+>> Description: Allocate a dispatcher with room for "max_waiters" tasks.
+>> policy: how notify_dispatch_give_next() picks the waiter.
+>> Returns: handle, or NULL if max_waiters is 0 or memory is exhausted.
+*/
+notify_dispatch_t *notify_dispatch_create(size_t max_waiters, notify_dispatch_policy_t policy);
+
+//Free the dispatcher. The waiting tasks are not touched.
+void notify_dispatch_delete(notify_dispatch_t *d);
+
+/*
+Function : notify_dispatch_add
+>> Description: Register a task that waits with notify_dispatch_take().
+>> Returns: index to pass to notify_dispatch_give() (0, 1, ... in call order), or -1 if the dispatcher is full.
+*/
+int notify_dispatch_add(notify_dispatch_t *d, TaskHandle_t task);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : notify_dispatch_give
+>> Description: Wake waiter "index" (task context). Replaces xSemaphoreGive().
+>> Returns: pdPASS, or pdFAIL if no task is registered at that index.
+*/
+BaseType_t notify_dispatch_give(notify_dispatch_t *d, size_t index);
+
+/*
+Function : notify_dispatch_give_next
+>> Description: Wake the waiter chosen by the dispatcher's policy (task context).
+>> Returns: index of the waiter that was given, or -1 if no waiter is registered.
+*/
+int notify_dispatch_give_next(notify_dispatch_t *d);
+
+/*
+Function : notify_dispatch_wait
+>> Description: notify_dispatch_take() for waiter "index" (the calling task, registered now or later by
+                notify_dispatch_add()). Marks the waiter as waiting for NOTIFY_DISPATCH_LEAST_RECENT and
+                counts the wake.
+>> Returns: pdTRUE if it was given, pdFALSE on timeout.
+*/
+BaseType_t notify_dispatch_wait(notify_dispatch_t *d, size_t index, TickType_t ticks_to_wait);
+
+/*
+Function : notify_dispatch_take
+>> Description: Block the calling task until it is given, without any bookkeeping. Replaces xSemaphoreTake().
+>> Returns: pdTRUE if it was given, pdFALSE on timeout.
+*/
+static inline BaseType_t notify_dispatch_take(TickType_t ticks_to_wait)
+{
+    return (ulTaskNotifyTake(pdTRUE, ticks_to_wait) != 0) ? pdTRUE : pdFALSE;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//Number of registered waiters.
+size_t notify_dispatch_waiters(const notify_dispatch_t *d);
+
+//Copy the counters of waiter "index" (any task; each field is read atomically on its own).
+void notify_dispatch_get_counters(const notify_dispatch_t *d, size_t index, notify_dispatch_counters_t *out);
+
+//Bytes notify_dispatch_create(max_waiters) allocates (the whole RAM cost, the TCBs already hold the values).
+size_t notify_dispatch_bytes(size_t max_waiters);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,172 @@
+//Direct-to-task signalling dispatcher (see notify_dispatch.h)
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "notify_dispatch.h"
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> Every slot is initialised by create, so a waiter may already wait before it is registered (on the
+   dual-core ESP32 a freshly created task can run on the other core before xTaskCreate() returns).
+   Only the task handle is written by notify_dispatch_add(), before the first give.
+>> next / served belong to the (single) giver. "waiting" is written by the waiter and read by the giver,
+   the counters are written by one side each and read by anyone: relaxed atomics are enough for both.
+>> Coalescing is detected with xTaskNotifyAndQuery(): a previous value != 0 means the waiter had not
+   taken the last give yet, so this one merges into it.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct {
+    TaskHandle_t task;
+    atomic_bool waiting;                    //blocked in notify_dispatch_wait()
+    uint32_t last_served;                   //value of "served" at the last give to this waiter (0 = never)
+    atomic_uint gives;
+    atomic_uint wakes;
+    atomic_uint coalesced;
+} waiter_t;
+
+struct notify_dispatch {
+    notify_dispatch_policy_t policy;
+    size_t max_waiters;
+    size_t count;
+    size_t next;                            //NOTIFY_DISPATCH_ROUND_ROBIN: waiter to give next
+    uint32_t served;                        //gives so far: the clock of NOTIFY_DISPATCH_LEAST_RECENT
+    waiter_t waiters[];
+};
+
+
+//-------------------------------------------------------------------------------------------------
+size_t notify_dispatch_bytes(size_t max_waiters)
+{
+    return sizeof(notify_dispatch_t) + max_waiters * sizeof(waiter_t);
+}
+
+notify_dispatch_t *notify_dispatch_create(size_t max_waiters, notify_dispatch_policy_t policy)
+{
+    if (max_waiters == 0) {
+        return NULL;
+    }
+    notify_dispatch_t *d = pvPortMalloc(notify_dispatch_bytes(max_waiters));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->policy = policy;
+    d->max_waiters = max_waiters;
+    d->count = 0;
+    d->next = 0;
+    d->served = 0;
+    for (size_t i = 0; i < max_waiters; i++) {
+        waiter_t *w = &d->waiters[i];
+        w->task = NULL;
+        w->last_served = 0;
+        atomic_init(&w->waiting, false);
+        atomic_init(&w->gives, 0);
+        atomic_init(&w->wakes, 0);
+        atomic_init(&w->coalesced, 0);
+    }
+    return d;
+}
+
+void notify_dispatch_delete(notify_dispatch_t *d)
+{
+    vPortFree(d);
+}
+
+int notify_dispatch_add(notify_dispatch_t *d, TaskHandle_t task)
+{
+    configASSERT(task != NULL);
+    if (d->count == d->max_waiters) {
+        return -1;
+    }
+    d->waiters[d->count].task = task;
+    return (int)d->count++;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t notify_dispatch_give(notify_dispatch_t *d, size_t index)
+{
+    if (index >= d->count) {
+        return pdFAIL;
+    }
+    waiter_t *w = &d->waiters[index];
+    w->last_served = ++d->served;
+    atomic_fetch_add_explicit(&w->gives, 1, memory_order_relaxed);
+
+    uint32_t previous = 0;
+    xTaskNotifyAndQuery(w->task, 0, eIncrement, &previous);
+    if (previous != 0) {
+        atomic_fetch_add_explicit(&w->coalesced, 1, memory_order_relaxed);
+    }
+    return pdPASS;
+}
+
+//NOTIFY_DISPATCH_LEAST_RECENT: a waiting task beats a busy one, then the oldest last_served wins
+static size_t pick_least_recent(const notify_dispatch_t *d)
+{
+    size_t best = 0;
+    bool best_waiting = atomic_load_explicit(&d->waiters[0].waiting, memory_order_relaxed);
+    for (size_t i = 1; i < d->count; i++) {
+        const waiter_t *w = &d->waiters[i];
+        bool waiting = atomic_load_explicit(&w->waiting, memory_order_relaxed);
+        if ((waiting && !best_waiting) ||
+            (waiting == best_waiting && w->last_served < d->waiters[best].last_served)) {
+            best = i;
+            best_waiting = waiting;
+        }
+    }
+    return best;
+}
+
+int notify_dispatch_give_next(notify_dispatch_t *d)
+{
+    if (d->count == 0) {
+        return -1;
+    }
+    size_t index;
+    if (d->policy == NOTIFY_DISPATCH_LEAST_RECENT) {
+        index = pick_least_recent(d);
+    } else {
+        index = d->next;
+        d->next = (d->next + 1) % d->count;
+    }
+    notify_dispatch_give(d, index);
+    return (int)index;
+}
+
+BaseType_t notify_dispatch_wait(notify_dispatch_t *d, size_t index, TickType_t ticks_to_wait)
+{
+    configASSERT(index < d->max_waiters);
+    waiter_t *w = &d->waiters[index];
+
+    atomic_store_explicit(&w->waiting, true, memory_order_relaxed);
+    BaseType_t got = notify_dispatch_take(ticks_to_wait);
+    atomic_store_explicit(&w->waiting, false, memory_order_relaxed);
+
+    if (got == pdTRUE) {
+        atomic_fetch_add_explicit(&w->wakes, 1, memory_order_relaxed);
+    }
+    return got;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+size_t notify_dispatch_waiters(const notify_dispatch_t *d)
+{
+    return d->count;
+}
+
+void notify_dispatch_get_counters(const notify_dispatch_t *d, size_t index, notify_dispatch_counters_t *out)
+{
+    configASSERT(index < d->count);
+    const waiter_t *w = &d->waiters[index];
+    out->gives = atomic_load_explicit(&w->gives, memory_order_relaxed);
+    out->wakes = atomic_load_explicit(&w->wakes, memory_order_relaxed);
+    out->coalesced = atomic_load_explicit(&w->coalesced, memory_order_relaxed);
+}
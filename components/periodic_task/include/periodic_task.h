@@ -0,0 +1,102 @@
+//Periodic tasks on xTaskDelayUntil(): fixed release times, with release jitter, execution time and deadline accounting
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why not while (1) { work(); vTaskDelay(period); } ?
+vTaskDelay() counts from the tick in which it is called: whenever the work - or the wait for the CPU
+before it - runs past a tick boundary, that period is a tick longer, and the error adds up. A 1000 ms loop
+that shares the CPU with higher-priority work falls behind by seconds per hour (host/bench/periodic_drift_sim).
+xTaskDelayUntil() counts from the previous release instead: release k is at first release + k x period
+whatever the job took, so late starts do not move the later releases.
+
+Flow:
+1) Write the job: one activation, returns when done - void job(periodic_task_t *pt, void *arg)
+2) pt = periodic_task_create(&(periodic_task_config_t){ .name = "task1", .job = job, .period_ms = 1000,
+                                                        .priority = 1, .stack_depth = 2048 });
+3) Any task, any time: periodic_task_get(pt, &stats) / periodic_task_print(pt)
+
+Per job the task records:
+>> release jitter : start of the job - its nominal release (waiting for the tick, for the CPU)
+>> execution time : end of the job - start of the job (includes preemption by other tasks)
+>> deadline miss  : the job ended later than release + deadline
+>> overrun        : the job ended after the next release; xTaskDelayUntil() then releases the next job
+                    at once, so missed releases are caught up instead of dropped
+
+Rules:
+>> The period is rounded down to whole ticks (10 ms at CONFIG_FREERTOS_HZ=100); 0 ticks is rejected.
+>> Before the first release the task waits for a tick, so the releases are aligned to the tick and the
+   microsecond clock (esp_timer) measures from there.
+>> Tasks whose periods share a multiple are released on the same tick and queue behind each other (more
+   release jitter than drifting vTaskDelay() loops, which spread out by accident). Give them different
+   priorities or create them a tick apart if that matters.
+>> The counters are written by the periodic task only and read with relaxed atomics: each field is
+   exact, a snapshot taken during a job may mix this job and the previous one.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct periodic_task periodic_task_t;
+
+typedef void (*periodic_job_t)(periodic_task_t *pt, void *arg);
+
+typedef struct {
+    const char *name;
+    periodic_job_t job;                     //one activation per period
+    void *arg;
+    uint32_t period_ms;
+    uint32_t deadline_ms;                   //relative to the release, 0 = period
+    UBaseType_t priority;
+    uint32_t stack_depth;                   //as xTaskCreate() (bytes on ESP-IDF)
+} periodic_task_config_t;
+
+typedef struct {
+    uint32_t period_us;                     //after rounding to ticks
+    uint32_t deadline_us;
+    uint32_t releases;                      //jobs started (the running job included)
+    uint32_t deadline_misses;
+    uint32_t overruns;                      //jobs that ended after the next release
+    uint32_t jitter_max_us;                 //release jitter
+    uint32_t jitter_avg_us;                 //moving average over ~16 jobs
+    uint32_t exec_min_us;                   //0 before the first job
+    uint32_t exec_max_us;
+    uint32_t exec_avg_us;                   //moving average over ~16 jobs
+} periodic_task_stats_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : periodic_task_create
+>> Description: Create the task; it waits for the next tick, then runs config->job once per period.
+>> Returns: handle, or NULL if job is NULL, the period is shorter than one tick or the task could not be
+            created.
+*/
+periodic_task_t *periodic_task_create(const periodic_task_config_t *config);
+
+//Delete the task and free the handle. Do not call it from the task's own job.
+void periodic_task_delete(periodic_task_t *pt);
+
+//Underlying FreeRTOS task, for APIs that need the raw handle.
+TaskHandle_t periodic_task_handle(const periodic_task_t *pt);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Copy the counters (any task, while the periodic task runs).
+void periodic_task_get(const periodic_task_t *pt, periodic_task_stats_t *out);
+
+//One line: name, period, releases, jitter, execution time, misses, overruns.
+void periodic_task_print(const periodic_task_t *pt);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,180 @@
+//Periodic tasks on xTaskDelayUntil() with jitter / execution time / deadline accounting (see periodic_task.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "periodic_task.h"
+#include "relaxed_atomic.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> Release k is at first_us + k x period_us, first_us taken right after the aligning tick. The kernel
+   releases on ticks (xTaskDelayUntil), the accounting measures in us against the same grid.
+>> Moving averages are kept x16 in one word: avg16 += x - avg16 / 16, reported as avg16 / 16.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define AVG_SHIFT           4
+
+struct periodic_task {
+    periodic_task_config_t config;
+    TaskHandle_t task;
+    TickType_t period_ticks;
+    uint32_t period_us;
+    uint32_t deadline_us;
+    atomic_uint releases;
+    atomic_uint deadline_misses;
+    atomic_uint overruns;
+    atomic_uint jitter_max_us;
+    atomic_uint jitter_avg16;
+    atomic_uint exec_min_us;
+    atomic_uint exec_max_us;
+    atomic_uint exec_avg16;
+};
+
+
+static inline uint64_t now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+static inline unsigned clamp_us(uint64_t us)
+{
+    return us > UINT32_MAX ? UINT32_MAX : (unsigned)us;
+}
+
+static void update_avg16(atomic_uint *avg16, unsigned value, uint32_t samples)
+{
+    unsigned avg = relaxed_load(avg16);
+    relaxed_store(avg16, (samples == 1) ? value << AVG_SHIFT : avg + value - (avg >> AVG_SHIFT));
+}
+
+//One finished job: release = nominal release time, start / end = measured
+static void account(periodic_task_t *pt, uint32_t job, uint64_t release, uint64_t start, uint64_t end)
+{
+    unsigned jitter = (start > release) ? clamp_us(start - release) : 0;
+    unsigned exec = clamp_us(end - start);
+
+    if (jitter > relaxed_load(&pt->jitter_max_us)) {
+        relaxed_store(&pt->jitter_max_us, jitter);
+    }
+    update_avg16(&pt->jitter_avg16, jitter, job);
+    if (job == 1 || exec < relaxed_load(&pt->exec_min_us)) {
+        relaxed_store(&pt->exec_min_us, exec);
+    }
+    if (exec > relaxed_load(&pt->exec_max_us)) {
+        relaxed_store(&pt->exec_max_us, exec);
+    }
+    update_avg16(&pt->exec_avg16, exec, job);
+    if (end > release + pt->deadline_us) {
+        relaxed_store(&pt->deadline_misses, relaxed_load(&pt->deadline_misses) + 1);
+    }
+}
+
+static void periodic_runner(void *pv)
+{
+    periodic_task_t *pt = pv;
+
+    vTaskDelay(1);                          //align the releases to the tick
+    TickType_t last_wake = xTaskGetTickCount();
+    uint64_t first_us = now_us();
+
+    for (uint32_t k = 0;; k++) {
+        uint64_t release = first_us + (uint64_t)k * pt->period_us;
+        uint64_t start = now_us();
+        relaxed_store(&pt->releases, k + 1);
+        pt->config.job(pt, pt->config.arg);
+        account(pt, k + 1, release, start, now_us());
+
+        //pdFALSE: the next release has passed already, it runs at once
+        if (xTaskDelayUntil(&last_wake, pt->period_ticks) == pdFALSE) {
+            relaxed_store(&pt->overruns, relaxed_load(&pt->overruns) + 1);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+periodic_task_t *periodic_task_create(const periodic_task_config_t *config)
+{
+    if (config == NULL || config->job == NULL || pdMS_TO_TICKS(config->period_ms) == 0) {
+        return NULL;
+    }
+    periodic_task_t *pt = pvPortMalloc(sizeof(*pt));
+    if (pt == NULL) {
+        return NULL;
+    }
+    pt->config = *config;
+    pt->period_ticks = pdMS_TO_TICKS(config->period_ms);
+    pt->period_us = (uint32_t)pt->period_ticks * portTICK_PERIOD_MS * 1000u;
+    pt->deadline_us = config->deadline_ms ? config->deadline_ms * 1000u : pt->period_us;
+    atomic_init(&pt->releases, 0);
+    atomic_init(&pt->deadline_misses, 0);
+    atomic_init(&pt->overruns, 0);
+    atomic_init(&pt->jitter_max_us, 0);
+    atomic_init(&pt->jitter_avg16, 0);
+    atomic_init(&pt->exec_min_us, 0);
+    atomic_init(&pt->exec_max_us, 0);
+    atomic_init(&pt->exec_avg16, 0);
+
+    if (xTaskCreate(periodic_runner, config->name, config->stack_depth, pt, config->priority, &pt->task) != pdPASS) {
+        vPortFree(pt);
+        return NULL;
+    }
+    return pt;
+}
+
+void periodic_task_delete(periodic_task_t *pt)
+{
+    vTaskDelete(pt->task);
+    vPortFree(pt);
+}
+
+TaskHandle_t periodic_task_handle(const periodic_task_t *pt)
+{
+    return pt->task;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void periodic_task_get(const periodic_task_t *pt, periodic_task_stats_t *out)
+{
+    out->period_us = pt->period_us;
+    out->deadline_us = pt->deadline_us;
+    out->releases = relaxed_load(&pt->releases);
+    out->deadline_misses = relaxed_load(&pt->deadline_misses);
+    out->overruns = relaxed_load(&pt->overruns);
+    out->jitter_max_us = relaxed_load(&pt->jitter_max_us);
+    out->jitter_avg_us = relaxed_load(&pt->jitter_avg16) >> AVG_SHIFT;
+    out->exec_min_us = relaxed_load(&pt->exec_min_us);
+    out->exec_max_us = relaxed_load(&pt->exec_max_us);
+    out->exec_avg_us = relaxed_load(&pt->exec_avg16) >> AVG_SHIFT;
+}
+
+void periodic_task_print(const periodic_task_t *pt)
+{
+    periodic_task_stats_t st;
+    periodic_task_get(pt, &st);
+    printf("%-16s %6u ms %8u releases  jitter avg %6u max %6u us  exec avg %6u max %6u us  "
+           "misses %u  overruns %u\n", pt->config.name ? pt->config.name : "periodic",
+           (unsigned)(st.period_us / 1000u), (unsigned)st.releases, (unsigned)st.jitter_avg_us,
+           (unsigned)st.jitter_max_us, (unsigned)st.exec_avg_us, (unsigned)st.exec_max_us,
+           (unsigned)st.deadline_misses, (unsigned)st.overruns);
+}
+//-------------------------------------------------------------------------------------------------
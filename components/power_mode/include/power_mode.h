@@ -0,0 +1,131 @@
+//Power-managed mode: dynamic frequency scaling + tickless idle with a PM lock held only around real work,
+//time spent per frequency / idle state, and an energy model against the always-on configuration
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+task1 / task2 print one line every 500 / 1000 ms and sleep the rest of the time, yet the CPU runs at
+CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ all the time and wakes for every 10 ms tick. With power management the chip
+clocks down when nobody needs speed and, when every task is blocked, skips the ticks and goes to light sleep
+until the next timeout (tickless idle). Speed is requested with a PM lock (ESP_PM_CPU_FREQ_MAX) - held only
+between power_mode_work_begin() and power_mode_work_end(), i.e. around the log line.
+
+Flow:
+1) power_mode_start(&(power_mode_config_t){ .max_freq_mhz = 160, .min_freq_mhz = 80, .light_sleep = true,
+                                             .report_ms = 10000 })
+2) task loop: power_mode_work_begin(); ESP_LOGI(...); power_mode_work_end(); vTaskDelay(...)
+3) every report_ms (or power_mode_sample() by hand): the last window split into
+   >> max    : lock held, CPU at max_freq_mhz
+   >> min    : running without the lock, CPU at min_freq_mhz
+   >> idle   : every core in its idle task - light sleep (light_sleep) or WAITI at min_freq_mhz
+   >> wakes  : work periods started while nobody held the lock
+4) power_mode_estimate(): average current, duty cycle and wakes per hour of that window, for this mode and
+   for the always-on configuration (same work at max_freq_mhz, idle = WAITI at max_freq_mhz, no sleep)
+
+Rules:
+>> ESP32: needs CONFIG_PM_ENABLE, for light sleep also CONFIG_FREERTOS_USE_TICKLESS_IDLE (sdkconfig), and
+   CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS for the idle time. Host: no frequencies, the lock is only counted;
+   the windows and the model work the same (host/bench/power_model_sim).
+>> Idle time comes from the idle tasks' run-time counters; the chip is counted idle as long as the least idle
+   core is (light sleep needs all cores idle). Windows must stay below 71 minutes (32-bit microseconds).
+>> begin / end nest and may be called from any task on any core, not from interrupts.
+>> The model's currents are datasheet values (POWER_MODE_MODEL_ESP32: 160 / 80 MHz, radio off) - an
+   estimate for comparing configurations, not a measurement; use a power meter for absolute numbers.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define POWER_MODE_IDLE_AVAILABLE   (configGENERATE_RUN_TIME_STATS == 1)
+
+#ifndef POWER_MODE_TASK_PRIORITY
+#define POWER_MODE_TASK_PRIORITY    1
+#endif
+
+#ifndef POWER_MODE_TASK_STACK
+#define POWER_MODE_TASK_STACK       3072
+#endif
+
+typedef struct {
+    uint32_t max_freq_mhz;          //while any task is between work_begin / work_end
+    uint32_t min_freq_mhz;          //otherwise (ESP32: 40 = XTAL, 80, 160, 240)
+    bool light_sleep;               //tickless idle into light sleep when every task is blocked
+    uint32_t report_ms;             //0 = no reporter task, else power_mode_print() of a window every report_ms
+} power_mode_config_t;
+
+typedef struct {
+    uint32_t elapsed_us;
+    uint32_t max_us;                //PM lock held
+    uint32_t min_us;                //running, lock not held
+    uint32_t idle_us;               //all cores idle
+    uint32_t wakes;                 //work periods started from no holder
+    uint32_t max_freq_mhz;
+    uint32_t min_freq_mhz;
+    bool light_sleep;
+} power_mode_window_t;
+
+//Supply current per state in microamps
+typedef struct {
+    uint32_t run_max_ua;            //running at max_freq_mhz
+    uint32_t run_min_ua;            //running at min_freq_mhz
+    uint32_t wait_max_ua;           //idle (WAITI) at max_freq_mhz: the always-on configuration
+    uint32_t wait_min_ua;           //idle at min_freq_mhz, light sleep off
+    uint32_t sleep_ua;              //light sleep
+    uint32_t wake_us;               //light-sleep exit + entry per wake, spent at run_min_ua
+} power_mode_model_t;
+
+//ESP32 datasheet, modem-sleep (radio off) at 160 / 80 MHz and light sleep
+#define POWER_MODE_MODEL_ESP32      ((power_mode_model_t){ .run_max_ua = 44000, .run_min_ua = 31000, \
+                                                           .wait_max_ua = 27000, .wait_min_ua = 20000, \
+                                                           .sleep_ua = 800, .wake_us = 500 })
+
+typedef struct {
+    uint32_t avg_ua;
+    uint32_t duty_permille;         //share of the window not idle
+    uint32_t wakes_per_hour;        //CPU wake-ups: work periods in light sleep, otherwise every tick
+    uint32_t mah_per_day;
+} power_mode_estimate_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : power_mode_start
+>> Description: Configures DFS / light sleep (esp_pm_configure), creates the PM lock, starts the windows and,
+                with report_ms, a reporter task.
+>> Returns: pdPASS, or pdFAIL if config is invalid, power_mode is already running, power management or
+            run-time stats are not enabled, or esp_pm_configure() refused the frequencies.
+*/
+BaseType_t power_mode_start(const power_mode_config_t *config);
+
+//Real work starts: CPU at max_freq_mhz until the matching power_mode_work_end(). Nests.
+void power_mode_work_begin(void);
+void power_mode_work_end(void);
+
+/*
+Function : power_mode_sample
+>> Description: The window since the previous sample (or power_mode_start()). With report_ms the reporter
+                samples as well, so each caller sees only part of the time.
+>> Returns: pdPASS, or pdFAIL if power_mode is not running.
+*/
+BaseType_t power_mode_sample(power_mode_window_t *out);
+
+//This mode and the always-on configuration for the same window, extrapolated to an hour / a day.
+void power_mode_estimate(const power_mode_window_t *w, const power_mode_model_t *model,
+                         power_mode_estimate_t *managed, power_mode_estimate_t *always_on);
+
+//One line per window: time per state, wakes, estimate with POWER_MODE_MODEL_ESP32 vs always-on.
+void power_mode_print(const power_mode_window_t *w);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,271 @@
+//Power-managed mode: DFS + tickless idle, PM lock around real work, time per state and energy model (see power_mode.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "power_mode.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_err.h"
+#include "esp_pm.h"
+#endif
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> All times are on the run-time stats clock (portGET_RUN_TIME_COUNTER_VALUE: esp_timer us on the ESP32,
+   CLOCK_MONOTONIC us on the host), the clock the idle tasks' counters run on.
+>> Lock-held time without a lock of our own: the 0 -> 1 holder subtracts its start time from held_acc, the
+   1 -> 0 holder adds its end time. In 32-bit modular arithmetic held_acc is the total held time once
+   nobody holds; while somebody does, adding "now" completes the open period. A sample racing with a
+   begin / end is off by that one period's edge, not more.
+---------------------------------------------------------------------------------------------------
+*/
+
+static atomic_uint holders;
+static atomic_uint held_acc;
+static atomic_uint wakes;
+
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t work_lock;
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+static inline uint32_t now_us(void)
+{
+#if POWER_MODE_IDLE_AVAILABLE
+    return (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+#else
+    return 0;
+#endif
+}
+
+static uint32_t per_hour(uint64_t count, uint32_t elapsed_us)
+{
+    return (elapsed_us == 0) ? 0 : (uint32_t)(count * 3600000000ull / elapsed_us);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void power_mode_work_begin(void)
+{
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    if (work_lock != NULL) {
+        esp_pm_lock_acquire(work_lock);     //back at max_freq_mhz before the period is timed
+    }
+#endif
+    if (atomic_fetch_add_explicit(&holders, 1, memory_order_relaxed) == 0) {
+        atomic_fetch_sub_explicit(&held_acc, now_us(), memory_order_relaxed);
+        atomic_fetch_add_explicit(&wakes, 1, memory_order_relaxed);
+    }
+}
+
+void power_mode_work_end(void)
+{
+    if (atomic_fetch_sub_explicit(&holders, 1, memory_order_relaxed) == 1) {
+        atomic_fetch_add_explicit(&held_acc, now_us(), memory_order_relaxed);
+    }
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    if (work_lock != NULL) {
+        esp_pm_lock_release(work_lock);
+    }
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void power_mode_estimate(const power_mode_window_t *w, const power_mode_model_t *model,
+                         power_mode_estimate_t *managed, power_mode_estimate_t *always_on)
+{
+    memset(managed, 0, sizeof(*managed));
+    memset(always_on, 0, sizeof(*always_on));
+    if (w->elapsed_us == 0) {
+        return;
+    }
+
+    //This mode: every wake pays wake_us at the low clock, taken out of the sleep time
+    uint64_t wake_us = w->light_sleep ? (uint64_t)w->wakes * model->wake_us : 0;
+    uint64_t idle_us = (w->idle_us > wake_us) ? w->idle_us - wake_us : 0;
+    uint64_t charge = (uint64_t)w->max_us * model->run_max_ua + (uint64_t)w->min_us * model->run_min_ua +
+                      (uint64_t)(w->idle_us - idle_us) * model->run_min_ua +
+                      idle_us * (w->light_sleep ? model->sleep_ua : model->wait_min_ua);
+    managed->avg_ua = (uint32_t)(charge / w->elapsed_us);
+    managed->duty_permille = (uint32_t)((uint64_t)(w->elapsed_us - w->idle_us) * 1000u / w->elapsed_us);
+    managed->wakes_per_hour = w->light_sleep ? per_hour(w->wakes, w->elapsed_us) : configTICK_RATE_HZ * 3600u;
+    managed->mah_per_day = managed->avg_ua * 24u / 1000u;
+
+    //Always on: the same cycles at max_freq_mhz, WAITI at max_freq_mhz in between, woken by every tick
+    uint64_t busy_us = w->max_us;
+    if (w->max_freq_mhz != 0) {
+        busy_us += (uint64_t)w->min_us * w->min_freq_mhz / w->max_freq_mhz;
+    }
+    busy_us = (busy_us > w->elapsed_us) ? w->elapsed_us : busy_us;
+    charge = busy_us * model->run_max_ua + (w->elapsed_us - busy_us) * model->wait_max_ua;
+    always_on->avg_ua = (uint32_t)(charge / w->elapsed_us);
+    always_on->duty_permille = (uint32_t)(busy_us * 1000u / w->elapsed_us);
+    always_on->wakes_per_hour = configTICK_RATE_HZ * 3600u;
+    always_on->mah_per_day = always_on->avg_ua * 24u / 1000u;
+}
+
+void power_mode_print(const power_mode_window_t *w)
+{
+    power_mode_estimate_t managed, always_on;
+    power_mode_estimate(w, &POWER_MODE_MODEL_ESP32, &managed, &always_on);
+    printf("power mode: %u ms window, %u MHz %u.%03u ms, %u MHz %u.%03u ms, %s %u ms, %u wakes\n",
+           (unsigned)(w->elapsed_us / 1000u), (unsigned)w->max_freq_mhz, (unsigned)(w->max_us / 1000u),
+           (unsigned)(w->max_us % 1000u), (unsigned)w->min_freq_mhz, (unsigned)(w->min_us / 1000u),
+           (unsigned)(w->min_us % 1000u), w->light_sleep ? "light sleep" : "idle", (unsigned)(w->idle_us / 1000u),
+           (unsigned)w->wakes);
+    printf("power mode: ~%u uA (%u mAh/day), duty %u.%u %%, %u wakes/h  vs always-on ~%u uA (%u mAh/day), "
+           "%u wakes/h\n", (unsigned)managed.avg_ua, (unsigned)managed.mah_per_day,
+           (unsigned)(managed.duty_permille / 10u), (unsigned)(managed.duty_permille % 10u),
+           (unsigned)managed.wakes_per_hour, (unsigned)always_on.avg_ua, (unsigned)always_on.mah_per_day,
+           (unsigned)always_on.wakes_per_hour);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+#if POWER_MODE_IDLE_AVAILABLE
+//-------------------------------------------------------------------------------------------------
+static power_mode_config_t mode_config;
+static BaseType_t running;
+static SemaphoreHandle_t sample_lock;
+static uint32_t prev_time, prev_held, prev_wakes;
+static uint32_t prev_idle[configNUMBER_OF_CORES];
+static TaskHandle_t reporter;
+
+static TaskHandle_t idle_handle(BaseType_t core)
+{
+#if configNUMBER_OF_CORES > 1
+    return xTaskGetIdleTaskHandleForCore(core);
+#else
+    (void)core;
+    return xTaskGetIdleTaskHandle();
+#endif
+}
+
+static uint32_t held_now(void)
+{
+    uint32_t acc = atomic_load_explicit(&held_acc, memory_order_relaxed);
+    return (atomic_load_explicit(&holders, memory_order_relaxed) != 0) ? acc + now_us() : acc;
+}
+
+//Starts the next window at "now"; only the idle totals are needed from the previous one
+static void window_mark(uint32_t time, uint32_t held, uint32_t wake_count)
+{
+    prev_time = time;
+    prev_held = held;
+    prev_wakes = wake_count;
+    for (BaseType_t c = 0; c < configNUMBER_OF_CORES; c++) {
+        prev_idle[c] = (uint32_t)ulTaskGetRunTimeCounter(idle_handle(c));
+    }
+}
+
+BaseType_t power_mode_sample(power_mode_window_t *out)
+{
+    if (running != pdTRUE) {
+        return pdFAIL;
+    }
+    xSemaphoreTake(sample_lock, portMAX_DELAY);
+    uint32_t time = now_us(), held = held_now();
+    uint32_t wake_count = atomic_load_explicit(&wakes, memory_order_relaxed);
+    uint32_t idle = UINT32_MAX;
+    for (BaseType_t c = 0; c < configNUMBER_OF_CORES; c++) {
+        uint32_t core_idle = (uint32_t)ulTaskGetRunTimeCounter(idle_handle(c)) - prev_idle[c];
+        idle = (core_idle < idle) ? core_idle : idle;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->elapsed_us = time - prev_time;
+    out->max_us = held - prev_held;
+    out->max_us = (out->max_us > out->elapsed_us) ? out->elapsed_us : out->max_us;
+    out->idle_us = (idle > out->elapsed_us - out->max_us) ? out->elapsed_us - out->max_us : idle;
+    out->min_us = out->elapsed_us - out->max_us - out->idle_us;
+    out->wakes = wake_count - prev_wakes;
+    out->max_freq_mhz = mode_config.max_freq_mhz;
+    out->min_freq_mhz = mode_config.min_freq_mhz;
+    out->light_sleep = mode_config.light_sleep;
+
+    window_mark(time, held, wake_count);
+    xSemaphoreGive(sample_lock);
+    return pdPASS;
+}
+
+static void reporter_task(void *pv)
+{
+    (void)pv;
+    power_mode_window_t w;
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(mode_config.report_ms));
+        if (power_mode_sample(&w) == pdPASS) {
+            power_mode_print(&w);
+        }
+    }
+}
+
+BaseType_t power_mode_start(const power_mode_config_t *config)
+{
+    if (config == NULL || config->min_freq_mhz == 0 || config->max_freq_mhz < config->min_freq_mhz ||
+        (config->report_ms != 0 && pdMS_TO_TICKS(config->report_ms) == 0) || running == pdTRUE) {
+        return pdFAIL;
+    }
+    sample_lock = (sample_lock != NULL) ? sample_lock : xSemaphoreCreateMutex();
+    if (sample_lock == NULL) {
+        return pdFAIL;
+    }
+
+#ifdef ESP_PLATFORM
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm = {
+        .max_freq_mhz = (int)config->max_freq_mhz,
+        .min_freq_mhz = (int)config->min_freq_mhz,
+        .light_sleep_enable = config->light_sleep,  //ESP_ERR_NOT_SUPPORTED without CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    };
+    if (esp_pm_configure(&pm) != ESP_OK) {
+        return pdFAIL;
+    }
+    if (work_lock == NULL && esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "power_mode", &work_lock) != ESP_OK) {
+        return pdFAIL;
+    }
+#else
+    return pdFAIL;                          //CONFIG_PM_ENABLE is not set: nothing would scale or sleep
+#endif
+#endif
+
+    mode_config = *config;
+    window_mark(now_us(), held_now(), atomic_load_explicit(&wakes, memory_order_relaxed));
+    running = pdTRUE;
+    if (config->report_ms != 0 && reporter == NULL &&
+        xTaskCreate(reporter_task, "power_rpt", POWER_MODE_TASK_STACK, NULL, POWER_MODE_TASK_PRIORITY,
+                    &reporter) != pdPASS) {
+        reporter = NULL;
+        running = pdFALSE;                  //not started: a later power_mode_start() may try again
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
+
+#else   //run-time stats compiled out: no idle time, no windows
+
+BaseType_t power_mode_start(const power_mode_config_t *config)
+{
+    (void)config;
+    return pdFAIL;
+}
+
+BaseType_t power_mode_sample(power_mode_window_t *out)
+{
+    (void)out;
+    return pdFAIL;
+}
+
+#endif
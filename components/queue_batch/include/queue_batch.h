@@ -0,0 +1,53 @@
+//Batched send / receive on top of a normal FreeRTOS queue
+
+#pragma once
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why batch?
+With one xQueueSend per item the consumer is made ready (and usually switched to) once per item.
+At high rates most of the CPU goes into context switches instead of real work.
+
+>> queue_batch_send    : copies as many items as fit while the scheduler is suspended, so the
+                         consumer is woken ONCE for the whole group instead of once per item.
+>> queue_batch_receive : blocks for the first item only, then drains everything else that is already
+                         pending (up to max_items) without blocking again -> one wake-up per batch.
+
+Both work on any queue created with xQueueCreate / xQueueCreateStatic, so batched and single-item
+callers can share the same handle. Not for use from ISRs.
+---------------------------------------------------------------------------------------------------
+*/
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : queue_batch_send
+>> Description: Send up to "count" items (stored back to back in "items") to the back of the queue.
+>> item_size: must be the uxItemSize the queue was created with.
+>> ticks_to_wait: total time the call may block waiting for space (shared by the whole batch).
+>> Returns: number of items actually sent (count on success, less if the timeout expired).
+*/
+size_t queue_batch_send(QueueHandle_t queue, const void *items, size_t count, size_t item_size,
+                        TickType_t ticks_to_wait);
+
+/*
+Function : queue_batch_receive
+>> Description: Wait up to ticks_to_wait for the first item, then take every item already pending.
+>> items: caller buffer with room for max_items items of item_size bytes.
+>> Returns: number of items copied into "items" (0 only when the timeout expired).
+*/
+size_t queue_batch_receive(QueueHandle_t queue, void *items, size_t max_items, size_t item_size,
+                           TickType_t ticks_to_wait);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
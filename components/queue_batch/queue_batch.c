@@ -0,0 +1,64 @@
+//Batched send / receive on top of a normal FreeRTOS queue (see queue_batch.h)
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "queue_batch.h"
+
+
+//-------------------------------------------------------------------------------------------------
+size_t queue_batch_send(QueueHandle_t queue, const void *items, size_t count, size_t item_size,
+                        TickType_t ticks_to_wait)
+{
+    const uint8_t *src = items;
+    size_t sent = 0;
+    TimeOut_t timeout;
+
+    vTaskSetTimeOutState(&timeout);
+    while (sent < count) {
+        //Fill all free slots with the scheduler suspended: the consumer becomes ready only once,
+        //when xTaskResumeAll() runs. Zero timeout is required while the scheduler is suspended.
+        vTaskSuspendAll();
+        while (sent < count && xQueueSend(queue, src + sent * item_size, 0) == pdPASS) {
+            sent++;
+        }
+        (void)xTaskResumeAll();
+
+        if (sent == count || xTaskCheckForTimeOut(&timeout, &ticks_to_wait) == pdTRUE) {
+            break;
+        }
+
+        //Queue is full: block for one slot with whatever time is left, then try to fill again
+        if (xQueueSend(queue, src + sent * item_size, ticks_to_wait) != pdPASS) {
+            break;
+        }
+        sent++;
+    }
+    return sent;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+size_t queue_batch_receive(QueueHandle_t queue, void *items, size_t max_items, size_t item_size,
+                           TickType_t ticks_to_wait)
+{
+    uint8_t *dst = items;
+    size_t received = 0;
+
+    if (max_items == 0 || xQueueReceive(queue, dst, ticks_to_wait) != pdPASS) {
+        return 0;
+    }
+    received = 1;
+
+    //Drain what is already pending; a producer blocked on "full" is released once, after the drain
+    vTaskSuspendAll();
+    while (received < max_items && xQueueReceive(queue, dst + received * item_size, 0) == pdPASS) {
+        received++;
+    }
+    (void)xTaskResumeAll();
+
+    return received;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+//Per-queue occupancy, drop and blocking-time telemetry with a registry keyed by queue name
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+How it works:
+>> queue_stats_create() creates the queue AND a stats slot in a fixed registry, keyed by name.
+   With configQUEUE_REGISTRY_SIZE > 0 the queue is also added to the FreeRTOS queue registry,
+   so debuggers (OpenOCD / GDB) show it by name too.
+>> queue_stats_send() / queue_stats_receive() are drop-in replacements for xQueueSend / xQueueReceive.
+   They first try without blocking; only when that fails is the blocking call timed. The common
+   non-blocking case therefore costs a few relaxed atomic increments and no clock reads.
+>> Readers (a monitor task, a shell command ...) get a consistent copy with queue_stats_get()
+   or print every registered queue with queue_stats_print_all().
+>> queue_stats_print_all() formats through one static snapshot: call it from ONE task only (two tasks
+   printing at once would overwrite each other's lines). Other readers use queue_stats_get() with
+   their own queue_stats_snapshot_t.
+
+Blocking-time histogram buckets:
+   bucket 0 = did not block, bucket i = blocked for [2^(i-1), 2^i) us, last bucket = everything longer.
+   A wait shorter than 1 us still blocked: it is counted in bucket 1, which therefore covers [0, 2) us.
+
+All counters are 32-bit and wrap; use queue_stats_reset() between measurement windows if needed.
+Set QUEUE_STATS_ENABLE to 0 to compile the wrappers down to plain xQueueSend / xQueueReceive.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef QUEUE_STATS_ENABLE
+#define QUEUE_STATS_ENABLE          1
+#endif
+
+#if configQUEUE_REGISTRY_SIZE > 0
+#define QUEUE_STATS_MAX_QUEUES      configQUEUE_REGISTRY_SIZE
+#else
+#define QUEUE_STATS_MAX_QUEUES      8
+#endif
+
+#define QUEUE_STATS_HIST_BUCKETS    24      //last bucket starts at 2^22 us (~4.2 s)
+
+typedef struct queue_stats queue_stats_t;
+
+typedef struct {
+    const char *name;
+    UBaseType_t capacity;
+    UBaseType_t depth;                      //items waiting right now
+    UBaseType_t high_water;                 //largest depth seen after a send
+    uint32_t sends;                         //successful sends
+    uint32_t send_failures;                 //sends that timed out (errQUEUE_FULL) = dropped items
+    uint32_t receives;                      //successful receives
+    uint32_t receive_failures;              //receives that timed out (errQUEUE_EMPTY)
+    uint32_t send_wait_ticks;               //total ticks spent blocked in send
+    uint32_t receive_wait_ticks;            //total ticks spent blocked in receive
+    uint32_t send_block_hist[QUEUE_STATS_HIST_BUCKETS];
+    uint32_t receive_block_hist[QUEUE_STATS_HIST_BUCKETS];
+} queue_stats_snapshot_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : queue_stats_create
+>> Description: xQueueCreate(length, item_size) plus a registry slot called "name".
+>> name: must stay valid for the life of the queue (a string literal is fine).
+>> Returns: stats handle, or NULL when the queue cannot be created or the registry is full.
+*/
+queue_stats_t *queue_stats_create(const char *name, UBaseType_t length, UBaseType_t item_size);
+
+//Register an existing queue (e.g. created with xQueueCreateStatic). Same return value as above.
+queue_stats_t *queue_stats_attach(QueueHandle_t queue, const char *name, UBaseType_t capacity);
+
+//Underlying FreeRTOS queue, for APIs that need the raw handle.
+QueueHandle_t queue_stats_handle(const queue_stats_t *stats);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//xQueueSend / xQueueReceive with telemetry: same parameters and return values.
+BaseType_t queue_stats_send(queue_stats_t *stats, const void *item, TickType_t ticks_to_wait);
+BaseType_t queue_stats_receive(queue_stats_t *stats, void *item, TickType_t ticks_to_wait);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Registry access
+queue_stats_t *queue_stats_find(const char *name);                     //NULL if unknown
+void queue_stats_get(const queue_stats_t *stats, queue_stats_snapshot_t *out);
+void queue_stats_reset(queue_stats_t *stats);                           //counters and hwm; items still queued keep counting
+void queue_stats_print_all(void);                                       //one table line per queue, one caller task
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,270 @@
+//Per-queue occupancy, drop and blocking-time telemetry (see queue_stats.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "queue_stats.h"
+#include "relaxed_atomic.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+struct queue_stats {
+    _Atomic(const char *) name;             //published last (release): NULL = slot not ready yet
+    QueueHandle_t queue;
+    UBaseType_t capacity;
+    atomic_int in_flight;                   //+1 per counted send, -1 per counted receive; not reset
+    atomic_uint high_water;
+    atomic_uint sends;
+    atomic_uint send_failures;
+    atomic_uint receives;
+    atomic_uint receive_failures;
+    atomic_uint send_wait_ticks;
+    atomic_uint receive_wait_ticks;
+    atomic_uint send_block_hist[QUEUE_STATS_HIST_BUCKETS];
+    atomic_uint receive_block_hist[QUEUE_STATS_HIST_BUCKETS];
+};
+
+static struct queue_stats registry[QUEUE_STATS_MAX_QUEUES];
+static atomic_uint registry_used;           //slots are handed out once and never reused
+
+
+static uint64_t now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+//Bucket 1 + floor(log2(us)), so bucket i holds [2^(i-1), 2^i) us; bucket 0 is kept for "did not block".
+//A wait that took less than 1 us still blocked: us == 0 goes into bucket 1 as well, which is [0, 2) us.
+static unsigned hist_bucket(uint64_t us)
+{
+    unsigned bucket = 1;
+    while (us > 1 && bucket < QUEUE_STATS_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+//The depth right after a send ("depth") comes from in_flight instead of uxQueueMessagesWaiting(),
+//which would take the queue lock a second time on every send. in_flight is a signed count that
+//queue_stats_reset() leaves alone, so items still queued at a reset are received against their own send.
+//The counts of concurrent calls can arrive out of order: a send counted late makes it briefly negative
+//(taken as empty), a receive counted late makes it briefly too high (clamped to the capacity).
+static void update_high_water(struct queue_stats *qs, int depth)
+{
+    if (depth < 0) {
+        depth = 0;
+    } else if ((unsigned)depth > qs->capacity) {
+        depth = (int)qs->capacity;
+    }
+    unsigned seen = relaxed_load(&qs->high_water);
+    while ((unsigned)depth > seen &&
+           !atomic_compare_exchange_weak_explicit(&qs->high_water, &seen, (unsigned)depth,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+queue_stats_t *queue_stats_attach(QueueHandle_t queue, const char *name, UBaseType_t capacity)
+{
+    if (queue == NULL || name == NULL) {
+        return NULL;
+    }
+    unsigned slot = atomic_fetch_add(&registry_used, 1);
+    if (slot >= QUEUE_STATS_MAX_QUEUES) {
+        atomic_fetch_sub(&registry_used, 1);
+        return NULL;
+    }
+    struct queue_stats *qs = &registry[slot];
+    qs->queue = queue;
+    qs->capacity = capacity;
+    atomic_store(&qs->in_flight, (int)uxQueueMessagesWaiting(queue));     //attached to a queue in use
+    queue_stats_reset(qs);
+    atomic_store_explicit(&qs->name, name, memory_order_release);         //last: queue_stats_find() skips slots without a name
+
+#if configQUEUE_REGISTRY_SIZE > 0
+    vQueueAddToRegistry(queue, name);
+#endif
+    return qs;
+}
+
+queue_stats_t *queue_stats_create(const char *name, UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = xQueueCreate(length, item_size);
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue_stats_t *qs = queue_stats_attach(queue, name, length);
+    if (qs == NULL) {
+        vQueueDelete(queue);
+    }
+    return qs;
+}
+
+QueueHandle_t queue_stats_handle(const queue_stats_t *stats)
+{
+    return stats->queue;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t queue_stats_send(queue_stats_t *stats, const void *item, TickType_t ticks_to_wait)
+{
+#if QUEUE_STATS_ENABLE
+    BaseType_t result = xQueueSend(stats->queue, item, 0);
+
+    if (result != pdPASS && ticks_to_wait != 0) {
+        //Slow path only: the queue is full and the caller is willing to wait
+        TickType_t start_tick = xTaskGetTickCount();
+        uint64_t start_us = now_us();
+        result = xQueueSend(stats->queue, item, ticks_to_wait);
+        unsigned bucket = hist_bucket(now_us() - start_us);
+        relaxed_add(&stats->send_wait_ticks, (unsigned)(xTaskGetTickCount() - start_tick));
+        relaxed_add(&stats->send_block_hist[bucket], 1);
+    }
+
+    if (result == pdPASS) {
+        relaxed_add(&stats->sends, 1);
+        update_high_water(stats, atomic_fetch_add_explicit(&stats->in_flight, 1, memory_order_relaxed) + 1);
+    } else {
+        relaxed_add(&stats->send_failures, 1);
+    }
+    return result;
+#else
+    return xQueueSend(stats->queue, item, ticks_to_wait);
+#endif
+}
+
+BaseType_t queue_stats_receive(queue_stats_t *stats, void *item, TickType_t ticks_to_wait)
+{
+#if QUEUE_STATS_ENABLE
+    BaseType_t result = xQueueReceive(stats->queue, item, 0);
+
+    if (result != pdPASS && ticks_to_wait != 0) {
+        TickType_t start_tick = xTaskGetTickCount();
+        uint64_t start_us = now_us();
+        result = xQueueReceive(stats->queue, item, ticks_to_wait);
+        unsigned bucket = hist_bucket(now_us() - start_us);
+        relaxed_add(&stats->receive_wait_ticks, (unsigned)(xTaskGetTickCount() - start_tick));
+        relaxed_add(&stats->receive_block_hist[bucket], 1);
+    }
+
+    if (result == pdPASS) {
+        relaxed_add(&stats->receives, 1);
+        atomic_fetch_sub_explicit(&stats->in_flight, 1, memory_order_relaxed);
+    } else {
+        relaxed_add(&stats->receive_failures, 1);
+    }
+    return result;
+#else
+    return xQueueReceive(stats->queue, item, ticks_to_wait);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+queue_stats_t *queue_stats_find(const char *name)
+{
+    unsigned used = atomic_load(&registry_used);
+    for (unsigned i = 0; i < used && i < QUEUE_STATS_MAX_QUEUES; i++) {
+        const char *slot_name = atomic_load_explicit(&registry[i].name, memory_order_acquire);
+        if (slot_name != NULL && strcmp(slot_name, name) == 0) {
+            return &registry[i];
+        }
+    }
+    return NULL;
+}
+
+void queue_stats_get(const queue_stats_t *stats, queue_stats_snapshot_t *out)
+{
+    out->name = atomic_load_explicit(&stats->name, memory_order_acquire);
+    out->capacity = stats->capacity;
+    out->depth = uxQueueMessagesWaiting(stats->queue);
+    out->high_water = relaxed_load(&stats->high_water);
+    out->sends = relaxed_load(&stats->sends);
+    out->send_failures = relaxed_load(&stats->send_failures);
+    out->receives = relaxed_load(&stats->receives);
+    out->receive_failures = relaxed_load(&stats->receive_failures);
+    out->send_wait_ticks = relaxed_load(&stats->send_wait_ticks);
+    out->receive_wait_ticks = relaxed_load(&stats->receive_wait_ticks);
+    //Bucket 0 is not counted on the hot path: every call that did not land in a blocking bucket
+    out->send_block_hist[0] = out->sends + out->send_failures;
+    out->receive_block_hist[0] = out->receives + out->receive_failures;
+    for (unsigned i = 1; i < QUEUE_STATS_HIST_BUCKETS; i++) {
+        out->send_block_hist[i] = relaxed_load(&stats->send_block_hist[i]);
+        out->receive_block_hist[i] = relaxed_load(&stats->receive_block_hist[i]);
+        out->send_block_hist[0] -= out->send_block_hist[i];
+        out->receive_block_hist[0] -= out->receive_block_hist[i];
+    }
+}
+
+void queue_stats_reset(queue_stats_t *stats)
+{
+    atomic_store(&stats->high_water, 0);
+    atomic_store(&stats->sends, 0);
+    atomic_store(&stats->send_failures, 0);
+    atomic_store(&stats->receives, 0);
+    atomic_store(&stats->receive_failures, 0);
+    atomic_store(&stats->send_wait_ticks, 0);
+    atomic_store(&stats->receive_wait_ticks, 0);
+    for (unsigned i = 0; i < QUEUE_STATS_HIST_BUCKETS; i++) {
+        atomic_store(&stats->send_block_hist[i], 0);
+        atomic_store(&stats->receive_block_hist[i], 0);
+    }
+}
+
+//Upper bound (us) of the bucket that contains the given percentile, 0 when nothing blocked
+static uint32_t hist_percentile_us(const uint32_t *hist, double pct)
+{
+    uint32_t total = 0;
+    for (unsigned i = 0; i < QUEUE_STATS_HIST_BUCKETS; i++) {
+        total += hist[i];
+    }
+    uint32_t rank = (uint32_t)((double)total * pct / 100.0);
+    uint32_t seen = 0;
+    for (unsigned i = 0; i < QUEUE_STATS_HIST_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen > rank) {
+            return (i == 0) ? 0 : (1u << i);
+        }
+    }
+    return 0;
+}
+
+void queue_stats_print_all(void)
+{
+    static queue_stats_snapshot_t snap;     //~200 bytes, keep it off the caller's stack (single caller, see .h)
+
+    printf("%-12s %5s %5s %9s %7s %9s %7s %9s %9s %11s\n", "queue", "depth", "hwm", "sent", "dropped",
+           "received", "rx t/o", "tx wait", "rx wait", "rx p99 us");
+    unsigned used = atomic_load(&registry_used);
+    for (unsigned i = 0; i < used && i < QUEUE_STATS_MAX_QUEUES; i++) {
+        if (atomic_load_explicit(&registry[i].name, memory_order_acquire) == NULL) {
+            continue;
+        }
+        queue_stats_get(&registry[i], &snap);
+        printf("%-12s %2u/%-2u %5u %9u %7u %9u %7u %7u t %7u t %11u\n", snap.name, (unsigned)snap.depth,
+               (unsigned)snap.capacity, (unsigned)snap.high_water, (unsigned)snap.sends,
+               (unsigned)snap.send_failures, (unsigned)snap.receives, (unsigned)snap.receive_failures,
+               (unsigned)snap.send_wait_ticks, (unsigned)snap.receive_wait_ticks,
+               (unsigned)hist_percentile_us(snap.receive_block_hist, 99.0));
+    }
+}
+//-------------------------------------------------------------------------------------------------
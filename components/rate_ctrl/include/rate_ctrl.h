@@ -0,0 +1,78 @@
+//Backpressure-aware rate controller for producer tasks
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why adapt the producer rate?
+A fixed vTaskDelay() between sends is either too slow (the consumer idles) or too fast (the queue fills
+and items are dropped on errQUEUE_FULL). The controller looks at the queue after every send and returns
+the delay to use before the next one:
+
+>> Send failed (queue full)        : item dropped -> delay x2          (back off hard)
+>> Occupancy >= high watermark     : delay x1.5                         (back off gently)
+>> Occupancy <= low watermark      : delay - step                       (speed up slowly)
+>> In between                      : delay unchanged
+
+This is AIMD (additive increase of the rate, multiplicative decrease), the same idea TCP uses.
+Every attempt is counted, so sent + dropped == attempts and the loss rate is always known.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct {
+    TickType_t min_period;          //fastest allowed rate (delay between sends, >= 1 tick)
+    TickType_t max_period;          //slowest allowed rate
+    TickType_t initial_period;
+    TickType_t step;                //speed-up step when the queue is nearly empty
+    uint8_t high_pct;               //occupancy (% of capacity) at which to back off
+    uint8_t low_pct;                //occupancy (% of capacity) at which to speed up
+} rate_ctrl_config_t;
+
+typedef struct {
+    rate_ctrl_config_t cfg;
+    TickType_t period;              //current delay between sends
+    uint32_t attempts;              //calls to rate_ctrl_update()
+    uint32_t sent;                  //attempts that returned pdPASS
+    uint32_t dropped;               //attempts that failed (errQUEUE_FULL)
+    uint32_t backoffs;              //times the period was increased
+} rate_ctrl_t;
+
+//Defaults: 1 tick .. 200 ms (the original fixed delay), back off above 75 %, speed up below 25 %
+#define RATE_CTRL_DEFAULT_CONFIG() {            \
+    .min_period = 1,                            \
+    .max_period = pdMS_TO_TICKS(200),           \
+    .initial_period = pdMS_TO_TICKS(200),       \
+    .step = 1,                                  \
+    .high_pct = 75,                             \
+    .low_pct = 25,                              \
+}
+
+
+//Start the controller at cfg->initial_period with all counters at zero.
+void rate_ctrl_init(rate_ctrl_t *rc, const rate_ctrl_config_t *cfg);
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : rate_ctrl_update
+>> Description: Record the result of one send and compute the next delay.
+>> pending: items waiting in the queue right after the send (uxQueueMessagesWaiting).
+>> capacity: queue length given at creation time.
+>> send_result: return value of xQueueSend (pdPASS or errQUEUE_FULL).
+>> Returns: ticks to wait before the next send (pass it to vTaskDelay).
+*/
+TickType_t rate_ctrl_update(rate_ctrl_t *rc, UBaseType_t pending, UBaseType_t capacity, BaseType_t send_result);
+//-------------------------------------------------------------------------------------------------
+
+//Dropped / attempted in per-mille (0..1000), 0 before the first attempt.
+uint32_t rate_ctrl_loss_permille(const rate_ctrl_t *rc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+//Backpressure-aware rate controller for producer tasks (see rate_ctrl.h)
+
+#include "freertos/FreeRTOS.h"
+#include "rate_ctrl.h"
+
+
+static TickType_t clamp_period(const rate_ctrl_t *rc, TickType_t period)
+{
+    if (period < rc->cfg.min_period) {
+        return rc->cfg.min_period;
+    }
+    if (period > rc->cfg.max_period) {
+        return rc->cfg.max_period;
+    }
+    return period;
+}
+
+void rate_ctrl_init(rate_ctrl_t *rc, const rate_ctrl_config_t *cfg)
+{
+    rc->cfg = *cfg;
+    if (rc->cfg.min_period == 0) {
+        rc->cfg.min_period = 1;         //0 would turn the producer into a busy loop
+    }
+    rc->period = clamp_period(rc, cfg->initial_period);
+    rc->attempts = 0;
+    rc->sent = 0;
+    rc->dropped = 0;
+    rc->backoffs = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+TickType_t rate_ctrl_update(rate_ctrl_t *rc, UBaseType_t pending, UBaseType_t capacity, BaseType_t send_result)
+{
+    TickType_t period = rc->period;
+    uint32_t fill_pct = (capacity != 0) ? (uint32_t)((pending * 100u) / capacity) : 100u;
+
+    rc->attempts++;
+    if (send_result == pdPASS) {
+        rc->sent++;
+    } else {
+        rc->dropped++;
+    }
+
+    if (send_result != pdPASS) {
+        period = period * 2 + 1;                        //dropped an item: back off hard
+        rc->backoffs++;
+    } else if (fill_pct >= rc->cfg.high_pct) {
+        period = period + period / 2 + 1;               //consumer falling behind: back off gently
+        rc->backoffs++;
+    } else if (fill_pct <= rc->cfg.low_pct && period > rc->cfg.step) {
+        period = period - rc->cfg.step;                 //consumer keeping up: speed up slowly
+    }
+
+    rc->period = clamp_period(rc, period);
+    return rc->period;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+uint32_t rate_ctrl_loss_permille(const rate_ctrl_t *rc)
+{
+    return (rc->attempts != 0) ? (uint32_t)(((uint64_t)rc->dropped * 1000u) / rc->attempts) : 0;
+}
@@ -0,0 +1,33 @@
+//Relaxed atomic counters for the telemetry components (queue_stats, signal_sem, wake_latency, periodic_task, ...)
+
+#pragma once
+
+#include <stdatomic.h>
+
+/*
+---------------------------------------------------------------------------------------------------
+Counters that are only read for statistics: each field must be exact on its own, but nothing is ordered
+against them, so every access is relaxed (no barrier on the hot path).
+
+Rules:
+>> 32-bit counters only: the ESP32 (Xtensa LX6) has no lock-free 64-bit atomics. They wrap.
+>> relaxed_add() for counters written by several tasks or cores; relaxed_store(load + value) is enough
+   when a single task writes (no read-modify-write).
+>> C only (<stdatomic.h>).
+---------------------------------------------------------------------------------------------------
+*/
+
+static inline unsigned relaxed_load(const atomic_uint *counter)
+{
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static inline void relaxed_store(atomic_uint *counter, unsigned value)
+{
+    atomic_store_explicit(counter, value, memory_order_relaxed);
+}
+
+static inline void relaxed_add(atomic_uint *counter, unsigned value)
+{
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
@@ -0,0 +1,96 @@
+//Rate-monotonic priorities and admission control (response-time analysis) for periodic_task sets
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "periodic_task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+xTaskCreate(task1, "task1", 2048, NULL, 1, NULL) - the priority is a guess, and whether every task meets
+its deadline is found out in the field. Here each task declares its period, deadline and worst-case
+execution time (WCET), and before anything is created:
+>> Priorities: the shorter the deadline, the higher the priority (rate monotonic when deadline = period).
+   For independent periodic tasks on one core no other fixed-priority order meets more deadlines.
+>> Admission: the response-time analysis computes each task's worst case - its WCET plus everything that
+   can preempt it, at the worst phasing - and the set is rejected if one of them exceeds its deadline:
+       R = C(i) + sum over higher/equal priority j of ceil(R / T(j)) x C(j)      (iterate until R stops)
+   The test is exact for these assumptions, unlike the utilization bound (69 %) it is not pessimistic.
+
+Flow:
+1) rm_task_t set[] = { { .config = { .name = "task1", .job = job1, .period_ms = 1000, .stack_depth = 2048 },
+                         .wcet_us = 5000 }, ... };
+2) if (rm_sched_start(set, 2, 1, &report) != pdPASS) { rm_sched_print(set, 2, &report); ... rejected }
+3) set[i].task is the periodic_task (counters: periodic_task_get / periodic_task_print)
+
+rm_sched_assign() and rm_sched_analyse() can be used on their own, e.g. to check hand-picked priorities:
+fill config.priority yourself and call rm_sched_analyse().
+
+Rules:
+>> Periods are rounded down to ticks exactly as periodic_task does; the deadline defaults to the period.
+>> Equal priorities are counted as preempting each other (time slicing): conservative.
+>> The WCET must include what the job waits for (UART output, mutexes held by lower-priority tasks) plus a
+   margin for interrupts and the tick; the analysis trusts it.
+>> One core: on the ESP32, pin the set to one core or treat the result as a guide only.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define RM_SCHED_UNBOUNDED  UINT32_MAX      //response time above the deadline (iteration stopped)
+
+typedef struct {
+    periodic_task_config_t config;          //config.priority is set by rm_sched_assign()
+    uint32_t wcet_us;                       //worst-case execution time of one job
+    uint32_t response_us;                   //out: worst-case response time, or RM_SCHED_UNBOUNDED
+    periodic_task_t *task;                  //out: created by rm_sched_start()
+} rm_task_t;
+
+typedef struct {
+    uint32_t utilization_permille;          //sum of WCET / period
+    size_t misses;                          //tasks whose response time exceeds the deadline
+    size_t first_miss;                      //index of the first one, count if none
+    BaseType_t schedulable;
+} rm_sched_report_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : rm_sched_assign
+>> Description: Deadline-monotonic priorities from lowest_priority up: the longest deadline gets
+                lowest_priority, equal deadlines share a priority.
+>> Returns: pdPASS, or pdFAIL if the set needs priorities at or above configMAX_PRIORITIES (nothing changed).
+*/
+BaseType_t rm_sched_assign(rm_task_t *tasks, size_t count, UBaseType_t lowest_priority);
+
+/*
+Function : rm_sched_analyse
+>> Description: Response-time analysis with the priorities in config.priority; fills response_us of
+                every task and the report.
+*/
+void rm_sched_analyse(rm_task_t *tasks, size_t count, rm_sched_report_t *report);
+
+/*
+Function : rm_sched_start
+>> Description: rm_sched_assign() + rm_sched_analyse(), then one periodic_task per entry - only if every
+                task meets its deadline. report may be NULL.
+>> Returns: pdPASS, or pdFAIL if priorities run out, the set is not schedulable or a task could not be
+            created (the ones created are deleted again).
+*/
+BaseType_t rm_sched_start(rm_task_t *tasks, size_t count, UBaseType_t lowest_priority, rm_sched_report_t *report);
+
+//Delete the tasks rm_sched_start() created.
+void rm_sched_stop(rm_task_t *tasks, size_t count);
+
+//Table: name, period, deadline, WCET, priority, response time; then utilization and verdict.
+void rm_sched_print(const rm_task_t *tasks, size_t count, const rm_sched_report_t *report);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+//Rate-monotonic priorities and response-time analysis for periodic_task sets (see rm_sched.h)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "rm_sched.h"
+
+
+//Same rounding as periodic_task_create()
+static uint32_t period_us(const rm_task_t *t)
+{
+    return (uint32_t)pdMS_TO_TICKS(t->config.period_ms) * portTICK_PERIOD_MS * 1000u;
+}
+
+static uint32_t deadline_us(const rm_task_t *t)
+{
+    return t->config.deadline_ms ? t->config.deadline_ms * 1000u : period_us(t);
+}
+
+//Priority level above the lowest = number of distinct deadlines longer than the task's own
+static UBaseType_t level_of(const rm_task_t *tasks, size_t count, size_t i)
+{
+    UBaseType_t level = 0;
+    for (size_t j = 0; j < count; j++) {
+        if (deadline_us(&tasks[j]) <= deadline_us(&tasks[i])) {
+            continue;
+        }
+        bool seen = false;                  //count each deadline value once
+        for (size_t k = 0; k < j && !seen; k++) {
+            seen = deadline_us(&tasks[k]) == deadline_us(&tasks[j]);
+        }
+        level += seen ? 0 : 1;
+    }
+    return level;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t rm_sched_assign(rm_task_t *tasks, size_t count, UBaseType_t lowest_priority)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (lowest_priority + level_of(tasks, count, i) >= configMAX_PRIORITIES) {
+            return pdFAIL;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        tasks[i].config.priority = lowest_priority + level_of(tasks, count, i);
+    }
+    return pdPASS;
+}
+
+void rm_sched_analyse(rm_task_t *tasks, size_t count, rm_sched_report_t *report)
+{
+    uint64_t utilization = 0;
+    report->misses = 0;
+    report->first_miss = count;
+
+    for (size_t i = 0; i < count; i++) {
+        rm_task_t *t = &tasks[i];
+        if (period_us(t) == 0) {            //shorter than a tick: periodic_task_create() rejects it
+            t->response_us = RM_SCHED_UNBOUNDED;
+            report->first_miss = (report->misses == 0) ? i : report->first_miss;
+            report->misses++;
+            continue;
+        }
+        utilization += (uint64_t)t->wcet_us * 1000u / period_us(t);
+
+        //R(n+1) = C(i) + sum ceil(R(n) / T(j)) x C(j): grows monotonically, stop at a fixed point or past D
+        uint64_t deadline = deadline_us(t);
+        uint64_t response = t->wcet_us;
+        while (response <= deadline) {
+            uint64_t next = t->wcet_us;
+            for (size_t j = 0; j < count; j++) {
+                if (j != i && tasks[j].config.priority >= t->config.priority && period_us(&tasks[j]) != 0) {
+                    uint64_t period = period_us(&tasks[j]);
+                    next += (response + period - 1) / period * tasks[j].wcet_us;
+                }
+            }
+            if (next == response) {
+                break;
+            }
+            response = next;
+        }
+
+        if (response > deadline) {
+            t->response_us = RM_SCHED_UNBOUNDED;
+            report->first_miss = (report->misses == 0) ? i : report->first_miss;
+            report->misses++;
+        } else {
+            t->response_us = (uint32_t)response;
+        }
+    }
+    report->utilization_permille = (utilization > UINT32_MAX) ? UINT32_MAX : (uint32_t)utilization;
+    report->schedulable = (report->misses == 0) ? pdTRUE : pdFALSE;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t rm_sched_start(rm_task_t *tasks, size_t count, UBaseType_t lowest_priority, rm_sched_report_t *report)
+{
+    rm_sched_report_t local;
+    report = (report != NULL) ? report : &local;
+    for (size_t i = 0; i < count; i++) {
+        tasks[i].task = NULL;
+    }
+
+    if (rm_sched_assign(tasks, count, lowest_priority) != pdPASS) {
+        *report = (rm_sched_report_t){ .first_miss = count, .schedulable = pdFALSE };
+        return pdFAIL;
+    }
+    rm_sched_analyse(tasks, count, report);
+    if (report->schedulable != pdTRUE) {
+        return pdFAIL;
+    }
+
+    //Highest priority first: a new task never has to wait for one created before it
+    for (UBaseType_t prio = configMAX_PRIORITIES; prio-- > lowest_priority;) {
+        for (size_t i = 0; i < count; i++) {
+            if (tasks[i].config.priority != prio) {
+                continue;
+            }
+            tasks[i].task = periodic_task_create(&tasks[i].config);
+            if (tasks[i].task == NULL) {
+                rm_sched_stop(tasks, count);
+                return pdFAIL;
+            }
+        }
+    }
+    return pdPASS;
+}
+
+void rm_sched_stop(rm_task_t *tasks, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (tasks[i].task != NULL) {
+            periodic_task_delete(tasks[i].task);
+            tasks[i].task = NULL;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void rm_sched_print(const rm_task_t *tasks, size_t count, const rm_sched_report_t *report)
+{
+    printf("%-16s %9s %9s %9s %4s %11s\n", "task", "period", "deadline", "wcet", "prio", "response");
+    for (size_t i = 0; i < count; i++) {
+        const rm_task_t *t = &tasks[i];
+        char response[16];
+        if (t->response_us == RM_SCHED_UNBOUNDED) {
+            snprintf(response, sizeof(response), "MISS");
+        } else {
+            snprintf(response, sizeof(response), "%u us", (unsigned)t->response_us);
+        }
+        printf("%-16s %6u ms %6u ms %6u us %4u %11s\n", t->config.name ? t->config.name : "?",
+               (unsigned)(period_us(t) / 1000u), (unsigned)(deadline_us(t) / 1000u), (unsigned)t->wcet_us,
+               (unsigned)t->config.priority, response);
+    }
+    printf("utilization %u.%u %%, %s\n", (unsigned)(report->utilization_permille / 10u),
+           (unsigned)(report->utilization_permille % 10u),
+           report->schedulable == pdTRUE ? "schedulable" : "NOT schedulable");
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,134 @@
+//Per-task and per-core CPU utilization from FreeRTOS run-time stats: periodic deltas, table and binary snapshot
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+With CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS the kernel adds the time between switch-in and switch-out to a
+counter in every TCB, but the counters only ever grow: "task1 ran 83 ms since boot" says nothing about now.
+The sampler task reads all of them with uxTaskGetSystemState() every period and reports the difference to the
+previous read:
+>> per task: share of one core during the last window (a task runs on one core at a time)
+>> per core: 100 % minus the share of that core's idle task
+
+Flow:
+1) runtime_stats_start(&(runtime_stats_config_t){ .period_ms = 1000, .print_every = 5 })
+2) every period: snapshot of the last window; every print_every-th one printed as a table
+3) runtime_stats_get(&snap) from any task; runtime_stats_encode() packs it for a log / network link,
+   runtime_stats_decode() unpacks it on the other side (plain C, builds on the PC too)
+
+Binary snapshot (little endian, version 1):
+   "RS" | version u8 | cores u8 | window_us u32 | busy_permille u16 x cores | tasks u8 |
+   per task: number u16 | priority u8 | state u8 | cpu_permille u16 | stack_free u16 | name_len u8 | name
+   = 10 + 2 x cores + (9 + name) per task: 2 cores, 8 tasks with ~8-character names ~150 bytes.
+
+Rules:
+>> Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (sdkconfig; on the
+   host configUSE_TRACE_FACILITY / configGENERATE_RUN_TIME_STATS). Without them RUNTIME_STATS_AVAILABLE is 0
+   and runtime_stats_start() fails.
+>> uxTaskGetSystemState() suspends the scheduler and measures every task's stack high-water mark: the cost
+   grows with the number of tasks and their free stack (host/bench/runtime_stats_overhead). Sample every
+   second or so, not every tick.
+>> The counter is 32-bit (esp_timer us on the ESP32, us on the host): windows must stay below 71 minutes.
+>> Tasks beyond RUNTIME_STATS_MAX_TASKS are left out of the snapshot (the busiest are kept).
+---------------------------------------------------------------------------------------------------
+*/
+
+#define RUNTIME_STATS_AVAILABLE     (configUSE_TRACE_FACILITY == 1 && configGENERATE_RUN_TIME_STATS == 1)
+
+#ifndef RUNTIME_STATS_MAX_TASKS
+#define RUNTIME_STATS_MAX_TASKS     24
+#endif
+
+#define RUNTIME_STATS_MAX_CORES     2
+#define RUNTIME_STATS_NAME_LEN      configMAX_TASK_NAME_LEN
+
+//Largest runtime_stats_encode() output
+#define RUNTIME_STATS_ENCODED_MAX   (10 + 2 * RUNTIME_STATS_MAX_CORES + \
+                                     RUNTIME_STATS_MAX_TASKS * (9 + RUNTIME_STATS_NAME_LEN))
+
+#ifndef RUNTIME_STATS_TASK_PRIORITY
+#define RUNTIME_STATS_TASK_PRIORITY (configMAX_PRIORITIES - 2)  //samples on time even under load
+#endif
+
+#ifndef RUNTIME_STATS_TASK_STACK
+#define RUNTIME_STATS_TASK_STACK    3072
+#endif
+
+typedef struct {
+    char name[RUNTIME_STATS_NAME_LEN];
+    uint16_t number;                        //xTaskNumber: tells apart tasks with the same name
+    uint8_t priority;
+    uint8_t state;                          //eTaskState at the end of the window
+    uint16_t cpu_permille;                  //share of one core during the window
+    uint16_t stack_free;                    //high-water mark in bytes, saturated at 65535
+    uint32_t run_us;                        //run time during the window (not encoded)
+} runtime_stats_task_t;
+
+typedef struct {
+    uint32_t window_us;
+    uint32_t sequence;                      //snapshots taken so far (not encoded)
+    uint8_t cores;
+    uint16_t busy_permille[RUNTIME_STATS_MAX_CORES];
+    uint8_t task_count;
+    runtime_stats_task_t tasks[RUNTIME_STATS_MAX_TASKS];    //busiest first
+} runtime_stats_snapshot_t;
+
+typedef struct {
+    uint32_t period_ms;                     //window length
+    uint32_t print_every;                   //print every Nth snapshot, 0 = never
+    void (*on_snapshot)(const runtime_stats_snapshot_t *snap, void *arg);    //sampler task, may be NULL
+    void *arg;
+} runtime_stats_config_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : runtime_stats_start
+>> Description: Takes the first reading and creates the sampler task. config is copied.
+>> Returns: pdPASS, or pdFAIL if run-time stats are compiled out, period_ms is below one tick, the
+            sampler runs already or could not be created.
+*/
+BaseType_t runtime_stats_start(const runtime_stats_config_t *config);
+
+/*
+Function : runtime_stats_sample
+>> Description: One window by hand: the snapshot covers the time since the previous call (or since
+                runtime_stats_start). Called by the sampler task; usable without it. Not reentrant.
+>> Returns: pdPASS, or pdFAIL if run-time stats are compiled out or this is the first reading.
+*/
+BaseType_t runtime_stats_sample(runtime_stats_snapshot_t *out);
+
+/*
+Function : runtime_stats_get
+>> Description: Copy of the latest snapshot taken by the sampler task.
+>> Returns: pdPASS, or pdFAIL if there is none yet.
+*/
+BaseType_t runtime_stats_get(runtime_stats_snapshot_t *out);
+
+//Table: per-core busy share, then per task priority, state, CPU share, run time and free stack.
+void runtime_stats_print(const runtime_stats_snapshot_t *snap);
+
+/*
+Function : runtime_stats_encode / runtime_stats_decode
+>> Description: Binary form described above. Names longer than RUNTIME_STATS_NAME_LEN - 1 are cut.
+>> Returns: encode: bytes written, 0 if len is too small. decode: pdPASS, or pdFAIL if the buffer is
+            truncated, not a version 1 snapshot or has more cores / tasks than fit.
+*/
+size_t runtime_stats_encode(const runtime_stats_snapshot_t *snap, uint8_t *buf, size_t len);
+BaseType_t runtime_stats_decode(const uint8_t *buf, size_t len, runtime_stats_snapshot_t *out);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
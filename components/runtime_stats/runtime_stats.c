@@ -0,0 +1,352 @@
+//Per-task / per-core CPU utilization deltas from uxTaskGetSystemState() (see runtime_stats.h)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "runtime_stats.h"
+
+
+#define SNAPSHOT_MAGIC0     'R'
+#define SNAPSHOT_MAGIC1     'S'
+#define SNAPSHOT_VERSION    1u
+#define SPARE_STATUS        4u              //tasks created between counting and reading
+
+static const char *const state_names[] = { "running", "ready", "blocked", "suspend", "deleted", "invalid" };
+
+
+//-------------------------------------------------------------------------------------------------
+static inline uint16_t permille(uint64_t part, uint32_t whole)
+{
+    if (whole == 0) {
+        return 0;
+    }
+    uint64_t p = part * 1000u / whole;
+    return (uint16_t)(p > 1000u ? 1000u : p);
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+size_t runtime_stats_encode(const runtime_stats_snapshot_t *snap, uint8_t *buf, size_t len)
+{
+    size_t pos = 9u + 2u * snap->cores;
+    if (len < pos) {
+        return 0;
+    }
+    buf[0] = SNAPSHOT_MAGIC0;
+    buf[1] = SNAPSHOT_MAGIC1;
+    buf[2] = SNAPSHOT_VERSION;
+    buf[3] = snap->cores;
+    put_u32(&buf[4], snap->window_us);
+    for (uint8_t c = 0; c < snap->cores; c++) {
+        put_u16(&buf[8 + 2 * c], snap->busy_permille[c]);
+    }
+    buf[pos - 1] = snap->task_count;
+
+    for (uint8_t i = 0; i < snap->task_count; i++) {
+        const runtime_stats_task_t *t = &snap->tasks[i];
+        size_t name_len = strnlen(t->name, RUNTIME_STATS_NAME_LEN - 1);
+        if (len - pos < 9u + name_len) {
+            return 0;
+        }
+        put_u16(&buf[pos], t->number);
+        buf[pos + 2] = t->priority;
+        buf[pos + 3] = t->state;
+        put_u16(&buf[pos + 4], t->cpu_permille);
+        put_u16(&buf[pos + 6], t->stack_free);
+        buf[pos + 8] = (uint8_t)name_len;
+        memcpy(&buf[pos + 9], t->name, name_len);
+        pos += 9u + name_len;
+    }
+    return pos;
+}
+
+BaseType_t runtime_stats_decode(const uint8_t *buf, size_t len, runtime_stats_snapshot_t *out)
+{
+    if (len < 9 || buf[0] != SNAPSHOT_MAGIC0 || buf[1] != SNAPSHOT_MAGIC1 || buf[2] != SNAPSHOT_VERSION ||
+        buf[3] > RUNTIME_STATS_MAX_CORES || len < 9u + 2u * buf[3]) {
+        return pdFAIL;
+    }
+    memset(out, 0, sizeof(*out));
+    out->cores = buf[3];
+    out->window_us = get_u32(&buf[4]);
+    for (uint8_t c = 0; c < out->cores; c++) {
+        out->busy_permille[c] = get_u16(&buf[8 + 2 * c]);
+    }
+    size_t pos = 9u + 2u * out->cores;
+    uint8_t count = buf[pos - 1];
+    if (count > RUNTIME_STATS_MAX_TASKS) {
+        return pdFAIL;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        runtime_stats_task_t *t = &out->tasks[i];
+        if (len - pos < 9u || buf[pos + 8] >= RUNTIME_STATS_NAME_LEN || len - pos < 9u + buf[pos + 8]) {
+            return pdFAIL;
+        }
+        t->number = get_u16(&buf[pos]);
+        t->priority = buf[pos + 2];
+        t->state = buf[pos + 3];
+        t->cpu_permille = get_u16(&buf[pos + 4]);
+        t->stack_free = get_u16(&buf[pos + 6]);
+        memcpy(t->name, &buf[pos + 9], buf[pos + 8]);
+        t->run_us = (uint32_t)((uint64_t)out->window_us * t->cpu_permille / 1000u);
+        pos += 9u + buf[pos + 8];
+    }
+    out->task_count = count;
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void runtime_stats_print(const runtime_stats_snapshot_t *snap)
+{
+    printf("runtime stats #%u: window %u ms", (unsigned)snap->sequence, (unsigned)(snap->window_us / 1000u));
+    for (uint8_t c = 0; c < snap->cores; c++) {
+        printf(", core %u busy %u.%u %%", c, snap->busy_permille[c] / 10u, snap->busy_permille[c] % 10u);
+    }
+    printf("\n%-16s %5s %4s %-8s %7s %9s %10s\n", "task", "num", "prio", "state", "cpu %", "run ms", "stack free");
+    for (uint8_t i = 0; i < snap->task_count; i++) {
+        const runtime_stats_task_t *t = &snap->tasks[i];
+        printf("%-16s %5u %4u %-8s %5u.%u %5u.%03u %10u\n", t->name, t->number, t->priority,
+               state_names[t->state < 5 ? t->state : 5], t->cpu_permille / 10u, t->cpu_permille % 10u,
+               (unsigned)(t->run_us / 1000u), (unsigned)(t->run_us % 1000u), t->stack_free);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+#if RUNTIME_STATS_AVAILABLE
+/*
+---------------------------------------------------------------------------------------------------
+>> Every reading is a fresh pvPortMalloc'd TaskStatus_t array: uxTaskGetSystemState() fails outright if
+   the array is too small, and the previous reading must stay around to subtract from.
+>> Tasks are matched between readings by xTaskNumber (unique per task, never reused).
+---------------------------------------------------------------------------------------------------
+*/
+
+//-------------------------------------------------------------------------------------------------
+static TaskStatus_t *prev_status;
+static UBaseType_t prev_count;
+static configRUN_TIME_COUNTER_TYPE prev_total;
+static uint32_t sequence;
+
+static runtime_stats_config_t sampler_config;
+static TaskHandle_t sampler;
+static SemaphoreHandle_t latest_lock;
+static runtime_stats_snapshot_t latest;
+static BaseType_t have_latest;
+
+//New reading; the previous one is kept for the deltas. pdFAIL if out of memory.
+static BaseType_t read_status(TaskStatus_t **status, UBaseType_t *count, configRUN_TIME_COUNTER_TYPE *total)
+{
+    UBaseType_t room = uxTaskGetNumberOfTasks() + SPARE_STATUS;
+    *status = pvPortMalloc(room * sizeof(TaskStatus_t));
+    if (*status == NULL) {
+        return pdFAIL;
+    }
+    *count = uxTaskGetSystemState(*status, room, total);
+    if (*count == 0) {                      //more tasks than room: they were created meanwhile
+        vPortFree(*status);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+static uint32_t delta_of(const TaskStatus_t *now)
+{
+    for (UBaseType_t j = 0; j < prev_count; j++) {
+        if (prev_status[j].xTaskNumber == now->xTaskNumber) {
+            return (uint32_t)(now->ulRunTimeCounter - prev_status[j].ulRunTimeCounter);
+        }
+    }
+    return (uint32_t)now->ulRunTimeCounter;             //created during the window
+}
+
+static TaskHandle_t idle_handle(BaseType_t core)
+{
+#if configNUMBER_OF_CORES > 1
+    return xTaskGetIdleTaskHandleForCore(core);
+#else
+    (void)core;
+    return xTaskGetIdleTaskHandle();
+#endif
+}
+
+//Insert into the snapshot, busiest first; once it is full the least busy entry drops out
+static void insert_busiest(runtime_stats_snapshot_t *out, const runtime_stats_task_t *t)
+{
+    uint8_t pos = out->task_count;
+    if (pos == RUNTIME_STATS_MAX_TASKS) {
+        if (out->tasks[pos - 1].run_us >= t->run_us) {
+            return;
+        }
+        pos--;
+    } else {
+        out->task_count++;
+    }
+    while (pos > 0 && out->tasks[pos - 1].run_us < t->run_us) {
+        out->tasks[pos] = out->tasks[pos - 1];
+        pos--;
+    }
+    out->tasks[pos] = *t;
+}
+
+BaseType_t runtime_stats_sample(runtime_stats_snapshot_t *out)
+{
+    TaskStatus_t *status;
+    UBaseType_t count;
+    configRUN_TIME_COUNTER_TYPE total;
+    if (read_status(&status, &count, &total) != pdPASS) {
+        return pdFAIL;
+    }
+    if (prev_status == NULL) {
+        prev_status = status;
+        prev_count = count;
+        prev_total = total;
+        return pdFAIL;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->window_us = (uint32_t)(total - prev_total);
+    out->sequence = ++sequence;
+    out->cores = (configNUMBER_OF_CORES < RUNTIME_STATS_MAX_CORES) ? configNUMBER_OF_CORES : RUNTIME_STATS_MAX_CORES;
+    for (uint8_t c = 0; c < out->cores; c++) {
+        out->busy_permille[c] = 1000u;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *s = &status[i];
+        runtime_stats_task_t t = {
+            .number = (uint16_t)s->xTaskNumber,
+            .priority = (uint8_t)s->uxCurrentPriority,
+            .state = (uint8_t)s->eCurrentState,
+            .run_us = delta_of(s),
+        };
+        uint32_t free_bytes = (uint32_t)s->usStackHighWaterMark * (uint32_t)sizeof(StackType_t);
+        t.stack_free = (uint16_t)(free_bytes > UINT16_MAX ? UINT16_MAX : free_bytes);
+        t.cpu_permille = permille(t.run_us, out->window_us);
+        strncpy(t.name, s->pcTaskName, RUNTIME_STATS_NAME_LEN - 1);
+        for (uint8_t c = 0; c < out->cores; c++) {
+            if (s->xHandle == idle_handle(c)) {
+                out->busy_permille[c] = 1000u - t.cpu_permille;
+            }
+        }
+        insert_busiest(out, &t);
+    }
+
+    vPortFree(prev_status);
+    prev_status = status;
+    prev_count = count;
+    prev_total = total;
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void sampler_task(void *pv)
+{
+    (void)pv;
+    static runtime_stats_snapshot_t snap;   //~0.7 KB: not on the sampler's stack
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(sampler_config.period_ms));
+        if (runtime_stats_sample(&snap) != pdPASS) {
+            continue;
+        }
+        xSemaphoreTake(latest_lock, portMAX_DELAY);
+        latest = snap;
+        have_latest = pdTRUE;
+        xSemaphoreGive(latest_lock);
+
+        if (sampler_config.on_snapshot != NULL) {
+            sampler_config.on_snapshot(&snap, sampler_config.arg);
+        }
+        if (sampler_config.print_every != 0 && snap.sequence % sampler_config.print_every == 0) {
+            runtime_stats_print(&snap);
+        }
+    }
+}
+
+BaseType_t runtime_stats_start(const runtime_stats_config_t *config)
+{
+    if (config == NULL || pdMS_TO_TICKS(config->period_ms) == 0 || sampler != NULL) {
+        return pdFAIL;
+    }
+    latest_lock = (latest_lock != NULL) ? latest_lock : xSemaphoreCreateMutex();
+    if (latest_lock == NULL) {
+        return pdFAIL;
+    }
+    sampler_config = *config;
+    runtime_stats_sample(&latest);          //first reading: the deltas start here (not published)
+    if (xTaskCreate(sampler_task, "rt_stats", RUNTIME_STATS_TASK_STACK, NULL, RUNTIME_STATS_TASK_PRIORITY,
+                    &sampler) != pdPASS) {
+        sampler = NULL;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t runtime_stats_get(runtime_stats_snapshot_t *out)
+{
+    if (latest_lock == NULL) {
+        return pdFAIL;
+    }
+    xSemaphoreTake(latest_lock, portMAX_DELAY);
+    BaseType_t ok = have_latest;
+    if (ok == pdTRUE) {
+        *out = latest;
+    }
+    xSemaphoreGive(latest_lock);
+    return ok == pdTRUE ? pdPASS : pdFAIL;
+}
+//-------------------------------------------------------------------------------------------------
+
+#else   //run-time stats compiled out
+
+BaseType_t runtime_stats_start(const runtime_stats_config_t *config)
+{
+    (void)config;
+    return pdFAIL;
+}
+
+BaseType_t runtime_stats_sample(runtime_stats_snapshot_t *out)
+{
+    (void)out;
+    return pdFAIL;
+}
+
+BaseType_t runtime_stats_get(runtime_stats_snapshot_t *out)
+{
+    (void)out;
+    return pdFAIL;
+}
+
+#endif
@@ -0,0 +1,118 @@
+//Scheduler trace: context switches and queue / semaphore operations from the kernel trace hooks into a
+//per-core ring, dumped for host/tools/sched_trace_tool (Chrome trace JSON for Perfetto / chrome://tracing)
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "sched_trace_wire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+A latency spike in the log ("Task B: Received semaphore!" 40 ms late) says that something was slow, not what
+ran instead. The kernel already calls a trace macro at every context switch and every queue operation;
+sched_trace_hooks.h points them at this recorder, which stores 8 bytes per event into a ring per core.
+The dump goes to the PC and becomes a timeline: one lane per core, a slice per task, the gives and takes
+as markers with an arrow from each give to the take it released.
+
+Flow:
+1) Hooks: on the host always compiled in (host/config/FreeRTOSConfig.h, HOST_SCHED_TRACE); on the ESP32
+   force-include sched_trace_hooks.h into every component (EX3_SCHED_TRACE=1 in SIMPLE_BIN_SEMAPHORE).
+2) sched_trace_name_queue(sem, "xSemaphore") - queues / semaphores show up by name, tasks always do
+3) sched_trace_capture(SCHED_TRACE_ONE_SHOT, 5000): records for 5 s, then prints the dump as hex lines
+   between "//>>> sched_trace" and "//<<< sched_trace" (or sched_trace_start / _stop / _dump by hand)
+4) PC: sched_trace_tool json capture.txt -o trace.json  ->  open in ui.perfetto.dev or chrome://tracing
+       sched_trace_tool text capture.txt                ->  the same timeline as text
+
+Modes:
+>> SCHED_TRACE_ONE_SHOT       : a core stops recording when its ring is full: the first N events after start
+>> SCHED_TRACE_FLIGHT_RECORDER: the ring wraps: the last N events before sched_trace_stop(), e.g. called
+                                when a latency check fails
+
+Rules:
+>> Needs configUSE_TRACE_FACILITY (task and queue numbers; CONFIG_FREERTOS_USE_TRACE_FACILITY on the ESP32).
+>> Clock: esp_timer (1 MHz) on the ESP32, CLOCK_MONOTONIC in 100 ns units on the host; both are 32-bit,
+   so one capture must stay below 71 minutes (ESP32) / 7 minutes (host).
+>> Task names come from the tasks alive at dump time; a task deleted before shows up as "task <number>".
+>> The recorder numbers tasks with vTaskSetTaskNumber(); a task that already has a trace number (set by
+   another trace tool) keeps it, so do not give two tasks the same one.
+>> Hooks run inside the kernel: on the ESP32 the recorder and the ring are in IRAM / DRAM, nothing in it
+   blocks, allocates or logs.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef SCHED_TRACE_EVENTS
+#define SCHED_TRACE_EVENTS          1024        //per core, power of two (8 bytes each)
+#endif
+
+#ifndef SCHED_TRACE_MAX_NAMES
+#define SCHED_TRACE_MAX_NAMES       16          //named queues
+#endif
+
+#ifndef SCHED_TRACE_TASK_PRIORITY
+#define SCHED_TRACE_TASK_PRIORITY   (configMAX_PRIORITIES - 2)     //the dump is not interleaved with other output
+#endif
+
+#ifndef SCHED_TRACE_TASK_STACK
+#define SCHED_TRACE_TASK_STACK      3072
+#endif
+
+#define SCHED_TRACE_HEX_BYTES       32          //dump bytes per printed line
+
+typedef enum {
+    SCHED_TRACE_ONE_SHOT,
+    SCHED_TRACE_FLIGHT_RECORDER,
+} sched_trace_mode_t;
+
+//Receives the dump in pieces, in order
+typedef void (*sched_trace_write_t)(const void *data, size_t len, void *arg);
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : sched_trace_start
+>> Description: Empties the rings and starts recording.
+>> Returns: pdPASS, or pdFAIL if the kernel was built without sched_trace_hooks.h.
+*/
+BaseType_t sched_trace_start(sched_trace_mode_t mode);
+
+//Stops recording. An event being written on the other core at this moment may still complete.
+void sched_trace_stop(void);
+
+/*
+Function : sched_trace_name_queue
+>> Description: Gives a queue / semaphore / mutex a number (vQueueSetQueueNumber) and a name for the dump.
+                name must stay valid (a literal is fine). Call before the events of interest.
+>> Returns: pdPASS, or pdFAIL if queue or name is NULL or SCHED_TRACE_MAX_NAMES are in use.
+*/
+BaseType_t sched_trace_name_queue(QueueHandle_t queue, const char *name);
+
+/*
+Function : sched_trace_dump
+>> Description: Stops recording and passes the dump (format in sched_trace_wire.h) to write.
+>> Returns: bytes written (0 if the task list could not be read).
+*/
+size_t sched_trace_dump(sched_trace_write_t write, void *arg);
+
+//sched_trace_dump() to stdout as SCHED_TRACE_HEX_BYTES hex bytes per line between the marker lines.
+void sched_trace_print(void);
+
+/*
+Function : sched_trace_capture
+>> Description: sched_trace_start(mode), then a task that waits duration_ms, prints the dump with
+                sched_trace_print() and deletes itself.
+>> Returns: pdPASS, or pdFAIL if tracing could not start, duration_ms is 0 or the task was not created.
+*/
+BaseType_t sched_trace_capture(sched_trace_mode_t mode, uint32_t duration_ms);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+//FreeRTOS trace macros for components/sched_trace: included from FreeRTOSConfig.h (host) or force-included
+//into every source file (ESP-IDF, see the SIMPLE_BIN_SEMAPHORE CMakeLists.txt). No FreeRTOS includes here.
+
+#pragma once
+
+#ifndef __ASSEMBLER__                       //force-included into the kernel's .S files too
+
+#include <stdint.h>
+#include "sched_trace_wire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+The kernel expands these macros inside tasks.c / queue.c, mostly inside a critical section - but the
+BLOCKING_ macros run with only the scheduler suspended, so an interrupt may record an event in the middle
+of one. The recorder therefore reserves its ring slot with an atomic increment. While the trace is
+stopped each call costs one flag check.
+
+>> Semaphores and mutexes are queues: xSemaphoreGive() -> traceQUEUE_SEND, xSemaphoreTake() (also of a
+   mutex) -> traceQUEUE_RECEIVE. The queue type recorded with the event tells them apart.
+>> A macro defined before this header is included wins (the host config keeps its context-switch counter
+   that way). Kernels that have traceQUEUE_GIVE_FROM_ISR / traceQUEUE_SEMAPHORE_RECEIVE map them to the
+   macros below by default.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define SCHED_TRACE_HOOKS           1
+
+void sched_trace_hook_switch(uint8_t type);
+void sched_trace_hook_queue(uint8_t type, void *queue);
+
+#ifndef traceTASK_SWITCHED_IN
+#define traceTASK_SWITCHED_IN()                     sched_trace_hook_switch(SCHED_TRACE_EV_SWITCH_IN)
+#endif
+#ifndef traceTASK_SWITCHED_OUT
+#define traceTASK_SWITCHED_OUT()                    sched_trace_hook_switch(SCHED_TRACE_EV_SWITCH_OUT)
+#endif
+#define traceQUEUE_SEND(pxQueue)                    sched_trace_hook_queue(SCHED_TRACE_EV_SEND, (void *)(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue)                 sched_trace_hook_queue(SCHED_TRACE_EV_RECEIVE, (void *)(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           sched_trace_hook_queue(SCHED_TRACE_EV_SEND_ISR, (void *)(pxQueue))
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)        sched_trace_hook_queue(SCHED_TRACE_EV_RECEIVE_ISR, (void *)(pxQueue))
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)        sched_trace_hook_queue(SCHED_TRACE_EV_BLOCK_SEND, (void *)(pxQueue))
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)     sched_trace_hook_queue(SCHED_TRACE_EV_BLOCK_RECV, (void *)(pxQueue))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+//Scheduler trace dump format, shared by the recorder (sched_trace.c) and the host decoder (host/tools)
+//Plain C, no FreeRTOS / ESP-IDF includes: the kernel hooks and the host tool both use it as-is.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Dump (little endian):
+>> header   : "SCHT" | version u8 | cores u8 | reserved u16 | clock_hz u32
+>> per core : events u32 | lost u32 | events x SCHED_TRACE_EVENT_SIZE bytes, oldest first
+>> names    : count u16 | per name: kind u8 | id u16 | length u8 | bytes
+
+Event (8 bytes): time u32 | type u8 | object u8 | id u16
+>> time     : clock ticks (clock_hz per second), wraps; the decoder unwraps per core
+>> type     : SCHED_TRACE_EV_x
+>> object   : switch events 0, queue events the queue type (SCHED_TRACE_OBJ_x = ucQueueGetQueueType())
+>> id       : switch events the task's trace number (uxTaskGetTaskNumber, assigned by the recorder the
+              first time it records the task - not xTaskNumber of TaskStatus_t), queue events the queue
+              number (set by sched_trace_name_queue(), 0 = unnamed)
+
+A task's time slice runs from its SWITCH_IN to the next SWITCH_OUT on the same core; a queue event belongs
+to the task whose slice it falls in (or to an interrupt for the _ISR types).
+---------------------------------------------------------------------------------------------------
+*/
+
+#define SCHED_TRACE_MAGIC           "SCHT"
+#define SCHED_TRACE_MAGIC_LEN       4
+#define SCHED_TRACE_VERSION         1
+#define SCHED_TRACE_HEADER_SIZE     12
+#define SCHED_TRACE_CORE_HEADER     8
+#define SCHED_TRACE_EVENT_SIZE      8
+
+#define SCHED_TRACE_EV_SWITCH_IN    1
+#define SCHED_TRACE_EV_SWITCH_OUT   2
+#define SCHED_TRACE_EV_SEND         3           //xQueueSend / xSemaphoreGive
+#define SCHED_TRACE_EV_RECEIVE      4           //xQueueReceive / xSemaphoreTake (also mutexes)
+#define SCHED_TRACE_EV_SEND_ISR     5
+#define SCHED_TRACE_EV_RECEIVE_ISR  6
+#define SCHED_TRACE_EV_BLOCK_SEND   7           //the sender blocks: queue full
+#define SCHED_TRACE_EV_BLOCK_RECV   8           //the receiver blocks: queue empty / semaphore not given
+#define SCHED_TRACE_EV_COUNT        9
+
+//Queue types as reported by ucQueueGetQueueType() (queueQUEUE_TYPE_x in queue.h)
+#define SCHED_TRACE_OBJ_QUEUE       0
+#define SCHED_TRACE_OBJ_MUTEX       1
+#define SCHED_TRACE_OBJ_COUNTING    2
+#define SCHED_TRACE_OBJ_BINARY      3
+#define SCHED_TRACE_OBJ_RECURSIVE   4
+
+#define SCHED_TRACE_NAME_TASK       0
+#define SCHED_TRACE_NAME_QUEUE      1
+
+typedef struct {
+    uint32_t time;
+    uint8_t type;
+    uint8_t object;
+    uint16_t id;
+} sched_trace_event_t;
+
+
+//-------------------------------------------------------------------------------------------------
+//Little-endian fields
+
+static inline void sched_trace_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void sched_trace_put_u32(uint8_t *p, uint32_t v)
+{
+    sched_trace_put_u16(p, (uint16_t)v);
+    sched_trace_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t sched_trace_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t sched_trace_get_u32(const uint8_t *p)
+{
+    return sched_trace_get_u16(p) | ((uint32_t)sched_trace_get_u16(p + 2) << 16);
+}
+
+static inline void sched_trace_put_event(uint8_t *p, const sched_trace_event_t *e)
+{
+    sched_trace_put_u32(p, e->time);
+    p[4] = e->type;
+    p[5] = e->object;
+    sched_trace_put_u16(p + 6, e->id);
+}
+
+static inline void sched_trace_get_event(const uint8_t *p, sched_trace_event_t *e)
+{
+    e->time = sched_trace_get_u32(p);
+    e->type = p[4];
+    e->object = p[5];
+    e->id = sched_trace_get_u16(p + 6);
+}
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,331 @@
+//Scheduler trace recorder: kernel hooks -> per-core ring -> dump (see sched_trace.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sched_trace.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "esp_timer.h"
+#else
+#include <time.h>
+#define IRAM_ATTR
+#endif
+
+#if configUSE_TRACE_FACILITY != 1
+#error "sched_trace needs configUSE_TRACE_FACILITY (CONFIG_FREERTOS_USE_TRACE_FACILITY on ESP-IDF)"
+#endif
+
+#if defined(configNUMBER_OF_CORES)
+#define SCHED_TRACE_CORES   configNUMBER_OF_CORES
+#elif defined(portNUM_PROCESSORS)
+#define SCHED_TRACE_CORES   portNUM_PROCESSORS
+#else
+#define SCHED_TRACE_CORES   1
+#endif
+
+#ifdef ESP_PLATFORM
+#define CLOCK_HZ            1000000u        //esp_timer: 1 us
+#else
+#define CLOCK_HZ            10000000u       //CLOCK_MONOTONIC in 100 ns units
+#endif
+
+_Static_assert((SCHED_TRACE_EVENTS & (SCHED_TRACE_EVENTS - 1)) == 0, "SCHED_TRACE_EVENTS must be a power of two");
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> head counts every event offered to the ring since sched_trace_start(). A writer reserves its slot with
+   one fetch_add, so an interrupt recording in the middle of a hook gets the next slot instead of sharing
+   one. One-shot: slots from SCHED_TRACE_EVENTS on are not written (counted as lost); flight recorder:
+   slot = head modulo the ring, the oldest events are overwritten (also counted as lost).
+>> Switch events carry the task's trace number (uxTaskGetTaskNumber), not xTaskNumber from
+   uxTaskGetSystemState: the kernel keeps the latter in a field the hooks cannot read, and leaves the
+   former at 0 until someone calls vTaskSetTaskNumber(). The switch hook therefore numbers every task the
+   first time it records it (1, 2, ...), and the dump names tasks by the same uxTaskGetTaskNumber.
+>> The dump reads the rings only after recording stopped. In flight-recorder mode it leaves out the oldest
+   event of a wrapped ring: a writer that passed the flag check just before the stop may still be
+   overwriting it.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct {
+    atomic_uint head;
+    sched_trace_event_t events[SCHED_TRACE_EVENTS];
+} ring_t;
+
+typedef struct {
+    uint16_t id;
+    const char *name;
+} queue_name_t;
+
+static ring_t rings[SCHED_TRACE_CORES];
+static atomic_uint recording;
+static sched_trace_mode_t trace_mode;
+
+static queue_name_t queue_names[SCHED_TRACE_MAX_NAMES];
+static atomic_uint names_used;
+static atomic_uint tasks_numbered;
+
+static TaskHandle_t capture_task;
+
+
+static inline uint32_t IRAM_ATTR clock_now(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * CLOCK_HZ + (uint64_t)ts.tv_nsec / (1000000000u / CLOCK_HZ));
+#endif
+}
+
+static inline uint32_t IRAM_ATTR current_core(void)
+{
+#if SCHED_TRACE_CORES > 1
+    return (uint32_t)xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+//Time before the slot: an interrupt recording in between gets a later slot AND a later time
+static void IRAM_ATTR record(uint8_t type, uint8_t object, uint16_t id)
+{
+    uint32_t now = clock_now();
+    ring_t *r = &rings[current_core()];
+    unsigned slot = atomic_fetch_add_explicit(&r->head, 1, memory_order_relaxed);
+    if (trace_mode == SCHED_TRACE_ONE_SHOT && slot >= SCHED_TRACE_EVENTS) {
+        return;
+    }
+    r->events[slot & (SCHED_TRACE_EVENTS - 1u)] = (sched_trace_event_t){
+        .time = now, .type = type, .object = object, .id = id,
+    };
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Called by the trace macros in sched_trace_hooks.h
+
+//Trace number of "task", handed out on first use (only the core running the task gets here)
+static inline uint16_t IRAM_ATTR task_id(TaskHandle_t task)
+{
+    UBaseType_t id = uxTaskGetTaskNumber(task);
+    if (id == 0) {
+        id = atomic_fetch_add_explicit(&tasks_numbered, 1, memory_order_relaxed) % UINT16_MAX + 1u;
+        vTaskSetTaskNumber(task, id);
+    }
+    return (uint16_t)id;
+}
+
+void IRAM_ATTR sched_trace_hook_switch(uint8_t type)
+{
+    if (atomic_load_explicit(&recording, memory_order_relaxed)) {
+        record(type, 0, task_id(xTaskGetCurrentTaskHandle()));
+    }
+}
+
+void IRAM_ATTR sched_trace_hook_queue(uint8_t type, void *queue)
+{
+    if (atomic_load_explicit(&recording, memory_order_relaxed)) {
+        QueueHandle_t q = (QueueHandle_t)queue;
+        record(type, ucQueueGetQueueType(q), (uint16_t)uxQueueGetQueueNumber(q));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t sched_trace_start(sched_trace_mode_t mode)
+{
+#ifndef SCHED_TRACE_HOOKS
+    (void)mode;
+    return pdFAIL;                          //the kernel would never call the hooks
+#else
+    atomic_store(&recording, 0);
+    trace_mode = mode;
+    for (uint32_t c = 0; c < SCHED_TRACE_CORES; c++) {
+        atomic_store(&rings[c].head, 0);
+    }
+    atomic_store(&recording, 1);
+    return pdPASS;
+#endif
+}
+
+void sched_trace_stop(void)
+{
+    atomic_store(&recording, 0);
+}
+
+BaseType_t sched_trace_name_queue(QueueHandle_t queue, const char *name)
+{
+    if (queue == NULL || name == NULL) {
+        return pdFAIL;
+    }
+    unsigned slot = atomic_fetch_add(&names_used, 1);
+    if (slot >= SCHED_TRACE_MAX_NAMES) {
+        atomic_fetch_sub(&names_used, 1);
+        return pdFAIL;
+    }
+    queue_names[slot] = (queue_name_t){ .id = (uint16_t)(slot + 1u), .name = name };
+    vQueueSetQueueNumber(queue, slot + 1u);
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void write_name(sched_trace_write_t write, void *arg, uint8_t kind, uint16_t id, const char *name)
+{
+    uint8_t entry[4];
+    size_t len = strnlen(name, UINT8_MAX);
+    entry[0] = kind;
+    sched_trace_put_u16(&entry[1], id);
+    entry[3] = (uint8_t)len;
+    write(entry, sizeof(entry), arg);
+    write(name, len, arg);
+}
+
+size_t sched_trace_dump(sched_trace_write_t write, void *arg)
+{
+    sched_trace_stop();
+
+    //Task names: the tasks alive now
+    UBaseType_t room = uxTaskGetNumberOfTasks() + 4u;
+    TaskStatus_t *tasks = pvPortMalloc(room * sizeof(TaskStatus_t));
+    UBaseType_t task_count = (tasks != NULL) ? uxTaskGetSystemState(tasks, room, NULL) : 0;
+    if (task_count == 0) {
+        vPortFree(tasks);
+        return 0;
+    }
+
+    size_t total = 0;
+    uint8_t header[SCHED_TRACE_HEADER_SIZE];
+    memcpy(header, SCHED_TRACE_MAGIC, SCHED_TRACE_MAGIC_LEN);
+    header[4] = SCHED_TRACE_VERSION;
+    header[5] = SCHED_TRACE_CORES;
+    sched_trace_put_u16(&header[6], 0);
+    sched_trace_put_u32(&header[8], CLOCK_HZ);
+    write(header, sizeof(header), arg);
+    total += sizeof(header);
+
+    for (uint32_t c = 0; c < SCHED_TRACE_CORES; c++) {
+        const ring_t *r = &rings[c];
+        uint32_t head = atomic_load(&r->head);
+        uint32_t count = (head < SCHED_TRACE_EVENTS) ? head : SCHED_TRACE_EVENTS;
+        uint32_t first = 0;
+        if (trace_mode == SCHED_TRACE_FLIGHT_RECORDER && head > SCHED_TRACE_EVENTS) {
+            first = head - SCHED_TRACE_EVENTS + 1u;          //oldest slot left out, see above
+            count--;
+        }
+        uint8_t core_header[SCHED_TRACE_CORE_HEADER];
+        sched_trace_put_u32(&core_header[0], count);
+        sched_trace_put_u32(&core_header[4], head - count);
+        write(core_header, sizeof(core_header), arg);
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t ev[SCHED_TRACE_EVENT_SIZE];
+            sched_trace_put_event(ev, &r->events[(first + i) & (SCHED_TRACE_EVENTS - 1u)]);
+            write(ev, sizeof(ev), arg);
+        }
+        total += sizeof(core_header) + (size_t)count * SCHED_TRACE_EVENT_SIZE;
+    }
+
+    //Tasks never recorded have no trace number (0) and nothing to name
+    unsigned queues = atomic_load(&names_used);
+    queues = (queues < SCHED_TRACE_MAX_NAMES) ? queues : SCHED_TRACE_MAX_NAMES;
+    UBaseType_t numbered = 0;
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        numbered += (uxTaskGetTaskNumber(tasks[i].xHandle) != 0);
+    }
+    uint8_t count[2];
+    sched_trace_put_u16(count, (uint16_t)(numbered + queues));
+    write(count, sizeof(count), arg);
+    total += sizeof(count);
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        UBaseType_t id = uxTaskGetTaskNumber(tasks[i].xHandle);
+        if (id != 0) {
+            write_name(write, arg, SCHED_TRACE_NAME_TASK, (uint16_t)id, tasks[i].pcTaskName);
+            total += 4u + strnlen(tasks[i].pcTaskName, UINT8_MAX);
+        }
+    }
+    for (unsigned i = 0; i < queues; i++) {
+        write_name(write, arg, SCHED_TRACE_NAME_QUEUE, queue_names[i].id, queue_names[i].name);
+        total += 4u + strnlen(queue_names[i].name, UINT8_MAX);
+    }
+    vPortFree(tasks);
+    return total;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Hex lines: the dump is collected into SCHED_TRACE_HEX_BYTES pieces so every line is complete
+
+typedef struct {
+    uint8_t buf[SCHED_TRACE_HEX_BYTES];
+    size_t used;
+} hex_writer_t;
+
+static void hex_flush(hex_writer_t *w)
+{
+    char line[2 * SCHED_TRACE_HEX_BYTES + 2];
+    for (size_t i = 0; i < w->used; i++) {
+        snprintf(&line[2 * i], 3, "%02x", w->buf[i]);
+    }
+    printf(":%s\n", line);
+    w->used = 0;
+}
+
+static void hex_write(const void *data, size_t len, void *arg)
+{
+    hex_writer_t *w = arg;
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        w->buf[w->used++] = p[i];
+        if (w->used == SCHED_TRACE_HEX_BYTES) {
+            hex_flush(w);
+        }
+    }
+}
+
+void sched_trace_print(void)
+{
+    static hex_writer_t writer;             //one printer at a time: sched_trace_capture() or the caller
+    writer.used = 0;
+    printf("//>>> sched_trace\n");
+    size_t bytes = sched_trace_dump(hex_write, &writer);
+    if (writer.used) {
+        hex_flush(&writer);
+    }
+    printf("//<<< sched_trace %u bytes\n", (unsigned)bytes);
+}
+
+static void capture_task_fn(void *pv)
+{
+    vTaskDelay(pdMS_TO_TICKS((uint32_t)(uintptr_t)pv));
+    sched_trace_print();
+    capture_task = NULL;
+    vTaskDelete(NULL);
+}
+
+BaseType_t sched_trace_capture(sched_trace_mode_t mode, uint32_t duration_ms)
+{
+    if (duration_ms == 0 || capture_task != NULL || sched_trace_start(mode) != pdPASS) {
+        return pdFAIL;
+    }
+    if (xTaskCreate(capture_task_fn, "sched_trace", SCHED_TRACE_TASK_STACK, (void *)(uintptr_t)duration_ms,
+                    SCHED_TRACE_TASK_PRIORITY, &capture_task) != pdPASS) {
+        sched_trace_stop();
+        capture_task = NULL;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
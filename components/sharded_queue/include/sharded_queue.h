@@ -0,0 +1,122 @@
+//Multi-producer / multi-consumer queue split into one shard per core, consumers steal from remote shards
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+One FreeRTOS queue shared by producers on both cores is one lock: every send and every receive takes the
+queue's spinlock with interrupts masked, so the two cores queue up behind each other and the cache line
+of the queue moves back and forth with every item. Splitting the queue into one shard per core lets
+producers on core 0 and core 1 send at the same time without meeting; consumers only touch a remote
+shard when their own one is empty.
+
+Flow:
+1) sq = sharded_queue_create(&(sharded_queue_config_t){ .depth = 16, .item_size = sizeof(item_t) })
+2) Producer: sharded_queue_send(sq, &item, ticks)  - into the producer's home shard
+3) Consumer: sharded_queue_receive(sq, &item, ticks) - home shard first, then the others (steal); blocks
+   only when every shard is empty
+4) sharded_queue_get(sq, &stats): sent / received / stolen / consumer sleeps / failed sends
+
+Home shard:
+>> A task pinned to a core (xTaskCreatePinnedToCore) uses that core's shard.
+>> An unpinned task gets a fixed shard picked from its handle - not the core it happens to run on, which
+   changes, so that everything one producer sends stays in one shard.
+>> sharded_queue_send_to / _receive_from take the shard explicitly (e.g. several producers spread over
+   the shards on the single-core host).
+
+Order:
+>> Every shard is a FIFO queue and a producer only ever writes to its home shard, so the items of one
+   producer are received in the order they were sent, whichever consumer takes them. There is no order
+   between items of different producers.
+
+Rules:
+>> A producer blocks when ITS shard is full, even if another shard has room (that keeps the order).
+>> A blocked consumer sleeps on its task notification (index 0), like spsc_ring: do not use that index
+   for anything else in consumer tasks. Up to SHARDED_QUEUE_MAX_SLEEPERS consumers sleep at once,
+   further ones poll once per tick.
+>> Not from ISRs.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef SHARDED_QUEUE_MAX_SHARDS
+#define SHARDED_QUEUE_MAX_SHARDS    4
+#endif
+#ifndef SHARDED_QUEUE_MAX_SLEEPERS
+#define SHARDED_QUEUE_MAX_SLEEPERS  16
+#endif
+#ifndef SHARDED_QUEUE_CACHE_LINE
+#define SHARDED_QUEUE_CACHE_LINE    64
+#endif
+
+typedef struct sharded_queue sharded_queue_t;
+
+typedef struct {
+    uint8_t shards;                         //0 = one per core (configNUMBER_OF_CORES)
+    UBaseType_t depth;                      //items per shard
+    UBaseType_t item_size;
+} sharded_queue_config_t;
+
+typedef struct {
+    uint8_t shards;
+    uint32_t sent;
+    uint32_t received;
+    uint32_t stolen;                        //received from a shard other than the consumer's home
+    uint32_t sleeps;                        //a consumer found every shard empty and blocked
+    uint32_t full;                          //sends that timed out on a full shard
+} sharded_queue_stats_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : sharded_queue_create
+>> Description: Create the shards (one xQueueCreate(depth, item_size) each) and the sleeper table.
+>> Returns: handle, or NULL if config is NULL, a size is 0, shards > SHARDED_QUEUE_MAX_SHARDS or out of memory.
+*/
+sharded_queue_t *sharded_queue_create(const sharded_queue_config_t *config);
+
+//Delete the shards and the handle. No task may be blocked on it.
+void sharded_queue_delete(sharded_queue_t *sq);
+
+//Home shard of the calling task (see "Home shard" above).
+uint8_t sharded_queue_home(const sharded_queue_t *sq);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : sharded_queue_send
+>> Description: Copy the item into the caller's home shard (xQueueSend semantics: wait up to "ticks" for
+                room in that shard) and wake one sleeping consumer, preferring one whose home it is.
+>> Returns: pdPASS, or errQUEUE_FULL if the shard stayed full.
+*/
+BaseType_t sharded_queue_send(sharded_queue_t *sq, const void *item, TickType_t ticks);
+BaseType_t sharded_queue_send_to(sharded_queue_t *sq, uint8_t shard, const void *item, TickType_t ticks);
+
+/*
+Function : sharded_queue_receive
+>> Description: Take the oldest item of the caller's home shard; if it is empty, of the next non-empty shard.
+                With every shard empty, wait up to "ticks" for any producer.
+>> Returns: pdPASS, or errQUEUE_EMPTY if nothing arrived in time.
+*/
+BaseType_t sharded_queue_receive(sharded_queue_t *sq, void *item, TickType_t ticks);
+BaseType_t sharded_queue_receive_from(sharded_queue_t *sq, uint8_t home, void *item, TickType_t ticks);
+
+//Items in all shards together / room for that many (depth x shards).
+UBaseType_t sharded_queue_count(const sharded_queue_t *sq);
+UBaseType_t sharded_queue_capacity(const sharded_queue_t *sq);
+
+void sharded_queue_get(const sharded_queue_t *sq, sharded_queue_stats_t *out);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,320 @@
+//Sharded multi-producer / multi-consumer queue (see sharded_queue.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sharded_queue.h"
+
+#if defined(configNUMBER_OF_CORES)
+#define SHARDED_QUEUE_CORES configNUMBER_OF_CORES
+#elif defined(portNUM_PROCESSORS)
+#define SHARDED_QUEUE_CORES portNUM_PROCESSORS
+#else
+#define SHARDED_QUEUE_CORES 1
+#endif
+
+#if SHARDED_QUEUE_MAX_SLEEPERS > 32
+#error "SHARDED_QUEUE_MAX_SLEEPERS: the sleeper masks are 32 bits"
+#endif
+
+
+/*
+---------------------------------------------------------------------------------------------------
+Memory layout:
+>> One cache line per shard: its FreeRTOS queue handle, a "pending" hint and the shard's counters. A
+   producer only writes the line (and the queue) of its own shard.
+>> The sleeper table (two masks + one slot per sleeping consumer) is only written when a consumer goes
+   to sleep or a producer wakes one.
+>> pvPortMalloc only guarantees portBYTE_ALIGNMENT, so the handle is placed at the first line boundary of
+   a block one line larger (as spsc_ring does).
+
+pending:
+The shard's item count as seen from outside the queue: +1 after a send, -1 after a receive. Consumers
+read it to skip empty shards without taking the queue's lock - on the ESP32 that lock is a spinlock
+with interrupts masked and, for a remote shard, a cache line owned by the other core. It may lag the
+queue by one operation; the queue itself decides, the hint only avoids pointless attempts.
+
+Sleeping without lost wake-ups (spsc_ring's handshake, per consumer slot):
+The consumer sets its bit in "sleeping", then re-reads every pending. The producer increments pending,
+then reads "sleeping". A full fence sits between the store and the load on both sides, so either the
+consumer sees the item or the producer sees the bit - and clears it with fetch_and, so exactly one
+producer notifies each sleeper.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct {
+    QueueHandle_t queue;
+    atomic_int pending;             //hint, see above
+    atomic_uint sent;
+    atomic_uint received;           //by a consumer whose home this is
+    atomic_uint stolen;             //by a consumer of another shard
+    atomic_uint full;
+} sq_shard_t;
+
+typedef struct {
+    _Atomic(TaskHandle_t) task;
+    atomic_uint home;
+} sq_sleeper_t;
+
+struct sharded_queue {
+    union { sq_shard_t s; uint8_t line[SHARDED_QUEUE_CACHE_LINE]; } shard[SHARDED_QUEUE_MAX_SHARDS];
+    atomic_uint claimed;            //bit i: slot[i] belongs to a consumer on its way to sleep
+    atomic_uint sleeping;           //bit i: slot[i]'s task is (about to be) blocked, not yet woken
+    atomic_uint sleeps;
+    sq_sleeper_t slot[SHARDED_QUEUE_MAX_SLEEPERS];
+    UBaseType_t depth;
+    uint8_t shards;
+    void *block;                    //what pvPortMalloc returned, for vPortFree
+};
+
+_Static_assert(sizeof(sq_shard_t) <= SHARDED_QUEUE_CACHE_LINE, "sq_shard_t must fit in one cache line");
+_Static_assert((SHARDED_QUEUE_CACHE_LINE & (SHARDED_QUEUE_CACHE_LINE - 1)) == 0,
+               "SHARDED_QUEUE_CACHE_LINE must be a power of two");
+
+
+//-------------------------------------------------------------------------------------------------
+sharded_queue_t *sharded_queue_create(const sharded_queue_config_t *config)
+{
+    if (config == NULL || config->depth == 0 || config->item_size == 0) {
+        return NULL;
+    }
+    uint8_t shards = config->shards ? config->shards : (uint8_t)SHARDED_QUEUE_CORES;
+    if (shards > SHARDED_QUEUE_MAX_SHARDS) {
+        return NULL;
+    }
+
+    uint8_t *block = pvPortMalloc(SHARDED_QUEUE_CACHE_LINE - 1u + sizeof(sharded_queue_t));
+    if (block == NULL) {
+        return NULL;
+    }
+    sharded_queue_t *sq = (sharded_queue_t *)(((uintptr_t)block + SHARDED_QUEUE_CACHE_LINE - 1u) &
+                                              ~(uintptr_t)(SHARDED_QUEUE_CACHE_LINE - 1u));
+    memset(sq, 0, sizeof(sharded_queue_t));
+    sq->block = block;
+    sq->shards = shards;
+    sq->depth = config->depth;
+    for (uint8_t i = 0; i < shards; i++) {
+        sq->shard[i].s.queue = xQueueCreate(config->depth, config->item_size);
+        if (sq->shard[i].s.queue == NULL) {
+            sharded_queue_delete(sq);
+            return NULL;
+        }
+    }
+    return sq;
+}
+
+void sharded_queue_delete(sharded_queue_t *sq)
+{
+    if (sq == NULL) {
+        return;
+    }
+    for (uint8_t i = 0; i < sq->shards; i++) {
+        if (sq->shard[i].s.queue != NULL) {
+            vQueueDelete(sq->shard[i].s.queue);
+        }
+    }
+    vPortFree(sq->block);
+}
+
+uint8_t sharded_queue_home(const sharded_queue_t *sq)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+#if defined(ESP_PLATFORM) && (SHARDED_QUEUE_CORES > 1)
+    BaseType_t core = xTaskGetCoreID(self);          //tskNO_AFFINITY when not pinned
+    if (core != tskNO_AFFINITY) {
+        return (uint8_t)((UBaseType_t)core % sq->shards);
+    }
+#endif
+    //Unpinned: the TCB address (Fibonacci hash) - stable for the task's lifetime
+    uint32_t h = (uint32_t)(uintptr_t)self * 2654435761u;
+    return (uint8_t)((h >> 16) % sq->shards);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Wake one sleeping consumer, preferably one whose home is "shard". Called right after pending++.
+static void sq_wake(sharded_queue_t *sq, uint8_t shard)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t mask = atomic_load_explicit(&sq->sleeping, memory_order_relaxed);
+    while (mask != 0) {
+        uint32_t pick = mask & (~mask + 1u);        //lowest sleeper, unless a local one follows
+        for (uint32_t m = mask; m != 0; m &= m - 1u) {
+            uint32_t i = (uint32_t)__builtin_ctz(m);
+            if (atomic_load_explicit(&sq->slot[i].home, memory_order_relaxed) == shard) {
+                pick = 1u << i;
+                break;
+            }
+        }
+        if (atomic_fetch_and_explicit(&sq->sleeping, ~pick, memory_order_acq_rel) & pick) {
+            xTaskNotifyGive(atomic_load_explicit(&sq->slot[__builtin_ctz(pick)].task, memory_order_relaxed));
+            return;
+        }
+        mask = atomic_load_explicit(&sq->sleeping, memory_order_relaxed);   //another producer was faster
+    }
+}
+
+//Receive without waiting: home shard first, then the others in order
+static BaseType_t sq_take(sharded_queue_t *sq, uint8_t home, void *item)
+{
+    for (uint8_t k = 0; k < sq->shards; k++) {
+        uint8_t i = (uint8_t)((home + k) % sq->shards);
+        sq_shard_t *s = &sq->shard[i].s;
+        if (atomic_load_explicit(&s->pending, memory_order_relaxed) <= 0) {
+            continue;
+        }
+        if (xQueueReceive(s->queue, item, 0) == pdPASS) {
+            atomic_fetch_sub_explicit(&s->pending, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(k == 0 ? &s->received : &s->stolen, 1, memory_order_relaxed);
+            return pdPASS;
+        }
+    }
+    return pdFAIL;
+}
+
+static BaseType_t sq_any_pending(const sharded_queue_t *sq)
+{
+    for (uint8_t i = 0; i < sq->shards; i++) {
+        if (atomic_load_explicit(&sq->shard[i].s.pending, memory_order_relaxed) > 0) {
+            return pdTRUE;
+        }
+    }
+    return pdFALSE;
+}
+
+//Claim a free sleeper slot; -1 if all are taken
+static int sq_claim(sharded_queue_t *sq)
+{
+    uint32_t claimed = atomic_load_explicit(&sq->claimed, memory_order_relaxed);
+    for (;;) {
+        uint32_t free_mask = ~claimed & (uint32_t)((1ull << SHARDED_QUEUE_MAX_SLEEPERS) - 1u);
+        if (free_mask == 0) {
+            return -1;
+        }
+        uint32_t bit = free_mask & (~free_mask + 1u);
+        if (atomic_compare_exchange_weak_explicit(&sq->claimed, &claimed, claimed | bit, memory_order_acquire,
+                                                  memory_order_relaxed)) {
+            return __builtin_ctz(bit);
+        }
+    }
+}
+
+//Block until a producer wakes us or the timeout expires; pdFALSE = timed out.
+static BaseType_t sq_sleep(sharded_queue_t *sq, uint8_t home, TimeOut_t *timeout, TickType_t *ticks_to_wait)
+{
+    int i = sq_claim(sq);
+    if (i < 0) {
+        //More consumers blocked than slots: poll once per tick
+        if (xTaskCheckForTimeOut(timeout, ticks_to_wait) == pdTRUE) {
+            return pdFALSE;
+        }
+        vTaskDelay(1);
+        return pdTRUE;
+    }
+
+    const uint32_t bit = 1u << i;
+    atomic_store_explicit(&sq->slot[i].task, xTaskGetCurrentTaskHandle(), memory_order_relaxed);
+    atomic_store_explicit(&sq->slot[i].home, home, memory_order_relaxed);
+    atomic_fetch_or_explicit(&sq->sleeping, bit, memory_order_seq_cst);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    BaseType_t result = pdTRUE;
+    if (sq_any_pending(sq) == pdFALSE) {
+        if (xTaskCheckForTimeOut(timeout, ticks_to_wait) == pdTRUE) {
+            result = pdFALSE;
+        } else {
+            atomic_fetch_add_explicit(&sq->sleeps, 1, memory_order_relaxed);
+            ulTaskNotifyTake(pdTRUE, *ticks_to_wait);
+        }
+    }
+    //A producer that cleared the bit after we stopped waiting leaves one notification behind:
+    //the next sleep returns at once and re-checks - harmless.
+    atomic_fetch_and_explicit(&sq->sleeping, ~bit, memory_order_relaxed);
+    atomic_fetch_and_explicit(&sq->claimed, ~bit, memory_order_release);
+    return result;              //woken (or spurious) -> caller re-checks the shards
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t sharded_queue_send_to(sharded_queue_t *sq, uint8_t shard, const void *item, TickType_t ticks)
+{
+    configASSERT(shard < sq->shards);
+    sq_shard_t *s = &sq->shard[shard].s;
+    if (xQueueSend(s->queue, item, ticks) != pdPASS) {
+        atomic_fetch_add_explicit(&s->full, 1, memory_order_relaxed);
+        return errQUEUE_FULL;
+    }
+    atomic_fetch_add_explicit(&s->pending, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->sent, 1, memory_order_relaxed);
+    sq_wake(sq, shard);
+    return pdPASS;
+}
+
+BaseType_t sharded_queue_send(sharded_queue_t *sq, const void *item, TickType_t ticks)
+{
+    return sharded_queue_send_to(sq, sharded_queue_home(sq), item, ticks);
+}
+
+BaseType_t sharded_queue_receive_from(sharded_queue_t *sq, uint8_t home, void *item, TickType_t ticks)
+{
+    configASSERT(home < sq->shards);
+    TimeOut_t timeout;
+    BaseType_t timeout_set = pdFALSE;
+
+    while (sq_take(sq, home, item) != pdPASS) {
+        if (ticks == 0) {
+            return errQUEUE_EMPTY;
+        }
+        if (timeout_set == pdFALSE) {
+            vTaskSetTimeOutState(&timeout);
+            timeout_set = pdTRUE;
+        }
+        if (sq_sleep(sq, home, &timeout, &ticks) == pdFALSE) {
+            return errQUEUE_EMPTY;
+        }
+    }
+    return pdPASS;
+}
+
+BaseType_t sharded_queue_receive(sharded_queue_t *sq, void *item, TickType_t ticks)
+{
+    return sharded_queue_receive_from(sq, sharded_queue_home(sq), item, ticks);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+UBaseType_t sharded_queue_count(const sharded_queue_t *sq)
+{
+    UBaseType_t n = 0;
+    for (uint8_t i = 0; i < sq->shards; i++) {
+        n += uxQueueMessagesWaiting(sq->shard[i].s.queue);
+    }
+    return n;
+}
+
+UBaseType_t sharded_queue_capacity(const sharded_queue_t *sq)
+{
+    return sq->depth * sq->shards;
+}
+
+void sharded_queue_get(const sharded_queue_t *sq, sharded_queue_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->shards = sq->shards;
+    for (uint8_t i = 0; i < sq->shards; i++) {
+        const sq_shard_t *s = &sq->shard[i].s;
+        out->sent += atomic_load_explicit(&s->sent, memory_order_relaxed);
+        out->full += atomic_load_explicit(&s->full, memory_order_relaxed);
+        uint32_t stolen = atomic_load_explicit(&s->stolen, memory_order_relaxed);
+        out->received += atomic_load_explicit(&s->received, memory_order_relaxed) + stolen;
+        out->stolen += stolen;
+    }
+    out->sleeps = atomic_load_explicit(&sq->sleeps, memory_order_relaxed);
+}
+//-------------------------------------------------------------------------------------------------
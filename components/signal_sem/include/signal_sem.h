@@ -0,0 +1,73 @@
+//Instrumented signalling semaphore: binary or counting up to a ceiling, with lost-give accounting
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+xSemaphoreGive() on a binary semaphore that is already given returns pdFAIL and the event is gone: if the
+consumers fall behind for a moment, two events become one and nobody notices.
+
+>> ceiling = 1 : binary semaphore (xSemaphoreCreateBinary), a give while one is pending is lost (coalesced)
+>> ceiling = N : counting semaphore (xSemaphoreCreateCounting(N, 0)), up to N events wait for the takers;
+                 a burst of up to N gives is processed later instead of being lost
+Either way every give that did not count is counted as lost, so the loss is visible.
+
+Choosing the ceiling: the longest burst the takers cannot absorb at once. More headroom does not help with
+sustained overload (give rate > take rate): the semaphore just sits at the ceiling and loses the excess.
+
+signal_sem_give() / signal_sem_take() cost one xSemaphoreGive / xSemaphoreTake plus a few relaxed
+atomic increments. signal_sem_give_from_isr() is safe from interrupts.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct signal_sem signal_sem_t;
+
+typedef struct {
+    UBaseType_t ceiling;
+    UBaseType_t pending;                    //gives waiting for a take right now
+    UBaseType_t high_water;                 //largest number of pending gives seen
+    uint32_t gives;                         //signal_sem_give() calls (lost ones included)
+    uint32_t lost;                          //gives that found the semaphore at its ceiling
+    uint32_t takes;                         //successful takes
+} signal_sem_stats_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : signal_sem_create
+>> Description: Create the semaphore, empty. ceiling 1 = binary, > 1 = counting.
+>> Returns: handle, or NULL if ceiling is 0 or memory is exhausted.
+*/
+signal_sem_t *signal_sem_create(UBaseType_t ceiling);
+
+void signal_sem_delete(signal_sem_t *s);
+
+//Underlying FreeRTOS semaphore, for APIs that need the raw handle.
+SemaphoreHandle_t signal_sem_handle(const signal_sem_t *s);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//xSemaphoreGive / xSemaphoreGiveFromISR / xSemaphoreTake with accounting: same parameters and results
+//(give returns pdFAIL when the event is lost).
+BaseType_t signal_sem_give(signal_sem_t *s);
+BaseType_t signal_sem_give_from_isr(signal_sem_t *s, BaseType_t *higher_priority_task_woken);
+BaseType_t signal_sem_take(signal_sem_t *s, TickType_t ticks_to_wait);
+//-------------------------------------------------------------------------------------------------
+
+
+//Copy the counters (each field is read atomically on its own).
+void signal_sem_get(const signal_sem_t *s, signal_sem_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
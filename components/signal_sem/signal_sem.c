@@ -0,0 +1,114 @@
+//Instrumented signalling semaphore (see signal_sem.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "signal_sem.h"
+#include "relaxed_atomic.h"
+
+struct signal_sem {
+    SemaphoreHandle_t sem;
+    UBaseType_t ceiling;
+    atomic_uint high_water;
+    atomic_uint gives;
+    atomic_uint lost;
+    atomic_uint takes;
+};
+
+
+//Pending count estimated from the counters (no second semaphore lock per give), see queue_stats.c
+static void update_high_water(signal_sem_t *s)
+{
+    unsigned pending = relaxed_load(&s->gives) - relaxed_load(&s->lost) - relaxed_load(&s->takes);
+    if (pending > s->ceiling) {
+        pending = s->ceiling;               //a take counted late, clamp to what is possible
+    }
+    unsigned seen = relaxed_load(&s->high_water);
+    while (pending > seen &&
+           !atomic_compare_exchange_weak_explicit(&s->high_water, &seen, pending,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static BaseType_t account_give(signal_sem_t *s, BaseType_t result)
+{
+    if (result == pdPASS) {
+        update_high_water(s);
+    } else {
+        relaxed_add(&s->lost, 1);
+    }
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+signal_sem_t *signal_sem_create(UBaseType_t ceiling)
+{
+    if (ceiling == 0) {
+        return NULL;
+    }
+    signal_sem_t *s = pvPortMalloc(sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->sem = (ceiling == 1) ? xSemaphoreCreateBinary() : xSemaphoreCreateCounting(ceiling, 0);
+    if (s->sem == NULL) {
+        vPortFree(s);
+        return NULL;
+    }
+    s->ceiling = ceiling;
+    atomic_init(&s->high_water, 0);
+    atomic_init(&s->gives, 0);
+    atomic_init(&s->lost, 0);
+    atomic_init(&s->takes, 0);
+    return s;
+}
+
+void signal_sem_delete(signal_sem_t *s)
+{
+    vSemaphoreDelete(s->sem);
+    vPortFree(s);
+}
+
+SemaphoreHandle_t signal_sem_handle(const signal_sem_t *s)
+{
+    return s->sem;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//"gives" is counted before the give: a taker it wakes (and that may preempt us) must never see takes > gives
+BaseType_t signal_sem_give(signal_sem_t *s)
+{
+    relaxed_add(&s->gives, 1);
+    return account_give(s, xSemaphoreGive(s->sem));
+}
+
+BaseType_t signal_sem_give_from_isr(signal_sem_t *s, BaseType_t *higher_priority_task_woken)
+{
+    relaxed_add(&s->gives, 1);
+    return account_give(s, xSemaphoreGiveFromISR(s->sem, higher_priority_task_woken));
+}
+
+BaseType_t signal_sem_take(signal_sem_t *s, TickType_t ticks_to_wait)
+{
+    BaseType_t result = xSemaphoreTake(s->sem, ticks_to_wait);
+    if (result == pdPASS) {
+        relaxed_add(&s->takes, 1);
+    }
+    return result;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+void signal_sem_get(const signal_sem_t *s, signal_sem_stats_t *out)
+{
+    out->ceiling = s->ceiling;
+    out->pending = uxSemaphoreGetCount(s->sem);
+    out->high_water = relaxed_load(&s->high_water);
+    out->gives = relaxed_load(&s->gives);
+    out->lost = relaxed_load(&s->lost);
+    out->takes = relaxed_load(&s->takes);
+}
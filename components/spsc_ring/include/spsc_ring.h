@@ -0,0 +1,85 @@
+//Lock-free single-producer / single-consumer ring buffer
+//Drop-in alternative to a FreeRTOS queue when exactly ONE task sends and exactly ONE task receives.
+
+#pragma once
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why a ring buffer instead of xQueueSend / xQueueReceive?
+Every queue call enters a critical section (interrupts masked, spinlock taken on dual-core ESP32),
+copies the item and walks the waiting-task lists, even when nobody is waiting.
+With one producer and one consumer that locking is not needed:
+>> The producer is the only writer of "head", the consumer is the only writer of "tail".
+>> Each side publishes its index with a release store and reads the other side with an acquire load.
+>> head and tail live on separate cache lines so the two cores do not fight over the same line.
+
+Blocking semantics are kept the same as the queue:
+>> Empty ring + ticks_to_wait > 0 : the consumer sleeps on its task notification (no busy-waiting).
+>> Full ring  + ticks_to_wait > 0 : the producer sleeps on its task notification.
+>> The other side only calls xTaskNotifyGive() when the sleeper flag is set, so the fast path
+   (nobody asleep) never touches the scheduler.
+
+Rules:
+1) Capacity must be a power of two (index wrap is a mask, not a modulo).
+2) Only one task may send and only one task may receive (SPSC). Not usable from ISRs.
+3) Blocking uses notification index 0 of the sending / receiving task.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef SPSC_RING_CACHE_LINE
+#define SPSC_RING_CACHE_LINE 64
+#endif
+
+typedef struct spsc_ring spsc_ring_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : spsc_ring_create
+>> Description: Allocate a ring that can hold "capacity" items of "item_size" bytes each.
+>> Parameters: capacity: number of slots, must be a power of two (2, 4, ... 1024 ...).
+>> item_size: size in bytes of one item, same meaning as uxItemSize of xQueueCreate.
+>> Returns: handle of the ring, or NULL if the capacity is invalid or memory is exhausted.
+*/
+spsc_ring_t *spsc_ring_create(size_t capacity, size_t item_size);
+
+//Free a ring created with spsc_ring_create(). No task may be blocked on it.
+void spsc_ring_delete(spsc_ring_t *ring);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : spsc_ring_send
+>> Description: Copy one item to the back of the ring (producer side only).
+>> ticks_to_wait: same as xQueueSend, 0 = return at once when full, portMAX_DELAY = wait forever.
+>> Returns: pdPASS if the item was stored, otherwise errQUEUE_FULL.
+*/
+BaseType_t spsc_ring_send(spsc_ring_t *ring, const void *item, TickType_t ticks_to_wait);
+
+/*
+Function : spsc_ring_receive
+>> Description: Copy the oldest item out of the ring (consumer side only).
+>> ticks_to_wait: same as xQueueReceive, 0 = return at once when empty, portMAX_DELAY = wait forever.
+>> Returns: pdPASS if an item was copied into "item", otherwise errQUEUE_EMPTY.
+*/
+BaseType_t spsc_ring_receive(spsc_ring_t *ring, void *item, TickType_t ticks_to_wait);
+//-------------------------------------------------------------------------------------------------
+
+
+//Number of items currently stored (a snapshot, like uxQueueMessagesWaiting).
+size_t spsc_ring_count(const spsc_ring_t *ring);
+
+//Total number of slots given at creation time.
+size_t spsc_ring_capacity(const spsc_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,210 @@
+//Lock-free single-producer / single-consumer ring buffer (see spsc_ring.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "spsc_ring.h"
+
+
+/*
+---------------------------------------------------------------------------------------------------
+Memory layout:
+>> Line 1 (producer side): head, cached copy of tail, producer task handle, producer sleep flag.
+>> Line 2 (consumer side): tail, cached copy of head, consumer task handle, consumer sleep flag.
+>> Line 3 (read only)    : mask, item size, pointer to the slots.
+>> pvPortMalloc only guarantees portBYTE_ALIGNMENT (8 bytes), so the block is one line larger and the ring
+   starts at the first line boundary inside it; the padding alone would not keep the two sides apart.
+
+head and tail are free-running counters; "head - tail" is the fill level and "index & mask" is the slot.
+The cached copies mean the producer only reads the consumer line when the ring LOOKS full
+(and the consumer only reads the producer line when it LOOKS empty).
+
+Sleeping without lost wake-ups:
+The sleeper sets its flag, then re-checks the ring. The other side updates its index, then checks the flag.
+A full memory fence sits between the store and the load on both sides, so at least one of the two
+always sees the other's store: either the sleeper sees the new item/space, or the waker sees the flag.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct {
+    atomic_size_t index;            //head (producer line) or tail (consumer line)
+    size_t other_cache;             //last value read of the other side's index
+    TaskHandle_t task;              //task that last slept on this side
+    atomic_uint waiting;            //1 while "task" is (about to be) blocked
+} spsc_side_t;
+
+struct spsc_ring {
+    union { spsc_side_t p; uint8_t p_line[SPSC_RING_CACHE_LINE]; };
+    union { spsc_side_t c; uint8_t c_line[SPSC_RING_CACHE_LINE]; };
+    size_t mask;
+    size_t item_size;
+    uint8_t *slots;
+    void *block;                    //what pvPortMalloc returned, for vPortFree
+};
+
+_Static_assert(sizeof(spsc_side_t) <= SPSC_RING_CACHE_LINE, "spsc_side_t must fit in one cache line");
+_Static_assert((SPSC_RING_CACHE_LINE & (SPSC_RING_CACHE_LINE - 1)) == 0, "SPSC_RING_CACHE_LINE must be a power of two");
+
+
+//-------------------------------------------------------------------------------------------------
+spsc_ring_t *spsc_ring_create(size_t capacity, size_t item_size)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 || item_size == 0) {
+        return NULL;            //capacity must be a power of two
+    }
+
+    uint8_t *block = pvPortMalloc(SPSC_RING_CACHE_LINE - 1u + sizeof(spsc_ring_t) + capacity * item_size);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    //First cache-line boundary inside the block
+    spsc_ring_t *ring = (spsc_ring_t *)(((uintptr_t)block + SPSC_RING_CACHE_LINE - 1u) &
+                                        ~(uintptr_t)(SPSC_RING_CACHE_LINE - 1u));
+    memset(ring, 0, sizeof(spsc_ring_t));
+    ring->block = block;
+    atomic_init(&ring->p.index, 0);
+    atomic_init(&ring->p.waiting, 0);
+    atomic_init(&ring->c.index, 0);
+    atomic_init(&ring->c.waiting, 0);
+    ring->mask = capacity - 1;
+    ring->item_size = item_size;
+    ring->slots = (uint8_t *)(ring + 1);        //slots follow the control block
+    return ring;
+}
+
+void spsc_ring_delete(spsc_ring_t *ring)
+{
+    if (ring != NULL) {
+        vPortFree(ring->block);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Wake the task sleeping on "side" (if any). Called right after publishing our own index.
+static inline void spsc_wake(spsc_side_t *side)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&side->waiting, memory_order_relaxed) != 0 &&
+        atomic_exchange_explicit(&side->waiting, 0, memory_order_acq_rel) != 0) {
+        xTaskNotifyGive(side->task);
+    }
+}
+
+//Block the calling task until woken or the timeout expires.
+//"ready" re-checks the ring after the sleep flag is visible; returns pdTRUE when waiting is over.
+static BaseType_t spsc_sleep(spsc_side_t *self, const spsc_ring_t *ring, BaseType_t (*ready)(const spsc_ring_t *),
+                             TimeOut_t *timeout, TickType_t *ticks_to_wait)
+{
+    self->task = xTaskGetCurrentTaskHandle();
+    atomic_store_explicit(&self->waiting, 1, memory_order_seq_cst);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (ready(ring) == pdTRUE) {
+        atomic_store_explicit(&self->waiting, 0, memory_order_relaxed);
+        return pdTRUE;
+    }
+    if (xTaskCheckForTimeOut(timeout, ticks_to_wait) == pdTRUE) {
+        atomic_store_explicit(&self->waiting, 0, memory_order_relaxed);
+        return pdFALSE;
+    }
+
+    ulTaskNotifyTake(pdTRUE, *ticks_to_wait);
+    atomic_store_explicit(&self->waiting, 0, memory_order_relaxed);
+    return pdTRUE;              //woken (or spurious) -> caller re-checks the ring
+}
+
+static BaseType_t spsc_has_space(const spsc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->p.index, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->c.index, memory_order_acquire);
+    return (head - tail) <= ring->mask ? pdTRUE : pdFALSE;
+}
+
+static BaseType_t spsc_has_data(const spsc_ring_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->p.index, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->c.index, memory_order_relaxed);
+    return head != tail ? pdTRUE : pdFALSE;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t spsc_ring_send(spsc_ring_t *ring, const void *item, TickType_t ticks_to_wait)
+{
+    const size_t head = atomic_load_explicit(&ring->p.index, memory_order_relaxed);
+    TimeOut_t timeout;
+    BaseType_t timeout_set = pdFALSE;
+
+    while ((head - ring->p.other_cache) > ring->mask) {
+        //Looks full: refresh the cached tail before deciding
+        ring->p.other_cache = atomic_load_explicit(&ring->c.index, memory_order_acquire);
+        if ((head - ring->p.other_cache) <= ring->mask) {
+            break;
+        }
+        if (ticks_to_wait == 0) {
+            return errQUEUE_FULL;
+        }
+        if (timeout_set == pdFALSE) {
+            vTaskSetTimeOutState(&timeout);
+            timeout_set = pdTRUE;
+        }
+        if (spsc_sleep(&ring->p, ring, spsc_has_space, &timeout, &ticks_to_wait) == pdFALSE) {
+            return errQUEUE_FULL;
+        }
+    }
+
+    memcpy(&ring->slots[(head & ring->mask) * ring->item_size], item, ring->item_size);
+    atomic_store_explicit(&ring->p.index, head + 1, memory_order_release);
+    spsc_wake(&ring->c);
+    return pdPASS;
+}
+
+BaseType_t spsc_ring_receive(spsc_ring_t *ring, void *item, TickType_t ticks_to_wait)
+{
+    const size_t tail = atomic_load_explicit(&ring->c.index, memory_order_relaxed);
+    TimeOut_t timeout;
+    BaseType_t timeout_set = pdFALSE;
+
+    while (ring->c.other_cache == tail) {
+        //Looks empty: refresh the cached head before deciding
+        ring->c.other_cache = atomic_load_explicit(&ring->p.index, memory_order_acquire);
+        if (ring->c.other_cache != tail) {
+            break;
+        }
+        if (ticks_to_wait == 0) {
+            return errQUEUE_EMPTY;
+        }
+        if (timeout_set == pdFALSE) {
+            vTaskSetTimeOutState(&timeout);
+            timeout_set = pdTRUE;
+        }
+        if (spsc_sleep(&ring->c, ring, spsc_has_data, &timeout, &ticks_to_wait) == pdFALSE) {
+            return errQUEUE_EMPTY;
+        }
+    }
+
+    memcpy(item, &ring->slots[(tail & ring->mask) * ring->item_size], ring->item_size);
+    atomic_store_explicit(&ring->c.index, tail + 1, memory_order_release);
+    spsc_wake(&ring->p);
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+size_t spsc_ring_count(const spsc_ring_t *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->c.index, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->p.index, memory_order_acquire);
+    return head - tail;
+}
+
+size_t spsc_ring_capacity(const spsc_ring_t *ring)
+{
+    return ring->mask + 1;
+}
@@ -0,0 +1,119 @@
+//Stack high-water-mark profiling: peak use per task over a run, recommended sizes as a generated header
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+xTaskCreate(task1, "task1", 2048, NULL, 1, NULL) - 2048 is a guess, made once and never checked. Too small
+corrupts memory, too big wastes RAM on every task. The kernel already knows the answer: new stacks are
+filled with a known pattern and uxTaskGetStackHighWaterMark() tells how much of it was never overwritten.
+
+Flow:
+1) Profiling build: create the tasks with a generous depth (STACK_PROFILE_RUN_DEPTH), register each one:
+       stack_profile_watch(handle, "task1", STACK_PROFILE_RUN_DEPTH, 2048);
+2) stack_profile_start(100, 60000): a low-priority task samples every watched stack every 100 ms; after
+   60 s it prints the table (peak use, when it last grew, recommended size) and the header below, then ends.
+3) Save the header as <project>/include/stack_sizes.h:
+       //>>> stack_sizes.h
+       #pragma once
+       #ifdef ESP_PLATFORM
+       #define STACK_DEPTH_task1           1120        //peak 680 bytes
+       #endif
+       //<<< stack_sizes.h
+4) Normal build: the example includes stack_sizes.h when it exists and creates task1 with
+   STACK_DEPTH_task1; tasks it does not list keep their default.
+
+Rules:
+>> Depths are in xTaskCreate() units: bytes on ESP-IDF, StackType_t words on the POSIX port. The header is
+   only valid on the platform it was measured on and says so (#ifdef ESP_PLATFORM / #ifndef ESP_PLATFORM).
+>> Recommended = peak + STACK_PROFILE_MARGIN_PERCENT + STACK_PROFILE_MARGIN_BYTES, rounded up to 16 bytes,
+   never below the port minimum (POSIX: PTHREAD_STACK_MIN, or the thread silently runs on another stack).
+>> A high-water mark only covers the paths that ran: exercise error paths and the longest log lines during
+   the run. A stack that still grew in the second half of the run is flagged "growing" - run longer.
+>> Do not delete a watched task while the sampler runs (the handle is read on every sample).
+>> The id becomes part of a macro name: letters, digits and '_' only.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef STACK_PROFILE_MAX_TASKS
+#define STACK_PROFILE_MAX_TASKS         16
+#endif
+
+#ifndef STACK_PROFILE_MARGIN_PERCENT
+#define STACK_PROFILE_MARGIN_PERCENT    25
+#endif
+
+#ifndef STACK_PROFILE_MARGIN_BYTES
+#define STACK_PROFILE_MARGIN_BYTES      256
+#endif
+
+//Depth to create watched tasks with in a profiling build: 8 KB on ESP-IDF, 64 KB on the POSIX port
+#ifndef STACK_PROFILE_RUN_DEPTH
+#define STACK_PROFILE_RUN_DEPTH         8192
+#endif
+
+#ifndef STACK_PROFILE_TASK_PRIORITY
+#define STACK_PROFILE_TASK_PRIORITY     1                   //just above idle
+#endif
+
+#ifndef STACK_PROFILE_TASK_STACK
+#define STACK_PROFILE_TASK_STACK        3072
+#endif
+
+typedef struct {
+    const char *id;
+    uint32_t depth;                         //as created, xTaskCreate() units
+    uint32_t baseline_depth;                //what the task gets without the profile (savings column)
+    uint32_t peak_bytes;                    //largest use seen
+    uint32_t grew_ms;                       //when the peak last grew, ms after stack_profile_start()
+    uint32_t recommended_depth;             //xTaskCreate() units, margin and port minimum included
+} stack_profile_result_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : stack_profile_watch
+>> Description: Registers a task. depth = the depth it was created with, baseline_depth = the one it
+                would get without a generated header (0 = depth). id must stay valid (a literal is fine).
+>> Returns: pdPASS, or pdFAIL if task or id is NULL or STACK_PROFILE_MAX_TASKS are registered already.
+*/
+BaseType_t stack_profile_watch(TaskHandle_t task, const char *id, uint32_t depth, uint32_t baseline_depth);
+
+/*
+Function : stack_profile_start
+>> Description: Creates the sampler task: stack_profile_sample() every sample_ms for duration_ms, then
+                stack_profile_print() + stack_profile_print_header(), then the sampler deletes itself.
+                Tasks may still be registered after the start.
+>> Returns: pdPASS, or pdFAIL if duration_ms is 0, the sampler runs already or could not be created.
+*/
+BaseType_t stack_profile_start(uint32_t sample_ms, uint32_t duration_ms);
+
+//One pass over every watched task (the sampler calls this; also usable without the sampler task).
+void stack_profile_sample(void);
+
+/*
+Function : stack_profile_get
+>> Description: Result for the task registered as id.
+>> Returns: pdPASS, or pdFAIL if no task is registered under that id.
+*/
+BaseType_t stack_profile_get(const char *id, stack_profile_result_t *out);
+
+//Table: depth, peak use, last growth, recommended size and saving against the baseline, in bytes.
+void stack_profile_print(void);
+
+//The generated header, between "//>>> stack_sizes.h" and "//<<< stack_sizes.h" lines.
+void stack_profile_print_header(void);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,249 @@
+//Stack high-water-mark profiling and stack_sizes.h generation (see stack_profile.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "stack_profile.h"
+#include "relaxed_atomic.h"
+
+#ifndef ESP_PLATFORM
+#include <limits.h>                         //PTHREAD_STACK_MIN
+#endif
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> Slots are handed out once and never reused (like queue_stats). The handle is stored last with
+   release order: the sampler skips slots whose handle is still NULL.
+>> Only the sampler (or whoever calls stack_profile_sample) writes peak / grew: relaxed load + store.
+---------------------------------------------------------------------------------------------------
+*/
+
+//Smallest stack the port really uses: below PTHREAD_STACK_MIN (+ the port's thread record at the top)
+//the POSIX port's pthread_attr_setstack() fails and the thread runs on a default pthread stack instead
+#ifdef ESP_PLATFORM
+#define MIN_STACK_BYTES     ((uint32_t)configMINIMAL_STACK_SIZE * sizeof(StackType_t))
+#else
+#define MIN_STACK_BYTES     ((uint32_t)PTHREAD_STACK_MIN + 256u)
+#endif
+
+typedef struct {
+    TaskHandle_t _Atomic task;
+    const char *id;
+    uint32_t depth;
+    uint32_t baseline_depth;
+    atomic_uint peak_bytes;
+    atomic_uint grew_ms;
+} watch_t;
+
+static watch_t watched[STACK_PROFILE_MAX_TASKS];
+static atomic_uint watched_used;
+static atomic_uint sampler_running;
+static atomic_uint samples;
+static atomic_uint last_sample_ms;
+static TickType_t start_tick;
+static uint32_t run_ms;
+
+
+static inline uint32_t depth_bytes(uint32_t depth)
+{
+    return depth * (uint32_t)sizeof(StackType_t);
+}
+
+//Peak + margin, rounded up to 16 bytes
+static uint32_t needed_bytes(uint32_t peak_bytes)
+{
+    uint32_t bytes = peak_bytes + peak_bytes * STACK_PROFILE_MARGIN_PERCENT / 100u + STACK_PROFILE_MARGIN_BYTES;
+    return (bytes + 15u) & ~15u;
+}
+
+//needed_bytes(), at least the port minimum; in xTaskCreate() units
+static uint32_t recommend_depth(uint32_t peak_bytes)
+{
+    uint32_t bytes = needed_bytes(peak_bytes);
+    bytes = (bytes < MIN_STACK_BYTES) ? MIN_STACK_BYTES : bytes;
+    return (bytes + (uint32_t)sizeof(StackType_t) - 1u) / (uint32_t)sizeof(StackType_t);
+}
+
+static uint32_t ms_since_start(void)
+{
+    return (uint32_t)(xTaskGetTickCount() - start_tick) * portTICK_PERIOD_MS;
+}
+
+//Still growing: the peak moved in the second half of the samples so far
+static int growing(const watch_t *w)
+{
+    return relaxed_load(&w->grew_ms) > relaxed_load(&last_sample_ms) / 2u;
+}
+
+static void fill_result(const watch_t *w, stack_profile_result_t *out)
+{
+    out->id = w->id;
+    out->depth = w->depth;
+    out->baseline_depth = w->baseline_depth;
+    out->peak_bytes = relaxed_load(&w->peak_bytes);
+    out->grew_ms = relaxed_load(&w->grew_ms);
+    out->recommended_depth = recommend_depth(out->peak_bytes);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t stack_profile_watch(TaskHandle_t task, const char *id, uint32_t depth, uint32_t baseline_depth)
+{
+    if (task == NULL || id == NULL) {
+        return pdFAIL;
+    }
+    unsigned slot = atomic_fetch_add(&watched_used, 1);
+    if (slot >= STACK_PROFILE_MAX_TASKS) {
+        atomic_fetch_sub(&watched_used, 1);
+        return pdFAIL;
+    }
+    watch_t *w = &watched[slot];
+    w->id = id;
+    w->depth = depth;
+    w->baseline_depth = baseline_depth ? baseline_depth : depth;
+    atomic_init(&w->peak_bytes, 0);
+    atomic_init(&w->grew_ms, 0);
+    atomic_store_explicit(&w->task, task, memory_order_release);
+    return pdPASS;
+}
+
+void stack_profile_sample(void)
+{
+    uint32_t now_ms = ms_since_start();
+    unsigned used = atomic_load(&watched_used);
+    for (unsigned i = 0; i < used && i < STACK_PROFILE_MAX_TASKS; i++) {
+        watch_t *w = &watched[i];
+        TaskHandle_t task = atomic_load_explicit(&w->task, memory_order_acquire);
+        if (task == NULL) {
+            continue;
+        }
+        uint32_t free_bytes = depth_bytes((uint32_t)uxTaskGetStackHighWaterMark(task));
+        uint32_t peak = (free_bytes < depth_bytes(w->depth)) ? depth_bytes(w->depth) - free_bytes : 0;
+        if (peak > relaxed_load(&w->peak_bytes)) {
+            relaxed_store(&w->peak_bytes, peak);
+            relaxed_store(&w->grew_ms, now_ms);
+        }
+    }
+    relaxed_store(&last_sample_ms, now_ms);
+    relaxed_store(&samples, relaxed_load(&samples) + 1);
+}
+
+BaseType_t stack_profile_get(const char *id, stack_profile_result_t *out)
+{
+    unsigned used = atomic_load(&watched_used);
+    for (unsigned i = 0; i < used && i < STACK_PROFILE_MAX_TASKS; i++) {
+        const watch_t *w = &watched[i];
+        if (atomic_load_explicit(&w->task, memory_order_acquire) != NULL && strcmp(w->id, id) == 0) {
+            fill_result(w, out);
+            return pdPASS;
+        }
+    }
+    return pdFAIL;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void sampler_task(void *pv)
+{
+    TickType_t period = (TickType_t)(uintptr_t)pv;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (ms_since_start() < run_ms) {
+        stack_profile_sample();
+        xTaskDelayUntil(&last_wake, period);
+    }
+    stack_profile_sample();
+    stack_profile_print();
+    stack_profile_print_header();
+    atomic_store(&sampler_running, 0);
+    vTaskDelete(NULL);
+}
+
+BaseType_t stack_profile_start(uint32_t sample_ms, uint32_t duration_ms)
+{
+    unsigned idle = 0;
+    if (duration_ms == 0 || !atomic_compare_exchange_strong(&sampler_running, &idle, 1)) {
+        return pdFAIL;
+    }
+    TickType_t period = pdMS_TO_TICKS(sample_ms);
+    period = (period == 0) ? 1 : period;
+    start_tick = xTaskGetTickCount();
+    run_ms = duration_ms;
+    if (xTaskCreate(sampler_task, "stack_prof", STACK_PROFILE_TASK_STACK, (void *)(uintptr_t)period,
+                    STACK_PROFILE_TASK_PRIORITY, NULL) != pdPASS) {
+        atomic_store(&sampler_running, 0);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void stack_profile_print(void)
+{
+    printf("stack profile: %u samples over %u.%u s, margin %u %% + %u bytes (sizes in bytes)\n",
+           relaxed_load(&samples), relaxed_load(&last_sample_ms) / 1000u, relaxed_load(&last_sample_ms) % 1000u / 100u,
+           (unsigned)STACK_PROFILE_MARGIN_PERCENT, (unsigned)STACK_PROFILE_MARGIN_BYTES);
+    printf("%-16s %8s %8s %8s %10s %8s %11s %8s\n", "task", "baseline", "profiled", "peak", "grew at", "needed",
+           "recommended", "saved");
+    unsigned used = atomic_load(&watched_used);
+    int32_t total_saved = 0;
+    int raised = 0;
+    for (unsigned i = 0; i < used && i < STACK_PROFILE_MAX_TASKS; i++) {
+        const watch_t *w = &watched[i];
+        if (atomic_load_explicit(&w->task, memory_order_acquire) == NULL) {
+            continue;
+        }
+        stack_profile_result_t r;
+        fill_result(w, &r);
+        uint32_t needed = needed_bytes(r.peak_bytes);
+        int32_t saved = (int32_t)depth_bytes(r.baseline_depth) - (int32_t)needed;
+        total_saved += saved;
+        raised |= depth_bytes(r.recommended_depth) > needed;
+        printf("%-16s %8u %8u %8u %8u.%u s %8u %11u %8d%s%s\n", r.id, (unsigned)depth_bytes(r.baseline_depth),
+               (unsigned)depth_bytes(r.depth), (unsigned)r.peak_bytes, (unsigned)(r.grew_ms / 1000u),
+               (unsigned)(r.grew_ms % 1000u / 100u), (unsigned)needed, (unsigned)depth_bytes(r.recommended_depth),
+               (int)saved, growing(w) ? "  growing" : "",
+               r.peak_bytes + STACK_PROFILE_MARGIN_BYTES > depth_bytes(r.depth) ? "  FULL: profile with more" : "");
+    }
+    printf("%-16s %67d bytes (baseline - needed)\n", "total saved", (int)total_saved);
+    if (raised) {
+        printf("recommended = needed, raised to the port minimum of %u bytes where smaller\n",
+               (unsigned)MIN_STACK_BYTES);
+    }
+}
+
+void stack_profile_print_header(void)
+{
+    printf("//>>> stack_sizes.h\n");
+    printf("//Generated by stack_profile (components/stack_profile) - do not edit, profile again instead.\n");
+    printf("//%u samples over %u s; peak + %u %% + %u bytes, rounded up to 16 bytes, in xTaskCreate() units\n",
+           relaxed_load(&samples), relaxed_load(&last_sample_ms) / 1000u, (unsigned)STACK_PROFILE_MARGIN_PERCENT,
+           (unsigned)STACK_PROFILE_MARGIN_BYTES);
+    printf("#pragma once\n");
+#ifdef ESP_PLATFORM
+    printf("#ifdef ESP_PLATFORM                 //measured on the ESP32: sizes in bytes\n");
+#else
+    printf("#ifndef ESP_PLATFORM                //measured on the POSIX port: sizes in %u-byte words\n",
+           (unsigned)sizeof(StackType_t));
+#endif
+    unsigned used = atomic_load(&watched_used);
+    for (unsigned i = 0; i < used && i < STACK_PROFILE_MAX_TASKS; i++) {
+        const watch_t *w = &watched[i];
+        if (atomic_load_explicit(&w->task, memory_order_acquire) == NULL) {
+            continue;
+        }
+        stack_profile_result_t r;
+        fill_result(w, &r);
+        printf("#define STACK_DEPTH_%-16s %-8u //peak %u bytes%s\n", r.id, (unsigned)r.recommended_depth,
+               (unsigned)r.peak_bytes, growing(w) ? ", still growing" : "");
+    }
+    printf("#endif\n");
+    printf("//<<< stack_sizes.h\n");
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,123 @@
+//Static-allocation build mode: task stacks / TCBs, queue storage and semaphores carved from one boot-time arena
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+xTaskCreate / xQueueCreate / xSemaphoreCreateBinary take their memory from the heap at run time: two blocks
+per task, two per queue, in whatever holes the heap has at that moment. Startup time depends on the heap's
+state, the free heap after boot is whatever is left over, and objects created and deleted later leave holes.
+The ...Static variants take the memory from the caller instead; this component is that caller. The
+application declares what it creates, the sum is one static array sized at compile time, and the objects
+are laid out in it one after the other at boot - no heap, no search, the same addresses on every boot.
+
+Flow:
+1) Size the arena at compile time from what will be created:
+   STATIC_ARENA_DEFINE(arena, STATIC_ARENA_TASK_BYTES(2048) + STATIC_ARENA_TASK_BYTES(2048) +
+                              STATIC_ARENA_QUEUE_BYTES(10, sizeof(int)));
+2) At boot, instead of xTaskCreate / xQueueCreate / xSemaphoreCreateBinary:
+   q = static_arena_queue(&arena, "q", 10, sizeof(int));
+   static_arena_task(&arena, producer_task, "producer", 2048, NULL, 5, STATIC_ARENA_ANY_CORE, &producer);
+3) static_arena_report(&arena): every object with its offset and size, the total and what is left over.
+
+Rules:
+>> Objects are carved in call order and never given back (vTaskDelete on such a task frees nothing);
+   static_arena_reset() starts over once every object of the arena has been deleted.
+>> The arena is not locked: create its objects from one task, at boot.
+>> A size that does not match the calls fails at boot (NULL / pdFAIL and the report says by how much),
+   never by overwriting memory. Sizes are rounded to STATIC_ARENA_ALIGN bytes per block.
+>> Objects that components create internally (rings, pools, their own tasks) still come from the heap.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef STATIC_ARENA_MAX_OBJECTS
+#define STATIC_ARENA_MAX_OBJECTS    16
+#endif
+
+#define STATIC_ARENA_ALIGN          8u
+#define STATIC_ARENA_ANY_CORE       (-1)
+
+#define STATIC_ARENA_ROUND(bytes)   (((size_t)(bytes) + STATIC_ARENA_ALIGN - 1u) & ~(size_t)(STATIC_ARENA_ALIGN - 1u))
+
+//Bytes one object takes in the arena (depth as xTaskCreate(): bytes on ESP-IDF, words on the host)
+#define STATIC_ARENA_TASK_BYTES(depth)          (STATIC_ARENA_ROUND(sizeof(StaticTask_t)) + \
+                                                 STATIC_ARENA_ROUND((size_t)(depth) * sizeof(StackType_t)))
+#define STATIC_ARENA_QUEUE_BYTES(length, item)  (STATIC_ARENA_ROUND(sizeof(StaticQueue_t)) + \
+                                                 STATIC_ARENA_ROUND((size_t)(length) * (size_t)(item)))
+#define STATIC_ARENA_SEMAPHORE_BYTES            STATIC_ARENA_ROUND(sizeof(StaticSemaphore_t))
+
+typedef enum {
+    STATIC_ARENA_KIND_TASK = 0,
+    STATIC_ARENA_KIND_QUEUE,
+    STATIC_ARENA_KIND_SEMAPHORE,
+} static_arena_kind_t;
+
+typedef struct {
+    const char *name;
+    uint8_t kind;                           //static_arena_kind_t
+    uint32_t offset;
+    uint32_t bytes;                         //control block + stack / storage
+} static_arena_object_t;
+
+typedef struct {
+    const char *name;
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t refused;                         //bytes asked for that did not fit
+    uint8_t count;
+    static_arena_object_t objects[STATIC_ARENA_MAX_OBJECTS];
+} static_arena_t;
+
+//One static array of "bytes" (rounded up) and its descriptor, both in .bss
+#define STATIC_ARENA_DEFINE(id, bytes) \
+    static uint64_t id##_storage[(STATIC_ARENA_ROUND(bytes) + sizeof(uint64_t) - 1u) / sizeof(uint64_t)]; \
+    static static_arena_t id = { .name = #id, .base = (uint8_t *)id##_storage, .size = sizeof(id##_storage) }
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : static_arena_task
+>> Description: xTaskCreateStatic() (xTaskCreateStaticPinnedToCore() with a core on a multi-core ESP32)
+                with the TCB and the stack taken from the arena.
+>> Returns: pdPASS, or pdFAIL if the arena is too small or its object table is full (*handle = NULL).
+*/
+BaseType_t static_arena_task(static_arena_t *arena, TaskFunction_t fn, const char *name, uint32_t depth,
+                             void *param, UBaseType_t priority, BaseType_t core, TaskHandle_t *handle);
+
+//xQueueCreateStatic() from the arena. NULL if it does not fit.
+QueueHandle_t static_arena_queue(static_arena_t *arena, const char *name, UBaseType_t length, UBaseType_t item_size);
+
+//xSemaphoreCreateBinaryStatic() from the arena (initially empty, as xSemaphoreCreateBinary()). NULL if it does not fit.
+SemaphoreHandle_t static_arena_binary(static_arena_t *arena, const char *name);
+
+//Forget every object; only after all of them have been deleted.
+void static_arena_reset(static_arena_t *arena);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : static_arena_report
+>> Description: Prints one line per object (kind, offset, bytes), the arena's used / total bytes, what was
+                refused and, on the ESP32, the free heap - the footprint of the static build.
+>> Returns: pdPASS if every request fit, pdFAIL otherwise.
+*/
+BaseType_t static_arena_report(const static_arena_t *arena);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
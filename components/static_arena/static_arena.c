@@ -0,0 +1,110 @@
+//Boot-time arena for the static FreeRTOS objects (see static_arena.h)
+
+#include <stdint.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "static_arena.h"
+
+#if configSUPPORT_STATIC_ALLOCATION != 1
+#error "static_arena needs CONFIG_FREERTOS_SUPPORT_STATIC_ALLOCATION (configSUPPORT_STATIC_ALLOCATION)"
+#endif
+
+static const char *const kind_names[] = { "task", "queue", "semaphore" };
+
+
+//-------------------------------------------------------------------------------------------------
+//Control block + storage of one object, one after the other; NULL if it does not fit
+static uint8_t *carve(static_arena_t *arena, const char *name, static_arena_kind_t kind, size_t bytes)
+{
+    if (arena->count == STATIC_ARENA_MAX_OBJECTS || bytes > arena->size - arena->used) {
+        arena->refused += bytes;
+        return NULL;
+    }
+    static_arena_object_t *o = &arena->objects[arena->count++];
+    o->name = name;
+    o->kind = (uint8_t)kind;
+    o->offset = (uint32_t)arena->used;
+    o->bytes = (uint32_t)bytes;
+    uint8_t *p = arena->base + arena->used;
+    arena->used += bytes;
+    return p;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t static_arena_task(static_arena_t *arena, TaskFunction_t fn, const char *name, uint32_t depth,
+                             void *param, UBaseType_t priority, BaseType_t core, TaskHandle_t *handle)
+{
+    TaskHandle_t task = NULL;
+    uint8_t *p = carve(arena, name, STATIC_ARENA_KIND_TASK, STATIC_ARENA_TASK_BYTES(depth));
+    if (p != NULL) {
+        StaticTask_t *tcb = (StaticTask_t *)p;
+        StackType_t *stack = (StackType_t *)(p + STATIC_ARENA_ROUND(sizeof(StaticTask_t)));
+#if defined(ESP_PLATFORM) && configNUMBER_OF_CORES > 1
+        task = (core == STATIC_ARENA_ANY_CORE)
+             ? xTaskCreateStatic(fn, name, depth, param, priority, stack, tcb)
+             : xTaskCreateStaticPinnedToCore(fn, name, depth, param, priority, stack, tcb, core);
+#else
+        (void)core;
+        task = xTaskCreateStatic(fn, name, depth, param, priority, stack, tcb);
+#endif
+    }
+    if (handle != NULL) {
+        *handle = task;
+    }
+    return (task != NULL) ? pdPASS : pdFAIL;
+}
+
+QueueHandle_t static_arena_queue(static_arena_t *arena, const char *name, UBaseType_t length, UBaseType_t item_size)
+{
+    uint8_t *p = carve(arena, name, STATIC_ARENA_KIND_QUEUE, STATIC_ARENA_QUEUE_BYTES(length, item_size));
+    if (p == NULL) {
+        return NULL;
+    }
+    uint8_t *storage = (item_size != 0) ? p + STATIC_ARENA_ROUND(sizeof(StaticQueue_t)) : NULL;
+    return xQueueCreateStatic(length, item_size, storage, (StaticQueue_t *)p);
+}
+
+SemaphoreHandle_t static_arena_binary(static_arena_t *arena, const char *name)
+{
+    uint8_t *p = carve(arena, name, STATIC_ARENA_KIND_SEMAPHORE, STATIC_ARENA_SEMAPHORE_BYTES);
+    return (p != NULL) ? xSemaphoreCreateBinaryStatic((StaticSemaphore_t *)p) : NULL;
+}
+
+void static_arena_reset(static_arena_t *arena)
+{
+    arena->used = 0;
+    arena->refused = 0;
+    arena->count = 0;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+BaseType_t static_arena_report(const static_arena_t *arena)
+{
+    printf("static arena %s: %u of %u bytes used, %u objects\n", arena->name ? arena->name : "",
+           (unsigned)arena->used, (unsigned)arena->size, (unsigned)arena->count);
+    printf("%-16s %-10s %8s %8s\n", "object", "kind", "offset", "bytes");
+    for (uint8_t i = 0; i < arena->count; i++) {
+        const static_arena_object_t *o = &arena->objects[i];
+        printf("%-16s %-10s %8u %8u\n", o->name ? o->name : "", kind_names[o->kind < 3 ? o->kind : 0],
+               (unsigned)o->offset, (unsigned)o->bytes);
+    }
+    if (arena->refused != 0) {
+        printf("static arena %s: %u bytes did not fit - STATIC_ARENA_DEFINE is too small\n",
+               arena->name ? arena->name : "", (unsigned)arena->refused);
+    } else if (arena->used < arena->size) {
+        printf("static arena %s: %u bytes unused - STATIC_ARENA_DEFINE is larger than what was created\n",
+               arena->name ? arena->name : "", (unsigned)(arena->size - arena->used));
+    }
+#ifdef ESP_PLATFORM
+    printf("free heap after boot: %u bytes\n", (unsigned)xPortGetFreeHeapSize());
+#endif
+    return (arena->refused == 0) ? pdPASS : pdFAIL;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+//Typed FreeRTOS queue for C++: StaticQueue<T, N> over xQueueCreateStatic, item type and capacity fixed at compile time
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+xQueueCreate(10, sizeof(int)) fixes the item size at run time and xQueueSend(q, &value, ticks) takes a
+void *: sending a short into that queue, or a struct into a queue created for pointers, compiles and
+copies the wrong number of bytes. StaticQueue<int, 10> carries the item type in its type: send / receive
+only accept an int, the item size and the storage (N x sizeof(T) bytes, in the object itself, no heap)
+follow from it, and a type the kernel cannot copy bytewise does not compile. Timeouts are std::chrono
+durations instead of tick counts, so 10ms means 10 ms at any CONFIG_FREERTOS_HZ.
+
+Flow:
+1) static StaticQueue<int, 10> q;                       (.bss; a global or a function-local static)
+2) Producer: q.send_for(value, std::chrono::milliseconds(10))  / q.try_send(value) / q.send(value)
+3) Consumer: int rx; if (q.receive(rx)) { ... }       / q.receive_for(rx, 100ms) / q.try_receive(rx)
+4) C code and the other components take q.handle() like any QueueHandle_t.
+
+Item copies:
+>> The kernel copies every item into and out of the storage itself (memcpy of the item size); the
+   wrapper adds no copy of its own and inlines to the same xQueueSend / xQueueReceive call.
+>> T up to the size of a pointer is passed by value, larger T by const reference.
+>> Only a T is accepted: sending a long (or the literal 5 into a StaticQueue<uint8_t, N>) hits a deleted
+   overload instead of being narrowed silently; convert explicitly, e.g. q.send(uint8_t(5)).
+>> An empty T (struct Event {}) is a pure signal: the queue is created with item size 0, which makes the
+   kernel skip the copy, and has no storage at all.
+
+Rules:
+>> T must be trivially copyable (no pointers to itself, no destructor to run); a queue of pointers to
+   larger objects is StaticQueue<Frame *, N>.
+>> Timeouts are rounded up to whole ticks: a non-zero timeout never turns into a poll. send / receive
+   without a timeout wait forever (portMAX_DELAY).
+>> Not copyable or movable (the kernel keeps pointers into the object). Create it before the tasks
+   that use it and do not destroy it while a task is blocked on it.
+>> ISRs: send_from_isr / receive_from_isr, with the usual pxHigherPriorityTaskWoken.
+---------------------------------------------------------------------------------------------------
+*/
+
+template <typename T, std::size_t N>
+class StaticQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "StaticQueue: T is copied bytewise, it must be trivially copyable");
+    static_assert(N > 0, "StaticQueue: capacity must be at least 1");
+
+public:
+    //Empty items are signals: no bytes per item, no storage
+    static constexpr UBaseType_t kItemSize = std::is_empty<T>::value ? 0u : (UBaseType_t)sizeof(T);
+    //Small items by value (registers), larger ones by reference
+    using param_type = typename std::conditional<(sizeof(T) <= sizeof(void *)), T, const T &>::type;
+
+    StaticQueue() : handle_(xQueueCreateStatic(N, kItemSize, storage(), &control_))
+    {
+        configASSERT(handle_ != NULL);      //cannot fail with static storage
+    }
+    ~StaticQueue() { vQueueDelete(handle_); }
+
+    StaticQueue(const StaticQueue &) = delete;
+    StaticQueue &operator=(const StaticQueue &) = delete;
+
+
+    //---------------------------------------------------------------------------------------------
+    //Send to the back. false = still full after the timeout (errQUEUE_FULL).
+    bool try_send(param_type item) { return xQueueSend(handle_, &item, 0) == pdPASS; }
+    bool send(param_type item) { return xQueueSend(handle_, &item, portMAX_DELAY) == pdPASS; }
+    template <class Rep, class Period>
+    bool send_for(param_type item, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return xQueueSend(handle_, &item, to_ticks(timeout)) == pdPASS;
+    }
+
+    //Receive from the front into out. false = still empty after the timeout, out unchanged.
+    bool try_receive(T &out) { return xQueueReceive(handle_, &out, 0) == pdPASS; }
+    bool receive(T &out) { return xQueueReceive(handle_, &out, portMAX_DELAY) == pdPASS; }
+    template <class Rep, class Period>
+    bool receive_for(T &out, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return xQueueReceive(handle_, &out, to_ticks(timeout)) == pdPASS;
+    }
+
+    bool send_from_isr(param_type item, BaseType_t *woken) { return xQueueSendFromISR(handle_, &item, woken) == pdPASS; }
+
+    //Any other type is an exact match for these, so they win over an implicit conversion to T
+    template <class U> bool try_send(U) = delete;
+    template <class U> bool send(U) = delete;
+    template <class U, class Rep, class Period>
+    bool send_for(U, const std::chrono::duration<Rep, Period> &) = delete;
+    template <class U> bool send_from_isr(U, BaseType_t *) = delete;
+    bool receive_from_isr(T &out, BaseType_t *woken) { return xQueueReceiveFromISR(handle_, &out, woken) == pdPASS; }
+    //---------------------------------------------------------------------------------------------
+
+
+    //---------------------------------------------------------------------------------------------
+    std::size_t size() const { return uxQueueMessagesWaiting(handle_); }
+    std::size_t available() const { return uxQueueSpacesAvailable(handle_); }
+    static constexpr std::size_t capacity() { return N; }
+    QueueHandle_t handle() const { return handle_; }
+
+    //Whole ticks, rounded up; zero or negative = do not wait
+    template <class Rep, class Period>
+    static constexpr TickType_t to_ticks(const std::chrono::duration<Rep, Period> &timeout)
+    {
+        using ticks = std::chrono::duration<uint64_t, std::ratio<1, configTICK_RATE_HZ>>;
+        if (timeout <= timeout.zero()) {
+            return 0;
+        }
+        uint64_t t = (uint64_t)std::chrono::ceil<ticks>(timeout).count();
+        return (t < (uint64_t)portMAX_DELAY) ? (TickType_t)t : (TickType_t)(portMAX_DELAY - 1u);
+    }
+    //---------------------------------------------------------------------------------------------
+
+private:
+    uint8_t *storage() { return kItemSize ? storage_ : nullptr; }
+
+    alignas(T) uint8_t storage_[kItemSize ? N * sizeof(T) : 1u];
+    StaticQueue_t control_;
+    QueueHandle_t handle_;
+};
@@ -0,0 +1,81 @@
+//Periodic signal from a hardware timer interrupt: xSemaphoreGiveFromISR() every period, no giving task
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why a timer interrupt instead of a task with vTaskDelay()?
+>> Timing: vTaskDelay() counts ticks (10 ms at CONFIG_FREERTOS_HZ=100) from wherever the task happens to
+   be, so the period is rounded to ticks, and anything that delays the task (higher-priority work, its
+   own printf) shifts every following signal. A gptimer alarm with auto-reload fires every period_us
+   on the hardware clock (1 us resolution) no matter what the tasks do.
+>> RAM: the giving task needs a TCB and its own stack (2048 bytes in the examples) just to sleep. The
+   interrupt runs on the ISR stack that exists anyway; what remains is this object and the driver's.
+
+Flow:
+1) sem = xSemaphoreCreateBinary();
+2) ts  = timer_signal_start(&(timer_signal_config_t){ .period_us = 1000000, .sem = sem });
+3) Any task: xSemaphoreTake(sem, portMAX_DELAY) - exactly as with a giving task
+
+The interrupt gives with xSemaphoreGiveFromISR() and asks for a context switch when that woke a task
+with a higher priority than the interrupted one (the gptimer driver passes the callback's return value
+to portYIELD_FROM_ISR()), so the woken task runs right after the interrupt instead of at the next tick.
+
+Per fire the interrupt also records the time since the previous one: timer_signal_get() reports the
+interval range (interrupt-entry jitter) and how many gives found the semaphore still given (lost).
+
+Host build: the timer is simulated with the tick hook (host/support/host_isr.h), so the period is
+rounded to whole ticks there.
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct timer_signal timer_signal_t;
+
+typedef struct {
+    uint32_t period_us;
+    SemaphoreHandle_t sem;                  //binary or counting semaphore the interrupt gives
+    void (*on_fire)(void *arg);             //optional, called in the interrupt right before the give
+    void *arg;
+} timer_signal_config_t;
+
+typedef struct {
+    uint32_t period_us;                     //as configured (host: rounded to ticks)
+    uint32_t fires;
+    uint32_t lost;                          //gives that found the semaphore already given
+    uint32_t min_interval_us;               //between two interrupts (0 until the second one)
+    uint32_t max_interval_us;
+} timer_signal_stats_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : timer_signal_start
+>> Description: Create and start the periodic timer. on_fire (if set) must be safe in an interrupt.
+>> Returns: handle, or NULL if the period is 0, the semaphore is NULL, no timer is free or memory is
+            exhausted.
+*/
+timer_signal_t *timer_signal_start(const timer_signal_config_t *config);
+
+//Stop the timer and free it. The semaphore is not touched.
+void timer_signal_stop(timer_signal_t *ts);
+//-------------------------------------------------------------------------------------------------
+
+
+//Copy the counters (any task, while the timer runs; each field is read atomically on its own).
+void timer_signal_get(const timer_signal_t *ts, timer_signal_stats_t *out);
+
+//Bytes timer_signal_start() allocates itself (the driver's timer object comes on top on the ESP32).
+size_t timer_signal_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,194 @@
+//Periodic signal from a hardware timer interrupt (see timer_signal.h)
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "timer_signal.h"
+
+#ifdef ESP_PLATFORM
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#else
+#include <time.h>
+#include "host_isr.h"
+#define IRAM_ATTR
+#endif
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> ESP32: gptimer at 1 MHz, alarm at period_us with auto-reload, so the period does not depend on how
+   long the interrupt takes. The callback's return value tells the driver to portYIELD_FROM_ISR().
+>> Host: host_isr timer every period_us / tick-period ticks, called from the tick hook.
+>> The counters are written only by the interrupt and read by tasks: relaxed atomics. last_us is the
+   interrupt's own state.
+---------------------------------------------------------------------------------------------------
+*/
+
+struct timer_signal {
+    timer_signal_config_t config;
+#ifdef ESP_PLATFORM
+    gptimer_handle_t timer;
+#else
+    int host_timer;
+#endif
+    uint64_t last_us;                       //time of the previous interrupt, 0 before the first
+    atomic_uint fires;
+    atomic_uint lost;
+    atomic_uint min_interval_us;
+    atomic_uint max_interval_us;
+};
+
+
+static inline uint64_t IRAM_ATTR isr_now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+//The interrupt: account, give, report whether a higher-priority task was woken
+static bool IRAM_ATTR fire(timer_signal_t *ts)
+{
+    uint64_t now = isr_now_us();
+    if (ts->last_us != 0) {
+        unsigned interval = (unsigned)(now - ts->last_us);
+        if (interval < atomic_load_explicit(&ts->min_interval_us, memory_order_relaxed)) {
+            atomic_store_explicit(&ts->min_interval_us, interval, memory_order_relaxed);
+        }
+        if (interval > atomic_load_explicit(&ts->max_interval_us, memory_order_relaxed)) {
+            atomic_store_explicit(&ts->max_interval_us, interval, memory_order_relaxed);
+        }
+    }
+    ts->last_us = now;
+    atomic_fetch_add_explicit(&ts->fires, 1, memory_order_relaxed);
+
+    if (ts->config.on_fire != NULL) {
+        ts->config.on_fire(ts->config.arg);
+    }
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (xSemaphoreGiveFromISR(ts->config.sem, &higher_priority_task_woken) != pdPASS) {
+        atomic_fetch_add_explicit(&ts->lost, 1, memory_order_relaxed);
+    }
+    return higher_priority_task_woken == pdTRUE;
+}
+
+#ifdef ESP_PLATFORM
+static bool IRAM_ATTR on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *event, void *user_ctx)
+{
+    (void)timer;
+    (void)event;
+    return fire(user_ctx);                  //true: the driver ends the interrupt with portYIELD_FROM_ISR()
+}
+
+static bool start_timer(timer_signal_t *ts)
+{
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,           //1 tick = 1 us
+    };
+    if (gptimer_new_timer(&timer_config, &ts->timer) != ESP_OK) {
+        return false;
+    }
+    const gptimer_event_callbacks_t callbacks = { .on_alarm = on_alarm };
+    const gptimer_alarm_config_t alarm = {
+        .alarm_count = ts->config.period_us,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    if (gptimer_register_event_callbacks(ts->timer, &callbacks, ts) != ESP_OK ||
+        gptimer_set_alarm_action(ts->timer, &alarm) != ESP_OK || gptimer_enable(ts->timer) != ESP_OK) {
+        gptimer_del_timer(ts->timer);
+        return false;
+    }
+    if (gptimer_start(ts->timer) != ESP_OK) {
+        gptimer_disable(ts->timer);
+        gptimer_del_timer(ts->timer);
+        return false;
+    }
+    return true;
+}
+
+static void stop_timer(timer_signal_t *ts)
+{
+    gptimer_stop(ts->timer);
+    gptimer_disable(ts->timer);
+    gptimer_del_timer(ts->timer);
+}
+#else
+static void on_host_tick(void *arg)
+{
+    fire(arg);                              //a woken task runs when the tick interrupt returns
+}
+
+static bool start_timer(timer_signal_t *ts)
+{
+    uint32_t tick_us = 1000000u / configTICK_RATE_HZ;
+    uint32_t ticks = (ts->config.period_us + tick_us / 2) / tick_us;
+    ticks = ticks ? ticks : 1;
+    ts->config.period_us = ticks * tick_us;
+    ts->host_timer = host_isr_timer_start(ticks, on_host_tick, ts);
+    return ts->host_timer >= 0;
+}
+
+static void stop_timer(timer_signal_t *ts)
+{
+    host_isr_timer_stop(ts->host_timer);
+}
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+size_t timer_signal_bytes(void)
+{
+    return sizeof(timer_signal_t);
+}
+
+timer_signal_t *timer_signal_start(const timer_signal_config_t *config)
+{
+    if (config == NULL || config->period_us == 0 || config->sem == NULL) {
+        return NULL;
+    }
+    timer_signal_t *ts = pvPortMalloc(sizeof(*ts));
+    if (ts == NULL) {
+        return NULL;
+    }
+    ts->config = *config;
+    ts->last_us = 0;
+    atomic_init(&ts->fires, 0);
+    atomic_init(&ts->lost, 0);
+    atomic_init(&ts->min_interval_us, UINT32_MAX);
+    atomic_init(&ts->max_interval_us, 0);
+    if (!start_timer(ts)) {
+        vPortFree(ts);
+        return NULL;
+    }
+    return ts;
+}
+
+void timer_signal_stop(timer_signal_t *ts)
+{
+    stop_timer(ts);
+    vPortFree(ts);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+void timer_signal_get(const timer_signal_t *ts, timer_signal_stats_t *out)
+{
+    out->period_us = ts->config.period_us;
+    out->fires = atomic_load_explicit(&ts->fires, memory_order_relaxed);
+    out->lost = atomic_load_explicit(&ts->lost, memory_order_relaxed);
+    unsigned min = atomic_load_explicit(&ts->min_interval_us, memory_order_relaxed);
+    out->min_interval_us = (min == UINT32_MAX) ? 0 : min;
+    out->max_interval_us = atomic_load_explicit(&ts->max_interval_us, memory_order_relaxed);
+}
@@ -0,0 +1,122 @@
+//Periodic jobs as callbacks on one executor task: a hierarchical timer wheel instead of one task (and stack) per job
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+Why?
+task1 / task2 print one line every 1000 / 500 ms, and each of them owns a task: a TCB plus a 2 KB stack
+(ESP-IDF counts the depth in bytes) that is idle more than 99 % of the time. A job that only has to run
+now and then needs a few words of state - when it is due next, what to call - not a stack of its own.
+The timer wheel keeps those words for every job and runs all of them from one executor task, so a
+hundred jobs cost one stack and a hundred small records.
+
+Flow:
+1) tw = timer_wheel_create(&(timer_wheel_config_t){ .name = "tw_exec", .priority = 1, .stack_depth = 2048 })
+2) Write the job: one activation, short, never blocks - void job(timer_wheel_job_t *job, void *arg)
+3) timer_wheel_add(tw, &(timer_wheel_job_config_t){ .name = "task1", .job = job, .period_ms = 1000 })
+4) Any task, any time: timer_wheel_cancel(tw, job), timer_wheel_get(tw, &stats) / timer_wheel_print(tw)
+
+The wheel:
+>> 4 levels of 64 slots. Level 0 holds the jobs due in the next 64 ticks, one slot per tick; level n
+   holds those due within 64^(n+1) ticks, one slot per 64^n ticks. Every 64^n ticks the next slot of
+   level n is re-sorted into the levels below (cascade). Adding, cancelling and running a job is O(1)
+   whatever the number of jobs; the longest period is 64^4 - 1 ticks (46 hours at 100 Hz).
+>> The executor sleeps (task notification with a timeout) until the next occupied level-0 slot or
+   cascade, not on every tick, so it does not keep a tickless-idle CPU awake; adding a job wakes it
+   to recompute.
+>> Releases are on a fixed grid like xTaskDelayUntil(): release k = first release + k x period. A job
+   still running at its next release (overrun) is released again on the following tick.
+
+Rules:
+>> All jobs of an executor run one after the other on its stack and priority: a job that blocks or runs
+   long delays every other job (overruns, see timer_wheel_get()). Size stack_depth for the deepest job.
+>> Periods are rounded down to whole ticks (10 ms at CONFIG_FREERTOS_HZ=100); 0 ticks is rejected.
+>> add / cancel from any task, or from a job on the same executor (a job may cancel itself); not from
+   interrupts. Other tasks wait for the executor to finish the jobs of the current tick.
+---------------------------------------------------------------------------------------------------
+*/
+
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS          4
+#endif
+
+#define TIMER_WHEEL_SLOT_BITS       6
+#define TIMER_WHEEL_SLOTS           (1u << TIMER_WHEEL_SLOT_BITS)
+
+typedef struct timer_wheel timer_wheel_t;
+typedef struct timer_wheel_job timer_wheel_job_t;
+
+typedef void (*timer_wheel_fn_t)(timer_wheel_job_t *job, void *arg);
+
+typedef struct {
+    const char *name;                       //executor task
+    UBaseType_t priority;
+    uint32_t stack_depth;                   //as xTaskCreate() (bytes on ESP-IDF)
+} timer_wheel_config_t;
+
+typedef struct {
+    const char *name;                       //not copied, for timer_wheel_print()
+    timer_wheel_fn_t job;
+    void *arg;
+    uint32_t period_ms;
+    uint32_t phase_ms;                      //first release after phase_ms, 0 = after one period
+} timer_wheel_job_config_t;
+
+typedef struct {
+    uint32_t jobs;                          //registered now
+    uint32_t runs;                          //activations, all jobs
+    uint32_t overruns;                      //activations that started after the next release was due
+    uint32_t wakes;                         //times the executor woke up
+    uint32_t cascades;                      //jobs moved down a level
+} timer_wheel_stats_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : timer_wheel_create
+>> Description: Create an empty wheel and its executor task.
+>> Returns: handle, or NULL if config is NULL or out of memory.
+*/
+timer_wheel_t *timer_wheel_create(const timer_wheel_config_t *config);
+
+//Delete the executor and free every job and the wheel. Not from a job.
+void timer_wheel_delete(timer_wheel_t *tw);
+
+/*
+Function : timer_wheel_add
+>> Description: Register a periodic job; it is copied into one small allocation (36 bytes on the ESP32).
+>> Returns: job handle, or NULL if job is NULL, the period is shorter than a tick or longer than the wheel,
+            or out of memory.
+*/
+timer_wheel_job_t *timer_wheel_add(timer_wheel_t *tw, const timer_wheel_job_config_t *config);
+
+//Stop and free the job; safe from its own callback. The handle is invalid afterwards.
+void timer_wheel_cancel(timer_wheel_t *tw, timer_wheel_job_t *job);
+
+//Executor task, for APIs that need the raw handle.
+TaskHandle_t timer_wheel_handle(const timer_wheel_t *tw);
+
+//Activations of one job so far (the running one included).
+uint32_t timer_wheel_job_runs(const timer_wheel_job_t *job);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void timer_wheel_get(timer_wheel_t *tw, timer_wheel_stats_t *out);
+
+//One line: executor, jobs, runs, overruns, wakes.
+void timer_wheel_print(timer_wheel_t *tw);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
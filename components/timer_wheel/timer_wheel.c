@@ -0,0 +1,382 @@
+//Hierarchical timer wheel executor: periodic callbacks sharing one task (see timer_wheel.h)
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "timer_wheel.h"
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> tw->next is the next tick to process. A job due at "expires" sits in the lowest level whose range covers
+   expires - next: level l, slot (expires >> 6l) & 63. Processing tick t: if t is a multiple of 64, cascade
+   slot (t >> 6) & 63 of level 1, and while that index is 0 the next level up; then run level-0 slot t & 63.
+>> Slot lists are hlists (next + pointer to the previous next), so a job unlinks itself in O(1) and a slot
+   head is one pointer. A bitmap per level says which slots are occupied, so the next event is found with
+   a count-trailing-zeros per level instead of walking empty slots - the executor never visits idle ticks.
+>> The jobs of a slot are moved to tw->pending before they run: a job re-added for the next tick, or one
+   that cancels another job of the same tick, never touches the list being walked.
+>> The executor holds tw->lock while it processes ticks. add / cancel called from a job are already under
+   it (the caller is the executor), everybody else takes it.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define SLOT_MASK           (TIMER_WHEEL_SLOTS - 1u)
+#define WHEEL_RANGE         (1ull << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS))
+#define POS_PENDING         UINT16_MAX
+
+struct timer_wheel_job {
+    timer_wheel_job_t *next;
+    timer_wheel_job_t **pprev;
+    timer_wheel_fn_t fn;
+    void *arg;
+    const char *name;
+    TickType_t expires;
+    TickType_t period;
+    atomic_uint runs;
+    uint16_t pos;                           //level x 64 + slot, or POS_PENDING
+};
+
+struct timer_wheel {
+    timer_wheel_config_t config;
+    TaskHandle_t task;
+    SemaphoreHandle_t lock;
+    TickType_t next;
+    uint64_t occupied[TIMER_WHEEL_LEVELS];
+    timer_wheel_job_t *slots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+    timer_wheel_job_t *pending;
+    timer_wheel_job_t *running;
+    bool running_cancelled;
+    timer_wheel_stats_t stats;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+static inline bool on_executor(const timer_wheel_t *tw)
+{
+    return xTaskGetCurrentTaskHandle() == tw->task;
+}
+
+static void lock(timer_wheel_t *tw)
+{
+    if (!on_executor(tw)) {
+        xSemaphoreTake(tw->lock, portMAX_DELAY);
+    }
+}
+
+static void unlock(timer_wheel_t *tw)
+{
+    if (!on_executor(tw)) {
+        xSemaphoreGive(tw->lock);
+    }
+}
+
+//Distance (0 .. 63) from slot "from" to the first occupied slot, going round; -1 if none
+static int first_from(uint64_t bits, unsigned from)
+{
+    if (bits == 0) {
+        return -1;
+    }
+    uint64_t rotated = (from == 0) ? bits : (bits >> from) | (bits << (TIMER_WHEEL_SLOTS - from));
+    return __builtin_ctzll(rotated);
+}
+
+static void link_head(timer_wheel_job_t **head, timer_wheel_job_t *job)
+{
+    job->next = *head;
+    if (job->next != NULL) {
+        job->next->pprev = &job->next;
+    }
+    *head = job;
+    job->pprev = head;
+}
+
+static void unlink_job(timer_wheel_t *tw, timer_wheel_job_t *job)
+{
+    *job->pprev = job->next;
+    if (job->next != NULL) {
+        job->next->pprev = job->pprev;
+    }
+    if (job->pos != POS_PENDING && tw->slots[job->pos] == NULL) {
+        tw->occupied[job->pos / TIMER_WHEEL_SLOTS] &= ~(1ull << (job->pos & SLOT_MASK));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void insert(timer_wheel_t *tw, timer_wheel_job_t *job)
+{
+    TickType_t key = job->expires;
+    uint32_t delta = (uint32_t)(key - tw->next);
+    if ((int32_t)delta < 0) {               //overdue: the next tick processed
+        key = tw->next;
+        delta = 0;
+    }
+    unsigned level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1u && delta >= (1ull << (TIMER_WHEEL_SLOT_BITS * (level + 1u)))) {
+        level++;
+    }
+    unsigned slot = (key >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+    job->pos = (uint16_t)(level * TIMER_WHEEL_SLOTS + slot);
+    link_head(&tw->slots[job->pos], job);
+    tw->occupied[level] |= 1ull << slot;
+}
+
+//Move every job of one slot into tw->pending (before running it / re-sorting it)
+static void take_slot(timer_wheel_t *tw, unsigned level, unsigned slot)
+{
+    timer_wheel_job_t **head = &tw->slots[level * TIMER_WHEEL_SLOTS + slot];
+    tw->pending = *head;
+    if (tw->pending != NULL) {
+        tw->pending->pprev = &tw->pending;
+    }
+    *head = NULL;
+    tw->occupied[level] &= ~(1ull << slot);
+    for (timer_wheel_job_t *job = tw->pending; job != NULL; job = job->next) {
+        job->pos = POS_PENDING;
+    }
+}
+
+static void cascade(timer_wheel_t *tw, unsigned level, unsigned slot)
+{
+    take_slot(tw, level, slot);
+    timer_wheel_job_t *job;
+    while ((job = tw->pending) != NULL) {
+        unlink_job(tw, job);
+        insert(tw, job);
+        tw->stats.cascades++;
+    }
+}
+
+static void run_pending(timer_wheel_t *tw)
+{
+    timer_wheel_job_t *job;
+    while ((job = tw->pending) != NULL) {
+        unlink_job(tw, job);
+        tw->running = job;
+        tw->running_cancelled = false;
+        atomic_fetch_add_explicit(&job->runs, 1, memory_order_relaxed);
+        tw->stats.runs++;
+        job->fn(job, job->arg);
+        tw->running = NULL;
+        if (tw->running_cancelled) {
+            vPortFree(job);
+            continue;
+        }
+
+        //Fixed grid; a release that has passed already runs on the next tick processed
+        job->expires += job->period;
+        if ((int32_t)(xTaskGetTickCount() - job->expires) >= 0) {
+            tw->stats.overruns++;
+        }
+        insert(tw, job);
+    }
+}
+
+//Tick t == tw->next: cascade on level boundaries, then the jobs due at t
+static void process_tick(timer_wheel_t *tw, TickType_t t)
+{
+    tw->next = t;                           //the ticks before t had nothing to do
+    if ((t & SLOT_MASK) == 0) {
+        for (unsigned level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            unsigned slot = (t >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+            cascade(tw, level, slot);
+            if (slot != 0) {
+                break;
+            }
+        }
+    }
+    tw->next = t + 1u;                      //jobs re-added from here on land after t
+    take_slot(tw, 0, t & SLOT_MASK);
+    run_pending(tw);
+}
+
+//First tick >= tw->next with something to do (run or cascade); pdFALSE if the wheel is empty
+static BaseType_t next_event(const timer_wheel_t *tw, TickType_t *out)
+{
+    TickType_t t = tw->next;
+    uint64_t best = UINT64_MAX;
+    int d = first_from(tw->occupied[0], t & SLOT_MASK);
+    if (d >= 0) {
+        best = (uint64_t)d;
+    }
+    for (unsigned level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        unsigned shift = TIMER_WHEEL_SLOT_BITS * level;
+        unsigned slot = (t >> shift) & SLOT_MASK;
+        bool aligned = (t & ((1u << shift) - 1u)) == 0;
+        //The slot under the index is due now only on its boundary, otherwise one full turn later
+        d = aligned ? first_from(tw->occupied[level], slot) : first_from(tw->occupied[level], (slot + 1u) & SLOT_MASK);
+        if (d >= 0) {
+            uint64_t block = ((uint64_t)(t >> shift) + (uint64_t)d + (aligned ? 0u : 1u)) << shift;
+            uint64_t distance = block - t;
+            best = (distance < best) ? distance : best;
+        }
+    }
+    if (best == UINT64_MAX) {
+        return pdFALSE;
+    }
+    *out = t + (TickType_t)best;
+    return pdTRUE;
+}
+
+//Nothing due up to "now": move tw->next up without visiting the empty ticks
+static void skip_idle(timer_wheel_t *tw, TickType_t now)
+{
+    TickType_t event;
+    if ((int32_t)(now - tw->next) >= 0 && (next_event(tw, &event) == pdFALSE || (int32_t)(event - now) > 0)) {
+        tw->next = now + 1u;
+    }
+}
+
+static void executor(void *pv)
+{
+    timer_wheel_t *tw = pv;
+    for (;;) {
+        xSemaphoreTake(tw->lock, portMAX_DELAY);
+        tw->stats.wakes++;
+        TickType_t now = xTaskGetTickCount(), event;
+        while ((int32_t)(now - tw->next) >= 0) {
+            if (next_event(tw, &event) == pdFALSE || (int32_t)(event - now) > 0) {
+                tw->next = now + 1u;
+                break;
+            }
+            process_tick(tw, event);
+        }
+
+        TickType_t wait = portMAX_DELAY;
+        if (next_event(tw, &event) == pdTRUE) {
+            TickType_t after = xTaskGetTickCount();
+            wait = ((int32_t)(event - after) > 0) ? event - after : 0;
+            wait = (wait >= portMAX_DELAY) ? portMAX_DELAY - 1u : wait;
+        }
+        xSemaphoreGive(tw->lock);
+
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+timer_wheel_t *timer_wheel_create(const timer_wheel_config_t *config)
+{
+    if (config == NULL) {
+        return NULL;
+    }
+    timer_wheel_t *tw = pvPortMalloc(sizeof(*tw));
+    if (tw == NULL) {
+        return NULL;
+    }
+    memset(tw, 0, sizeof(*tw));
+    tw->config = *config;
+    tw->lock = xSemaphoreCreateMutex();
+    if (tw->lock == NULL) {
+        vPortFree(tw);
+        return NULL;
+    }
+    tw->next = xTaskGetTickCount();
+    if (xTaskCreate(executor, config->name, config->stack_depth, tw, config->priority, &tw->task) != pdPASS) {
+        vSemaphoreDelete(tw->lock);
+        vPortFree(tw);
+        return NULL;
+    }
+    return tw;
+}
+
+void timer_wheel_delete(timer_wheel_t *tw)
+{
+    xSemaphoreTake(tw->lock, portMAX_DELAY);    //the executor is between ticks: no job is running
+    vTaskDelete(tw->task);
+    for (unsigned i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++) {
+        while (tw->slots[i] != NULL) {
+            timer_wheel_job_t *job = tw->slots[i];
+            unlink_job(tw, job);
+            vPortFree(job);
+        }
+    }
+    xSemaphoreGive(tw->lock);
+    vSemaphoreDelete(tw->lock);
+    vPortFree(tw);
+}
+
+timer_wheel_job_t *timer_wheel_add(timer_wheel_t *tw, const timer_wheel_job_config_t *config)
+{
+    if (config == NULL || config->job == NULL) {
+        return NULL;
+    }
+    TickType_t period = pdMS_TO_TICKS(config->period_ms);
+    TickType_t phase = config->phase_ms ? pdMS_TO_TICKS(config->phase_ms) : period;
+    if (period == 0 || period >= WHEEL_RANGE || phase >= WHEEL_RANGE) {
+        return NULL;
+    }
+    timer_wheel_job_t *job = pvPortMalloc(sizeof(*job));
+    if (job == NULL) {
+        return NULL;
+    }
+    job->fn = config->job;
+    job->arg = config->arg;
+    job->name = config->name;
+    job->period = period;
+    atomic_init(&job->runs, 0);
+
+    lock(tw);
+    TickType_t now = xTaskGetTickCount();
+    skip_idle(tw, now);
+    job->expires = now + phase;
+    insert(tw, job);
+    tw->stats.jobs++;
+    unlock(tw);
+    if (!on_executor(tw)) {
+        xTaskNotifyGive(tw->task);          //it may sleep past the new job's first release
+    }
+    return job;
+}
+
+void timer_wheel_cancel(timer_wheel_t *tw, timer_wheel_job_t *job)
+{
+    lock(tw);
+    tw->stats.jobs--;
+    if (job == tw->running) {
+        tw->running_cancelled = true;       //freed once its callback returns
+    } else {
+        unlink_job(tw, job);
+        vPortFree(job);
+    }
+    unlock(tw);
+}
+
+TaskHandle_t timer_wheel_handle(const timer_wheel_t *tw)
+{
+    return tw->task;
+}
+
+uint32_t timer_wheel_job_runs(const timer_wheel_job_t *job)
+{
+    return atomic_load_explicit(&job->runs, memory_order_relaxed);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void timer_wheel_get(timer_wheel_t *tw, timer_wheel_stats_t *out)
+{
+    lock(tw);
+    *out = tw->stats;
+    unlock(tw);
+}
+
+void timer_wheel_print(timer_wheel_t *tw)
+{
+    timer_wheel_stats_t st;
+    timer_wheel_get(tw, &st);
+    printf("%-16s %6u jobs %8u runs  %u overruns  %u wakes  %u cascades\n",
+           tw->config.name ? tw->config.name : "timer_wheel", (unsigned)st.jobs, (unsigned)st.runs,
+           (unsigned)st.overruns, (unsigned)st.wakes, (unsigned)st.cascades);
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,100 @@
+//Give-to-take wake latency: timestamp at the give, lock-free histogram of the delta at the take
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+What is measured?
+The time from just before xSemaphoreGive() (or any other signal) in the giving task to the moment the
+take returns in the woken task: kernel give path + context switch(es) + take path. That is the critical
+path of a signal, and the part FreeRTOS adds on top of the application's own work.
+
+Flow:
+1) lat = wake_latency_create(WAKE_LATENCY_CYCLES);
+2) Giver : wake_latency_give(lat); xSemaphoreGive(sem);
+3) Taker : if (xSemaphoreTake(sem, portMAX_DELAY) == pdTRUE) { wake_latency_take(lat); ... }
+4) Anyone, any time: wake_latency_report(lat, &r) or wake_latency_print(lat, "give->take")
+
+Clocks:
+>> WAKE_LATENCY_CYCLES : CCOUNT (esp_cpu_get_cycle_count), one CPU cycle resolution, a few cycles to read.
+                         Each core has its own CCOUNT and the two are not synchronised, so a take on the
+                         other core is not recorded (counted as cross_core). With DFS (power management)
+                         the CPU clock changes and cycles no longer convert to a fixed time: use TIMER.
+>> WAKE_LATENCY_TIMER  : esp_timer_get_time(), 1 us resolution, valid across cores.
+On the host build both read clock_gettime(CLOCK_MONOTONIC) in ns.
+
+One sample per give: the first take after a give consumes its timestamp. A take without a give stamped
+since the last sample (a queued or merged signal) is counted as unmatched; with several takers of one give
+(a broadcast) only the first one is measured.
+
+Histogram: log-linear, 8 sub-buckets per power of two (values are within 12.5 % of the reported
+percentile, exact below 16 ns), up to 2^32 ns (~4.3 s). Recording is two relaxed atomic increments and a
+CAS for the max - no lock, safe from both cores and from ISRs. Percentiles are the upper bound of the
+bucket; the max is exact. Counters are 32-bit (ESP32 has no lock-free 64-bit atomics).
+---------------------------------------------------------------------------------------------------
+*/
+
+typedef struct wake_latency wake_latency_t;
+
+typedef enum {
+    WAKE_LATENCY_CYCLES = 0,
+    WAKE_LATENCY_TIMER,
+} wake_latency_clock_t;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t unmatched;                     //takes without a give stamped since the last sample
+    uint32_t cross_core;                    //WAKE_LATENCY_CYCLES: samples dropped, take on the other core
+    uint32_t p50_ns;
+    uint32_t p90_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+} wake_latency_report_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : wake_latency_create
+>> Description: Allocate an empty histogram (about 1 KB) that times with "clock".
+>> Returns: handle, or NULL if memory is exhausted.
+*/
+wake_latency_t *wake_latency_create(wake_latency_clock_t clock);
+
+void wake_latency_delete(wake_latency_t *w);
+
+//Clear the histogram and the counters (not atomic as a whole: call between measurement windows).
+void wake_latency_reset(wake_latency_t *w);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Giver: call right before the give. Task or ISR context.
+void wake_latency_give(wake_latency_t *w);
+
+/*
+Function : wake_latency_take
+>> Description: Taker: call right after the take returned. Records now - last give.
+>> Returns: pdTRUE if a sample was recorded, pdFALSE if unmatched or on the other core (CYCLES).
+*/
+BaseType_t wake_latency_take(wake_latency_t *w);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Percentiles and counters from the histogram (any task, while recording continues).
+void wake_latency_report(const wake_latency_t *w, wake_latency_report_t *out);
+
+//One line with printf: name, samples, p50 / p90 / p99 / max in ns, unmatched, cross-core.
+void wake_latency_print(const wake_latency_t *w, const char *name);
+//-------------------------------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
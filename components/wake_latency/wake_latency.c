@@ -0,0 +1,234 @@
+//Give-to-take wake latency histogram (see wake_latency.h)
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wake_latency.h"
+#include "relaxed_atomic.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+#if defined(configNUMBER_OF_CORES)
+#define WAKE_LATENCY_CORES  configNUMBER_OF_CORES
+#elif defined(portNUM_PROCESSORS)
+#define WAKE_LATENCY_CORES  portNUM_PROCESSORS
+#else
+#define WAKE_LATENCY_CORES  1
+#endif
+
+
+/*
+---------------------------------------------------------------------------------------------------
+>> The give stamp is ONE atomic word: bit 0 = armed, bit 1 = giving core, bits 2..31 = clock. The take
+   swaps it with 0, so it gets the stamp of exactly one give, even if the next give races with it.
+   The cost: deltas are taken modulo 2^30 clock units (4.4 s of CCOUNT at 240 MHz, 17 min of
+   esp_timer, 1 s on the host) - far above any wake latency worth measuring.
+>> Buckets: values below 16 ns have their own bucket; above, 8 per power of two, indexed by the most
+   significant bit and the 3 bits after it.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define STAMP_ARMED         1u
+#define STAMP_CORE1         2u
+#define STAMP_SHIFT         2
+
+#define SUB_BITS            3
+#define SUBS                (1u << SUB_BITS)
+#define BUCKETS             ((32u - SUB_BITS + 1u) * SUBS)     //240: the last one ends at 2^32 - 1 ns
+
+struct wake_latency {
+    wake_latency_clock_t clock;
+    uint32_t cycles_per_us;                 //WAKE_LATENCY_CYCLES on the ESP32
+    atomic_uint stamp;
+    atomic_uint samples;
+    atomic_uint unmatched;
+    atomic_uint cross_core;
+    atomic_uint max_ns;
+    atomic_uint hist[BUCKETS];
+};
+
+
+//Clock in its own units: CPU cycles or us on the ESP32, ns on the host
+static inline uint32_t clock_now(const wake_latency_t *w)
+{
+#ifdef ESP_PLATFORM
+    return (w->clock == WAKE_LATENCY_CYCLES) ? (uint32_t)esp_cpu_get_cycle_count() : (uint32_t)esp_timer_get_time();
+#else
+    (void)w;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+static inline uint32_t units_to_ns(const wake_latency_t *w, uint32_t units)
+{
+#ifdef ESP_PLATFORM
+    uint64_t ns = (w->clock == WAKE_LATENCY_CYCLES) ? (uint64_t)units * 1000u / w->cycles_per_us
+                                                     : (uint64_t)units * 1000u;
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+#else
+    (void)w;
+    return units;
+#endif
+}
+
+static inline uint32_t current_core(void)
+{
+#if WAKE_LATENCY_CORES > 1
+    return (uint32_t)xPortGetCoreID();
+#else
+    return 0;
+#endif
+}
+
+static unsigned bucket_of(uint32_t ns)
+{
+    if (ns < 2 * SUBS) {
+        return ns;
+    }
+    unsigned msb = 31u - (unsigned)__builtin_clz(ns);
+    return (msb - SUB_BITS + 1u) * SUBS + ((ns >> (msb - SUB_BITS)) & (SUBS - 1u));
+}
+
+//Largest value that falls into "bucket"
+static uint32_t bucket_top(unsigned bucket)
+{
+    if (bucket < 2 * SUBS) {
+        return bucket;
+    }
+    unsigned shift = bucket / SUBS - 1u;    //msb - SUB_BITS
+    uint64_t low = (uint64_t)(SUBS + bucket % SUBS) << shift;
+    return (uint32_t)(low + ((uint64_t)1 << shift) - 1u);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+wake_latency_t *wake_latency_create(wake_latency_clock_t clock)
+{
+    wake_latency_t *w = pvPortMalloc(sizeof(*w));
+    if (w == NULL) {
+        return NULL;
+    }
+    w->clock = clock;
+#ifdef ESP_PLATFORM
+    w->cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+#else
+    w->cycles_per_us = 1000;
+#endif
+    atomic_init(&w->stamp, 0);
+    atomic_init(&w->samples, 0);
+    atomic_init(&w->unmatched, 0);
+    atomic_init(&w->cross_core, 0);
+    atomic_init(&w->max_ns, 0);
+    for (unsigned i = 0; i < BUCKETS; i++) {
+        atomic_init(&w->hist[i], 0);
+    }
+    return w;
+}
+
+void wake_latency_delete(wake_latency_t *w)
+{
+    vPortFree(w);
+}
+
+void wake_latency_reset(wake_latency_t *w)
+{
+    atomic_store(&w->stamp, 0);
+    atomic_store(&w->samples, 0);
+    atomic_store(&w->unmatched, 0);
+    atomic_store(&w->cross_core, 0);
+    atomic_store(&w->max_ns, 0);
+    for (unsigned i = 0; i < BUCKETS; i++) {
+        atomic_store_explicit(&w->hist[i], 0, memory_order_relaxed);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void wake_latency_give(wake_latency_t *w)
+{
+    uint32_t stamp = (clock_now(w) << STAMP_SHIFT) | (current_core() ? STAMP_CORE1 : 0u) | STAMP_ARMED;
+    atomic_store_explicit(&w->stamp, stamp, memory_order_release);
+}
+
+BaseType_t wake_latency_take(wake_latency_t *w)
+{
+    uint32_t now = clock_now(w);            //first: everything below is not part of the wake
+    uint32_t stamp = atomic_exchange_explicit(&w->stamp, 0, memory_order_acquire);
+    if ((stamp & STAMP_ARMED) == 0) {
+        relaxed_add(&w->unmatched, 1);
+        return pdFALSE;
+    }
+    if (w->clock == WAKE_LATENCY_CYCLES && ((stamp & STAMP_CORE1) != 0) != (current_core() != 0)) {
+        relaxed_add(&w->cross_core, 1);
+        return pdFALSE;
+    }
+
+    uint32_t units = ((now << STAMP_SHIFT) - (stamp & ~(STAMP_ARMED | STAMP_CORE1))) >> STAMP_SHIFT;
+    uint32_t ns = units_to_ns(w, units);
+    relaxed_add(&w->hist[bucket_of(ns)], 1);
+    relaxed_add(&w->samples, 1);
+    unsigned seen = relaxed_load(&w->max_ns);
+    while (ns > seen &&
+           !atomic_compare_exchange_weak_explicit(&w->max_ns, &seen, ns, memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return pdTRUE;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Walks the live counters instead of copying ~1 KB to the stack; samples recorded meanwhile can only
+//move a percentile to a later bucket
+void wake_latency_report(const wake_latency_t *w, wake_latency_report_t *out)
+{
+    static const double pcts[] = { 50.0, 90.0, 99.0 };
+    uint32_t *fields[] = { &out->p50_ns, &out->p90_ns, &out->p99_ns };
+
+    uint32_t total = 0;
+    for (unsigned i = 0; i < BUCKETS; i++) {
+        total += relaxed_load(&w->hist[i]);
+    }
+    for (unsigned p = 0; p < sizeof(pcts) / sizeof(pcts[0]); p++) {
+        uint32_t rank = (uint32_t)((double)total * pcts[p] / 100.0);
+        uint32_t seen = 0;
+        *fields[p] = 0;
+        for (unsigned i = 0; i < BUCKETS && total > 0; i++) {
+            seen += relaxed_load(&w->hist[i]);
+            if (seen > rank) {
+                *fields[p] = bucket_top(i);
+                break;
+            }
+        }
+    }
+    out->samples = total;
+    out->unmatched = relaxed_load(&w->unmatched);
+    out->cross_core = relaxed_load(&w->cross_core);
+    out->max_ns = relaxed_load(&w->max_ns);
+    //The max is exact, the bucket top of the p99 may lie above it
+    for (unsigned p = 0; p < sizeof(pcts) / sizeof(pcts[0]); p++) {
+        if (*fields[p] > out->max_ns) {
+            *fields[p] = out->max_ns;
+        }
+    }
+}
+
+void wake_latency_print(const wake_latency_t *w, const char *name)
+{
+    wake_latency_report_t r;
+    wake_latency_report(w, &r);
+    printf("%-16s %8u samples  p50 %8u  p90 %8u  p99 %8u  max %8u ns  unmatched %u  cross-core %u\n", name,
+           (unsigned)r.samples, (unsigned)r.p50_ns, (unsigned)r.p90_ns, (unsigned)r.p99_ns, (unsigned)r.max_ns,
+           (unsigned)r.unmatched, (unsigned)r.cross_core);
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,177 @@
+//Host benchmark: caller-side cost of synchronous ESP_LOGI vs. deferred ASYNC_LOGI
+//Two sinks for stdout: /dev/null (formatting cost only) and a model of the ESP32 console UART at
+//115200 baud (8N1: 10 bits per byte, the writer spins until the byte would have left the FIFO).
+//The table goes to the original stdout, the log lines go to the sink.
+
+#define _GNU_SOURCE                         //fopencookie
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "async_log.h"
+#include "bench_util.h"
+
+#define BENCH_CALLS_NULL    20000u
+#define BENCH_CALLS_UART    400u
+#define UART_BAUD           115200u         //CONFIG_ESP_CONSOLE_UART_BAUDRATE
+#define BURST_CALLS         (ASYNC_LOG_RING_SIZE * 8u)
+
+static const char *TAG = "EX2";
+static FILE *report;
+static FILE *null_sink;
+static FILE *uart_sink;
+static uint32_t *samples;
+
+
+//-------------------------------------------------------------------------------------------------
+static ssize_t uart_write(void *cookie, const char *buf, size_t size)
+{
+    (void)cookie;
+    (void)buf;
+    uint64_t until = bench_now_ns() + (uint64_t)size * 10u * 1000000000ull / UART_BAUD;
+    while (bench_now_ns() < until) {
+    }
+    return (ssize_t)size;
+}
+
+static FILE *open_uart_sink(void)
+{
+    cookie_io_functions_t io = { .write = uart_write };
+    FILE *f = fopencookie(NULL, "w", io);
+    setvbuf(f, NULL, _IOLBF, 256);          //line buffered like the ESP-IDF console
+    return f;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+typedef enum { FMT_INT, FMT_MIXED } fmt_kind_t;
+static const char *const fmt_names[] = { "\"Got value: %d\"", "int+unsigned+double+%s" };
+
+static inline void log_sync(fmt_kind_t fmt, uint32_t i)
+{
+    if (fmt == FMT_INT) {
+        ESP_LOGI(TAG, "Got value: %d", (int)i);
+    } else {
+        ESP_LOGI(TAG, "ch%d raw=%u volts=%.3f state=%s", (int)(i & 7), (unsigned)i, i * 0.001, "ok");
+    }
+}
+
+static inline void log_async(fmt_kind_t fmt, uint32_t i)
+{
+    if (fmt == FMT_INT) {
+        ASYNC_LOGI(TAG, "Got value: %d", (int)i);
+    } else {
+        ASYNC_LOGI(TAG, "ch%d raw=%u volts=%.3f state=%s", (int)(i & 7), (unsigned)i, i * 0.001, "ok");
+    }
+}
+
+typedef struct {
+    double mean_ns;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+} call_cost_t;
+
+static call_cost_t summarize(uint32_t calls, uint64_t total_ns)
+{
+    call_cost_t c;
+    c.mean_ns = (double)total_ns / calls;
+    c.p50_ns = bench_percentile(samples, calls, 50.0);
+    c.p99_ns = bench_percentile(samples, calls, 99.0);
+    return c;
+}
+
+static call_cost_t run_sync(fmt_kind_t fmt, uint32_t calls)
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < calls; i++) {
+        uint64_t t0 = bench_now_ns();
+        log_sync(fmt, i);
+        samples[i] = (uint32_t)(bench_now_ns() - t0);
+        total += samples[i];
+    }
+    fflush(stdout);
+    return summarize(calls, total);
+}
+
+//Calls are timed one by one; between groups of half a ring the drain task is allowed to catch up,
+//so the ring never overflows and only the caller-side cost is measured
+static call_cost_t run_async(fmt_kind_t fmt, uint32_t calls)
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < calls; i++) {
+        uint64_t t0 = bench_now_ns();
+        log_async(fmt, i);
+        samples[i] = (uint32_t)(bench_now_ns() - t0);
+        total += samples[i];
+        if ((i % (ASYNC_LOG_RING_SIZE / 2)) == ASYNC_LOG_RING_SIZE / 2 - 1) {
+            async_log_flush(portMAX_DELAY);
+        }
+    }
+    async_log_flush(portMAX_DELAY);
+    return summarize(calls, total);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void bench_task(void *pv)
+{
+    (void)pv;
+    samples = malloc(BENCH_CALLS_NULL * sizeof(uint32_t));
+    configASSERT(samples != NULL);
+    BaseType_t started = async_log_start();
+    configASSERT(started == pdPASS);
+
+    const struct { const char *name; FILE *sink; uint32_t calls; } sinks[] = {
+        { "/dev/null",   null_sink, BENCH_CALLS_NULL },
+        { "uart 115200", uart_sink, BENCH_CALLS_UART },
+    };
+
+    fprintf(report, "caller-side cost per log call (ring %u records/core, drain task priority %u)\n",
+            ASYNC_LOG_RING_SIZE, (unsigned)ASYNC_LOG_TASK_PRIORITY);
+    fprintf(report, "%-12s %-24s %12s %10s %10s %12s %10s %10s %8s\n", "sink", "format",
+            "sync ns", "p50", "p99", "async ns", "p50", "p99", "speedup");
+    for (size_t s = 0; s < sizeof(sinks) / sizeof(sinks[0]); s++) {
+        stdout = sinks[s].sink;
+        for (int f = FMT_INT; f <= FMT_MIXED; f++) {
+            call_cost_t sync = run_sync((fmt_kind_t)f, sinks[s].calls);
+            call_cost_t async = run_async((fmt_kind_t)f, sinks[s].calls);
+            fprintf(report, "%-12s %-24s %12.0f %10u %10u %12.0f %10u %10u %7.1fx\n", sinks[s].name,
+                    fmt_names[f], sync.mean_ns, (unsigned)sync.p50_ns, (unsigned)sync.p99_ns, async.mean_ns,
+                    (unsigned)async.p50_ns, (unsigned)async.p99_ns, sync.mean_ns / async.mean_ns);
+        }
+    }
+    configASSERT(async_log_dropped() == 0);
+
+    //Burst without letting the drain task run: the ring overflows and the extra lines are counted
+    stdout = null_sink;
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < BURST_CALLS; i++) {
+        log_async(FMT_INT, i);
+    }
+    uint64_t burst_ns = bench_now_ns() - t0;
+    uint32_t dropped = async_log_dropped();
+    async_log_flush(portMAX_DELAY);
+    fprintf(report, "\nburst of %u calls into %u free records: %u dropped (counted), %.0f ns per call\n",
+            BURST_CALLS, ASYNC_LOG_RING_SIZE, (unsigned)dropped, (double)burst_ns / BURST_CALLS);
+    fflush(report);
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    null_sink = fopen("/dev/null", "w");
+    uart_sink = open_uart_sink();
+    configASSERT(report != NULL && null_sink != NULL && uart_sink != NULL);
+
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
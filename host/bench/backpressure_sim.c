@@ -0,0 +1,113 @@
+//Host simulation: fixed-rate vs. adaptive (rate_ctrl) producer against slow and bursty consumers
+//Reports sustained throughput (items received per second) and loss rate for every scenario.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "rate_ctrl.h"
+
+#define SIM_SECONDS         5u
+#define QUEUE_DEPTH         10u             //same as QUEUE_EXAMPLE_BASIC
+#define FIXED_PERIOD        pdMS_TO_TICKS(10)   //fixed producer running flat out (1 tick)
+#define SEND_TIMEOUT        pdMS_TO_TICKS(10)   //same timeout as the example
+
+typedef enum { CONSUMER_FAST, CONSUMER_SLOW, CONSUMER_BURSTY } consumer_kind_t;
+static const char *const consumer_names[] = { "fast", "slow (40 ms/item)", "bursty (0.5 s on/off)" };
+
+typedef struct {
+    QueueHandle_t q;
+    consumer_kind_t consumer;
+    int adaptive;
+    rate_ctrl_t rc;                         //used for both producers, so the accounting is identical
+    volatile uint32_t received;
+} sim_ctx_t;
+
+static sim_ctx_t ctx;
+
+
+//-------------------------------------------------------------------------------------------------
+static void producer_task(void *pv)
+{
+    (void)pv;
+    int value = 0;
+    while (1) {
+        value++;
+        BaseType_t sent = xQueueSend(ctx.q, &value, SEND_TIMEOUT);
+        TickType_t next = rate_ctrl_update(&ctx.rc, uxQueueMessagesWaiting(ctx.q), QUEUE_DEPTH, sent);
+        vTaskDelay(ctx.adaptive ? next : FIXED_PERIOD);
+    }
+}
+
+static void consumer_task(void *pv)
+{
+    (void)pv;
+    int rx = 0;
+    while (1) {
+        if (ctx.consumer == CONSUMER_BURSTY) {
+            //Stalled for the second half of every second (e.g. busy flushing to flash)
+            TickType_t phase = xTaskGetTickCount() % configTICK_RATE_HZ;
+            if (phase >= configTICK_RATE_HZ / 2) {
+                vTaskDelay(configTICK_RATE_HZ - phase);
+            }
+        }
+        if (xQueueReceive(ctx.q, &rx, portMAX_DELAY) == pdPASS) {
+            ctx.received++;
+            if (ctx.consumer == CONSUMER_SLOW) {
+                vTaskDelay(pdMS_TO_TICKS(40));
+            }
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void run_case(consumer_kind_t consumer, int adaptive)
+{
+    rate_ctrl_config_t cfg = RATE_CTRL_DEFAULT_CONFIG();
+    rate_ctrl_init(&ctx.rc, &cfg);
+    ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(int));
+    configASSERT(ctx.q != NULL);
+    ctx.consumer = consumer;
+    ctx.adaptive = adaptive;
+    ctx.received = 0;
+
+    TaskHandle_t producer, cons;
+    xTaskCreate(consumer_task, "consumer", 2048, NULL, 5, &cons);
+    xTaskCreate(producer_task, "producer", 2048, NULL, 5, &producer);
+    vTaskDelay(pdMS_TO_TICKS(SIM_SECONDS * 1000u));
+    vTaskDelete(producer);
+    vTaskDelete(cons);
+
+    printf("%-22s %-9s %10.1f %9u %9u %8.1f%% %14u\n",
+           consumer_names[consumer], adaptive ? "adaptive" : "fixed",
+           (double)ctx.received / SIM_SECONDS, (unsigned)ctx.rc.attempts, (unsigned)ctx.rc.dropped,
+           rate_ctrl_loss_permille(&ctx.rc) / 10.0,
+           (unsigned)((adaptive ? ctx.rc.period : FIXED_PERIOD) * portTICK_PERIOD_MS));
+    vQueueDelete(ctx.q);
+}
+
+static void sim_task(void *pv)
+{
+    (void)pv;
+    printf("%u s per scenario, queue depth %u, fixed producer period %u ms\n",
+           SIM_SECONDS, QUEUE_DEPTH, (unsigned)(FIXED_PERIOD * portTICK_PERIOD_MS));
+    printf("%-22s %-9s %10s %9s %9s %9s %14s\n", "consumer", "producer", "rx/sec", "attempts", "dropped",
+           "loss", "end period ms");
+    for (int c = CONSUMER_FAST; c <= CONSUMER_BURSTY; c++) {
+        run_case((consumer_kind_t)c, 0);
+        run_case((consumer_kind_t)c, 1);
+    }
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(sim_task, "sim", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,41 @@
+//Small helpers shared by the host benchmarks (FreeRTOS POSIX port only)
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+//Monotonic wall clock in nanoseconds (host replacement for the CCOUNT cycle counter)
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+//CPU time consumed by the whole process in nanoseconds (all FreeRTOS tasks share one process)
+static inline uint64_t bench_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+//Sort "samples" in place and return the requested percentile (0.0 .. 100.0)
+static inline uint32_t bench_percentile(uint32_t *samples, size_t count, double pct)
+{
+    if (count == 0) {
+        return 0;
+    }
+    qsort(samples, count, sizeof(uint32_t), bench_cmp_u32);
+    size_t idx = (size_t)((pct / 100.0) * (double)(count - 1) + 0.5);
+    return samples[idx];
+}
@@ -0,0 +1,254 @@
+//Host round-trip check for the binlog component
+//Replays the log lines of the three examples (plus a few argument edge cases) through BINLOG_x and, in
+//parallel, through plain snprintf. The binary stream is decoded with the string table read back from this
+//executable and must reproduce the text byte for byte. Reports bytes per line for both and the ratio.
+//
+//  binlog_roundtrip            exit code 1 on any mismatch or if the size reduction is below 5x
+
+#define _GNU_SOURCE                         //open_memstream
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "binlog.h"
+#include "binlog_decode.h"
+
+#define SIM_SECONDS         600u            //simulated run time
+#define MIN_REDUCTION       5.0             //host text bytes / binary bytes
+#define DECODE_CHUNK        7u              //feed the decoder in odd-sized pieces, like a serial port
+
+typedef enum { EX1, EX2, EX3, EDGE, STREAM_COUNT } stream_t;
+static const char *const stream_names[] = {
+    "ex1 task1/task2 (ESP_LOGI)", "ex2 producer/consumer", "ex3 taskA/B/C (printf)", "argument edge cases"
+};
+
+typedef struct {
+    uint32_t lines;
+    uint64_t text_bytes;                    //host console (no colours, LF)
+    uint64_t console_bytes;                 //ESP32 console: CONFIG_LOG_COLORS + CRLF
+    uint64_t binary_bytes;                  //including the SYNC / TAG records the line triggered
+} stream_stats_t;
+
+static stream_stats_t stats[STREAM_COUNT];
+static uint8_t *bin;
+static size_t bin_len, bin_cap;
+static char *ref;
+static size_t ref_len, ref_cap;
+static uint32_t sim_now_ms;
+
+
+//-------------------------------------------------------------------------------------------------
+static void grow(void **buf, size_t *cap, size_t need)
+{
+    if (need > *cap) {
+        *cap = (need > *cap * 2) ? need : *cap * 2;
+        *buf = realloc(*buf, *cap);
+        configASSERT(*buf != NULL);
+    }
+}
+
+static void bin_sink(const void *data, size_t len)
+{
+    grow((void **)&bin, &bin_cap, bin_len + len);
+    memcpy(&bin[bin_len], data, len);
+    bin_len += len;
+}
+
+static uint32_t sim_clock(void)
+{
+    return sim_now_ms;
+}
+
+//Reference text; returns its length and the number of '\n' in it
+static __attribute__((format(printf, 2, 3))) size_t ref_printf(size_t *newlines, const char *format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf(NULL, 0, format, ap);
+    va_end(ap);
+    grow((void **)&ref, &ref_cap, ref_len + (size_t)n + 1);
+    va_start(ap, format);
+    vsnprintf(&ref[ref_len], (size_t)n + 1, format, ap);
+    va_end(ap);
+
+    *newlines = 0;
+    for (int i = 0; i < n; i++) {
+        *newlines += (ref[ref_len + (size_t)i] == '\n');
+    }
+    ref_len += (size_t)n;
+    return (size_t)n;
+}
+
+static void account(stream_t s, size_t binary, size_t text, size_t console)
+{
+    stats[s].lines++;
+    stats[s].binary_bytes += binary;
+    stats[s].text_bytes += text;
+    stats[s].console_bytes += console;
+}
+
+#define LOG_COLOR_BYTES     11              //"\033[0;32m" ... "\033[0m"
+
+//The same ESP_LOGI line through binlog and as text
+#define LOGI_BOTH(stream, tag, format, ...)                                                     \
+    do {                                                                                        \
+        size_t before = bin_len, newlines;                                                      \
+        BINLOG_LOGI(tag, format, ##__VA_ARGS__);                                                \
+        size_t n = ref_printf(&newlines, "I (%u) %s: " format "\n", (unsigned)sim_now_ms, tag, ##__VA_ARGS__); \
+        account(stream, bin_len - before, n, n + LOG_COLOR_BYTES + newlines);                   \
+    } while (0)
+
+//The same printf through binlog and as text
+#define PRINTF_BOTH(stream, format, ...)                                                        \
+    do {                                                                                        \
+        size_t before = bin_len, newlines;                                                      \
+        BINLOG_PRINTF(format, ##__VA_ARGS__);                                                   \
+        size_t n = ref_printf(&newlines, format, ##__VA_ARGS__);                                \
+        account(stream, bin_len - before, n, n + newlines);                                     \
+    } while (0)
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//What the examples print, on the simulated clock (same periods as the real tasks)
+static void replay_examples(void)
+{
+    static const char *TAG = "EX2";
+    int value = 0;
+    int next_taker = 0;
+
+    for (sim_now_ms = 0; sim_now_ms < SIM_SECONDS * 1000u; sim_now_ms += 100) {
+        if (sim_now_ms % 1000 == 0) {
+            LOGI_BOTH(EX1, "TASK1", "Running...");
+            PRINTF_BOTH(EX3, "Task A: Giving semaphore\n");
+            if (next_taker == 0) {
+                PRINTF_BOTH(EX3, "Task B: Received semaphore!\n");
+            } else {
+                PRINTF_BOTH(EX3, "Task C: Received semaphore!\n");
+            }
+            next_taker ^= 1;
+        }
+        if (sim_now_ms % 500 == 0) {
+            LOGI_BOTH(EX1, "TASK2", "Running...");
+        }
+        if (sim_now_ms % 200 == 0) {
+            value++;
+            LOGI_BOTH(EX2, TAG, "Got value: %d", value);
+        }
+        if (sim_now_ms % 10000 == 0) {
+            LOGI_BOTH(EX2, TAG, "Rate: period %u ms, sent %u, dropped %u (%u.%u%% loss)",
+                      200u, (unsigned)value, 3u, 0u, 5u);
+        }
+    }
+}
+
+static void replay_edge_cases(void)
+{
+    char stack_text[16];
+    snprintf(stack_text, sizeof(stack_text), "on stack");
+
+    LOGI_BOTH(EDGE, "EDGE", "neg %d %i min %ld", -1, -123456, (long)INT32_MIN);
+    LOGI_BOTH(EDGE, "EDGE", "hex %x %#X %08lx oct %o", 0xdeadbeefu, 255u, 0x1234ul, 8u);
+    LOGI_BOTH(EDGE, "EDGE", "short %hd %hhu size %zu", (short)-7, (unsigned char)200, (size_t)4096);
+    LOGI_BOTH(EDGE, "EDGE", "width |%5d|%-5d|%*d|%.*s|", 42, 42, 6, 7, 3, "abcdef");
+    LOGI_BOTH(EDGE, "EDGE", "float %.3f %e %g", 3.14159, -0.00012, 1e10);
+    LOGI_BOTH(EDGE, "EDGE", "char %c%c string '%s' '%s'", 'o', 'k', stack_text, "");
+    LOGI_BOTH(EDGE, "EDGE", "percent 100%% %llu", 18446744073709551615ull);
+    PRINTF_BOTH(EDGE, "printf two\nlines %d\n", 2);
+    PRINTF_BOTH(EDGE, "no newline ");
+    PRINTF_BOTH(EDGE, "tab\tand backslash \\ %s\n", "done");
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static int check_round_trip(void)
+{
+    binlog_table_t table;
+    if (binlog_table_load(&table, "/proc/self/exe") != 0) {
+        return 0;
+    }
+    char *decoded = NULL;
+    size_t decoded_len = 0;
+    FILE *out = open_memstream(&decoded, &decoded_len);
+    configASSERT(out != NULL);
+
+    static binlog_decoder_t decoder;
+    binlog_decoder_init(&decoder, &table, out);
+    for (size_t pos = 0; pos < bin_len; pos += DECODE_CHUNK) {
+        size_t n = (bin_len - pos < DECODE_CHUNK) ? bin_len - pos : DECODE_CHUNK;
+        binlog_decoder_feed(&decoder, &bin[pos], n);
+    }
+    binlog_decoder_finish(&decoder);
+    fclose(out);
+
+    int ok = (decoded_len == ref_len && memcmp(decoded, ref, ref_len) == 0 && decoder.resyncs == 0);
+    if (!ok) {
+        size_t i = 0;
+        while (i < decoded_len && i < ref_len && decoded[i] == ref[i]) {
+            i++;
+        }
+        size_t from = (i > 40) ? i - 40 : 0;
+        printf("MISMATCH at byte %zu (%u resyncs)\n  expected: %.80s\n  decoded:  %.80s\n", i,
+               (unsigned)decoder.resyncs, &ref[from], (from < decoded_len) ? &decoded[from] : "");
+    }
+    printf("%zu call sites in the string table, %llu records decoded\n", table.count,
+           (unsigned long long)decoder.records);
+    free(decoded);
+    binlog_table_free(&table);
+    return ok;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    static const char boot_text[] = "ets Jun  8 2016 00:22:57\nrst:0x1 (POWERON_RESET),boot:0x13 (SPI_FAST_FLASH_BOOT)\n";
+
+    //Boot messages come before binlog_start() and must pass through the decoder untouched
+    bin_sink(boot_text, sizeof(boot_text) - 1);
+    size_t newlines;
+    ref_printf(&newlines, "%s", boot_text);
+
+    binlog_config_t cfg = BINLOG_DEFAULT_CONFIG();
+    cfg.write = bin_sink;
+    cfg.timestamp = sim_clock;
+    BaseType_t started = binlog_start(&cfg);
+    configASSERT(started == pdPASS);
+
+    replay_examples();
+    replay_edge_cases();
+    configASSERT(binlog_dropped() == 0);
+
+    int ok = check_round_trip();
+
+    printf("\n%-28s %8s %12s %12s %12s %10s %10s\n", "stream", "lines", "text B/line", "ESP32 B/line",
+           "binary B/line", "vs text", "vs ESP32");
+    double worst = 1e9;
+    for (int s = 0; s < STREAM_COUNT; s++) {
+        const stream_stats_t *st = &stats[s];
+        double text = (double)st->text_bytes / st->lines;
+        double console = (double)st->console_bytes / st->lines;
+        double binary = (double)st->binary_bytes / st->lines;
+        printf("%-28s %8u %12.1f %12.1f %12.2f %9.1fx %9.1fx\n", stream_names[s], (unsigned)st->lines,
+               text, console, binary, text / binary, console / binary);
+        if (s != EDGE && text / binary < worst) {
+            worst = text / binary;
+        }
+    }
+    printf("\nround trip: %s, smallest reduction on the example streams %.1fx (required %.1fx)\n",
+           ok ? "identical" : "FAILED", worst, MIN_REDUCTION);
+    fflush(stdout);
+    exit((ok && worst >= MIN_REDUCTION) ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 8192, NULL, 5, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,157 @@
+//Host benchmark: wake-all latency of event_broadcast as the number of subscribers grows (2 .. 32)
+//Subscribers run above the publisher, so each publish is followed by all of them running before the
+//publisher continues. Per tick, from just before the publish call:
+//  first wake : the first subscriber's wait returned
+//  last wake  : the last subscriber's wait returned (every subscriber has seen the tick)
+//  round      : the publisher runs again - all subscribers woke, acknowledged and blocked again
+//Baseline: the publisher wakes the same subscribers one by one with xTaskNotifyGive() (N calls per tick).
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "event_broadcast.h"
+#include "bench_util.h"
+
+#define BENCH_TICKS         2000u
+#define MAX_SUBSCRIBERS     32u
+#define PUBLISHER_PRIO      4
+#define SUBSCRIBER_PRIO     5
+
+static const uint32_t subscriber_counts[] = { 2, 4, 8, 16, 32 };
+#define COUNT_CASES         (sizeof(subscriber_counts) / sizeof(subscriber_counts[0]))
+
+typedef enum { WAKE_BROADCAST, WAKE_NOTIFY_LOOP } wake_kind_t;
+
+typedef struct {
+    wake_kind_t kind;
+    event_broadcast_t *broadcast;
+    uint32_t subscribers;
+    atomic_uint woken;                      //subscribers that saw the current tick
+    uint64_t wake_ns[MAX_SUBSCRIBERS];
+} bench_ctx_t;
+
+typedef struct {
+    bench_ctx_t *ctx;
+    uint32_t index;
+} subscriber_arg_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void subscriber_task(void *pv)
+{
+    const subscriber_arg_t *arg = pv;
+    bench_ctx_t *ctx = arg->ctx;
+    while (1) {
+        BaseType_t got = (ctx->kind == WAKE_BROADCAST) ? event_broadcast_wait(ctx->broadcast, arg->index, portMAX_DELAY)
+                                                       : (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) != 0);
+        ctx->wake_ns[arg->index] = bench_now_ns();
+        configASSERT(got == pdTRUE);
+        (void)got;
+        atomic_fetch_add_explicit(&ctx->woken, 1, memory_order_relaxed);
+        if (ctx->kind == WAKE_BROADCAST) {
+            event_broadcast_ack(ctx->broadcast, arg->index);
+        }
+    }
+}
+
+static void run_case(wake_kind_t kind, uint32_t subscribers)
+{
+    static bench_ctx_t ctx;
+    static subscriber_arg_t args[MAX_SUBSCRIBERS];
+    TaskHandle_t tasks[MAX_SUBSCRIBERS];
+    ctx.kind = kind;
+    ctx.subscribers = subscribers;
+    ctx.broadcast = NULL;
+    if (kind == WAKE_BROADCAST) {
+        ctx.broadcast = event_broadcast_create(subscribers);
+        configASSERT(ctx.broadcast != NULL);
+    }
+
+    uint32_t *first_ns = malloc(BENCH_TICKS * sizeof(uint32_t));
+    uint32_t *last_ns = malloc(BENCH_TICKS * sizeof(uint32_t));
+    configASSERT(first_ns != NULL && last_ns != NULL);
+
+    for (uint32_t i = 0; i < subscribers; i++) {
+        args[i] = (subscriber_arg_t){ .ctx = &ctx, .index = i };
+        xTaskCreate(subscriber_task, "sub", 2048, &args[i], SUBSCRIBER_PRIO, &tasks[i]);
+        configASSERT(tasks[i] != NULL);
+    }
+
+    uint64_t round_sum = 0;
+    for (uint32_t t = 0; t < BENCH_TICKS; t++) {
+        atomic_store_explicit(&ctx.woken, 0, memory_order_relaxed);
+        uint64_t start = bench_now_ns();
+        if (kind == WAKE_BROADCAST) {
+            BaseType_t sent = event_broadcast_publish(ctx.broadcast, portMAX_DELAY);
+            configASSERT(sent == pdPASS);
+            (void)sent;
+        } else {
+            for (uint32_t i = 0; i < subscribers; i++) {
+                xTaskNotifyGive(tasks[i]);
+            }
+        }
+        uint64_t end = bench_now_ns();
+        //Subscribers are above us: by now every one of them has run (one core)
+        configASSERT(atomic_load_explicit(&ctx.woken, memory_order_relaxed) == subscribers);
+
+        uint64_t first = UINT64_MAX, last = 0;
+        for (uint32_t i = 0; i < subscribers; i++) {
+            first = ctx.wake_ns[i] < first ? ctx.wake_ns[i] : first;
+            last = ctx.wake_ns[i] > last ? ctx.wake_ns[i] : last;
+        }
+        first_ns[t] = (uint32_t)(first - start);
+        last_ns[t] = (uint32_t)(last - start);
+        round_sum += end - start;
+    }
+
+    for (uint32_t i = 0; i < subscribers; i++) {
+        vTaskDelete(tasks[i]);
+    }
+    if (kind == WAKE_BROADCAST) {
+        event_broadcast_stats_t st;
+        event_broadcast_get(ctx.broadcast, &st);
+        configASSERT(st.published == BENCH_TICKS && st.skipped == 0 && st.acks == BENCH_TICKS * subscribers);
+        event_broadcast_delete(ctx.broadcast);
+    }
+
+    uint64_t last_sum = 0;
+    for (uint32_t t = 0; t < BENCH_TICKS; t++) {
+        last_sum += last_ns[t];
+    }
+    uint32_t first_p50 = bench_percentile(first_ns, BENCH_TICKS, 50.0);
+    uint32_t last_p50 = bench_percentile(last_ns, BENCH_TICKS, 50.0);
+    uint32_t last_p99 = bench_percentile(last_ns, BENCH_TICKS, 99.0);
+    uint32_t last_max = last_ns[BENCH_TICKS - 1];
+    printf("%-20s %5u %12u %10.0f %10u %10u %10u %12.0f\n",
+           kind == WAKE_BROADCAST ? "event_broadcast" : "xTaskNotifyGive x N", (unsigned)subscribers,
+           first_p50, (double)last_sum / BENCH_TICKS, last_p50, last_p99, last_max,
+           (double)round_sum / BENCH_TICKS);
+    free(first_ns);
+    free(last_ns);
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    vTaskPrioritySet(NULL, PUBLISHER_PRIO);
+    printf("wake-all latency, %u ticks per case, publisher priority %d, subscribers at priority %d\n",
+           BENCH_TICKS, PUBLISHER_PRIO, SUBSCRIBER_PRIO);
+    printf("%-20s %5s %12s %10s %10s %10s %10s %12s\n", "wake", "N", "first p50 ns", "last avg",
+           "last p50", "last p99", "last max", "ns/round");
+    for (size_t c = 0; c < COUNT_CASES; c++) {
+        run_case(WAKE_BROADCAST, subscriber_counts[c]);
+        run_case(WAKE_NOTIFY_LOOP, subscriber_counts[c]);
+    }
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
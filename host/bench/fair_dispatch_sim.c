@@ -0,0 +1,244 @@
+//Host simulation: how SIMPLE_BIN_SEMAPHORE's signals are split between competing waiters
+//taskA gives every GIVE_PERIOD_US, taskB needs ~60 us per signal and taskC ~140 us (a slower consumer).
+//SIM_GIVES gives per case: the binary semaphore of the example, then notify_dispatch round robin and
+//least recent. Per waiter: share of the wakes, gives addressed / merged, and wake latency (simulated us
+//from the give to the take returning). Lost = gives that produced no wake (semaphore already given,
+//notification still pending).
+//
+//The clock is simulated, the tasks and the kernel are real: taskA (this bench task) runs at the LOWEST
+//priority, so it only runs when taskB and taskC are both blocked - waiting for the signal, or "working"
+//(blocked on work_done until the clock reaches busy_until). taskA advances the clock event by event (next
+//give or next end of work), so the result does not depend on host speed and every run prints the same.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "notify_dispatch.h"
+#include "bench_util.h"
+
+#define SIM_GIVES           100000u
+#define GIVE_PERIOD_US      60u
+#define WORK_SPREAD_PCT     30u             //work time = mean +- 30 %, uniform
+#define WAITERS             2u
+#define GIVER_PRIO          1               //below the waiters: runs only when both are blocked
+#define WAITER_PRIO         2
+#define NOT_PENDING         UINT64_MAX
+
+static const uint32_t work_mean_us[WAITERS] = { 60, 140 };
+static const char *const waiter_names[WAITERS] = { "taskB", "taskC" };
+
+typedef enum { CASE_SEMAPHORE, CASE_ROUND_ROBIN, CASE_LEAST_RECENT, CASE_COUNT } sim_case_t;
+static const char *const case_names[CASE_COUNT] = { "binary semaphore", "round robin", "least recent" };
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t work_done;
+    bool busy;
+    uint64_t busy_until;
+    uint64_t pending_since;                 //notify cases: time of the give this waiter will take next
+    uint32_t wakes;
+    uint32_t *latency_us;                   //one entry per wake
+    uint32_t rng;
+} sim_waiter_t;
+
+static struct {
+    sim_case_t kind;
+    SemaphoreHandle_t sem;
+    notify_dispatch_t *dispatch;
+    uint64_t now_us;
+    uint64_t sem_given_at;                  //semaphore case: time of the give that is still pending
+    uint32_t sem_lost;                      //semaphore case: gives while the semaphore was already given
+    sim_waiter_t w[WAITERS];
+} sim;
+
+
+//-------------------------------------------------------------------------------------------------
+static uint32_t work_time_us(uint32_t index)
+{
+    sim_waiter_t *w = &sim.w[index];
+    w->rng ^= w->rng << 13;                 //xorshift32: same sequence on every run
+    w->rng ^= w->rng >> 17;
+    w->rng ^= w->rng << 5;
+    uint32_t spread = work_mean_us[index] * WORK_SPREAD_PCT / 100u;
+    return work_mean_us[index] - spread + w->rng % (2u * spread + 1u);
+}
+
+static void waiter_task(void *pv)
+{
+    uint32_t me = (uint32_t)(uintptr_t)pv;
+    sim_waiter_t *w = &sim.w[me];
+    while (1) {
+        BaseType_t got = (sim.kind == CASE_SEMAPHORE) ? xSemaphoreTake(sim.sem, portMAX_DELAY)
+                                                      : notify_dispatch_wait(sim.dispatch, me, portMAX_DELAY);
+        configASSERT(got == pdTRUE);
+        (void)got;
+
+        uint64_t given_at = (sim.kind == CASE_SEMAPHORE) ? sim.sem_given_at : w->pending_since;
+        configASSERT(given_at != NOT_PENDING);
+        w->pending_since = NOT_PENDING;
+        w->latency_us[w->wakes++] = (uint32_t)(sim.now_us - given_at);
+
+        w->busy = true;
+        w->busy_until = sim.now_us + work_time_us(me);
+        xSemaphoreTake(w->work_done, portMAX_DELAY);    //taskA gives it when the clock reaches busy_until
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//taskA's give. The scheduler is suspended so the bookkeeping is done before the woken waiter runs.
+static void give_signal(void)
+{
+    vTaskSuspendAll();
+    if (sim.kind == CASE_SEMAPHORE) {
+        if (xSemaphoreGive(sim.sem) == pdPASS) {
+            sim.sem_given_at = sim.now_us;
+        } else {
+            sim.sem_lost++;
+        }
+    } else {
+        int index = notify_dispatch_give_next(sim.dispatch);
+        configASSERT(index >= 0);
+        if (sim.w[index].pending_since == NOT_PENDING) {
+            sim.w[index].pending_since = sim.now_us;    //a merged give keeps the older time
+        }
+    }
+    xTaskResumeAll();
+}
+
+//Earliest end of work not later than "limit", or -1
+static int next_work_end(uint64_t limit)
+{
+    int found = -1;
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        const sim_waiter_t *w = &sim.w[i];
+        if (w->busy && w->busy_until <= limit && (found < 0 || w->busy_until < sim.w[found].busy_until)) {
+            found = (int)i;
+        }
+    }
+    return found;
+}
+
+static void finish_work(int index)
+{
+    sim.now_us = sim.w[index].busy_until;
+    sim.w[index].busy = false;
+    xSemaphoreGive(sim.w[index].work_done);     //the waiter runs at once and blocks again before we continue
+}
+
+static void run_case(sim_case_t kind)
+{
+    sim.kind = kind;
+    sim.now_us = 0;
+    sim.sem_given_at = NOT_PENDING;
+    sim.sem_lost = 0;
+    if (kind == CASE_SEMAPHORE) {
+        sim.sem = xSemaphoreCreateBinary();
+        configASSERT(sim.sem != NULL);
+    } else {
+        sim.dispatch = notify_dispatch_create(WAITERS, kind == CASE_ROUND_ROBIN ? NOTIFY_DISPATCH_ROUND_ROBIN
+                                                                                : NOTIFY_DISPATCH_LEAST_RECENT);
+        configASSERT(sim.dispatch != NULL);
+    }
+
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        sim_waiter_t *w = &sim.w[i];
+        *w = (sim_waiter_t){ .pending_since = NOT_PENDING, .rng = 0x9e3779b9u + i };
+        w->latency_us = malloc(SIM_GIVES * sizeof(uint32_t));
+        w->work_done = xSemaphoreCreateBinary();
+        configASSERT(w->latency_us != NULL && w->work_done != NULL);
+        xTaskCreate(waiter_task, waiter_names[i], 2048, (void *)(uintptr_t)i, WAITER_PRIO, &w->task);
+        configASSERT(w->task != NULL);
+        if (kind != CASE_SEMAPHORE) {
+            notify_dispatch_add(sim.dispatch, w->task);
+        }
+    }
+
+    uint64_t next_give = 0;
+    for (uint32_t gives = 0; gives < SIM_GIVES;) {
+        int ending = next_work_end(next_give);
+        if (ending >= 0) {
+            finish_work(ending);
+        } else {
+            sim.now_us = next_give;
+            give_signal();
+            gives++;
+            next_give += GIVE_PERIOD_US;
+        }
+    }
+    //Let both waiters finish (and pick up any signal still pending)
+    for (int ending; (ending = next_work_end(UINT64_MAX)) >= 0;) {
+        finish_work(ending);
+    }
+
+    uint32_t total_wakes = 0;
+    uint32_t lost = sim.sem_lost;
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        total_wakes += sim.w[i].wakes;
+    }
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        sim_waiter_t *w = &sim.w[i];
+        notify_dispatch_counters_t c = { 0 };
+        if (kind != CASE_SEMAPHORE) {
+            notify_dispatch_get_counters(sim.dispatch, i, &c);
+            configASSERT(c.wakes == w->wakes && c.gives == c.wakes + c.coalesced);
+            lost += c.coalesced;
+        }
+        uint64_t sum = 0;
+        for (uint32_t k = 0; k < w->wakes; k++) {
+            sum += w->latency_us[k];
+        }
+        uint32_t p50 = bench_percentile(w->latency_us, w->wakes, 50.0);
+        uint32_t p99 = bench_percentile(w->latency_us, w->wakes, 99.0);
+        uint32_t max = w->wakes ? w->latency_us[w->wakes - 1] : 0;
+        char given[16] = "-", merged[16] = "-";
+        if (kind != CASE_SEMAPHORE) {
+            snprintf(given, sizeof(given), "%u", (unsigned)c.gives);
+            snprintf(merged, sizeof(merged), "%u", (unsigned)c.coalesced);
+        }
+        printf("%-18s %-6s %7.1f%% %8u %8s %8s %9.1f %8u %8u %8u\n", i == 0 ? case_names[kind] : "",
+               waiter_names[i], 100.0 * w->wakes / total_wakes, (unsigned)w->wakes, given, merged,
+               w->wakes ? (double)sum / w->wakes : 0.0, p50, p99, max);
+    }
+    //Every give either woke a waiter or was lost
+    configASSERT(total_wakes + lost == SIM_GIVES);
+    printf("%-18s lost %u of %u gives (%.2f %%)\n\n", "", (unsigned)lost, SIM_GIVES, 100.0 * lost / SIM_GIVES);
+
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        vTaskDelete(sim.w[i].task);
+        vSemaphoreDelete(sim.w[i].work_done);
+        free(sim.w[i].latency_us);
+    }
+    if (kind == CASE_SEMAPHORE) {
+        vSemaphoreDelete(sim.sem);
+    } else {
+        notify_dispatch_delete(sim.dispatch);
+    }
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    vTaskPrioritySet(NULL, GIVER_PRIO);
+    printf("%u gives, one every %u us; taskB works %u us, taskC %u us per signal (+-%u %%), simulated clock\n\n",
+           SIM_GIVES, GIVE_PERIOD_US, (unsigned)work_mean_us[0], (unsigned)work_mean_us[1], WORK_SPREAD_PCT);
+    printf("%-18s %-6s %8s %8s %8s %8s %9s %8s %8s %8s\n", "dispatch", "waiter", "share", "wakes", "given",
+           "merged", "lat avg", "p50 us", "p99 us", "max us");
+    for (int kind = 0; kind < CASE_COUNT; kind++) {
+        run_case((sim_case_t)kind);
+    }
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "taskA", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,165 @@
+//Host benchmark: periodic signal from a task (SIMPLE_BIN_SEMAPHORE's Task A) vs. from a timer interrupt
+//A taker blocks on a binary semaphore and timestamps every signal; a load task at a priority between the
+//two giver variants spins for 2 ticks every 7 ticks, out of phase with the 5-tick period.
+//
+//  task below load : give + vTaskDelay(period), priority below the load (Task A in the example has 2)
+//  task above load : the same loop above everything else
+//  timer interrupt : timer_signal, xSemaphoreGiveFromISR() from the (simulated) timer interrupt
+//
+//Reported per case: mean interval, mean and largest |interval - period| (jitter) and drift
+//(how far the last signal is from where "signals x period" puts it). vTaskDelay() counts from the give,
+//so every late wake-up shifts all later signals; the timer does not care when the taker runs.
+//On the host the timer interrupt is the tick hook (host/support/host_isr.c), so it has tick resolution
+//here; on the ESP32 the gptimer has 1 us.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "timer_signal.h"
+#include "bench_util.h"
+
+#define PERIOD_TICKS        5u
+#define PERIODS             200u
+#define LOAD_BUSY_TICKS     2u
+#define LOAD_IDLE_TICKS     5u
+#define TASK_A_STACK        2048u           //Task A's stack in the example (bytes on ESP-IDF)
+
+#define PRIO_TAKER          4
+#define PRIO_LOAD           3
+
+typedef enum { SRC_TASK, SRC_TIMER } source_t;
+
+typedef struct {
+    const char *name;
+    source_t source;
+    UBaseType_t giver_prio;
+} signal_case_t;
+
+static const signal_case_t signal_cases[] = {
+    { "task below load", SRC_TASK, 2 },
+    { "task above load", SRC_TASK, 5 },
+    { "timer interrupt", SRC_TIMER, 0 },
+};
+
+static struct {
+    SemaphoreHandle_t sem;
+    TaskHandle_t bench;
+    uint64_t take_ns[PERIODS + 1];
+} ctx;
+
+
+//-------------------------------------------------------------------------------------------------
+static void giver_task(void *pv)
+{
+    (void)pv;
+    while (1) {
+        vTaskDelay(PERIOD_TICKS);
+        xSemaphoreGive(ctx.sem);
+    }
+}
+
+static void taker_task(void *pv)
+{
+    (void)pv;
+    for (uint32_t i = 0; i <= PERIODS; i++) {
+        xSemaphoreTake(ctx.sem, portMAX_DELAY);
+        ctx.take_ns[i] = bench_now_ns();
+    }
+    xTaskNotifyGive(ctx.bench);
+    vTaskSuspend(NULL);
+}
+
+//Spins LOAD_BUSY_TICKS, sleeps LOAD_IDLE_TICKS: delays everything below it by up to 2 ticks
+static void load_task(void *pv)
+{
+    (void)pv;
+    while (1) {
+        TickType_t start = xTaskGetTickCount();
+        while (xTaskGetTickCount() - start < LOAD_BUSY_TICKS) {
+        }
+        vTaskDelay(LOAD_IDLE_TICKS);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void run_signal_case(const signal_case_t *sc)
+{
+    ctx.sem = xSemaphoreCreateBinary();
+    configASSERT(ctx.sem != NULL);
+
+    TaskHandle_t taker, load, giver = NULL;
+    timer_signal_t *timer = NULL;
+    xTaskCreate(taker_task, "taker", 2048, NULL, PRIO_TAKER, &taker);
+    xTaskCreate(load_task, "load", 2048, NULL, PRIO_LOAD, &load);
+    configASSERT(taker != NULL && load != NULL);
+    if (sc->source == SRC_TASK) {
+        xTaskCreate(giver_task, "TaskA", TASK_A_STACK, NULL, sc->giver_prio, &giver);
+        configASSERT(giver != NULL);
+    } else {
+        timer_signal_config_t config = { .period_us = PERIOD_TICKS * portTICK_PERIOD_MS * 1000u, .sem = ctx.sem };
+        timer = timer_signal_start(&config);
+        configASSERT(timer != NULL);
+    }
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    uint32_t lost = 0;
+    if (timer != NULL) {
+        timer_signal_stats_t st;
+        timer_signal_get(timer, &st);
+        lost = st.lost;
+        timer_signal_stop(timer);
+    } else {
+        vTaskDelete(giver);
+    }
+    vTaskDelete(load);
+    vTaskDelete(taker);
+    vSemaphoreDelete(ctx.sem);
+
+    double period_us = PERIOD_TICKS * portTICK_PERIOD_MS * 1000.0;
+    double sum = 0.0, dev_sum = 0.0, jitter = 0.0;
+    for (uint32_t i = 1; i <= PERIODS; i++) {
+        double interval = (double)(ctx.take_ns[i] - ctx.take_ns[i - 1]) / 1000.0;
+        double dev = (interval > period_us) ? interval - period_us : period_us - interval;
+        sum += interval;
+        dev_sum += dev;
+        jitter = (dev > jitter) ? dev : jitter;
+    }
+    double drift = sum - PERIODS * period_us;
+    printf("%-16s %4u %10.0f %10.0f %10.0f %10.0f %6u\n", sc->name, (unsigned)sc->giver_prio, sum / PERIODS,
+           dev_sum / PERIODS, jitter, drift, (unsigned)lost);
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    ctx.bench = xTaskGetCurrentTaskHandle();
+
+    printf("periodic signal, %u ticks (%u ms) x %u periods, taker priority %u, load priority %u "
+           "(%u ticks busy / %u idle)\n", PERIOD_TICKS, PERIOD_TICKS * (unsigned)portTICK_PERIOD_MS, PERIODS,
+           PRIO_TAKER, PRIO_LOAD, LOAD_BUSY_TICKS, LOAD_IDLE_TICKS);
+    printf("%-16s %4s %10s %10s %10s %10s %6s\n", "source", "prio", "mean us", "mean dev", "jitter us",
+           "drift us", "lost");
+    for (size_t i = 0; i < sizeof(signal_cases) / sizeof(signal_cases[0]); i++) {
+        run_signal_case(&signal_cases[i]);
+    }
+
+    printf("\nRAM for the signal source:\n");
+    printf("  Task A         : TCB %zu + stack %u = %zu bytes (TCB size of this build)\n", sizeof(StaticTask_t),
+           TASK_A_STACK, sizeof(StaticTask_t) + TASK_A_STACK);
+    printf("  timer interrupt: %zu bytes (+ the gptimer driver object on the ESP32)\n", timer_signal_bytes());
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
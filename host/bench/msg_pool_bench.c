@@ -0,0 +1,126 @@
+//Host benchmark: copy-by-value queue vs. zero-copy msg_pool + pointer queue across payload sizes
+//Producer fills every frame, consumer reads it back, so both paths touch the payload once.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "msg_pool.h"
+#include "bench_util.h"
+
+#define BENCH_ITEMS         100000u
+#define QUEUE_DEPTH         10u             //same depth as QUEUE_EXAMPLE_BASIC
+#define POOL_BLOCKS         (QUEUE_DEPTH + 2u)  //+1 held by the producer, +1 held by the consumer
+#define MAX_PAYLOAD         1500u
+
+typedef enum { PATH_COPY, PATH_ZERO_COPY } path_t;
+
+typedef struct {
+    path_t path;
+    size_t payload;
+    QueueHandle_t q;
+    msg_pool_t *pool;
+    TaskHandle_t waiter;
+} bench_ctx_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void producer_task(void *pv)
+{
+    bench_ctx_t *ctx = pv;
+    static uint8_t frame[MAX_PAYLOAD];
+
+    for (uint32_t seq = 0; seq < BENCH_ITEMS; seq++) {
+        if (ctx->path == PATH_COPY) {
+            memset(frame, (int)(seq & 0xff), ctx->payload);
+            xQueueSend(ctx->q, frame, portMAX_DELAY);       //copies payload bytes into the queue
+        } else {
+            uint8_t *msg = msg_pool_alloc(ctx->pool, portMAX_DELAY);
+            memset(msg, (int)(seq & 0xff), ctx->payload);   //filled in place
+            xQueueSend(ctx->q, &msg, portMAX_DELAY);        //copies one pointer
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv)
+{
+    bench_ctx_t *ctx = pv;
+    static uint8_t frame[MAX_PAYLOAD];
+
+    for (uint32_t seq = 0; seq < BENCH_ITEMS; seq++) {
+        const uint8_t *data;
+        uint8_t *msg = NULL;
+        if (ctx->path == PATH_COPY) {
+            xQueueReceive(ctx->q, frame, portMAX_DELAY);
+            data = frame;
+        } else {
+            xQueueReceive(ctx->q, &msg, portMAX_DELAY);
+            data = msg;
+        }
+        configASSERT(data[0] == (uint8_t)seq && data[ctx->payload - 1] == (uint8_t)seq);
+        if (msg != NULL) {
+            msg_pool_free(ctx->pool, msg);
+        }
+    }
+    xTaskNotifyGive(ctx->waiter);
+    vTaskDelete(NULL);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static double run_case(path_t path, size_t payload)
+{
+    static bench_ctx_t ctx;
+    ctx.path = path;
+    ctx.payload = payload;
+    ctx.waiter = xTaskGetCurrentTaskHandle();
+    if (path == PATH_COPY) {
+        ctx.q = xQueueCreate(QUEUE_DEPTH, payload);
+        ctx.pool = NULL;
+    } else {
+        ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(void *));
+        ctx.pool = msg_pool_create(payload, POOL_BLOCKS);
+        configASSERT(ctx.pool != NULL);
+    }
+    configASSERT(ctx.q != NULL);
+
+    uint64_t t0 = bench_now_ns();
+    xTaskCreate(consumer_task, "consumer", 2048, &ctx, 5, NULL);
+    xTaskCreate(producer_task, "producer", 2048, &ctx, 5, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t elapsed = bench_now_ns() - t0;
+
+    if (ctx.pool != NULL) {
+        msg_pool_delete(ctx.pool);      //asserts that no block leaked (debug builds)
+    }
+    vQueueDelete(ctx.q);
+    return (double)BENCH_ITEMS * 1e9 / (double)elapsed;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    static const size_t payloads[] = { 4, 64, 256, 512, 1024, 1500 };
+    printf("%u frames, queue depth %u, pool of %u blocks, MSG_POOL_DEBUG=%d\n",
+           BENCH_ITEMS, QUEUE_DEPTH, POOL_BLOCKS, MSG_POOL_DEBUG);
+    printf("%8s %14s %14s %8s\n", "payload", "copy msg/s", "zero-copy msg/s", "speedup");
+    for (size_t i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++) {
+        double copy = run_case(PATH_COPY, payloads[i]);
+        double zero = run_case(PATH_ZERO_COPY, payloads[i]);
+        printf("%8u %14.0f %14.0f %7.2fx\n", (unsigned)payloads[i], copy, zero, zero / copy);
+    }
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
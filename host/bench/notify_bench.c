@@ -0,0 +1,195 @@
+//Host benchmark: binary semaphore vs. task notifications (notify_dispatch) as the signal of SIMPLE_BIN_SEMAPHORE
+//Same shape as the example: one giver, two waiters (Task B / Task C). With the semaphore either waiter wakes,
+//with the dispatcher the giver alternates between them.
+//
+//  give-to-wake : waiters above the giver, so the give switches straight to the woken waiter; time from just
+//                 before the give call to the take returning (the pure wake path)
+//  give + take  : one task gives and takes with nobody waiting (the API cost without a context switch)
+//  RAM          : bytes allocated for the signal itself
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "notify_dispatch.h"
+#include "bench_util.h"
+
+#define BENCH_GIVES         100000u
+#define BENCH_PAIRS         1000000u
+#define WAITERS             2u
+#define GIVER_PRIO          4
+#define WAITER_PRIO         5
+
+typedef enum { SIGNAL_SEMAPHORE, SIGNAL_NOTIFY } signal_kind_t;
+
+typedef struct {
+    signal_kind_t kind;
+    SemaphoreHandle_t sem;
+    notify_dispatch_t *dispatch;
+    TaskHandle_t giver;
+    volatile uint64_t give_stamp;
+    volatile uint32_t seq;
+    uint32_t *latency_ns;
+    uint32_t wakes[WAITERS];
+} bench_ctx_t;
+
+typedef struct {
+    bench_ctx_t *ctx;
+    uint32_t index;                         //dispatcher index (Task B = 0, Task C = 1)
+} waiter_arg_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void waiter_task(void *pv)
+{
+    const waiter_arg_t *arg = pv;
+    bench_ctx_t *ctx = arg->ctx;
+    while (1) {
+        BaseType_t got = (ctx->kind == SIGNAL_SEMAPHORE) ? xSemaphoreTake(ctx->sem, portMAX_DELAY)
+                                                          : notify_dispatch_take(portMAX_DELAY);
+        uint64_t now = bench_now_ns();
+        configASSERT(got == pdTRUE);
+        (void)got;
+        ctx->latency_ns[ctx->seq] = (uint32_t)(now - ctx->give_stamp);
+        ctx->wakes[arg->index]++;           //shows how the semaphore split the gives
+        xTaskNotifyGive(ctx->giver);        //ack: the giver waits for it before the next give
+    }
+}
+
+static void run_wake_case(signal_kind_t kind)
+{
+    static bench_ctx_t ctx;
+    ctx = (bench_ctx_t){ .kind = kind, .giver = xTaskGetCurrentTaskHandle() };
+    ctx.latency_ns = malloc(BENCH_GIVES * sizeof(uint32_t));
+    configASSERT(ctx.latency_ns != NULL);
+
+    if (kind == SIGNAL_SEMAPHORE) {
+        ctx.sem = xSemaphoreCreateBinary();
+        configASSERT(ctx.sem != NULL);
+    } else {
+        ctx.dispatch = notify_dispatch_create(WAITERS, NOTIFY_DISPATCH_ROUND_ROBIN);
+        configASSERT(ctx.dispatch != NULL);
+    }
+
+    //The bench task is the giver: it drops below the waiters for the measurement
+    UBaseType_t own_prio = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, GIVER_PRIO);
+    static waiter_arg_t args[WAITERS];
+    TaskHandle_t waiters[WAITERS];
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        args[i] = (waiter_arg_t){ .ctx = &ctx, .index = i };
+        xTaskCreate(waiter_task, i == 0 ? "TaskB" : "TaskC", 2048, &args[i], WAITER_PRIO, &waiters[i]);
+        configASSERT(waiters[i] != NULL);
+        if (kind == SIGNAL_NOTIFY) {
+            notify_dispatch_add(ctx.dispatch, waiters[i]);
+        }
+    }
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t seq = 0; seq < BENCH_GIVES; seq++) {
+        ctx.seq = seq;
+        ctx.give_stamp = bench_now_ns();
+        if (kind == SIGNAL_SEMAPHORE) {
+            xSemaphoreGive(ctx.sem);
+        } else {
+            notify_dispatch_give(ctx.dispatch, seq % WAITERS);
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    uint64_t elapsed = bench_now_ns() - t0;
+
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        vTaskDelete(waiters[i]);
+    }
+    vTaskPrioritySet(NULL, own_prio);
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < BENCH_GIVES; i++) {
+        sum += ctx.latency_ns[i];
+    }
+    uint32_t p50 = bench_percentile(ctx.latency_ns, BENCH_GIVES, 50.0);
+    uint32_t p99 = bench_percentile(ctx.latency_ns, BENCH_GIVES, 99.0);
+    uint32_t max = ctx.latency_ns[BENCH_GIVES - 1];
+
+    printf("%-24s %10.0f %10u %10u %10u %12.0f %8u/%u\n",
+           kind == SIGNAL_SEMAPHORE ? "xSemaphoreGive/Take" : "notify_dispatch",
+           (double)sum / BENCH_GIVES, p50, p99, max, (double)elapsed / BENCH_GIVES,
+           (unsigned)ctx.wakes[0], (unsigned)ctx.wakes[1]);
+
+    if (kind == SIGNAL_SEMAPHORE) {
+        vSemaphoreDelete(ctx.sem);
+    } else {
+        notify_dispatch_delete(ctx.dispatch);
+    }
+    free(ctx.latency_ns);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Give and take from the same task, nobody blocked: no context switch, only the API path
+static double pair_cost_ns(signal_kind_t kind)
+{
+    SemaphoreHandle_t sem = NULL;
+    notify_dispatch_t *d = NULL;
+    if (kind == SIGNAL_SEMAPHORE) {
+        sem = xSemaphoreCreateBinary();
+        configASSERT(sem != NULL);
+    } else {
+        d = notify_dispatch_create(1, NOTIFY_DISPATCH_ROUND_ROBIN);
+        configASSERT(d != NULL);
+        notify_dispatch_add(d, xTaskGetCurrentTaskHandle());
+    }
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_PAIRS; i++) {
+        if (kind == SIGNAL_SEMAPHORE) {
+            xSemaphoreGive(sem);
+            xSemaphoreTake(sem, 0);
+        } else {
+            notify_dispatch_give(d, 0);
+            notify_dispatch_take(0);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - t0;
+
+    if (kind == SIGNAL_SEMAPHORE) {
+        vSemaphoreDelete(sem);
+    } else {
+        notify_dispatch_delete(d);
+    }
+    return (double)elapsed / BENCH_PAIRS;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    printf("give-to-wake, %u gives, giver priority %d, %u waiters at priority %d\n", BENCH_GIVES, GIVER_PRIO,
+           WAITERS, WAITER_PRIO);
+    printf("%-24s %10s %10s %10s %10s %12s %10s\n", "signal", "avg ns", "p50 ns", "p99 ns", "max ns",
+           "ns/round", "B/C wakes");
+    run_wake_case(SIGNAL_SEMAPHORE);
+    run_wake_case(SIGNAL_NOTIFY);
+
+    printf("\ngive + take, nobody waiting (%u pairs)\n", BENCH_PAIRS);
+    printf("%-24s %10.1f ns\n", "xSemaphoreGive/Take", pair_cost_ns(SIGNAL_SEMAPHORE));
+    printf("%-24s %10.1f ns\n", "notify_dispatch", pair_cost_ns(SIGNAL_NOTIFY));
+
+    //xSemaphoreCreateBinary() allocates a queue object (StaticSemaphore_t is its exact size); notifications
+    //live in the TCB that every task already has, so only the dispatcher table is extra
+    printf("\nRAM for the signal (this build, %u-bit pointers)\n", (unsigned)(sizeof(void *) * 8));
+    printf("%-24s %10u B  (semaphore object)\n", "xSemaphoreCreateBinary", (unsigned)sizeof(StaticSemaphore_t));
+    printf("%-24s %10u B  (dispatcher for %u waiters, 0 B per signal)\n", "notify_dispatch",
+           (unsigned)notify_dispatch_bytes(WAITERS), WAITERS);
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,253 @@
+//Host simulation: drift of periodic tasks over one hour, vTaskDelay() loop vs. xTaskDelayUntil() (periodic_task)
+//2 .. 64 tasks shaped like SIMPLE_TASK_Creation_1's task1 / task2: periods 1000 ms and 500 ms alternating, all
+//at priority 1, each job one ESP_LOGI line (JOB_MEAN_US +- JOB_SPREAD_US of UART time). Run twice: on an
+//otherwise idle CPU, and with higher-priority background work (a Wi-Fi / driver task stand-in) arriving on a
+//quarter of the ticks and taking BG_MIN_US .. BG_MAX_US.
+//
+//  vTaskDelay      : job, then vTaskDelay(period) - the next release is period ticks after the tick the job
+//                    ENDED in (what task1 / task2 do)
+//  xTaskDelayUntil : the next release is period ticks after the previous RELEASE (periodic_task)
+//
+//The kernel is modelled, not run: one core, CONFIG_FREERTOS_HZ ticks, wake-ups on ticks, highest priority
+//first, time slicing between equal priorities on every tick. That is what decides when a delayed task wakes,
+//and it lets an hour of simulated time run in about a second. periodic_task_check runs periodic_task itself
+//on the POSIX port against the same release rules.
+//Reported per policy and task count, with periodic_task's definitions (release = the tick that made the task
+//ready): releases run, releases lost against an ideal clock, drift of the last release (mean / max over the
+//tasks), worst release jitter and deadline misses (deadline = period).
+//
+//  periodic_drift_sim          exit code 1 if xTaskDelayUntil drifts or loses a release
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+
+#define SIM_SECONDS         3600u
+#define MAX_TASKS           64u
+#define JOB_MEAN_US         3000u           //~35 characters at 115200 baud
+#define JOB_SPREAD_US       1000u
+#define TASK_PRIO           1
+#define BG_MIN_US           2000u           //background: 1 tick in 4, 2 .. 8 ms = 12.5 % of the CPU
+#define BG_MAX_US           8000u
+
+#define TICK_US             (1000000u / configTICK_RATE_HZ)
+#define SIM_TICKS           ((uint64_t)SIM_SECONDS * configTICK_RATE_HZ)
+
+static const uint32_t task_counts[] = { 2, 4, 8, 16, 32, 64 };
+
+typedef enum { POLICY_DELAY, POLICY_DELAY_UNTIL } policy_t;
+
+typedef struct {
+    uint32_t period_ticks;
+    uint32_t prio;
+    uint64_t wake_tick;                     //next release (tick index)
+    uint64_t release_us;                    //of the current / last job
+    uint64_t first_tick;
+    uint32_t remaining_us;                  //of the current job
+    bool ready;
+    bool started;
+    uint64_t seq;                           //FIFO order among equal priorities
+    uint32_t releases;
+    uint32_t jobs;                          //finished
+    uint32_t misses;
+    uint32_t jitter_max_us;
+    uint32_t rng;
+} sim_task_t;
+
+typedef struct {
+    uint32_t releases;
+    uint32_t lost;
+    double drift_mean_ms;
+    double drift_max_ms;
+    uint32_t jitter_max_us;
+    uint32_t misses;
+} sim_result_t;
+
+static sim_task_t tasks[MAX_TASKS];
+static uint64_t seq_counter;
+static bool bg_enabled;
+static uint32_t bg_remaining_us;
+static uint32_t bg_rng;
+
+
+//-------------------------------------------------------------------------------------------------
+static uint32_t job_time_us(sim_task_t *t)
+{
+    t->rng ^= t->rng << 13;                 //xorshift32: same sequence on every run
+    t->rng ^= t->rng >> 17;
+    t->rng ^= t->rng << 5;
+    return JOB_MEAN_US - JOB_SPREAD_US + t->rng % (2u * JOB_SPREAD_US + 1u);
+}
+
+static void make_ready(sim_task_t *t, uint64_t now_us)
+{
+    t->ready = true;
+    t->started = false;
+    t->release_us = now_us;
+    t->releases++;
+    t->remaining_us = job_time_us(t);
+    t->seq = ++seq_counter;
+}
+
+static sim_task_t *pick(uint32_t n)
+{
+    sim_task_t *best = NULL;
+    for (uint32_t i = 0; i < n; i++) {
+        sim_task_t *t = &tasks[i];
+        if (t->ready && (!best || t->prio > best->prio || (t->prio == best->prio && t->seq < best->seq))) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+//Tick interrupt: wake the tasks whose release is due, rotate the running task behind its equals
+static void tick(uint32_t n, uint64_t tick_index, sim_task_t *running)
+{
+    if (bg_enabled) {
+        bg_rng ^= bg_rng << 13;
+        bg_rng ^= bg_rng >> 17;
+        bg_rng ^= bg_rng << 5;
+        if (bg_rng % 4u == 0) {
+            bg_remaining_us += BG_MIN_US + (bg_rng >> 2) % (BG_MAX_US - BG_MIN_US + 1u);
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (!tasks[i].ready && tasks[i].wake_tick == tick_index) {
+            make_ready(&tasks[i], tick_index * TICK_US);
+        }
+    }
+    if (running != NULL && running->ready) {
+        for (uint32_t i = 0; i < n; i++) {
+            if (&tasks[i] != running && tasks[i].ready && tasks[i].prio == running->prio) {
+                running->seq = ++seq_counter;
+                break;
+            }
+        }
+    }
+}
+
+static void job_done(sim_task_t *t, policy_t policy, uint64_t now_us)
+{
+    uint64_t now_tick = now_us / TICK_US;
+    t->jobs++;
+    if (now_us - t->release_us > (uint64_t)t->period_ticks * TICK_US) {
+        t->misses++;
+    }
+    t->ready = false;
+    if (policy == POLICY_DELAY) {
+        t->wake_tick = now_tick + t->period_ticks;
+    } else {
+        t->wake_tick = t->first_tick + (uint64_t)t->jobs * t->period_ticks;
+        if (t->wake_tick <= now_tick) {
+            make_ready(t, now_us);          //overrun: xTaskDelayUntil() returns at once
+        }
+    }
+}
+
+static sim_result_t simulate(uint32_t n, policy_t policy, bool background)
+{
+    bg_enabled = background;
+    bg_remaining_us = 0;
+    bg_rng = 0x2545f491u;
+    for (uint32_t i = 0; i < n; i++) {
+        tasks[i] = (sim_task_t){
+            .period_ticks = (i % 2 == 0) ? 1000u / portTICK_PERIOD_MS : 500u / portTICK_PERIOD_MS,
+            .prio = TASK_PRIO,
+            .wake_tick = 1,                 //all created together, first release on the next tick
+            .first_tick = 1,
+            .rng = 0x9e3779b9u * (i + 1u),
+        };
+    }
+    seq_counter = 0;
+
+    uint64_t now_us = TICK_US;
+    uint64_t tick_index = 1;
+    tick(n, tick_index, NULL);
+    while (tick_index < SIM_TICKS) {
+        sim_task_t *t = pick(n);
+        uint64_t next_tick_us = (tick_index + 1) * TICK_US;
+        if (bg_remaining_us > 0) {          //higher priority than every periodic task
+            uint32_t run = (uint32_t)(next_tick_us - now_us);
+            run = (bg_remaining_us < run) ? bg_remaining_us : run;
+            bg_remaining_us -= run;
+            now_us += run;
+            if (now_us == next_tick_us) {
+                tick(n, ++tick_index, NULL);
+            }
+            continue;
+        }
+        if (t == NULL) {
+            now_us = next_tick_us;
+            tick(n, ++tick_index, NULL);
+            continue;
+        }
+        if (!t->started) {
+            t->started = true;
+            uint64_t jitter = now_us - t->release_us;
+            if (jitter > t->jitter_max_us) {
+                t->jitter_max_us = (uint32_t)jitter;
+            }
+        }
+        if (now_us + t->remaining_us < next_tick_us) {
+            now_us += t->remaining_us;
+            job_done(t, policy, now_us);
+        } else {
+            t->remaining_us -= (uint32_t)(next_tick_us - now_us);
+            now_us = next_tick_us;
+            if (t->remaining_us == 0) {
+                job_done(t, policy, now_us);
+            }
+            tick(n, ++tick_index, t);
+        }
+    }
+
+    sim_result_t r = { 0 };
+    for (uint32_t i = 0; i < n; i++) {
+        sim_task_t *t = &tasks[i];
+        uint64_t period_us = (uint64_t)t->period_ticks * TICK_US;
+        //Drift: how much later than on an ideal clock the last release came
+        uint64_t ideal_us = (t->first_tick * TICK_US) + (uint64_t)(t->releases - 1) * period_us;
+        double drift_ms = (double)(t->release_us - ideal_us) / 1000.0;
+        uint32_t ideal_releases = (uint32_t)((SIM_TICKS - t->first_tick + t->period_ticks - 1) / t->period_ticks);
+        r.releases += t->releases;
+        r.lost += ideal_releases - t->releases;
+        r.drift_mean_ms += drift_ms / n;
+        r.drift_max_ms = (drift_ms > r.drift_max_ms) ? drift_ms : r.drift_max_ms;
+        r.jitter_max_us = (t->jitter_max_us > r.jitter_max_us) ? t->jitter_max_us : r.jitter_max_us;
+        r.misses += t->misses;
+    }
+    return r;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    bool failed = false;
+    printf("periodic tasks over %u s simulated, %u Hz tick, periods 1000 / 500 ms alternating, priority %u, "
+           "jobs %u +- %u us\n", SIM_SECONDS, (unsigned)configTICK_RATE_HZ, TASK_PRIO, JOB_MEAN_US, JOB_SPREAD_US);
+    for (int bg = 0; bg <= 1; bg++) {
+        printf("\n%s\n", bg ? "with background work above the periodic tasks (12.5 % CPU, 2 .. 8 ms bursts)"
+                             : "idle CPU otherwise");
+        printf("%5s %-16s %10s %8s %14s %13s %14s %8s\n", "tasks", "policy", "releases", "lost", "drift mean ms",
+               "drift max ms", "jitter max us", "misses");
+        for (size_t c = 0; c < sizeof(task_counts) / sizeof(task_counts[0]); c++) {
+            for (int p = POLICY_DELAY; p <= POLICY_DELAY_UNTIL; p++) {
+                sim_result_t r = simulate(task_counts[c], (policy_t)p, bg);
+                printf("%5u %-16s %10u %8u %14.0f %13.0f %14u %8u\n", (unsigned)task_counts[c],
+                       p == POLICY_DELAY ? "vTaskDelay" : "xTaskDelayUntil", (unsigned)r.releases,
+                       (unsigned)r.lost, r.drift_mean_ms, r.drift_max_ms, (unsigned)r.jitter_max_us,
+                       (unsigned)r.misses);
+                if (p == POLICY_DELAY_UNTIL && (r.lost != 0 || r.drift_max_ms != 0.0)) {
+                    failed = true;
+                }
+            }
+        }
+    }
+    if (failed) {
+        printf("FAILED: xTaskDelayUntil drifted or lost releases\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+//Host check: periodic_task (components/periodic_task) run on the POSIX port, its counters against the release
+//model of periodic_drift_sim (release = the tick that made the task ready, highest priority first)
+//
+//  lo  : period LO_PERIOD_MS, job LO_JOB_US, priority 2, deadline LO_DEADLINE_MS
+//  hi  : period 2 x LO_PERIOD_MS, job HI_JOB_US, priority 3, created one lo period after lo, so it is released
+//        on the same tick as every other lo job (lo jobs 1, 3, 5, ...) and runs first
+//  The jobs burn their time as CPU time, like rm_admission_check; nothing preempts a job once it started.
+//
+//  Model, per lo job: release jitter = HI_JOB_US when hi was released on the same tick, else 0; a deadline
+//  miss when jitter + LO_JOB_US > LO_DEADLINE_MS; execution time = LO_JOB_US. hi: no jitter, no misses.
+//  The model's jitter goes through periodic_task's max / moving average bookkeeping; the release counts
+//  come from the tick count at the end of the run (taken half a period after a release, no job in flight).
+//
+//  checks : releases and deadline misses exactly, jitter max / avg and exec avg within TOL_US, no overruns;
+//           up to ROUNDS runs, the first one that matches passes (a stall of the host shows up as jitter)
+//
+//  periodic_task_check         exit code 1 if no round matches the model
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "periodic_task.h"
+#include "bench_util.h"
+
+#define LO_PERIOD_MS        100u
+#define LO_DEADLINE_MS      5u
+#define LO_JOB_US           2000u
+#define HI_JOB_US           4000u           //lo jobs behind it end at 6 ms: past the deadline
+#define RUN_PERIODS         20u             //lo periods after hi started
+#define ROUNDS              5u
+#define TOL_US              1500u           //host tick and pthread hand-off latency
+#define AVG_SHIFT           4               //periodic_task's moving average: x16 in one word
+
+typedef struct {
+    uint32_t releases;
+    uint32_t deadline_misses;
+    uint32_t jitter_max_us;
+    uint32_t jitter_avg_us;
+    uint32_t exec_avg_us;
+} model_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void burn_job(periodic_task_t *pt, void *arg)
+{
+    (void)pt;
+    uint64_t end = bench_cpu_ns() + (uint64_t)(uintptr_t)arg * 1000u;
+    while (bench_cpu_ns() < end) {
+    }
+}
+
+//"releases" jobs of one task; job r waits blocked_us behind the other task when r % every == 1 (every = 0: never)
+static void run_model(model_t *m, uint32_t releases, uint32_t job_us, uint32_t deadline_us, uint32_t every,
+                      uint32_t blocked_us)
+{
+    uint32_t avg16 = 0;
+    *m = (model_t){ .releases = releases, .exec_avg_us = job_us };
+    for (uint32_t r = 0; r < releases; r++) {
+        uint32_t jitter = (every != 0 && r % every == 1u) ? blocked_us : 0;
+        m->jitter_max_us = (jitter > m->jitter_max_us) ? jitter : m->jitter_max_us;
+        avg16 = (r == 0) ? jitter << AVG_SHIFT : avg16 + jitter - (avg16 >> AVG_SHIFT);
+        m->deadline_misses += (jitter + job_us > deadline_us) ? 1u : 0u;
+    }
+    m->jitter_avg_us = avg16 >> AVG_SHIFT;
+}
+
+static bool near(uint32_t value, uint32_t expected)
+{
+    return value + TOL_US >= expected && value <= expected + TOL_US;
+}
+
+static bool compare(const char *name, uint32_t round, const periodic_task_stats_t *st, const model_t *m)
+{
+    bool ok = st->releases == m->releases && st->deadline_misses == m->deadline_misses && st->overruns == 0 &&
+              near(st->jitter_max_us, m->jitter_max_us) && near(st->jitter_avg_us, m->jitter_avg_us) &&
+              near(st->exec_avg_us, m->exec_avg_us);
+    printf("%-2s #%u %8u %8u %7u %7u %8u %8u %8u %8u %8u %8u %9u%s\n", name, (unsigned)round, (unsigned)st->releases,
+           (unsigned)m->releases, (unsigned)st->deadline_misses, (unsigned)m->deadline_misses,
+           (unsigned)st->jitter_max_us, (unsigned)m->jitter_max_us, (unsigned)st->jitter_avg_us,
+           (unsigned)m->jitter_avg_us, (unsigned)st->exec_avg_us, (unsigned)m->exec_avg_us,
+           (unsigned)st->overruns, ok ? "" : "  off");
+    return ok;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static bool run_round(uint32_t round)
+{
+    const TickType_t period = pdMS_TO_TICKS(LO_PERIOD_MS);
+
+    //lo waits one tick before its first release (c + 1); hi, created at c + period, is first released at
+    //c + period + 1, on lo's second release
+    TickType_t c = xTaskGetTickCount();
+    periodic_task_t *lo = periodic_task_create(&(periodic_task_config_t){ .name = "lo", .job = burn_job,
+        .arg = (void *)(uintptr_t)LO_JOB_US, .period_ms = LO_PERIOD_MS, .deadline_ms = LO_DEADLINE_MS,
+        .priority = 2, .stack_depth = 4096 });
+    configASSERT(lo != NULL);
+    TickType_t lo_first = c + 1;
+    xTaskDelayUntil(&c, period);
+    periodic_task_t *hi = periodic_task_create(&(periodic_task_config_t){ .name = "hi", .job = burn_job,
+        .arg = (void *)(uintptr_t)HI_JOB_US, .period_ms = 2u * LO_PERIOD_MS, .priority = 3, .stack_depth = 4096 });
+    configASSERT(hi != NULL);
+    TickType_t hi_first = c + 1;
+    xTaskDelayUntil(&c, RUN_PERIODS * period + period / 2u);
+
+    periodic_task_stats_t lo_st, hi_st;
+    periodic_task_get(lo, &lo_st);
+    periodic_task_get(hi, &hi_st);
+    TickType_t now = xTaskGetTickCount();
+    periodic_task_delete(hi);
+    periodic_task_delete(lo);
+
+    model_t lo_model, hi_model;
+    run_model(&lo_model, (now - lo_first) / period + 1u, LO_JOB_US, LO_DEADLINE_MS * 1000u, 2u, HI_JOB_US);
+    run_model(&hi_model, (now - hi_first) / (2u * period) + 1u, HI_JOB_US, 2u * LO_PERIOD_MS * 1000u, 0, 0);
+
+    vTaskDelay(2);                          //the idle task frees lo / hi
+
+    bool ok = compare("lo", round, &lo_st, &lo_model);
+    return compare("hi", round, &hi_st, &hi_model) && ok;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    printf("%u ms per round, lo %u / %u us (deadline %u ms, prio 2), hi %u / %u us (prio 3); measured vs model\n",
+           (RUN_PERIODS + 1u) * LO_PERIOD_MS, LO_JOB_US, LO_PERIOD_MS * 1000u, LO_DEADLINE_MS, HI_JOB_US,
+           2u * LO_PERIOD_MS * 1000u);
+    printf("%-5s %17s %15s %17s %17s %17s %9s\n", "task", "releases", "misses", "jitter max us", "jitter avg us",
+           "exec avg us", "overruns");
+    bool ok = false;
+    for (uint32_t round = 1; round <= ROUNDS && !ok; round++) {
+        ok = run_round(round);
+    }
+
+    if (!ok) {
+        printf("\nFAILED: no round matched the model\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
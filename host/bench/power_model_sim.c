@@ -0,0 +1,145 @@
+//Host simulation: duty cycle, wakes per hour and estimated current of SIMPLE_TASK_Creation_1 in the power-managed
+//mode (EX1_POWER_SAVE) against the always-on build
+//
+//  task1 / task2 as in the example: one log line every 1000 / 500 ms, the line stood in for by JOB_US of busy
+//  work between power_mode_work_begin() / _end(). After SIM_SECONDS one power_mode window is taken and fed to
+//  the ESP32 model (POWER_MODE_MODEL_ESP32) three ways:
+//
+//  always-on       : CPU at max MHz all the time, WAITI in idle, woken by every tick (the example as shipped)
+//  DFS only        : min MHz outside the PM lock, WAITI in idle (light_sleep = false)
+//  DFS + light     : min MHz outside the PM lock, light sleep when both tasks are blocked (tickless idle)
+//
+//  checks          : wakes per hour = 3 x 3600 (+-15 %), lock-held time = wakes x JOB_US (+-25 %),
+//                    idle >= 90 % of the window, DFS + light sleep at least 5x below always-on
+//  begin / end     : cost of one uncontended power_mode_work_begin() + _end() pair
+//
+//  power_model_sim         exit code 1 if any check fails
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "power_mode.h"
+#include "bench_util.h"
+
+#define SIM_SECONDS         5u
+#define JOB_US              3000u           //~35 characters at 115200 baud, as in periodic_drift_sim
+#define MAX_MHZ             160u
+#define MIN_MHZ             80u
+#define COST_PAIRS          1000000u
+#define WAKES_PER_HOUR      (3u * 3600u)    //task1 once, task2 twice a second
+
+
+//-------------------------------------------------------------------------------------------------
+//task1 / task2 with the log line replaced by JOB_US of busy work inside the PM lock
+
+static void job(void)
+{
+    power_mode_work_begin();
+    uint32_t start = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+    while ((uint32_t)portGET_RUN_TIME_COUNTER_VALUE() - start < JOB_US) {
+    }
+    power_mode_work_end();
+}
+
+static void task1(void *pv)
+{
+    (void)pv;
+    while (1) {
+        job();
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
+
+static void task2(void *pv)
+{
+    (void)pv;
+    while (1) {
+        job();
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void print_row(const char *name, const power_mode_estimate_t *e)
+{
+    printf("%-16s %9u %8u.%u %10u %10u\n", name, (unsigned)e->avg_ua, (unsigned)(e->duty_permille / 10u),
+           (unsigned)(e->duty_permille % 10u), (unsigned)e->wakes_per_hour, (unsigned)e->mah_per_day);
+}
+
+static bool within(uint64_t value, uint64_t expected, uint32_t percent)
+{
+    uint64_t margin = expected * percent / 100u;
+    return value + margin >= expected && value <= expected + margin;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    BaseType_t started = power_mode_start(&(power_mode_config_t){ .max_freq_mhz = MAX_MHZ, .min_freq_mhz = MIN_MHZ,
+                                                                   .light_sleep = true });
+    configASSERT(started == pdPASS);
+    BaseType_t created = xTaskCreate(task1, "task1", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    configASSERT(created == pdPASS);
+    created = xTaskCreate(task2, "task2", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    configASSERT(created == pdPASS);
+    vTaskDelay(pdMS_TO_TICKS(SIM_SECONDS * 1000u));
+
+    power_mode_window_t w;
+    BaseType_t sampled = power_mode_sample(&w);
+    configASSERT(sampled == pdPASS);
+    power_mode_print(&w);
+
+    power_mode_model_t model = POWER_MODE_MODEL_ESP32;
+    power_mode_estimate_t light, dfs, always_on;
+    power_mode_estimate(&w, &model, &light, &always_on);
+    power_mode_window_t no_sleep = w;
+    no_sleep.light_sleep = false;
+    power_mode_estimate(&no_sleep, &model, &dfs, &always_on);
+
+    printf("\n%-16s %9s %10s %10s %10s\n", "mode", "avg uA", "duty %", "wakes/h", "mAh/day");
+    print_row("always-on", &always_on);
+    print_row("DFS only", &dfs);
+    print_row("DFS + light", &light);
+
+    bool wakes_ok = within(light.wakes_per_hour, WAKES_PER_HOUR, 15);
+    bool held_ok = within(w.max_us, (uint64_t)w.wakes * JOB_US, 25);
+    bool idle_ok = (uint64_t)w.idle_us * 10u >= (uint64_t)w.elapsed_us * 9u;
+    bool saving_ok = light.avg_ua != 0 && light.avg_ua * 5u <= always_on.avg_ua;
+    printf("\nwakes           : %u per hour (expected %u)%s\n", (unsigned)light.wakes_per_hour,
+           (unsigned)WAKES_PER_HOUR, wakes_ok ? "" : "  WRONG");
+    printf("lock held       : %u us for %u wakes (expected %u)%s\n", (unsigned)w.max_us, (unsigned)w.wakes,
+           (unsigned)(w.wakes * JOB_US), held_ok ? "" : "  WRONG");
+    printf("idle            : %u of %u ms%s\n", (unsigned)(w.idle_us / 1000u), (unsigned)(w.elapsed_us / 1000u),
+           idle_ok ? "" : "  WRONG");
+    printf("saving          : %u.%ux less current than always-on%s\n", (unsigned)(always_on.avg_ua / light.avg_ua),
+           (unsigned)(always_on.avg_ua * 10u / light.avg_ua % 10u), saving_ok ? "" : "  WRONG");
+
+    vTaskSuspendAll();                      //task1 / task2 stay out of the cost loop
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < COST_PAIRS; i++) {
+        power_mode_work_begin();
+        power_mode_work_end();
+    }
+    uint64_t pair_ns = (bench_now_ns() - t0) / COST_PAIRS;
+    xTaskResumeAll();
+    printf("begin / end     : %u ns per pair (host, no esp_pm lock)\n", (unsigned)pair_ns);
+
+    bool ok = wakes_ok && held_ok && idle_ok && saving_ok;
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
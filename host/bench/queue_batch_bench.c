@@ -0,0 +1,120 @@
+//Host benchmark: context switches per item and throughput of queue_batch_send / queue_batch_receive
+//at batch sizes 1 / 8 / 32 / 128 (batch 1 is the plain one-item-per-call path of QUEUE_EXAMPLE_BASIC).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "queue_batch.h"
+#include "bench_util.h"
+
+#define BENCH_ITEMS         256000u         //multiple of every batch size
+#define QUEUE_DEPTH         128u            //deep enough for the largest batch
+
+extern volatile unsigned long ulHostContextSwitches;
+
+typedef struct {
+    QueueHandle_t q;
+    size_t batch;
+    uint32_t consumer_wakes;
+    TaskHandle_t waiter;
+} bench_ctx_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void producer_task(void *pv)
+{
+    bench_ctx_t *ctx = pv;
+    static int items[QUEUE_DEPTH];
+    int value = 0;
+
+    for (uint32_t done = 0; done < BENCH_ITEMS; done += ctx->batch) {
+        for (size_t i = 0; i < ctx->batch; i++) {
+            items[i] = value++;
+        }
+        if (ctx->batch == 1) {
+            xQueueSend(ctx->q, &items[0], portMAX_DELAY);
+        } else {
+            size_t sent = queue_batch_send(ctx->q, items, ctx->batch, sizeof(int), portMAX_DELAY);
+            configASSERT(sent == ctx->batch);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv)
+{
+    bench_ctx_t *ctx = pv;
+    static int rx[QUEUE_DEPTH];
+    int expected = 0;
+
+    while (expected < (int)BENCH_ITEMS) {
+        size_t n;
+        if (ctx->batch == 1) {
+            n = (xQueueReceive(ctx->q, &rx[0], portMAX_DELAY) == pdPASS) ? 1 : 0;
+        } else {
+            n = queue_batch_receive(ctx->q, rx, ctx->batch, sizeof(int), portMAX_DELAY);
+        }
+        ctx->consumer_wakes++;
+        for (size_t i = 0; i < n; i++) {
+            configASSERT(rx[i] == expected);    //FIFO order must hold across batches
+            expected++;
+        }
+    }
+    xTaskNotifyGive(ctx->waiter);
+    vTaskDelete(NULL);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void run_case(size_t batch)
+{
+    static bench_ctx_t ctx;
+    ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(int));
+    configASSERT(ctx.q != NULL);
+    ctx.batch = batch;
+    ctx.consumer_wakes = 0;
+    ctx.waiter = xTaskGetCurrentTaskHandle();
+
+    unsigned long switches0 = ulHostContextSwitches;
+    uint64_t cpu0 = bench_cpu_ns();
+    uint64_t t0 = bench_now_ns();
+    xTaskCreate(consumer_task, "consumer", 2048, &ctx, 5, NULL);
+    xTaskCreate(producer_task, "producer", 2048, &ctx, 5, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t elapsed = bench_now_ns() - t0;
+    uint64_t cpu = bench_cpu_ns() - cpu0;
+    unsigned long switches = ulHostContextSwitches - switches0;
+
+    printf("%6u %12.0f %14.3f %14.3f %12.1f\n",
+           (unsigned)batch,
+           (double)BENCH_ITEMS * 1e9 / (double)elapsed,
+           (double)switches / BENCH_ITEMS,
+           (double)ctx.consumer_wakes / BENCH_ITEMS,
+           (double)cpu / BENCH_ITEMS);
+
+    vQueueDelete(ctx.q);
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    static const size_t batches[] = { 1, 8, 32, 128 };
+    printf("%u int items, queue depth %u, producer + consumer at priority 5\n", BENCH_ITEMS, QUEUE_DEPTH);
+    printf("%6s %12s %14s %14s %12s\n", "batch", "items/sec", "ctx-sw/item", "wakes/item", "cpu ns/item");
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        run_case(batches[i]);
+    }
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,248 @@
+//Host benchmark suite for the producer/consumer queue of QUEUE_EXAMPLE_BASIC
+//Measures items/sec, send-to-receive latency (p50/p99/p999) and CPU time per item for every
+//queue depth x priority combination, writes the results as JSON and compares them with a baseline.
+//
+//  queue_perf_suite                                  print the table
+//  queue_perf_suite --json base.json                 record a baseline
+//  queue_perf_suite --baseline base.json [--threshold 10]
+//                                                    exit code 1 if any metric is more than 10% worse
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "bench_util.h"
+
+#define SUITE_ITEMS             100000u
+#define SUITE_STAMP_WINDOW      4096u       //must be larger than the deepest queue
+#define SUITE_BENCH_PRIORITY    7           //above every producer / consumer priority
+#define SUITE_MAX_CASES         32
+
+static const UBaseType_t depths[] = { 1, 10, 64, 1024 };
+
+typedef struct {
+    const char *name;
+    UBaseType_t producer_priority;
+    UBaseType_t consumer_priority;
+} prio_combo_t;
+
+static const prio_combo_t combos[] = {
+    { "equal",          5, 5 },             //as in the example
+    { "producer_high",  6, 5 },
+    { "consumer_high",  5, 6 },
+};
+
+typedef struct {
+    unsigned depth;
+    char prio[16];
+    double items_per_sec;
+    double cpu_ns_per_item;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t p999_ns;
+} suite_result_t;
+
+typedef struct {
+    QueueHandle_t q;
+    uint64_t stamps[SUITE_STAMP_WINDOW];
+    uint32_t *latency_ns;
+    TaskHandle_t waiter;
+} suite_ctx_t;
+
+static suite_ctx_t ctx;
+static const char *json_path;
+static const char *baseline_path;
+static double threshold_pct = 10.0;
+
+
+//-------------------------------------------------------------------------------------------------
+static void producer_task(void *pv)
+{
+    (void)pv;
+    for (uint32_t seq = 0; seq < SUITE_ITEMS; seq++) {
+        int value = (int)seq;
+        ctx.stamps[seq % SUITE_STAMP_WINDOW] = bench_now_ns();
+        xQueueSend(ctx.q, &value, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv)
+{
+    (void)pv;
+    int rx = 0;
+    for (uint32_t seq = 0; seq < SUITE_ITEMS; seq++) {
+        xQueueReceive(ctx.q, &rx, portMAX_DELAY);
+        ctx.latency_ns[seq] = (uint32_t)(bench_now_ns() - ctx.stamps[(uint32_t)rx % SUITE_STAMP_WINDOW]);
+    }
+    xTaskNotifyGive(ctx.waiter);
+    vTaskDelete(NULL);
+}
+
+static void run_case(UBaseType_t depth, const prio_combo_t *combo, suite_result_t *out)
+{
+    ctx.q = xQueueCreate(depth, sizeof(int));
+    configASSERT(ctx.q != NULL);
+    ctx.waiter = xTaskGetCurrentTaskHandle();
+
+    uint64_t cpu0 = bench_cpu_ns();
+    uint64_t t0 = bench_now_ns();
+    xTaskCreate(consumer_task, "consumer", 2048, NULL, combo->consumer_priority, NULL);
+    xTaskCreate(producer_task, "producer", 2048, NULL, combo->producer_priority, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t elapsed = bench_now_ns() - t0;
+    uint64_t cpu = bench_cpu_ns() - cpu0;
+    vQueueDelete(ctx.q);
+
+    out->depth = (unsigned)depth;
+    snprintf(out->prio, sizeof(out->prio), "%s", combo->name);
+    out->items_per_sec = (double)SUITE_ITEMS * 1e9 / (double)elapsed;
+    out->cpu_ns_per_item = (double)cpu / SUITE_ITEMS;
+    out->p50_ns = bench_percentile(ctx.latency_ns, SUITE_ITEMS, 50.0);
+    out->p99_ns = bench_percentile(ctx.latency_ns, SUITE_ITEMS, 99.0);
+    out->p999_ns = bench_percentile(ctx.latency_ns, SUITE_ITEMS, 99.9);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//JSON: one case per line so the baseline can be read back with sscanf, no JSON library needed
+#define SUITE_JSON_FMT  "{\"depth\": %u, \"prio\": \"%15[^\"]\", \"items_per_sec\": %lf, \"cpu_ns_per_item\": %lf, " \
+                        "\"p50_ns\": %u, \"p99_ns\": %u, \"p999_ns\": %u}"
+
+static void write_json(const char *path, const suite_result_t *res, size_t count)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        printf("cannot write %s\n", path);
+        return;
+    }
+    fprintf(f, "{\"suite\": \"queue_perf\", \"items\": %u, \"cases\": [\n", SUITE_ITEMS);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(f, "{\"depth\": %u, \"prio\": \"%s\", \"items_per_sec\": %.0f, \"cpu_ns_per_item\": %.1f, "
+                   "\"p50_ns\": %u, \"p99_ns\": %u, \"p999_ns\": %u}%s\n",
+                res[i].depth, res[i].prio, res[i].items_per_sec, res[i].cpu_ns_per_item,
+                res[i].p50_ns, res[i].p99_ns, res[i].p999_ns, (i + 1 < count) ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+}
+
+static size_t read_json(const char *path, suite_result_t *res, size_t max)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("cannot read baseline %s\n", path);
+        return 0;
+    }
+    char line[512];
+    size_t count = 0;
+    while (count < max && fgets(line, sizeof(line), f) != NULL) {
+        suite_result_t *r = &res[count];
+        if (sscanf(line, SUITE_JSON_FMT, &r->depth, r->prio, &r->items_per_sec, &r->cpu_ns_per_item,
+                   &r->p50_ns, &r->p99_ns, &r->p999_ns) == 7) {
+            count++;
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+//Returns the number of metrics worse than baseline by more than threshold_pct
+static int compare(const suite_result_t *res, size_t count, const suite_result_t *base, size_t base_count)
+{
+    const double up = 1.0 + threshold_pct / 100.0;
+    const double down = 1.0 - threshold_pct / 100.0;
+    int failures = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const suite_result_t *b = NULL;
+        for (size_t j = 0; j < base_count; j++) {
+            if (base[j].depth == res[i].depth && strcmp(base[j].prio, res[i].prio) == 0) {
+                b = &base[j];
+            }
+        }
+        if (b == NULL) {
+            continue;       //new case, nothing to compare with
+        }
+        struct { const char *name; double now, was; int higher_is_better; } m[] = {
+            { "items_per_sec",   res[i].items_per_sec,   b->items_per_sec,   1 },
+            { "cpu_ns_per_item", res[i].cpu_ns_per_item, b->cpu_ns_per_item, 0 },
+            { "p50_ns",          res[i].p50_ns,          b->p50_ns,          0 },
+            { "p99_ns",          res[i].p99_ns,          b->p99_ns,          0 },
+            { "p999_ns",         res[i].p999_ns,         b->p999_ns,         0 },
+        };
+        for (size_t k = 0; k < sizeof(m) / sizeof(m[0]); k++) {
+            int worse = m[k].higher_is_better ? (m[k].now < m[k].was * down) : (m[k].now > m[k].was * up);
+            if (worse) {
+                printf("REGRESSION depth=%u prio=%s %s: %.1f -> %.1f\n",
+                       res[i].depth, res[i].prio, m[k].name, m[k].was, m[k].now);
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void suite_task(void *pv)
+{
+    (void)pv;
+    static suite_result_t results[SUITE_MAX_CASES];
+    static suite_result_t baseline[SUITE_MAX_CASES];
+    size_t count = 0;
+
+    ctx.latency_ns = malloc(SUITE_ITEMS * sizeof(uint32_t));
+    configASSERT(ctx.latency_ns != NULL);
+
+    printf("%6s %-14s %12s %12s %9s %9s %9s\n", "depth", "priorities", "items/sec", "cpu ns/item",
+           "p50 ns", "p99 ns", "p999 ns");
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+        for (size_t c = 0; c < sizeof(combos) / sizeof(combos[0]); c++) {
+            suite_result_t *r = &results[count++];
+            run_case(depths[d], &combos[c], r);
+            printf("%6u %-14s %12.0f %12.1f %9u %9u %9u\n", r->depth, r->prio, r->items_per_sec,
+                   r->cpu_ns_per_item, r->p50_ns, r->p99_ns, r->p999_ns);
+        }
+    }
+    free(ctx.latency_ns);
+
+    if (json_path != NULL) {
+        write_json(json_path, results, count);
+    }
+
+    int status = 0;
+    if (baseline_path != NULL) {
+        size_t base_count = read_json(baseline_path, baseline, SUITE_MAX_CASES);
+        int failures = (base_count == 0) ? 1 : compare(results, count, baseline, base_count);
+        printf("%d metric(s) regressed by more than %.1f%% against %s\n", failures, threshold_pct, baseline_path);
+        status = (failures != 0);
+    }
+    exit(status);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold_pct = atof(argv[++i]);
+        } else {
+            printf("usage: %s [--json out.json] [--baseline base.json] [--threshold percent]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    xTaskCreate(suite_task, "suite", 4096, NULL, SUITE_BENCH_PRIORITY, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,165 @@
+//Host benchmark: cost of queue_stats telemetry on the send/receive hot path
+//1) single task, send + receive without blocking (pure per-call overhead)
+//2) producer/consumer through a depth-10 queue with blocking (overhead seen by the example)
+//3) check: reset with items still queued, drain, refill - the high-water mark must follow the real depth
+//   (exit code 1 if not)
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "queue_stats.h"
+#include "bench_util.h"
+
+#define BENCH_PAIRS         1000000u
+#define BENCH_ROUNDS        5u              //best of N, filters out host scheduling noise
+#define BENCH_ITEMS         100000u
+#define QUEUE_DEPTH         10u             //same depth as QUEUE_EXAMPLE_BASIC
+
+typedef struct {
+    int instrumented;
+    QueueHandle_t q;
+    queue_stats_t *qs;
+    TaskHandle_t waiter;
+} bench_ctx_t;
+
+static bench_ctx_t ctx;
+
+
+static inline BaseType_t bench_send(const int *value, TickType_t ticks)
+{
+    return ctx.instrumented ? queue_stats_send(ctx.qs, value, ticks) : xQueueSend(ctx.q, value, ticks);
+}
+
+static inline BaseType_t bench_receive(int *value, TickType_t ticks)
+{
+    return ctx.instrumented ? queue_stats_receive(ctx.qs, value, ticks) : xQueueReceive(ctx.q, value, ticks);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+static double run_pairs(void)
+{
+    uint64_t best = UINT64_MAX;
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        int rx = 0;
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < BENCH_PAIRS; i++) {
+            int value = (int)i;
+            bench_send(&value, 0);
+            bench_receive(&rx, 0);
+        }
+        uint64_t elapsed = bench_now_ns() - t0;
+        configASSERT(rx == (int)(BENCH_PAIRS - 1));
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return (double)best / BENCH_PAIRS;
+}
+
+static void producer_task(void *pv)
+{
+    (void)pv;
+    for (uint32_t seq = 0; seq < BENCH_ITEMS; seq++) {
+        int value = (int)seq;
+        bench_send(&value, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv)
+{
+    (void)pv;
+    int rx = 0;
+    for (uint32_t seq = 0; seq < BENCH_ITEMS; seq++) {
+        bench_receive(&rx, portMAX_DELAY);
+        configASSERT(rx == (int)seq);
+    }
+    xTaskNotifyGive(ctx.waiter);
+    vTaskDelete(NULL);
+}
+
+static double run_stream(void)
+{
+    ctx.waiter = xTaskGetCurrentTaskHandle();
+    uint64_t t0 = bench_now_ns();
+    xTaskCreate(consumer_task, "consumer", 2048, NULL, 5, NULL);
+    xTaskCreate(producer_task, "producer", 2048, NULL, 5, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return (double)BENCH_ITEMS * 1e9 / (double)(bench_now_ns() - t0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Items queued before queue_stats_reset() are received after it: the depth must not underflow into "full"
+static bool check_reset_with_items(void)
+{
+    queue_stats_t *qs = queue_stats_create("reset_q", QUEUE_DEPTH, sizeof(int));
+    configASSERT(qs != NULL);
+    int value = 0;
+    for (uint32_t i = 0; i < QUEUE_DEPTH - 2u; i++) {
+        queue_stats_send(qs, &value, 0);
+    }
+    queue_stats_reset(qs);
+    for (uint32_t i = 0; i < QUEUE_DEPTH - 2u; i++) {
+        queue_stats_receive(qs, &value, 0);
+    }
+    queue_stats_send(qs, &value, 0);
+    queue_stats_send(qs, &value, 0);
+
+    queue_stats_snapshot_t snap;
+    queue_stats_get(qs, &snap);
+    bool ok = snap.depth == 2 && snap.high_water == 2;
+    printf("\nreset with %u items queued, drained, 2 sent: depth %u, high water %u (expected 2)%s\n",
+           QUEUE_DEPTH - 2u, (unsigned)snap.depth, (unsigned)snap.high_water, ok ? "" : "  WRONG");
+    return ok;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void bench_task(void *pv)
+{
+    (void)pv;
+    //Same queue for both variants: the raw calls simply bypass the wrappers
+    ctx.qs = queue_stats_create("bench_q", QUEUE_DEPTH, sizeof(int));
+    configASSERT(ctx.qs != NULL && queue_stats_find("bench_q") == ctx.qs);
+    ctx.q = queue_stats_handle(ctx.qs);
+
+    ctx.instrumented = 0;
+    double raw_pair = run_pairs();
+    double raw_stream = run_stream();
+
+    ctx.instrumented = 1;
+    queue_stats_reset(ctx.qs);
+    double inst_pair = run_pairs();
+    queue_stats_reset(ctx.qs);                      //keep only the streaming run in the table below
+    double inst_stream = run_stream();
+
+    printf("%-34s %12s %12s %9s\n", "case", "raw", "queue_stats", "overhead");
+    printf("%-34s %9.1f ns %9.1f ns %8.1f%%\n", "send+receive pair, no blocking", raw_pair, inst_pair,
+           (inst_pair - raw_pair) * 100.0 / raw_pair);
+    printf("%-34s %12.0f %12.0f %8.1f%%\n", "producer/consumer items/sec", raw_stream, inst_stream,
+           (raw_stream - inst_stream) * 100.0 / raw_stream);
+    printf("\nTelemetry of the instrumented streaming run:\n");
+    queue_stats_print_all();
+
+    queue_stats_snapshot_t snap;
+    queue_stats_get(ctx.qs, &snap);
+    configASSERT(snap.sends == BENCH_ITEMS && snap.receives == BENCH_ITEMS);
+    configASSERT(snap.high_water <= QUEUE_DEPTH);
+    exit(check_reset_with_items() ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,207 @@
+//Host check: rate-monotonic admission (rm_sched) on known task sets, and measured deadline misses with
+//hand-picked vs. rate-monotonic priorities
+//
+//1) Analysis only: textbook task sets whose verdict is known (periods scaled to 10 ms ticks). Each is run
+//   through rm_sched_assign() + rm_sched_analyse() and the verdict compared with the expected one.
+//2) Measured: one set (6/20, 10/50, 30/100 ms WCET/period, 80 % utilization) runs as periodic_task jobs that
+//   burn their WCET in CPU time, RUN_SECONDS per priority assignment:
+//     all priority 1        : like xTaskCreate(task1, "task1", 2048, NULL, 1, NULL) for every task
+//     longest period first  : hand-picked, "the slow task does the important work"
+//     rate monotonic        : rm_sched_start()
+//   Deadline misses come from periodic_task's counters, the analysis column from rm_sched_analyse() on the
+//   same priorities.
+//
+//  rm_admission_check          exit code 1 if a known verdict is wrong, rm_sched_start() admits an
+//                              unschedulable set, or the rate-monotonic run misses a deadline
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "rm_sched.h"
+#include "bench_util.h"
+
+#define RUN_SECONDS         5u
+#define MAX_SET             4u
+
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t deadline_ms;                   //0 = period
+    uint32_t wcet_ms;
+} task_spec_t;
+
+typedef struct {
+    const char *name;
+    bool schedulable;                       //expected verdict
+    size_t count;
+    task_spec_t tasks[MAX_SET];
+} known_set_t;
+
+static const known_set_t known_sets[] = {
+    { "U 75 %, below the bound", true, 3, { { "t1", 100, 0, 20 }, { "t2", 150, 0, 40 }, { "t3", 350, 0, 100 } } },
+    { "U 88 %, t3 ends on its deadline", true, 3, { { "t1", 40, 0, 10 }, { "t2", 60, 0, 20 }, { "t3", 100, 0, 30 } } },
+    { "U 100 %, harmonic periods", true, 2, { { "t1", 20, 0, 10 }, { "t2", 40, 0, 20 } } },
+    { "U 97 %, not harmonic", false, 2, { { "t1", 50, 0, 20 }, { "t2", 70, 0, 40 } } },
+    { "U 110 %, overload", false, 2, { { "t1", 50, 0, 30 }, { "t2", 60, 0, 30 } } },
+    { "deadline < period", true, 2, { { "t1", 100, 20, 10 }, { "t2", 50, 0, 15 } } },
+};
+
+static const task_spec_t measured_set[] = {
+    { "fast", 20, 0, 6 },
+    { "medium", 50, 0, 10 },
+    { "slow", 100, 0, 30 },
+};
+#define MEASURED_COUNT      (sizeof(measured_set) / sizeof(measured_set[0]))
+
+typedef enum { PRIO_ALL_ONE, PRIO_LONGEST_FIRST, PRIO_RATE_MONOTONIC } prio_scheme_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void fill_set(rm_task_t *set, const task_spec_t *specs, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        set[i] = (rm_task_t){
+            .config = { .name = specs[i].name, .period_ms = specs[i].period_ms,
+                        .deadline_ms = specs[i].deadline_ms, .stack_depth = 4096, .priority = 1 },
+            .wcet_us = specs[i].wcet_ms * 1000u,
+        };
+    }
+}
+
+static bool check_known_sets(void)
+{
+    bool ok = true;
+    for (size_t s = 0; s < sizeof(known_sets) / sizeof(known_sets[0]); s++) {
+        const known_set_t *ks = &known_sets[s];
+        rm_task_t set[MAX_SET];
+        rm_sched_report_t report;
+        fill_set(set, ks->tasks, ks->count);
+        BaseType_t assigned = rm_sched_assign(set, ks->count, 1);
+        configASSERT(assigned == pdPASS);
+        rm_sched_analyse(set, ks->count, &report);
+
+        bool verdict = report.schedulable == pdTRUE;
+        printf("\n%s: expected %s -> %s\n", ks->name, ks->schedulable ? "schedulable" : "NOT schedulable",
+               verdict == ks->schedulable ? "ok" : "WRONG");
+        rm_sched_print(set, ks->count, &report);
+        ok = ok && (verdict == ks->schedulable);
+    }
+    return ok;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Burns the WCET as CPU time: only one FreeRTOS task runs at a time, so process CPU time is this task's
+static void burn_job(periodic_task_t *pt, void *arg)
+{
+    (void)pt;
+    uint64_t end = bench_cpu_ns() + (uint64_t)(uintptr_t)arg * 1000u;
+    while (bench_cpu_ns() < end) {
+    }
+}
+
+static bool run_measured(prio_scheme_t scheme)
+{
+    static const char *const names[] = { "all priority 1", "longest period first", "rate monotonic" };
+    rm_task_t set[MEASURED_COUNT];
+    rm_sched_report_t report;
+    fill_set(set, measured_set, MEASURED_COUNT);
+    for (size_t i = 0; i < MEASURED_COUNT; i++) {
+        set[i].config.job = burn_job;
+        set[i].config.arg = (void *)(uintptr_t)set[i].wcet_us;
+        set[i].config.priority = (scheme == PRIO_LONGEST_FIRST) ? (UBaseType_t)(i + 1) : 1;
+    }
+
+    bool admitted;
+    if (scheme == PRIO_RATE_MONOTONIC) {
+        admitted = rm_sched_start(set, MEASURED_COUNT, 1, &report) == pdPASS;
+    } else {
+        rm_sched_analyse(set, MEASURED_COUNT, &report);
+        for (size_t i = 0; i < MEASURED_COUNT; i++) {
+            set[i].task = periodic_task_create(&set[i].config);
+            configASSERT(set[i].task != NULL);
+        }
+        admitted = true;
+    }
+    if (!admitted) {
+        printf("%-22s rejected by rm_sched_start()\n", names[scheme]);
+        return false;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(RUN_SECONDS * 1000u));
+
+    uint32_t total_misses = 0;
+    for (size_t i = 0; i < MEASURED_COUNT; i++) {
+        periodic_task_stats_t st;
+        periodic_task_get(set[i].task, &st);
+        char analysis[16];
+        if (set[i].response_us == RM_SCHED_UNBOUNDED) {
+            snprintf(analysis, sizeof(analysis), "miss");
+        } else {
+            snprintf(analysis, sizeof(analysis), "%u us", (unsigned)set[i].response_us);
+        }
+        printf("%-22s %-7s %4u %10s %8u %8u %10u %10u\n", i == 0 ? names[scheme] : "", set[i].config.name,
+               (unsigned)set[i].config.priority, analysis, (unsigned)st.releases, (unsigned)st.deadline_misses,
+               (unsigned)st.jitter_max_us, (unsigned)st.exec_max_us);
+        total_misses += st.deadline_misses;
+    }
+    rm_sched_stop(set, MEASURED_COUNT);
+    return scheme != PRIO_RATE_MONOTONIC || total_misses == 0;
+}
+
+//The same set with one more task on top must be refused, and nothing may be created
+static bool check_rejection(void)
+{
+    rm_task_t set[MEASURED_COUNT + 1];
+    rm_sched_report_t report;
+    fill_set(set, measured_set, MEASURED_COUNT);
+    set[MEASURED_COUNT] = (rm_task_t){
+        .config = { .name = "extra", .period_ms = 40, .stack_depth = 4096, .job = burn_job,
+                    .arg = (void *)(uintptr_t)10000u },
+        .wcet_us = 10000u,
+    };
+    for (size_t i = 0; i < MEASURED_COUNT; i++) {
+        set[i].config.job = burn_job;
+        set[i].config.arg = (void *)(uintptr_t)set[i].wcet_us;
+    }
+    UBaseType_t tasks_before = uxTaskGetNumberOfTasks();
+    BaseType_t started = rm_sched_start(set, MEASURED_COUNT + 1, 1, &report);
+    printf("\nadding \"extra\" (10 / 40 ms): %s\n", started == pdPASS ? "ADMITTED" : "rejected");
+    rm_sched_print(set, MEASURED_COUNT + 1, &report);
+    if (started == pdPASS) {
+        rm_sched_stop(set, MEASURED_COUNT + 1);
+        return false;
+    }
+    return uxTaskGetNumberOfTasks() == tasks_before;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    bool ok = check_known_sets();
+
+    printf("\nmeasured, %u s per assignment, WCET burnt as CPU time\n", RUN_SECONDS);
+    printf("%-22s %-7s %4s %10s %8s %8s %10s %10s\n", "priorities", "task", "prio", "analysis", "releases",
+           "misses", "jitter max", "exec max");
+    for (int scheme = PRIO_ALL_ONE; scheme <= PRIO_RATE_MONOTONIC; scheme++) {
+        ok = run_measured((prio_scheme_t)scheme) && ok;
+    }
+    ok = check_rejection() && ok;
+
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 1, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
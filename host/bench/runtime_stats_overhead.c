@@ -0,0 +1,192 @@
+//Host benchmark: what run-time stats cost, and whether the numbers they report are right
+//
+//  context switch  : notify ping-pong between two tasks, ns per switch. Run-time stats add a counter read
+//                    and an add to every switch: configure once with -DHOST_RUNTIME_STATS=ON and once
+//                    without (the default) and compare this line.
+//  sample cost     : runtime_stats_sample() with 4 / 16 / 32 tasks (uxTaskGetSystemState() + deltas)
+//  accuracy        : a task busy for 5 ticks out of every 10 must show up at ~50 % in the sampler's snapshot,
+//                    core busy at least that much
+//  round trip      : runtime_stats_encode() -> runtime_stats_decode() gives back the same snapshot
+//
+//  runtime_stats_overhead      exit code 1 if the accuracy or round-trip check fails
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "runtime_stats.h"
+#include "bench_util.h"
+
+#define PING_PONGS          100000u
+#define SAMPLE_CALLS        200u
+#define FILLER_MAX          32u
+#define BURN_TICKS          5u                  //busy, then the same number of ticks blocked
+#define WINDOW_MS           1000u
+#define BURN_MIN_PERMILLE   400u
+#define BURN_MAX_PERMILLE   600u
+#define ECHO_PRIO           (configMAX_PRIORITIES - 1)
+
+static TaskHandle_t bench;
+
+
+//-------------------------------------------------------------------------------------------------
+static void echo_task(void *pv)
+{
+    (void)pv;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xTaskNotifyGive(bench);
+    }
+}
+
+//Each round trip is two switches: bench -> echo (higher priority, runs at once) -> bench
+static void measure_switch(void)
+{
+    TaskHandle_t echo;
+    BaseType_t created = xTaskCreate(echo_task, "echo", configMINIMAL_STACK_SIZE, NULL, ECHO_PRIO, &echo);
+    configASSERT(created == pdPASS);
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < PING_PONGS; i++) {
+        xTaskNotifyGive(echo);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    uint64_t ns = bench_now_ns() - t0;
+    vTaskDelete(echo);
+    printf("context switch  : %6u ns (run-time stats %s)\n", (unsigned)(ns / (2u * PING_PONGS)),
+           RUNTIME_STATS_AVAILABLE ? "compiled in" : "compiled out, HOST_RUNTIME_STATS=0");
+}
+//-------------------------------------------------------------------------------------------------
+
+
+#if RUNTIME_STATS_AVAILABLE
+//-------------------------------------------------------------------------------------------------
+static void filler_task(void *pv)
+{
+    (void)pv;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+static void burner_task(void *pv)
+{
+    (void)pv;
+    while (1) {
+        TickType_t start = xTaskGetTickCount();
+        while (xTaskGetTickCount() - start < BURN_TICKS) {
+        }
+        vTaskDelay(BURN_TICKS);
+    }
+}
+
+static void measure_sample(void)
+{
+    static runtime_stats_snapshot_t snap;
+    static const uint32_t task_counts[] = { 4, 16, 32 };
+    TaskHandle_t fillers[FILLER_MAX];
+    uint32_t created = 0;
+    (void)runtime_stats_sample(&snap);                  //first reading: only primes the deltas
+    for (size_t i = 0; i < sizeof(task_counts) / sizeof(task_counts[0]); i++) {
+        while (uxTaskGetNumberOfTasks() < task_counts[i] && created < FILLER_MAX) {
+            BaseType_t filler = xTaskCreate(filler_task, "filler", configMINIMAL_STACK_SIZE, NULL, 1, &fillers[created]);
+            configASSERT(filler == pdPASS);
+            created++;
+        }
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t n = 0; n < SAMPLE_CALLS; n++) {
+            BaseType_t sampled = runtime_stats_sample(&snap);
+            configASSERT(sampled == pdPASS);
+        }
+        uint64_t ns = (bench_now_ns() - t0) / SAMPLE_CALLS;
+        unsigned tasks = (unsigned)uxTaskGetNumberOfTasks();
+        printf("sample cost     : %6u ns with %2u tasks (%u ns per task)\n", (unsigned)ns, tasks,
+               (unsigned)(ns / tasks));
+    }
+    for (uint32_t i = 0; i < created; i++) {
+        xTaskNotifyGive(fillers[i]);
+    }
+    vTaskDelay(1);                          //fillers end, the idle task frees them
+}
+
+static bool check_accuracy(runtime_stats_snapshot_t *snap)
+{
+    TaskHandle_t burner;
+    BaseType_t created = xTaskCreate(burner_task, "burner", configMINIMAL_STACK_SIZE, NULL, 2, &burner);
+    configASSERT(created == pdPASS);
+    BaseType_t started = runtime_stats_start(&(runtime_stats_config_t){ .period_ms = WINDOW_MS, .print_every = 2 });
+    configASSERT(started == pdPASS);
+    vTaskDelay(pdMS_TO_TICKS(2u * WINDOW_MS + WINDOW_MS / 4u));      //two windows, the second one printed
+    BaseType_t got = runtime_stats_get(snap);
+    configASSERT(got == pdPASS);
+    vTaskDelete(burner);
+
+    const runtime_stats_task_t *b = NULL;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < snap->task_count; i++) {
+        sum += snap->tasks[i].cpu_permille;
+        if (strcmp(snap->tasks[i].name, "burner") == 0) {
+            b = &snap->tasks[i];
+        }
+    }
+    bool ok = b != NULL && b->cpu_permille >= BURN_MIN_PERMILLE && b->cpu_permille <= BURN_MAX_PERMILLE &&
+              snap->busy_permille[0] >= b->cpu_permille && snap->sequence >= 2;
+    printf("accuracy        : burner %u.%u %% (expected %u..%u %%), core busy %u.%u %%, all tasks %u.%u %%%s\n",
+           b ? b->cpu_permille / 10u : 0u, b ? b->cpu_permille % 10u : 0u, BURN_MIN_PERMILLE / 10u,
+           BURN_MAX_PERMILLE / 10u, snap->busy_permille[0] / 10u, snap->busy_permille[0] % 10u,
+           (unsigned)(sum / 10u), (unsigned)(sum % 10u), ok ? "" : "  WRONG");
+    return ok;
+}
+//-------------------------------------------------------------------------------------------------
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+static bool check_round_trip(const runtime_stats_snapshot_t *snap)
+{
+    static uint8_t buf[RUNTIME_STATS_ENCODED_MAX];
+    static runtime_stats_snapshot_t back;
+    size_t len = runtime_stats_encode(snap, buf, sizeof(buf));
+    bool ok = len > 0 && runtime_stats_decode(buf, len, &back) == pdPASS && back.window_us == snap->window_us &&
+              back.cores == snap->cores && back.task_count == snap->task_count &&
+              runtime_stats_encode(snap, buf, len - 1) == 0 && runtime_stats_decode(buf, len - 1, &back) == pdFAIL;
+    runtime_stats_decode(buf, len, &back);
+    for (uint8_t i = 0; ok && i < snap->task_count; i++) {
+        const runtime_stats_task_t *a = &snap->tasks[i], *z = &back.tasks[i];
+        ok = strcmp(a->name, z->name) == 0 && a->number == z->number && a->priority == z->priority &&
+             a->state == z->state && a->cpu_permille == z->cpu_permille && a->stack_free == z->stack_free;
+    }
+    printf("round trip      : %u tasks in %u bytes (%u-byte struct)%s\n", snap->task_count, (unsigned)len,
+           (unsigned)sizeof(*snap), ok ? "" : "  WRONG");
+    return ok;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    static runtime_stats_snapshot_t snap;
+    bool ok = true;
+    measure_switch();
+#if RUNTIME_STATS_AVAILABLE
+    measure_sample();
+    ok = check_accuracy(&snap);
+#else
+    printf("sample cost     : skipped, run-time stats compiled out\n");
+    snap = (runtime_stats_snapshot_t){ .window_us = 1000000u, .cores = 1, .busy_permille = { 250 }, .task_count = 2,
+                                       .tasks = { { "task1", 3, 1, 2, 200, 1400, 0 }, { "IDLE", 1, 0, 1, 750, 900, 0 } } };
+#endif
+    ok = check_round_trip(&snap) && ok;
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, &bench);
+    vTaskStartScheduler();
+    return 1;
+}
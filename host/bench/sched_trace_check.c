@@ -0,0 +1,259 @@
+//Host check: a sched_trace capture of the SIMPLE_BIN_SEMAPHORE tasks must reproduce their give / take sequence
+//
+//  Task A (priority 2) gives a binary semaphore every GIVE_PERIOD_MS, Task B / Task C (priority 1) take it,
+//  all three count what they did. The trace runs ROUNDS periods, then the dump is decoded in memory:
+//
+//  sequence        : gives in the trace == Task A's count, takes == Task B + Task C's count, strictly
+//                    alternating give, take, give, ... (a binary semaphore holds one give)
+//  attribution     : every give happens inside a Task A slice, every take inside a Task B / Task C slice
+//  switches        : per core SWITCH_IN and SWITCH_OUT alternate, and always name the same task
+//  export          : sched_trace_check.json (open in ui.perfetto.dev) has one flow arrow per take
+//  hook cost       : give + take on an uncontended semaphore, trace recording vs stopped (ns per pair)
+//
+//  sched_trace_check       exit code 1 if any check fails
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sched_trace.h"
+#include "sched_trace_decode.h"
+#include "bench_util.h"
+
+#define GIVE_PERIOD_MS      50u
+#define ROUNDS              20u
+#define COST_PAIRS          100000u
+#define JSON_PATH           "sched_trace_check.json"
+#define DUMP_MAX            (SCHED_TRACE_HEADER_SIZE + SCHED_TRACE_CORE_HEADER + SCHED_TRACE_EVENTS * SCHED_TRACE_EVENT_SIZE + 4096)
+
+static SemaphoreHandle_t xSemaphore;
+static volatile uint32_t gives, takes_b, takes_c;
+
+typedef struct {
+    uint8_t data[DUMP_MAX];
+    size_t len;
+    bool overflow;
+} dump_buf_t;
+
+
+//-------------------------------------------------------------------------------------------------
+//Task A / Task B / Task C as in SIMPLE_BIN_SEMAPHORE, with a shorter period and counters instead of printf
+
+static void taskA(void *pv)
+{
+    (void)pv;
+    while (1) {
+        xSemaphoreGive(xSemaphore);
+        gives++;
+        vTaskDelay(pdMS_TO_TICKS(GIVE_PERIOD_MS));
+    }
+}
+
+static void taskB(void *pv)
+{
+    (void)pv;
+    while (1) {
+        if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE) {
+            takes_b++;
+        }
+    }
+}
+
+static void taskC(void *pv)
+{
+    (void)pv;
+    while (1) {
+        if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE) {
+            takes_c++;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void dump_write(const void *data, size_t len, void *arg)
+{
+    dump_buf_t *b = arg;
+    if (len > sizeof(b->data) - b->len) {
+        b->overflow = true;
+        return;
+    }
+    memcpy(&b->data[b->len], data, len);
+    b->len += len;
+}
+
+static uint16_t task_number(const sched_trace_decoded_t *d, const char *name)
+{
+    for (size_t i = 0; i < d->name_count; i++) {
+        if (d->names[i].kind == SCHED_TRACE_NAME_TASK && strcmp(d->names[i].name, name) == 0) {
+            return d->names[i].id;
+        }
+    }
+    return 0;
+}
+
+static bool check_sequence(const sched_trace_decoded_t *d, uint16_t sem_id, uint32_t want_gives, uint32_t want_takes)
+{
+    uint16_t a = task_number(d, "TaskA"), b = task_number(d, "TaskB"), c = task_number(d, "TaskC");
+    uint32_t n_gives = 0, n_takes = 0, misplaced = 0, out_of_order = 0;
+    bool given = false;
+    for (size_t i = 0; i < d->count; i++) {
+        const sched_trace_record_t *r = &d->records[i];
+        if (r->id != sem_id || (r->type != SCHED_TRACE_EV_SEND && r->type != SCHED_TRACE_EV_RECEIVE)) {
+            continue;
+        }
+        if (r->type == SCHED_TRACE_EV_SEND) {
+            n_gives++;
+            misplaced += (r->task != a || r->object != SCHED_TRACE_OBJ_BINARY);
+            out_of_order += given;
+            given = true;
+        } else {
+            n_takes++;
+            misplaced += (r->task != b && r->task != c) || r->object != SCHED_TRACE_OBJ_BINARY;
+            out_of_order += !given;
+            given = false;
+        }
+    }
+    bool ok = a != 0 && b != 0 && c != 0 && n_gives == want_gives && n_takes == want_takes && misplaced == 0 &&
+              out_of_order == 0;
+    printf("sequence        : %u gives (Task A counted %u), %u takes (Task B + C counted %u), %u out of order%s\n",
+           (unsigned)n_gives, (unsigned)want_gives, (unsigned)n_takes, (unsigned)want_takes, (unsigned)out_of_order,
+           ok ? "" : "  WRONG");
+    printf("attribution     : %u events outside the giving / taking task's slice%s\n", (unsigned)misplaced,
+           misplaced == 0 ? "" : "  WRONG");
+    return ok;
+}
+
+static bool check_switches(const sched_trace_decoded_t *d)
+{
+    uint16_t running[SCHED_TRACE_DECODE_CORES] = { 0 };
+    uint32_t switches = 0, broken = 0;
+    for (size_t i = 0; i < d->count; i++) {
+        const sched_trace_record_t *r = &d->records[i];
+        if (r->type == SCHED_TRACE_EV_SWITCH_IN) {
+            broken += (running[r->core] != 0);
+            running[r->core] = r->id;
+            switches++;
+        } else if (r->type == SCHED_TRACE_EV_SWITCH_OUT) {
+            broken += (running[r->core] != 0 && running[r->core] != r->id);     //0: the trace starts inside a slice
+            running[r->core] = 0;
+        }
+    }
+    printf("switches        : %u switched in, %u unpaired%s\n", (unsigned)switches, (unsigned)broken,
+           broken == 0 ? "" : "  WRONG");
+    return broken == 0 && switches > 0;
+}
+
+static bool check_export(const sched_trace_decoded_t *d, uint32_t want_flows)
+{
+    FILE *f = fopen(JSON_PATH, "w+");
+    if (f == NULL || sched_trace_decode_json(d, f) != 0) {
+        printf("export          : cannot write %s  WRONG\n", JSON_PATH);
+        if (f != NULL) {
+            fclose(f);
+        }
+        return false;
+    }
+    rewind(f);
+    static char line[512];
+    uint32_t flows = 0, slices = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        flows += (strstr(line, "\"ph\":\"f\"") != NULL);
+        slices += (strstr(line, "\"ph\":\"X\"") != NULL);
+    }
+    long size = ftell(f);
+    fclose(f);
+    bool ok = flows == want_flows && slices > 0;
+    printf("export          : %s, %ld bytes, %u slices, %u flow arrows (expected %u)%s\n", JSON_PATH, size,
+           (unsigned)slices, (unsigned)flows, (unsigned)want_flows, ok ? "" : "  WRONG");
+    return ok;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static uint64_t give_take_ns(SemaphoreHandle_t sem)
+{
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < COST_PAIRS; i++) {
+        xSemaphoreGive(sem);
+        xSemaphoreTake(sem, 0);
+    }
+    return (bench_now_ns() - t0) / COST_PAIRS;
+}
+
+static void measure_cost(void)
+{
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    configASSERT(sem != NULL);
+    sched_trace_stop();
+    uint64_t off = give_take_ns(sem);
+    BaseType_t started = sched_trace_start(SCHED_TRACE_FLIGHT_RECORDER);
+    configASSERT(started == pdPASS);
+    uint64_t on = give_take_ns(sem);
+    sched_trace_stop();
+    vSemaphoreDelete(sem);
+    printf("hook cost       : give + take %u ns stopped, %u ns recording (%u ns per event)\n", (unsigned)off,
+           (unsigned)on, on > off ? (unsigned)((on - off) / 2u) : 0u);
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    static dump_buf_t dump;
+    static sched_trace_decoded_t decoded;
+
+    xSemaphore = xSemaphoreCreateBinary();
+    configASSERT(xSemaphore != NULL);
+    BaseType_t named = sched_trace_name_queue(xSemaphore, "xSemaphore");
+    configASSERT(named == pdPASS);
+    if (sched_trace_start(SCHED_TRACE_ONE_SHOT) != pdPASS) {
+        printf("capture         : skipped, kernel built without the trace hooks (HOST_SCHED_TRACE=0)\n");
+        exit(0);
+    }
+
+    //Waiters first, as in app_main(): Task A gives as soon as it exists
+    BaseType_t created = xTaskCreate(taskB, "TaskB", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    configASSERT(created == pdPASS);
+    created = xTaskCreate(taskC, "TaskC", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    configASSERT(created == pdPASS);
+    created = xTaskCreate(taskA, "TaskA", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    configASSERT(created == pdPASS);
+
+    //Stop half a period after the last give: every task is blocked, the counters match the trace
+    vTaskDelay(pdMS_TO_TICKS((ROUNDS - 1u) * GIVE_PERIOD_MS + GIVE_PERIOD_MS / 2u));
+    size_t len = sched_trace_dump(dump_write, &dump);
+    uint32_t want_gives = gives, want_takes = takes_b + takes_c;
+
+    bool ok = len > 0 && len == dump.len && !dump.overflow && sched_trace_decode_parse(&decoded, dump.data, dump.len) == 0;
+    if (ok) {
+        printf("capture         : %u events, %u lost, %u bytes (Task B took %u, Task C %u)\n",
+               (unsigned)decoded.count, (unsigned)decoded.lost[0], (unsigned)len, (unsigned)takes_b,
+               (unsigned)takes_c);
+        ok = check_sequence(&decoded, (uint16_t)uxQueueGetQueueNumber(xSemaphore), want_gives, want_takes);
+        ok = check_switches(&decoded) && ok;
+        ok = check_export(&decoded, want_takes) && ok && decoded.lost[0] == 0;
+        sched_trace_decode_free(&decoded);
+    } else {
+        printf("capture         : dump of %u bytes not decoded  WRONG\n", (unsigned)len);
+    }
+    measure_cost();
+
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,208 @@
+//Host benchmark: sharded_queue (components/sharded_queue) against one shared FreeRTOS queue, MPMC
+//
+//  P producers x C consumers, P in {1, 2, 4, 8}, C in {1, 2, 4}, all at priority 5.
+//  ITEMS items per case in total, split over the producers; an item is {producer, sequence number}.
+//  single   : one xQueueCreate(SHARDS x DEPTH) shared by everyone
+//  sharded  : SHARDS shards of DEPTH (the ESP32's two cores), producer i sends to shard i % SHARDS,
+//             consumer j's home is shard j % SHARDS (sharded_queue_send_to / _receive_from, the host
+//             has no pinned tasks)
+//  Reported : items per second (median of ROUNDS), share of the items the sharded consumers stole.
+//
+//  The POSIX port runs one task at a time, so the numbers show the cost of the extra bookkeeping,
+//  not the contention the shards remove on two cores.
+//
+//  checks   : every item received exactly once, the items of one producer arrive at each consumer
+//             in increasing sequence order (per-producer FIFO)
+//
+//  sharded_queue_bench      exit code 1 if a check fails
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sharded_queue.h"
+#include "bench_util.h"
+
+#define ITEMS               16000u
+#define ROUNDS              3u
+#define SHARDS              2u
+#define DEPTH               16u
+#define MAX_PRODUCERS       8u
+#define MAX_CONSUMERS       4u
+#define WORKER_PRIO         5
+
+typedef struct {
+    uint16_t producer;
+    uint16_t pad;
+    uint32_t seq;
+} item_t;
+
+typedef struct {
+    uint8_t index;
+    uint32_t count;                         //producer: items to send
+} worker_t;
+
+static struct {
+    BaseType_t sharded;
+    QueueHandle_t q;
+    sharded_queue_t *sq;
+    uint32_t total;
+    atomic_uint taken;
+    uint64_t t_end;
+    TaskHandle_t waiter;
+} run;
+
+static uint8_t seen[MAX_PRODUCERS][ITEMS];
+static int64_t last_seq[MAX_CONSUMERS][MAX_PRODUCERS];
+static atomic_uint errors;
+static worker_t workers[MAX_PRODUCERS + MAX_CONSUMERS];
+
+
+//-------------------------------------------------------------------------------------------------
+static void producer_task(void *pv)
+{
+    const worker_t *w = pv;
+    for (uint32_t seq = 0; seq < w->count; seq++) {
+        item_t item = { .producer = w->index, .seq = seq };
+        if (run.sharded) {
+            sharded_queue_send_to(run.sq, (uint8_t)(w->index % SHARDS), &item, portMAX_DELAY);
+        } else {
+            xQueueSend(run.q, &item, portMAX_DELAY);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv)
+{
+    const worker_t *w = pv;
+    item_t item;
+    while (atomic_load_explicit(&run.taken, memory_order_relaxed) < run.total) {
+        BaseType_t got = run.sharded
+                       ? sharded_queue_receive_from(run.sq, (uint8_t)(w->index % SHARDS), &item, 1)
+                       : xQueueReceive(run.q, &item, 1);
+        if (got != pdPASS) {
+            continue;                       //re-check "taken": the others may have drained the rest
+        }
+        if (item.producer >= MAX_PRODUCERS || item.seq >= ITEMS || seen[item.producer][item.seq]++ != 0 ||
+            (int64_t)item.seq <= last_seq[w->index][item.producer]) {
+            atomic_fetch_add_explicit(&errors, 1, memory_order_relaxed);
+        }
+        last_seq[w->index][item.producer] = item.seq;
+        if (atomic_fetch_add_explicit(&run.taken, 1, memory_order_relaxed) + 1u == run.total) {
+            run.t_end = bench_now_ns();
+        }
+    }
+    xTaskNotifyGive(run.waiter);
+    vTaskDelete(NULL);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Items per second for one case; *stolen = items the sharded consumers took from a remote shard
+static uint32_t run_case(BaseType_t sharded, uint32_t producers, uint32_t consumers, uint32_t *stolen)
+{
+    memset(seen, 0, sizeof(seen));
+    for (uint32_t c = 0; c < MAX_CONSUMERS; c++) {
+        for (uint32_t p = 0; p < MAX_PRODUCERS; p++) {
+            last_seq[c][p] = -1;
+        }
+    }
+    run.sharded = sharded;
+    run.total = (ITEMS / producers) * producers;
+    atomic_store(&run.taken, 0);
+    run.waiter = xTaskGetCurrentTaskHandle();
+    if (sharded) {
+        run.sq = sharded_queue_create(&(sharded_queue_config_t){ .shards = SHARDS, .depth = DEPTH,
+                                                                 .item_size = sizeof(item_t) });
+        configASSERT(run.sq != NULL);
+    } else {
+        run.q = xQueueCreate(SHARDS * DEPTH, sizeof(item_t));
+        configASSERT(run.q != NULL);
+    }
+
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t c = 0; c < consumers; c++) {
+        workers[MAX_PRODUCERS + c] = (worker_t){ .index = (uint8_t)c };
+        xTaskCreate(consumer_task, "consumer", 2048, &workers[MAX_PRODUCERS + c], WORKER_PRIO, NULL);
+    }
+    for (uint32_t p = 0; p < producers; p++) {
+        workers[p] = (worker_t){ .index = (uint8_t)p, .count = ITEMS / producers };
+        xTaskCreate(producer_task, "producer", 2048, &workers[p], WORKER_PRIO, NULL);
+    }
+    for (uint32_t c = 0; c < consumers; c++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+    uint64_t ns = run.t_end - t0;
+
+    for (uint32_t p = 0; p < producers; p++) {
+        for (uint32_t s = 0; s < ITEMS / producers; s++) {
+            if (seen[p][s] != 1) {
+                atomic_fetch_add_explicit(&errors, 1, memory_order_relaxed);
+            }
+        }
+    }
+    *stolen = 0;
+    if (sharded) {
+        sharded_queue_stats_t st;
+        sharded_queue_get(run.sq, &st);
+        if (st.sent != run.total || st.received != run.total) {
+            atomic_fetch_add_explicit(&errors, 1, memory_order_relaxed);
+        }
+        *stolen = st.stolen;
+        sharded_queue_delete(run.sq);
+    } else {
+        vQueueDelete(run.q);
+    }
+    vTaskDelay(2);                          //the idle task frees the workers
+    return (uint32_t)((uint64_t)run.total * 1000000000ull / (ns ? ns : 1));
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void bench_task(void *pv)
+{
+    (void)pv;
+    static const uint32_t producer_counts[] = { 1, 2, 4, 8 };
+    static const uint32_t consumer_counts[] = { 1, 2, 4 };
+    static uint32_t samples[2][ROUNDS];
+
+    printf("%u items per case, %u shards x %u vs one queue of %u, item %u bytes\n", ITEMS, SHARDS, DEPTH,
+           SHARDS * DEPTH, (unsigned)sizeof(item_t));
+    printf("%-4s %-4s %14s %14s %8s %8s\n", "P", "C", "single/s", "sharded/s", "ratio", "stolen");
+    for (size_t pi = 0; pi < sizeof(producer_counts) / sizeof(producer_counts[0]); pi++) {
+        for (size_t ci = 0; ci < sizeof(consumer_counts) / sizeof(consumer_counts[0]); ci++) {
+            uint32_t p = producer_counts[pi], c = consumer_counts[ci], stolen = 0, total_stolen = 0;
+            for (uint32_t r = 0; r < ROUNDS; r++) {
+                samples[0][r] = run_case(pdFALSE, p, c, &stolen);
+                samples[1][r] = run_case(pdTRUE, p, c, &stolen);
+                total_stolen += stolen;
+            }
+            uint32_t single = bench_percentile(samples[0], ROUNDS, 50.0);
+            uint32_t sharded = bench_percentile(samples[1], ROUNDS, 50.0);
+            printf("%-4u %-4u %14u %14u %7.2fx %7.1f%%\n", (unsigned)p, (unsigned)c, (unsigned)single,
+                   (unsigned)sharded, (double)sharded / (double)(single ? single : 1),
+                   100.0 * (double)total_stolen / (double)((ITEMS / p) * p * ROUNDS));
+        }
+    }
+
+    unsigned bad = atomic_load(&errors);
+    if (bad != 0) {
+        printf("\nFAILED: %u items lost, duplicated or out of producer order\n", bad);
+    }
+    exit(bad == 0 ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,228 @@
+//Host stress test: lost signals when taskA gives faster than taskB / taskC can take
+//Two load patterns, each with ceiling 1 (binary semaphore, as in SIMPLE_BIN_SEMAPHORE) and 2 .. 16 (counting):
+//  bursts   : BURST_SIZE gives at once every BURST_PERIOD_US - on average B + C keep up, but not at once
+//  overload : one give every OVERLOAD_PERIOD_US - more than B + C can take in the long run
+//Reports gives lost, the largest number pending and the give-to-take latency (simulated us, pending gives
+//taken oldest first).
+//
+//Same simulated clock as fair_dispatch_sim: real tasks and kernel, taskA (this task) at the lowest priority
+//advances the clock event by event, so the numbers do not depend on host speed.
+//
+//  signal_loss_stress          exit code 1 if a give is neither taken nor counted as lost, if the binary
+//                              semaphore loses nothing in the burst pattern, or if a ceiling that covers the
+//                              burst still loses gives
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "signal_sem.h"
+#include "bench_util.h"
+
+#define SIM_GIVES           100000u
+#define WAITERS             2u
+#define WORK_MEAN_US        100u            //taskB and taskC: 100 us +- 30 % per signal
+#define WORK_SPREAD_US      30u
+#define BURST_SIZE          6u
+#define BURST_PERIOD_US     400u            //6 gives / 400 us = 75 % of what B + C can take
+#define OVERLOAD_PERIOD_US  40u             //1 give / 40 us = 125 %
+#define MAX_CEILING         16u
+#define GIVER_PRIO          1
+#define WAITER_PRIO         2
+
+static const UBaseType_t ceilings[] = { 1, 2, 4, 8, 16 };
+#define CEILING_COUNT       (sizeof(ceilings) / sizeof(ceilings[0]))
+
+typedef enum { LOAD_BURSTS, LOAD_OVERLOAD } load_t;
+
+typedef struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t work_done;
+    bool busy;
+    uint64_t busy_until;
+    uint32_t rng;
+} sim_waiter_t;
+
+static struct {
+    signal_sem_t *sig;
+    uint64_t now_us;
+    uint64_t given_at[MAX_CEILING];         //FIFO of the pending gives' times
+    uint32_t fifo_head, fifo_count;
+    uint32_t *latency_us;
+    uint32_t takes;
+    sim_waiter_t w[WAITERS];
+} sim;
+
+
+//-------------------------------------------------------------------------------------------------
+static uint32_t work_time_us(sim_waiter_t *w)
+{
+    w->rng ^= w->rng << 13;                 //xorshift32: same sequence on every run
+    w->rng ^= w->rng >> 17;
+    w->rng ^= w->rng << 5;
+    return WORK_MEAN_US - WORK_SPREAD_US + w->rng % (2u * WORK_SPREAD_US + 1u);
+}
+
+static void waiter_task(void *pv)
+{
+    sim_waiter_t *w = pv;
+    while (1) {
+        BaseType_t got = signal_sem_take(sim.sig, portMAX_DELAY);
+        configASSERT(got == pdTRUE && sim.fifo_count > 0);
+        (void)got;
+        sim.latency_us[sim.takes++] = (uint32_t)(sim.now_us - sim.given_at[sim.fifo_head]);
+        sim.fifo_head = (sim.fifo_head + 1) % MAX_CEILING;
+        sim.fifo_count--;
+
+        w->busy = true;
+        w->busy_until = sim.now_us + work_time_us(w);
+        xSemaphoreTake(w->work_done, portMAX_DELAY);    //taskA gives it when the clock reaches busy_until
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//The scheduler is suspended so the give is queued in the FIFO before the woken waiter runs
+static void give_signal(void)
+{
+    vTaskSuspendAll();
+    if (signal_sem_give(sim.sig) == pdPASS) {
+        configASSERT(sim.fifo_count < MAX_CEILING);
+        sim.given_at[(sim.fifo_head + sim.fifo_count) % MAX_CEILING] = sim.now_us;
+        sim.fifo_count++;
+    }
+    xTaskResumeAll();
+}
+
+static int next_work_end(uint64_t limit)
+{
+    int found = -1;
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        const sim_waiter_t *w = &sim.w[i];
+        if (w->busy && w->busy_until <= limit && (found < 0 || w->busy_until < sim.w[found].busy_until)) {
+            found = (int)i;
+        }
+    }
+    return found;
+}
+
+static void finish_work(int index)
+{
+    sim.now_us = sim.w[index].busy_until;
+    sim.w[index].busy = false;
+    xSemaphoreGive(sim.w[index].work_done);
+}
+
+//Runs one load pattern with one ceiling, prints a table line, returns the number of lost gives
+static uint32_t run_case(load_t load, UBaseType_t ceiling, int *failed)
+{
+    sim.sig = signal_sem_create(ceiling);
+    configASSERT(sim.sig != NULL);
+    sim.now_us = 0;
+    sim.fifo_head = 0;
+    sim.fifo_count = 0;
+    sim.takes = 0;
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        sim_waiter_t *w = &sim.w[i];
+        *w = (sim_waiter_t){ .rng = 0x9e3779b9u + i };
+        w->work_done = xSemaphoreCreateBinary();
+        configASSERT(w->work_done != NULL);
+        xTaskCreate(waiter_task, i == 0 ? "taskB" : "taskC", 2048, w, WAITER_PRIO, &w->task);
+        configASSERT(w->task != NULL);
+    }
+
+    uint64_t next_give = 0;
+    for (uint32_t gives = 0; gives < SIM_GIVES;) {
+        int ending = next_work_end(next_give);
+        if (ending >= 0) {
+            finish_work(ending);
+            continue;
+        }
+        sim.now_us = next_give;
+        give_signal();
+        gives++;
+        if (load == LOAD_OVERLOAD) {
+            next_give += OVERLOAD_PERIOD_US;
+        } else if (gives % BURST_SIZE == 0) {
+            next_give += BURST_PERIOD_US;   //the gives inside a burst share one timestamp
+        }
+    }
+    for (int ending; (ending = next_work_end(UINT64_MAX)) >= 0;) {
+        finish_work(ending);
+    }
+
+    signal_sem_stats_t st;
+    signal_sem_get(sim.sig, &st);
+    if (st.gives != SIM_GIVES || st.takes != sim.takes || st.takes + st.lost + st.pending != st.gives) {
+        printf("ACCOUNTING MISMATCH: %u gives, %u takes, %u lost, %u pending\n", (unsigned)st.gives,
+               (unsigned)st.takes, (unsigned)st.lost, (unsigned)st.pending);
+        *failed = 1;
+    }
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < sim.takes; i++) {
+        sum += sim.latency_us[i];
+    }
+    uint32_t p50 = bench_percentile(sim.latency_us, sim.takes, 50.0);
+    uint32_t p99 = bench_percentile(sim.latency_us, sim.takes, 99.0);
+    uint32_t max = sim.takes ? sim.latency_us[sim.takes - 1] : 0;
+    printf("%-10s %8u %10u %9.2f%% %10u %9.1f %8u %8u %8u\n", load == LOAD_BURSTS ? "bursts" : "overload",
+           (unsigned)ceiling, (unsigned)st.lost, 100.0 * st.lost / st.gives, (unsigned)st.high_water,
+           sim.takes ? (double)sum / sim.takes : 0.0, p50, p99, max);
+
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        vTaskDelete(sim.w[i].task);
+        vSemaphoreDelete(sim.w[i].work_done);
+    }
+    signal_sem_delete(sim.sig);
+    return st.lost;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    vTaskPrioritySet(NULL, GIVER_PRIO);
+    sim.latency_us = malloc(SIM_GIVES * sizeof(uint32_t));
+    configASSERT(sim.latency_us != NULL);
+
+    printf("%u gives per case; taskB / taskC need %u +- %u us per signal (simulated clock)\n", SIM_GIVES,
+           WORK_MEAN_US, WORK_SPREAD_US);
+    printf("bursts: %u gives every %u us, overload: 1 give every %u us\n\n", BURST_SIZE, BURST_PERIOD_US,
+           OVERLOAD_PERIOD_US);
+    printf("%-10s %8s %10s %10s %10s %9s %8s %8s %8s\n", "load", "ceiling", "lost", "loss", "max pend",
+           "lat avg", "p50 us", "p99 us", "max us");
+
+    int failed = 0;
+    for (int load = LOAD_BURSTS; load <= LOAD_OVERLOAD; load++) {
+        for (size_t c = 0; c < CEILING_COUNT; c++) {
+            uint32_t lost = run_case((load_t)load, ceilings[c], &failed);
+            //Bursts: the binary semaphore must show the loss, a ceiling covering what B + C cannot take at once must not
+            if (load == LOAD_BURSTS && ceilings[c] == 1 && lost == 0) {
+                printf("FAILED: binary semaphore lost nothing, the burst pattern does not stress it\n");
+                failed = 1;
+            }
+            if (load == LOAD_BURSTS && ceilings[c] >= BURST_SIZE - WAITERS && lost != 0) {
+                printf("FAILED: ceiling %u still loses gives of a %u-give burst\n", (unsigned)ceilings[c],
+                       BURST_SIZE);
+                failed = 1;
+            }
+        }
+        printf("\n");
+    }
+    printf("%s\n", failed ? "FAILED" : "passed");
+    free(sim.latency_us);
+    fflush(stdout);
+    exit(failed ? 1 : 0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "taskA", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,125 @@
+//Host benchmark: xQueueSend/xQueueReceive vs. spsc_ring_send/spsc_ring_receive
+//Same shape as QUEUE_EXAMPLE_BASIC: one producer task, one consumer task, both priority 5, int items.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "spsc_ring.h"
+#include "bench_util.h"
+
+#define BENCH_ITEMS         200000u
+#define BENCH_STAMP_WINDOW  1024u           //must be larger than any channel depth
+#define QUEUE_DEPTH         10u             //same as the example: xQueueCreate(10, sizeof(int))
+#define RING_DEPTH          16u             //next power of two
+
+typedef enum { CHANNEL_QUEUE, CHANNEL_RING } channel_kind_t;
+
+typedef struct {
+    channel_kind_t kind;
+    QueueHandle_t q;
+    spsc_ring_t *ring;
+    uint64_t stamps[BENCH_STAMP_WINDOW];    //send time of item "seq", indexed by seq % window
+    uint32_t *latency_ns;
+    TaskHandle_t waiter;
+} bench_ctx_t;
+
+
+//-------------------------------------------------------------------------------------------------
+static void producer_task(void *pv)
+{
+    bench_ctx_t *ctx = pv;
+    for (uint32_t seq = 0; seq < BENCH_ITEMS; seq++) {
+        int value = (int)seq;
+        ctx->stamps[seq % BENCH_STAMP_WINDOW] = bench_now_ns();
+        if (ctx->kind == CHANNEL_QUEUE) {
+            xQueueSend(ctx->q, &value, portMAX_DELAY);
+        } else {
+            spsc_ring_send(ctx->ring, &value, portMAX_DELAY);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv)
+{
+    bench_ctx_t *ctx = pv;
+    int rx = 0;
+    for (uint32_t seq = 0; seq < BENCH_ITEMS; seq++) {
+        if (ctx->kind == CHANNEL_QUEUE) {
+            xQueueReceive(ctx->q, &rx, portMAX_DELAY);
+        } else {
+            spsc_ring_receive(ctx->ring, &rx, portMAX_DELAY);
+        }
+        configASSERT((uint32_t)rx == seq);  //FIFO order must hold
+        ctx->latency_ns[seq] = (uint32_t)(bench_now_ns() - ctx->stamps[seq % BENCH_STAMP_WINDOW]);
+    }
+    xTaskNotifyGive(ctx->waiter);
+    vTaskDelete(NULL);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void run_case(channel_kind_t kind)
+{
+    static bench_ctx_t ctx;
+    ctx.kind = kind;
+    ctx.waiter = xTaskGetCurrentTaskHandle();
+    ctx.latency_ns = malloc(BENCH_ITEMS * sizeof(uint32_t));
+    configASSERT(ctx.latency_ns != NULL);
+
+    if (kind == CHANNEL_QUEUE) {
+        ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(int));
+        configASSERT(ctx.q != NULL);
+    } else {
+        ctx.ring = spsc_ring_create(RING_DEPTH, sizeof(int));
+        configASSERT(ctx.ring != NULL);
+    }
+
+    uint64_t t0 = bench_now_ns();
+    xTaskCreate(consumer_task, "consumer", 2048, &ctx, 5, NULL);
+    xTaskCreate(producer_task, "producer", 2048, &ctx, 5, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t elapsed = bench_now_ns() - t0;
+
+    double items_per_sec = (double)BENCH_ITEMS * 1e9 / (double)elapsed;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < BENCH_ITEMS; i++) {
+        sum += ctx.latency_ns[i];
+    }
+    uint32_t p50 = bench_percentile(ctx.latency_ns, BENCH_ITEMS, 50.0);
+    uint32_t p99 = bench_percentile(ctx.latency_ns, BENCH_ITEMS, 99.0);
+    uint32_t max = ctx.latency_ns[BENCH_ITEMS - 1];
+
+    printf("%-22s %12.0f %10.0f %10u %10u %10u\n",
+           kind == CHANNEL_QUEUE ? "xQueue (depth 10)" : "spsc_ring (depth 16)",
+           items_per_sec, (double)sum / BENCH_ITEMS, p50, p99, max);
+
+    if (kind == CHANNEL_QUEUE) {
+        vQueueDelete(ctx.q);
+    } else {
+        spsc_ring_delete(ctx.ring);
+    }
+    free(ctx.latency_ns);
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    printf("%u int items, 1 producer + 1 consumer at priority 5\n", BENCH_ITEMS);
+    printf("%-22s %12s %10s %10s %10s %10s\n", "channel", "items/sec", "avg ns", "p50 ns", "p99 ns", "max ns");
+    run_case(CHANNEL_QUEUE);
+    run_case(CHANNEL_RING);
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
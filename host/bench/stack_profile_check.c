@@ -0,0 +1,170 @@
+//Host check: stack_profile on tasks with a known stack use, then the same tasks again at the recommended size
+//
+//1) Profile: four tasks created with STACK_PROFILE_RUN_DEPTH, each recursing through FRAME_BYTES frames:
+//     small / medium / large : 4 / 16 / 40 frames on every round
+//     late                   : 4 frames, 40 frames only after 70 % of the run (a rare path)
+//     printf                 : one printf line per round, like the example tasks
+//   stack_profile_start() samples every SAMPLE_MS for RUN_SECONDS and prints the table and the header; the
+//   baseline is the examples' 2048.
+//2) Re-run: the same workloads (late at full depth from the start) in tasks created with the recommended
+//   depths; their high-water marks must leave at least the fixed margin free.
+//
+//  stack_profile_check         exit code 1 if a peak is below the known use, "late" is not flagged as growing
+//                              (or a steady task is), or a re-run task ends up with less than the margin free
+//
+//Recursion, not one big local array: the stack pointer then really is as deep as the measured use, so a
+//signal arriving in the middle (the POSIX port's tick) lands inside the measured part.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "stack_profile.h"
+
+#define RUN_SECONDS         4u
+#define SAMPLE_MS           50u
+#define ROUND_MS            20u
+#define FRAME_BYTES         240u
+#define LATE_PERCENT        70u
+#define BASELINE_DEPTH      2048u
+
+typedef struct {
+    const char *id;
+    uint32_t frames;                        //0 = the printf task
+    uint32_t late_frames;                   //from LATE_PERCENT of the run on (0 = never)
+} workload_t;
+
+static const workload_t workloads[] = {
+    { "small", 4, 0 },
+    { "medium", 16, 0 },
+    { "large", 40, 0 },
+    { "late", 4, 40 },
+    { "printf", 0, 0 },
+};
+#define WORKLOADS           (sizeof(workloads) / sizeof(workloads[0]))
+
+static TickType_t run_start;
+static bool rerun;                          //phase 2: late frames from the start
+
+
+//-------------------------------------------------------------------------------------------------
+//Each level writes its whole frame, so the use is at least frames x FRAME_BYTES. The frame is written
+//again after the call: it stays live, the compiler cannot turn the recursion into a loop.
+static __attribute__((noinline)) uint32_t recurse(uint32_t frames)
+{
+    volatile uint8_t pad[FRAME_BYTES];
+    for (uint32_t i = 0; i < FRAME_BYTES; i++) {
+        pad[i] = (uint8_t)(frames + i);
+    }
+    uint32_t below = (frames > 1) ? recurse(frames - 1) : 0;
+    pad[0] = (uint8_t)below;
+    return pad[0] + pad[FRAME_BYTES - 1];
+}
+
+static void workload_task(void *pv)
+{
+    const workload_t *wl = pv;
+    for (uint32_t round = 0;; round++) {
+        uint32_t elapsed_ms = (uint32_t)(xTaskGetTickCount() - run_start) * portTICK_PERIOD_MS;
+        bool late = wl->late_frames && (rerun || elapsed_ms >= RUN_SECONDS * 10u * LATE_PERCENT);
+        if (wl->frames == 0) {
+            printf("[%s] round %u\n", wl->id, (unsigned)round);
+        } else {
+            (void)recurse(late ? wl->late_frames : wl->frames);
+        }
+        vTaskDelay(pdMS_TO_TICKS(ROUND_MS));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static bool profile_run(TaskHandle_t *tasks)
+{
+    run_start = xTaskGetTickCount();
+    BaseType_t started = stack_profile_start(SAMPLE_MS, RUN_SECONDS * 1000u);
+    configASSERT(started == pdPASS);
+    for (size_t i = 0; i < WORKLOADS; i++) {
+        BaseType_t created = xTaskCreate(workload_task, workloads[i].id, STACK_PROFILE_RUN_DEPTH,
+                                         (void *)&workloads[i], 2, &tasks[i]);
+        configASSERT(created == pdPASS);
+        BaseType_t watched = stack_profile_watch(tasks[i], workloads[i].id, STACK_PROFILE_RUN_DEPTH, BASELINE_DEPTH);
+        configASSERT(watched == pdPASS);
+    }
+    vTaskDelay(pdMS_TO_TICKS(RUN_SECONDS * 1000u + 500u));          //the sampler prints when it is done
+
+    bool ok = true;
+    printf("\n%-8s %10s %10s %12s %8s\n", "task", "known use", "peak", "recommended", "growing");
+    for (size_t i = 0; i < WORKLOADS; i++) {
+        const workload_t *wl = &workloads[i];
+        stack_profile_result_t r;
+        BaseType_t found = stack_profile_get(wl->id, &r);
+        configASSERT(found == pdPASS);
+        uint32_t frames = wl->late_frames ? wl->late_frames : wl->frames;
+        uint32_t known = frames * FRAME_BYTES;
+        uint32_t recommended = r.recommended_depth * (uint32_t)sizeof(StackType_t);
+        bool growing = r.grew_ms > RUN_SECONDS * 1000u / 2u;
+        bool row_ok = r.peak_bytes >= known && recommended >= r.peak_bytes + STACK_PROFILE_MARGIN_BYTES &&
+                      growing == (wl->late_frames != 0);
+        printf("%-8s %10u %10u %12u %8s%s\n", wl->id, (unsigned)known, (unsigned)r.peak_bytes,
+               (unsigned)recommended, growing ? "yes" : "no", row_ok ? "" : "  WRONG");
+        ok = ok && row_ok;
+        vTaskDelete(tasks[i]);
+    }
+    return ok;
+}
+
+static bool rerun_at_recommended(void)
+{
+    TaskHandle_t tasks[WORKLOADS];
+    rerun = true;
+    run_start = xTaskGetTickCount();
+    for (size_t i = 0; i < WORKLOADS; i++) {
+        stack_profile_result_t r;
+        BaseType_t found = stack_profile_get(workloads[i].id, &r);
+        configASSERT(found == pdPASS);
+        BaseType_t created = xTaskCreate(workload_task, workloads[i].id, r.recommended_depth, (void *)&workloads[i], 2,
+                                         &tasks[i]);
+        configASSERT(created == pdPASS);
+    }
+    vTaskDelay(pdMS_TO_TICKS(RUN_SECONDS * 1000u / 2u));
+
+    bool ok = true;
+    printf("\nre-run at the recommended depth, %u s\n%-8s %12s %10s\n", RUN_SECONDS / 2u, "task", "recommended",
+           "left free");
+    for (size_t i = 0; i < WORKLOADS; i++) {
+        stack_profile_result_t r;
+        stack_profile_get(workloads[i].id, &r);
+        uint32_t free_bytes = (uint32_t)uxTaskGetStackHighWaterMark(tasks[i]) * (uint32_t)sizeof(StackType_t);
+        bool row_ok = free_bytes >= STACK_PROFILE_MARGIN_BYTES;
+        printf("%-8s %12u %10u%s\n", workloads[i].id, (unsigned)(r.recommended_depth * sizeof(StackType_t)),
+               (unsigned)free_bytes, row_ok ? "" : "  TOO LITTLE");
+        ok = ok && row_ok;
+        vTaskDelete(tasks[i]);
+    }
+    return ok;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    TaskHandle_t tasks[WORKLOADS];
+    printf("profiling %u tasks at depth %u for %u s, baseline depth %u (%u-byte stack words)\n", (unsigned)WORKLOADS,
+           (unsigned)STACK_PROFILE_RUN_DEPTH, RUN_SECONDS, BASELINE_DEPTH, (unsigned)sizeof(StackType_t));
+    bool ok = profile_run(tasks);
+    ok = rerun_at_recommended() && ok;
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 1, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
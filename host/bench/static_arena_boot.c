@@ -0,0 +1,188 @@
+//Host benchmark: boot the examples' objects from the heap (xTaskCreate / xQueueCreate / xSemaphoreCreateBinary)
+//and from a static_arena (the ...Static variants), BOOTS times each
+//
+//  ex1             : task1, task2
+//  ex2             : producer, consumer, queue of 10 ints
+//  ex3             : TaskA, TaskB, TaskC, binary semaphore
+//
+//  boot ns         : median / max wall time to create the whole set (host stacks: configMINIMAL_STACK_SIZE
+//                    words, PTHREAD_STACK_MIN; the POSIX port starts a pthread per task, which both variants pay)
+//  heap B          : heap in use after the boot minus before (malloc statistics) - what the ESP32 would no
+//                    longer have free after boot
+//  arena B         : static bytes of the set, fixed at link time
+//
+//  checks          : every object created, the arena used exactly (sized by the STATIC_ARENA_*_BYTES macros),
+//                    static boot heap below 5 % of the dynamic one
+//
+//  static_arena_boot       exit code 1 if a check fails
+
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "static_arena.h"
+#include "bench_util.h"
+
+#define BOOTS               200u
+#define DEPTH               configMINIMAL_STACK_SIZE
+#define QUEUE_DEPTH         10u
+#define MAX_TASKS           3u
+
+typedef struct {
+    const char *name;
+    uint8_t tasks;
+    bool queue;
+    bool semaphore;
+    static_arena_t *arena;
+} boot_set_t;
+
+typedef struct {
+    uint32_t median_ns;
+    uint32_t max_ns;
+    size_t heap;
+    size_t arena_used;
+    bool created;
+} result_t;
+
+STATIC_ARENA_DEFINE(ex1_arena, 2u * STATIC_ARENA_TASK_BYTES(DEPTH));
+STATIC_ARENA_DEFINE(ex2_arena, 2u * STATIC_ARENA_TASK_BYTES(DEPTH) + STATIC_ARENA_QUEUE_BYTES(QUEUE_DEPTH, sizeof(int)));
+STATIC_ARENA_DEFINE(ex3_arena, 3u * STATIC_ARENA_TASK_BYTES(DEPTH) + STATIC_ARENA_SEMAPHORE_BYTES);
+
+static const boot_set_t sets[] = {
+    { "ex1", 2, false, false, &ex1_arena },
+    { "ex2", 2, true,  false, &ex2_arena },
+    { "ex3", 3, false, true,  &ex3_arena },
+};
+
+static const char *const task_names[MAX_TASKS] = { "t0", "t1", "t2" };
+static uint32_t samples[BOOTS];
+
+
+//-------------------------------------------------------------------------------------------------
+static size_t heap_used(void)
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks;
+}
+
+//Below the bench's priority: created and deleted before they ever run
+static void idle_task(void *pv)
+{
+    (void)pv;
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+//One boot of the set; returns false if an object could not be created
+static bool boot(const boot_set_t *set, bool arena, TaskHandle_t *tasks, QueueHandle_t *q, SemaphoreHandle_t *sem)
+{
+    bool ok = true;
+    for (uint8_t i = 0; i < set->tasks; i++) {
+        BaseType_t r = arena
+            ? static_arena_task(set->arena, idle_task, task_names[i], DEPTH, NULL, 1, STATIC_ARENA_ANY_CORE, &tasks[i])
+            : xTaskCreate(idle_task, task_names[i], DEPTH, NULL, 1, &tasks[i]);
+        ok = ok && r == pdPASS;
+    }
+    if (set->queue) {
+        *q = arena ? static_arena_queue(set->arena, "q", QUEUE_DEPTH, sizeof(int)) : xQueueCreate(QUEUE_DEPTH, sizeof(int));
+        ok = ok && *q != NULL;
+    }
+    if (set->semaphore) {
+        *sem = arena ? static_arena_binary(set->arena, "sem") : xSemaphoreCreateBinary();
+        ok = ok && *sem != NULL;
+    }
+    return ok;
+}
+
+static void shutdown(const boot_set_t *set, bool arena, TaskHandle_t *tasks, QueueHandle_t q, SemaphoreHandle_t sem)
+{
+    for (uint8_t i = 0; i < set->tasks; i++) {
+        if (tasks[i] != NULL) {
+            vTaskDelete(tasks[i]);
+        }
+    }
+    if (q != NULL) {
+        vQueueDelete(q);
+    }
+    if (sem != NULL) {
+        vSemaphoreDelete(sem);
+    }
+    vTaskDelay(2);                          //the idle task frees what the deleted tasks still hold
+    if (arena) {
+        static_arena_reset(set->arena);
+    }
+}
+
+static void measure(const boot_set_t *set, bool arena, result_t *r)
+{
+    r->created = true;
+    for (uint32_t k = 0; k < BOOTS; k++) {
+        TaskHandle_t tasks[MAX_TASKS] = { NULL };
+        QueueHandle_t q = NULL;
+        SemaphoreHandle_t sem = NULL;
+
+        size_t heap0 = heap_used();
+        uint64_t t0 = bench_now_ns();
+        r->created = boot(set, arena, tasks, &q, &sem) && r->created;
+        samples[k] = (uint32_t)(bench_now_ns() - t0);
+        if (k == 0) {
+            r->heap = heap_used() - heap0;
+            if (arena) {
+                r->arena_used = set->arena->used;
+                static_arena_report(set->arena);
+            }
+        }
+        shutdown(set, arena, tasks, q, sem);
+    }
+    r->max_ns = 0;
+    for (uint32_t k = 0; k < BOOTS; k++) {
+        r->max_ns = (samples[k] > r->max_ns) ? samples[k] : r->max_ns;
+    }
+    r->median_ns = bench_percentile(samples, BOOTS, 50.0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void bench_task(void *pv)
+{
+    (void)pv;
+    bool ok = true;
+    result_t res[sizeof(sets) / sizeof(sets[0])][2];
+
+    for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+        for (int arena = 0; arena <= 1; arena++) {
+            measure(&sets[s], arena, &res[s][arena]);
+        }
+    }
+
+    printf("\n%-5s %-8s %12s %12s %10s %10s\n", "set", "variant", "boot p50 ns", "boot max ns", "heap B", "arena B");
+    for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+        const result_t *dyn = &res[s][0], *sta = &res[s][1];
+        bool good = dyn->created && sta->created && sta->arena_used == sets[s].arena->size &&
+                    sta->heap * 20u < dyn->heap;
+        printf("%-5s %-8s %12u %12u %10u %10s\n", sets[s].name, "dynamic", (unsigned)dyn->median_ns,
+               (unsigned)dyn->max_ns, (unsigned)dyn->heap, "-");
+        printf("%-5s %-8s %12u %12u %10u %10u%s\n", sets[s].name, "static", (unsigned)sta->median_ns,
+               (unsigned)sta->max_ns, (unsigned)sta->heap, (unsigned)sets[s].arena->size, good ? "" : "  WRONG");
+        ok = ok && good;
+    }
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
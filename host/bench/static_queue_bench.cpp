@@ -0,0 +1,178 @@
+//Host benchmark: StaticQueue<T, N> (components/static_queue) against the raw C API on a queue of the same shape
+//
+//  uncontended     : one task, PAIRS x (send without waiting + receive without waiting), ns per pair -
+//                    the wrapper's own overhead, nothing else in the way
+//                    int     : xQueueSend(q, &v, 0) / xQueueReceive  vs  q.try_send(v) / q.try_receive
+//                    64 B    : a 64-byte struct, passed by reference on both sides
+//                    signal  : xQueueCreate(N, 1) with a dummy byte  vs  StaticQueue<Event, N>, item size 0
+//  ping-pong       : producer and consumer at the same priority, ITEMS ints through a queue of 10 with
+//                    portMAX_DELAY on both sides (ex2's shape without the delay), items per second
+//
+//  Rounds alternate raw / typed, the median of ROUNDS is reported.
+//  checks          : typed int / 64 B within 10 % (+20 ns) of raw, ping-pong throughput at least 85 % of raw
+//
+//  static_queue_bench      exit code 1 if a check fails
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "static_queue.hpp"
+#include "bench_util.h"
+
+#define PAIRS               200000u
+#define ITEMS               20000u
+#define ROUNDS              9u
+#define DEPTH               10u
+
+struct Frame {
+    uint8_t data[64];
+};
+struct Event {};
+
+static uint32_t samples[2][ROUNDS];
+
+
+//-------------------------------------------------------------------------------------------------
+//Uncontended send + receive pairs, ns per pair
+
+template <typename T>
+static uint32_t raw_pairs(QueueHandle_t q)
+{
+    T v{}, rx{};
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < PAIRS; i++) {
+        xQueueSend(q, &v, 0);
+        xQueueReceive(q, &rx, 0);
+    }
+    return (uint32_t)((bench_now_ns() - t0) / PAIRS);
+}
+
+template <typename T>
+static uint32_t typed_pairs(StaticQueue<T, DEPTH> &q)
+{
+    T v{}, rx{};
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < PAIRS; i++) {
+        q.try_send(v);
+        q.try_receive(rx);
+    }
+    return (uint32_t)((bench_now_ns() - t0) / PAIRS);
+}
+
+template <typename T, typename Raw>
+static void uncontended(const char *name, UBaseType_t raw_item_size, uint32_t *raw_ns, uint32_t *typed_ns)
+{
+    static StaticQueue<T, DEPTH> typed;
+    QueueHandle_t raw = xQueueCreate(DEPTH, raw_item_size);
+    configASSERT(raw != NULL);
+    for (uint32_t r = 0; r < ROUNDS; r++) {
+        samples[0][r] = raw_pairs<Raw>(raw);
+        samples[1][r] = typed_pairs<T>(typed);
+    }
+    vQueueDelete(raw);
+    *raw_ns = bench_percentile(samples[0], ROUNDS, 50.0);
+    *typed_ns = bench_percentile(samples[1], ROUNDS, 50.0);
+    printf("%-10s %-12s %10u %10u\n", name, "ns / pair", (unsigned)*raw_ns, (unsigned)*typed_ns);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Ping-pong: the bench task produces, a consumer task at the same priority drains
+
+static QueueHandle_t pp_raw;
+static StaticQueue<int, DEPTH> *pp_typed;
+static TaskHandle_t bench_handle;
+
+static void raw_consumer(void *pv)
+{
+    (void)pv;
+    int rx;
+    for (uint32_t i = 0; i < ITEMS; i++) {
+        xQueueReceive(pp_raw, &rx, portMAX_DELAY);
+    }
+    xTaskNotifyGive(bench_handle);
+    vTaskDelete(NULL);
+}
+
+static void typed_consumer(void *pv)
+{
+    (void)pv;
+    int rx;
+    for (uint32_t i = 0; i < ITEMS; i++) {
+        pp_typed->receive(rx);
+    }
+    xTaskNotifyGive(bench_handle);
+    vTaskDelete(NULL);
+}
+
+//Items per second for one round
+static uint32_t ping_pong(bool typed)
+{
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    BaseType_t created = xTaskCreate(typed ? typed_consumer : raw_consumer, "consumer", configMINIMAL_STACK_SIZE,
+                                     NULL, prio, NULL);
+    configASSERT(created == pdPASS);
+    uint64_t t0 = bench_now_ns();
+    for (int i = 0; i < (int)ITEMS; i++) {
+        if (typed) {
+            pp_typed->send(i);
+        } else {
+            xQueueSend(pp_raw, &i, portMAX_DELAY);
+        }
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t ns = bench_now_ns() - t0;
+    vTaskDelay(2);                          //the idle task frees the consumer
+    return (uint32_t)((uint64_t)ITEMS * 1000000000ull / (ns ? ns : 1));
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void bench_task(void *pv)
+{
+    (void)pv;
+    bool ok = true;
+    uint32_t raw_ns, typed_ns;
+    bench_handle = xTaskGetCurrentTaskHandle();
+
+    printf("%-10s %-12s %10s %10s\n", "item", "metric", "raw C", "typed");
+    uncontended<int, int>("int", sizeof(int), &raw_ns, &typed_ns);
+    ok = ok && typed_ns <= raw_ns + raw_ns / 10u + 20u;
+    uncontended<Frame, Frame>("64 B", sizeof(Frame), &raw_ns, &typed_ns);
+    ok = ok && typed_ns <= raw_ns + raw_ns / 10u + 20u;
+    uncontended<Event, uint8_t>("signal", 1, &raw_ns, &typed_ns);
+
+    static StaticQueue<int, DEPTH> typed;
+    pp_typed = &typed;
+    pp_raw = xQueueCreate(DEPTH, sizeof(int));
+    configASSERT(pp_raw != NULL);
+    for (uint32_t r = 0; r < ROUNDS; r++) {
+        samples[0][r] = ping_pong(false);
+        samples[1][r] = ping_pong(true);
+    }
+    uint32_t raw_rate = bench_percentile(samples[0], ROUNDS, 50.0);
+    uint32_t typed_rate = bench_percentile(samples[1], ROUNDS, 50.0);
+    printf("%-10s %-12s %10u %10u\n", "int", "ping-pong/s", (unsigned)raw_rate, (unsigned)typed_rate);
+    ok = ok && (uint64_t)typed_rate * 100u >= (uint64_t)raw_rate * 85u;
+
+    printf("\nStaticQueue<int, %u>: %u bytes static, no heap; StaticQueue<Event, %u>: %u bytes\n", DEPTH,
+           (unsigned)sizeof(StaticQueue<int, DEPTH>), DEPTH, (unsigned)sizeof(StaticQueue<Event, DEPTH>));
+    if (!ok) {
+        printf("\nFAILED: the typed queue is slower than the C API\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
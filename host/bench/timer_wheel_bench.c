@@ -0,0 +1,171 @@
+//Host benchmark: N periodic jobs on one timer_wheel executor vs one task per job (SIMPLE_TASK_Creation_1's model)
+//
+//  Jobs shaped like task1 / task2: periods 1000 ms and 500 ms alternating, the job itself only counts. For
+//  N = 2, 100 and 1000 both variants run RUN_MS:
+//
+//  task per job    : xTaskCreate() + a xTaskDelayUntil() loop per job (stack configMINIMAL_STACK_SIZE)
+//  timer wheel     : one executor task, every job a timer_wheel_add() record
+//
+//  fixed / per job : heap grown by the executor / by creating the N jobs (malloc statistics, host sizes: a POSIX
+//                    task's stack is PTHREAD_STACK_MIN words, an ESP32 task the 2 KB of the example plus its TCB)
+//  busy per run    : CPU time not spent in the idle task (run-time counters) / activations - the scheduling
+//                    cost of one release: wake-up, context switches, wheel bookkeeping
+//  missed          : jobs whose activation count is off by more than one from RUN_MS / period
+//
+//  timer_wheel_bench       exit code 1 if a job misses releases or the wheel reports overruns
+
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "timer_wheel.h"
+
+#define RUN_MS              3000u
+#define MAX_JOBS            1000u
+#define EXECUTOR_STACK      (configMINIMAL_STACK_SIZE * 2)
+
+static const uint32_t job_counts[] = { 2, 100, 1000 };
+
+typedef struct {
+    uint32_t period_ms;
+    volatile uint32_t runs;
+    TaskHandle_t task;
+    timer_wheel_job_t *job;
+} job_t;
+
+typedef struct {
+    size_t heap_fixed;
+    size_t heap_per_job;
+    uint32_t busy_ns_per_run;
+    uint32_t runs;
+    uint32_t missed;
+    uint32_t overruns;
+} result_t;
+
+static job_t jobs[MAX_JOBS];
+
+
+//-------------------------------------------------------------------------------------------------
+static size_t heap_used(void)
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks;
+}
+
+static uint32_t idle_us(void)
+{
+    return (uint32_t)ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandle());
+}
+
+static void job_task(void *pv)
+{
+    job_t *j = pv;
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(j->period_ms));
+        j->runs++;
+    }
+}
+
+static void wheel_job(timer_wheel_job_t *job, void *arg)
+{
+    (void)job;
+    job_t *j = arg;
+    j->runs++;
+}
+
+//Runs of every job against RUN_MS / period (+-1: the window and the first release do not line up)
+static void count_runs(uint32_t n, result_t *r)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t expected = RUN_MS / jobs[i].period_ms;
+        r->runs += jobs[i].runs;
+        r->missed += (jobs[i].runs + 1u < expected || jobs[i].runs > expected + 1u);
+    }
+}
+
+static void measure(uint32_t n, bool wheel, result_t *r)
+{
+    timer_wheel_t *tw = NULL;
+    for (uint32_t i = 0; i < n; i++) {
+        jobs[i] = (job_t){ .period_ms = (i % 2u) ? 500u : 1000u };
+    }
+
+    size_t heap0 = heap_used();
+    if (wheel) {
+        tw = timer_wheel_create(&(timer_wheel_config_t){ .name = "tw_exec", .priority = 2,
+                                                         .stack_depth = EXECUTOR_STACK });
+        configASSERT(tw != NULL);
+    }
+    size_t heap1 = heap_used();
+    //Both variants release their first job one period after creation
+    for (uint32_t i = 0; i < n; i++) {
+        if (wheel) {
+            jobs[i].job = timer_wheel_add(tw, &(timer_wheel_job_config_t){ .job = wheel_job, .arg = &jobs[i],
+                                                                          .period_ms = jobs[i].period_ms });
+            configASSERT(jobs[i].job != NULL);
+        } else {
+            BaseType_t created = xTaskCreate(job_task, "job", configMINIMAL_STACK_SIZE, &jobs[i], 2, &jobs[i].task);
+            configASSERT(created == pdPASS);
+        }
+    }
+    r->heap_fixed = heap1 - heap0;
+    r->heap_per_job = (heap_used() - heap1) / n;
+
+    uint32_t idle0 = idle_us(), t0 = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+    vTaskDelay(pdMS_TO_TICKS(RUN_MS) + 1u);
+    uint32_t idle = idle_us() - idle0, elapsed = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE() - t0;
+
+    if (wheel) {
+        timer_wheel_stats_t st;
+        timer_wheel_get(tw, &st);
+        r->overruns = st.overruns;
+        timer_wheel_delete(tw);
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            vTaskDelete(jobs[i].task);
+        }
+    }
+    count_runs(n, r);
+    uint32_t busy = (elapsed > idle) ? elapsed - idle : 0;
+    r->busy_ns_per_run = r->runs ? (uint32_t)((uint64_t)busy * 1000u / r->runs) : 0;
+    vTaskDelay(2);                          //the idle task frees the deleted tasks
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+static void bench_task(void *pv)
+{
+    (void)pv;
+    bool ok = true;
+    printf("%-6s %-14s %10s %10s %12s %8s %7s %9s\n", "jobs", "variant", "fixed B", "RAM/job B", "busy/run ns",
+           "runs", "missed", "overruns");
+    for (size_t k = 0; k < sizeof(job_counts) / sizeof(job_counts[0]); k++) {
+        uint32_t n = job_counts[k];
+        for (int wheel = 0; wheel <= 1; wheel++) {
+            result_t r = { 0 };
+            measure(n, wheel, &r);
+            bool good = r.missed == 0 && r.overruns == 0;
+            printf("%-6u %-14s %10u %10u %12u %8u %7u %9u%s\n", (unsigned)n, wheel ? "timer wheel" : "task per job",
+                   (unsigned)r.heap_fixed, (unsigned)r.heap_per_job, (unsigned)r.busy_ns_per_run, (unsigned)r.runs,
+                   (unsigned)r.missed, (unsigned)r.overruns, good ? "" : "  WRONG");
+            ok = ok && good;
+        }
+    }
+    if (!ok) {
+        printf("\nFAILED\n");
+    }
+    exit(ok ? 0 : 1);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
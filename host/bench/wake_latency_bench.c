@@ -0,0 +1,151 @@
+//Host benchmark: give-to-take wake latency of SIMPLE_BIN_SEMAPHORE across priority configurations
+//Same shape as the example: a giver and two waiters (Task B / Task C) on one binary semaphore. The giver
+//stamps with wake_latency_give() right before xSemaphoreGive(), the woken waiter calls wake_latency_take()
+//right after xSemaphoreTake() returned and acknowledges, the giver waits for the ack before the next give.
+//
+//  waiters above giver : the give switches to the waiter at once (the pure wake path)
+//  same priority       : the waiter runs when the giver blocks on the ack
+//  waiters below giver : the same, but the waiter can never preempt the giver (the example's default)
+//
+//The harness histogram is cross-checked against the exact sorted samples of the same run, and the
+//instrumentation cost (give + take stamp, no kernel call) is measured on its own.
+//Same-core vs. cross-core placement needs the ESP32 (the POSIX port has one core): build the example with
+//-DEX3_WAKE_LATENCY=1 -DEX3_PLACEMENT=EX3_PLACE_SAME_CORE / EX3_PLACE_CROSS_CORE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "wake_latency.h"
+#include "bench_util.h"
+
+#define BENCH_GIVES         100000u
+#define BENCH_STAMPS        1000000u
+#define WAITERS             2u
+
+typedef struct {
+    const char *name;
+    UBaseType_t giver_prio;
+    UBaseType_t waiter_prio;
+} prio_case_t;
+
+static const prio_case_t prio_cases[] = {
+    { "waiters above giver", 4, 5 },
+    { "same priority", 5, 5 },
+    { "waiters below giver", 5, 4 },
+};
+
+static struct {
+    SemaphoreHandle_t sem;
+    wake_latency_t *lat;
+    TaskHandle_t giver;
+    uint64_t give_ns;                       //exact reference, next to the harness stamp
+    uint32_t *exact_ns;
+    uint32_t takes;
+} ctx;
+
+
+//-------------------------------------------------------------------------------------------------
+static void waiter_task(void *pv)
+{
+    (void)pv;
+    while (1) {
+        BaseType_t got = xSemaphoreTake(ctx.sem, portMAX_DELAY);
+        wake_latency_take(ctx.lat);
+        uint64_t now = bench_now_ns();
+        configASSERT(got == pdTRUE);
+        (void)got;
+        ctx.exact_ns[ctx.takes++] = (uint32_t)(now - ctx.give_ns);
+        xTaskNotifyGive(ctx.giver);         //ack: the giver waits for it before the next give
+    }
+}
+
+static void run_prio_case(const prio_case_t *pc)
+{
+    ctx.sem = xSemaphoreCreateBinary();
+    ctx.lat = wake_latency_create(WAKE_LATENCY_CYCLES);
+    configASSERT(ctx.sem != NULL && ctx.lat != NULL);
+    ctx.giver = xTaskGetCurrentTaskHandle();
+    ctx.takes = 0;
+
+    UBaseType_t own_prio = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, pc->giver_prio);
+    TaskHandle_t waiters[WAITERS];
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        xTaskCreate(waiter_task, i == 0 ? "TaskB" : "TaskC", 2048, NULL, pc->waiter_prio, &waiters[i]);
+        configASSERT(waiters[i] != NULL);
+    }
+
+    for (uint32_t g = 0; g < BENCH_GIVES; g++) {
+        ctx.give_ns = bench_now_ns();
+        wake_latency_give(ctx.lat);
+        xSemaphoreGive(ctx.sem);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    for (uint32_t i = 0; i < WAITERS; i++) {
+        vTaskDelete(waiters[i]);
+    }
+    vTaskPrioritySet(NULL, own_prio);
+
+    wake_latency_report_t r;
+    wake_latency_report(ctx.lat, &r);
+    configASSERT(r.samples == BENCH_GIVES && ctx.takes == BENCH_GIVES && r.unmatched == 0);
+    printf("%-22s %4u/%-4u %-9s %9u %9u %9u %9u\n", pc->name, (unsigned)pc->giver_prio,
+           (unsigned)pc->waiter_prio, "harness", (unsigned)r.p50_ns, (unsigned)r.p90_ns, (unsigned)r.p99_ns,
+           (unsigned)r.max_ns);
+    uint32_t p50 = bench_percentile(ctx.exact_ns, BENCH_GIVES, 50.0);
+    uint32_t p90 = bench_percentile(ctx.exact_ns, BENCH_GIVES, 90.0);
+    uint32_t p99 = bench_percentile(ctx.exact_ns, BENCH_GIVES, 99.0);
+    uint32_t max = ctx.exact_ns[BENCH_GIVES - 1];
+    printf("%-22s %9s %-9s %9u %9u %9u %9u\n", "", "", "exact", p50, p90, p99, max);
+
+    vSemaphoreDelete(ctx.sem);
+    wake_latency_delete(ctx.lat);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Stamp + record from the same task, no kernel call: what the harness adds to the measured path
+static double stamp_cost_ns(void)
+{
+    wake_latency_t *lat = wake_latency_create(WAKE_LATENCY_CYCLES);
+    configASSERT(lat != NULL);
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_STAMPS; i++) {
+        wake_latency_give(lat);
+        wake_latency_take(lat);
+    }
+    uint64_t elapsed = bench_now_ns() - t0;
+    wake_latency_delete(lat);
+    return (double)elapsed / BENCH_STAMPS;
+}
+
+static void bench_task(void *pv)
+{
+    (void)pv;
+    ctx.exact_ns = malloc(BENCH_GIVES * sizeof(uint32_t));
+    configASSERT(ctx.exact_ns != NULL);
+
+    printf("give-to-take latency, %u gives per case, %u waiters on one binary semaphore (one core)\n",
+           BENCH_GIVES, WAITERS);
+    printf("%-22s %9s %-9s %9s %9s %9s %9s\n", "priorities", "giver/wtr", "source", "p50 ns", "p90 ns",
+           "p99 ns", "max ns");
+    for (size_t i = 0; i < sizeof(prio_cases) / sizeof(prio_cases[0]); i++) {
+        run_prio_case(&prio_cases[i]);
+    }
+    printf("\nwake_latency_give + wake_latency_take: %.1f ns per pair (%u pairs)\n", stamp_cost_ns(), BENCH_STAMPS);
+    free(ctx.exact_ns);
+    exit(0);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+int main(void)
+{
+    xTaskCreate(bench_task, "bench", 4096, NULL, 6, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,108 @@
+//FreeRTOS configuration for the host (POSIX/Linux port) build
+//Values mirror sdkconfig.esp32dev wherever the POSIX port allows it, so timing on the host
+//behaves like the ESP32 image (100 Hz tick, 25 priorities, timer task at priority 1, ...).
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+#include <limits.h>
+
+//Scheduler ------------------------------------------------------------------------------------
+#define configUSE_PREEMPTION                        1
+#define configUSE_TIME_SLICING                      1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION     0
+#define configUSE_TICKLESS_IDLE                     0
+#define configTICK_RATE_HZ                          100             //CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES                        25
+#define configMINIMAL_STACK_SIZE                    ( ( unsigned short ) PTHREAD_STACK_MIN )
+#define configMAX_TASK_NAME_LEN                     16              //CONFIG_FREERTOS_MAX_TASK_NAME_LEN
+#define configTICK_TYPE_WIDTH_IN_BITS               TICK_TYPE_WIDTH_32_BITS
+#define configIDLE_SHOULD_YIELD                     1
+#define configNUMBER_OF_CORES                       1               //POSIX port is single core (ESP32 has 2)
+
+//Synchronisation -------------------------------------------------------------------------------
+#define configUSE_TASK_NOTIFICATIONS                1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES       1               //CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES
+#define configUSE_MUTEXES                           1
+#define configUSE_RECURSIVE_MUTEXES                 1
+#define configUSE_COUNTING_SEMAPHORES               1
+#define configQUEUE_REGISTRY_SIZE                   8               //CONFIG_FREERTOS_QUEUE_REGISTRY_SIZE (QUEUE_EXAMPLE_BASIC)
+#define configUSE_QUEUE_SETS                        0
+
+//Memory ---------------------------------------------------------------------------------------
+#define configSUPPORT_STATIC_ALLOCATION             1               //CONFIG_FREERTOS_SUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION            1
+#define configKERNEL_PROVIDED_STATIC_MEMORY         1
+#define configTOTAL_HEAP_SIZE                       ( 1024 * 1024 ) //unused with heap_3 (malloc/free)
+
+//Hooks ----------------------------------------------------------------------------------------
+#define configUSE_IDLE_HOOK                         0
+#define configUSE_TICK_HOOK                         1               //simulated timer interrupts (host/support/host_isr.c)
+#define configUSE_MALLOC_FAILED_HOOK                0
+#define configUSE_DAEMON_TASK_STARTUP_HOOK          0
+#define configCHECK_FOR_STACK_OVERFLOW              0               //pthread stacks, not checked by the port
+
+//Debug / statistics ---------------------------------------------------------------------------
+//Run-time stats (components/runtime_stats) off by default: they read the clock on every context switch.
+//Set by the host CMake option HOST_RUNTIME_STATS (cmake -DHOST_RUNTIME_STATS=ON)
+#ifndef HOST_RUNTIME_STATS
+#define HOST_RUNTIME_STATS                          0
+#endif
+
+#define configUSE_TRACE_FACILITY                    1               //uxTaskGetSystemState(), task numbers
+#define configGENERATE_RUN_TIME_STATS               HOST_RUNTIME_STATS
+#define configUSE_STATS_FORMATTING_FUNCTIONS        0
+
+#if HOST_RUNTIME_STATS
+//Run-time counter: microseconds since start, 32-bit like esp_timer's CONFIG_FREERTOS_RUN_TIME_COUNTER_TYPE_U32
+//(defined in host/support/host_stats.c)
+extern unsigned long ulHostRunTimeCounter( void );
+#define configRUN_TIME_COUNTER_TYPE                 uint32_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ( ( uint32_t ) ulHostRunTimeCounter() )
+#endif
+
+//Trace hooks ----------------------------------------------------------------------------------
+//Context-switch counter for the benchmarks (defined in host/support/host_stats.c)
+extern volatile unsigned long ulHostContextSwitches;
+
+//Scheduler trace (components/sched_trace, linked into host_support) on by default; -DHOST_SCHED_TRACE=0
+//builds the kernel without its hooks
+#ifndef HOST_SCHED_TRACE
+#define HOST_SCHED_TRACE                            1
+#endif
+
+#if HOST_SCHED_TRACE
+#define traceTASK_SWITCHED_IN()                     do { ulHostContextSwitches++; \
+                                                         sched_trace_hook_switch( SCHED_TRACE_EV_SWITCH_IN ); } while( 0 )
+#include "sched_trace_hooks.h"
+#else
+#define traceTASK_SWITCHED_IN()                     ( ulHostContextSwitches++ )
+#endif
+
+//Software timers ------------------------------------------------------------------------------
+#define configUSE_TIMERS                            1
+#define configTIMER_TASK_PRIORITY                   1               //CONFIG_FREERTOS_TIMER_TASK_PRIORITY
+#define configTIMER_QUEUE_LENGTH                    10              //CONFIG_FREERTOS_TIMER_QUEUE_LENGTH
+#define configTIMER_TASK_STACK_DEPTH                ( configMINIMAL_STACK_SIZE * 2 )
+
+//Optional functions ---------------------------------------------------------------------------
+#define INCLUDE_vTaskPrioritySet                    1
+#define INCLUDE_uxTaskPriorityGet                   1
+#define INCLUDE_vTaskDelete                         1
+#define INCLUDE_vTaskSuspend                        1               //needed for portMAX_DELAY = wait forever
+#define INCLUDE_xTaskDelayUntil                     1
+#define INCLUDE_vTaskDelay                          1
+#define INCLUDE_xTaskGetSchedulerState              1
+#define INCLUDE_xTaskGetCurrentTaskHandle           1
+#define INCLUDE_uxTaskGetStackHighWaterMark         1
+#define INCLUDE_xTaskGetIdleTaskHandle              1
+#define INCLUDE_eTaskGetState                       1
+#define INCLUDE_xTimerPendFunctionCall              1
+#define INCLUDE_xTaskAbortDelay                     1
+#define INCLUDE_xTaskGetHandle                      1
+
+#define configASSERT( x )                           assert( x )
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,43 @@
+//Host shim for ESP-IDF's esp_log.h: same macros and "I (ms) TAG: message" line format, printed with printf
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL     ESP_LOG_INFO        //CONFIG_LOG_DEFAULT_LEVEL=3
+#endif
+
+//Milliseconds since the scheduler started (tick count based, like ESP-IDF before the RTOS clock is up)
+uint32_t esp_log_timestamp(void);
+
+#define ESP_HOST_LOG(level, letter, tag, format, ...)                                           \
+    do {                                                                                        \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                                       \
+            printf(letter " (%u) %s: " format "\n", (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__); \
+        }                                                                                       \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...)  ESP_HOST_LOG(ESP_LOG_ERROR,   "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  ESP_HOST_LOG(ESP_LOG_WARN,    "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  ESP_HOST_LOG(ESP_LOG_INFO,    "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  ESP_HOST_LOG(ESP_LOG_DEBUG,   "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  ESP_HOST_LOG(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,3 @@
+//Host shim: ESP-IDF includes the kernel as "freertos/FreeRTOS.h", the POSIX build as <FreeRTOS.h>
+#pragma once
+#include <FreeRTOS.h>
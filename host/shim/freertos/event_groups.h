@@ -0,0 +1,3 @@
+//Host shim: ESP-IDF includes the kernel as "freertos/event_groups.h", the POSIX build as <event_groups.h>
+#pragma once
+#include <event_groups.h>
@@ -0,0 +1,3 @@
+//Host shim: ESP-IDF includes the kernel as "freertos/queue.h", the POSIX build as <queue.h>
+#pragma once
+#include <queue.h>
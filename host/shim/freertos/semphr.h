@@ -0,0 +1,3 @@
+//Host shim: ESP-IDF includes the kernel as "freertos/semphr.h", the POSIX build as <semphr.h>
+#pragma once
+#include <semphr.h>
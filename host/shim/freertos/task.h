@@ -0,0 +1,3 @@
+//Host shim: ESP-IDF includes the kernel as "freertos/task.h", the POSIX build as <task.h>
+#pragma once
+#include <task.h>
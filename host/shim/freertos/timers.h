@@ -0,0 +1,3 @@
+//Host shim: ESP-IDF includes the kernel as "freertos/timers.h", the POSIX build as <timers.h>
+#pragma once
+#include <timers.h>
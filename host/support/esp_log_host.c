@@ -0,0 +1,12 @@
+//Host implementation of the few ESP-IDF functions behind host/shim/esp_log.h
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
@@ -0,0 +1,57 @@
+//Simulated hardware timer interrupts (see host_isr.h)
+
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_isr.h"
+
+typedef struct {
+    host_isr_handler_t handler;             //NULL = free slot
+    void *arg;
+    uint32_t period_ticks;
+    uint32_t countdown;
+} host_isr_timer_t;
+
+static host_isr_timer_t timers[HOST_ISR_TIMERS];
+
+
+//Called by the kernel from the tick interrupt (configUSE_TICK_HOOK)
+void vApplicationTickHook(void)
+{
+    for (int i = 0; i < HOST_ISR_TIMERS; i++) {
+        host_isr_timer_t *t = &timers[i];
+        if (t->handler != NULL && --t->countdown == 0) {
+            t->countdown = t->period_ticks;
+            t->handler(t->arg);
+        }
+    }
+}
+
+//The tick interrupt is masked inside a critical section, so the hook never sees a half-written slot
+int host_isr_timer_start(uint32_t period_ticks, host_isr_handler_t handler, void *arg)
+{
+    if (period_ticks == 0 || handler == NULL) {
+        return -1;
+    }
+    int id = -1;
+    taskENTER_CRITICAL();
+    for (int i = 0; i < HOST_ISR_TIMERS && id < 0; i++) {
+        if (timers[i].handler == NULL) {
+            timers[i] = (host_isr_timer_t){ .handler = handler, .arg = arg, .period_ticks = period_ticks,
+                                            .countdown = period_ticks };
+            id = i;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return id;
+}
+
+void host_isr_timer_stop(int id)
+{
+    if (id < 0 || id >= HOST_ISR_TIMERS) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    timers[id].handler = NULL;
+    taskEXIT_CRITICAL();
+}
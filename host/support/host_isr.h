@@ -0,0 +1,35 @@
+//Simulated hardware timer interrupts for the host build (driven by the FreeRTOS tick)
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+---------------------------------------------------------------------------------------------------
+The POSIX port has no peripherals. The closest thing to a timer interrupt is the tick itself: the
+kernel calls vApplicationTickHook() from the tick interrupt handler, where ...FromISR() calls are
+legal. host_isr_timer_start() registers a handler that this hook calls every "period_ticks" ticks.
+
+>> Resolution is one tick (10 ms at configTICK_RATE_HZ 100); a hardware timer has 1 us.
+>> Do not call portYIELD_FROM_ISR() in the handler: a task readied by a ...FromISR() call in the tick
+   hook is switched to when the tick interrupt returns.
+---------------------------------------------------------------------------------------------------
+*/
+
+#define HOST_ISR_TIMERS     4
+
+typedef void (*host_isr_handler_t)(void *arg);
+
+//Returns a timer id (0 .. HOST_ISR_TIMERS - 1), or -1 if all are in use or period_ticks is 0.
+int host_isr_timer_start(uint32_t period_ticks, host_isr_handler_t handler, void *arg);
+
+//After this returns the handler is not running and will not be called again.
+void host_isr_timer_stop(int id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+//Host entry point for the examples: plays the role of ESP-IDF's startup code
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*
+On the ESP32, ESP-IDF starts the scheduler itself and then calls app_main() from the "main" task
+(priority 1, CONFIG_ESP_MAIN_TASK_STACK_SIZE = 3584 bytes). app_main() may return; the main task is
+then deleted while the tasks it created keep running. This file reproduces that sequence on Linux.
+*/
+
+#define HOST_MAIN_TASK_PRIORITY     1
+#define HOST_MAIN_TASK_STACK        ( configMINIMAL_STACK_SIZE * 2 )
+
+void app_main(void);
+
+
+static void main_task(void *pv)
+{
+    (void)pv;
+    app_main();
+    vTaskDelete(NULL);
+}
+
+int main(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);       //one line at a time, like the UART console
+
+    xTaskCreate(main_task, "main", HOST_MAIN_TASK_STACK, NULL, HOST_MAIN_TASK_PRIORITY, NULL);
+    vTaskStartScheduler();
+
+    //Only reached if the scheduler could not start (e.g. not enough memory for the idle task)
+    return 1;
+}
@@ -0,0 +1,18 @@
+//Counters updated by the trace macros in host/config/FreeRTOSConfig.h and read by the benchmarks
+
+#include <stdint.h>
+#include <time.h>
+
+volatile unsigned long ulHostContextSwitches = 0;
+
+//Run-time stats clock: microseconds since the first call (the scheduler start), wraps like a uint32_t
+unsigned long ulHostRunTimeCounter(void)
+{
+    static struct timespec start;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (start.tv_sec == 0 && start.tv_nsec == 0) {
+        start = now;
+    }
+    return (unsigned long)(uint32_t)((now.tv_sec - start.tv_sec) * 1000000LL + (now.tv_nsec - start.tv_nsec) / 1000);
+}
@@ -0,0 +1,596 @@
+//Host decoder for the binlog component (see binlog_decode.h)
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binlog_decode.h"
+
+#define LINE_MAX_LEN        1024
+
+
+//-------------------------------------------------------------------------------------------------
+//String table from an ELF file: the "binlog_fmt" sites between the start / end symbols
+
+typedef struct {
+    uint32_t type;
+    uint64_t flags;
+    uint64_t addr;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+} section_t;
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    int is64;
+    uint64_t shoff;
+    uint16_t shnum;
+    uint16_t shentsize;
+} elf_t;
+
+static int elf_section(const elf_t *elf, uint16_t index, section_t *sec)
+{
+    uint64_t at = elf->shoff + (uint64_t)index * elf->shentsize;
+    if (at + elf->shentsize > elf->size) {
+        return -1;
+    }
+    if (elf->is64) {
+        Elf64_Shdr sh;
+        memcpy(&sh, elf->data + at, sizeof(sh));
+        *sec = (section_t){ sh.sh_type, sh.sh_flags, sh.sh_addr, sh.sh_offset, sh.sh_size, sh.sh_link };
+    } else {
+        Elf32_Shdr sh;
+        memcpy(&sh, elf->data + at, sizeof(sh));
+        *sec = (section_t){ sh.sh_type, sh.sh_flags, sh.sh_addr, sh.sh_offset, sh.sh_size, sh.sh_link };
+    }
+    return (sec->type == SHT_NOBITS || sec->offset + sec->size <= elf->size) ? 0 : -1;
+}
+
+//Value of the first symbol called "name" (any binding: __start_ symbols are local in executables)
+static int elf_symbol(const elf_t *elf, const char *name, uint64_t *value)
+{
+    for (uint16_t i = 0; i < elf->shnum; i++) {
+        section_t symtab, strtab;
+        if (elf_section(elf, i, &symtab) != 0 || symtab.type != SHT_SYMTAB ||
+            elf_section(elf, (uint16_t)symtab.link, &strtab) != 0) {
+            continue;
+        }
+        size_t entsize = elf->is64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+        for (uint64_t off = 0; off + entsize <= symtab.size; off += entsize) {
+            uint32_t name_off;
+            uint64_t sym_value;
+            if (elf->is64) {
+                Elf64_Sym sym;
+                memcpy(&sym, elf->data + symtab.offset + off, sizeof(sym));
+                name_off = sym.st_name;
+                sym_value = sym.st_value;
+            } else {
+                Elf32_Sym sym;
+                memcpy(&sym, elf->data + symtab.offset + off, sizeof(sym));
+                name_off = sym.st_name;
+                sym_value = sym.st_value;
+            }
+            if (name_off < strtab.size &&
+                strncmp((const char *)elf->data + strtab.offset + name_off, name, strtab.size - name_off) == 0) {
+                *value = sym_value;
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+static int table_from_elf(binlog_table_t *table, const uint8_t *data, size_t size, const char *path)
+{
+    elf_t elf = { .data = data, .size = size };
+    if (size < EI_NIDENT || data[EI_DATA] != ELFDATA2LSB) {
+        fprintf(stderr, "%s: only little-endian ELF files are supported\n", path);
+        return -1;
+    }
+    elf.is64 = (data[EI_CLASS] == ELFCLASS64);
+    if (elf.is64) {
+        Elf64_Ehdr eh;
+        if (size < sizeof(eh)) {
+            return -1;
+        }
+        memcpy(&eh, data, sizeof(eh));
+        elf.shoff = eh.e_shoff;
+        elf.shnum = eh.e_shnum;
+        elf.shentsize = eh.e_shentsize;
+    } else {
+        Elf32_Ehdr eh;
+        if (size < sizeof(eh)) {
+            return -1;
+        }
+        memcpy(&eh, data, sizeof(eh));
+        elf.shoff = eh.e_shoff;
+        elf.shnum = eh.e_shnum;
+        elf.shentsize = eh.e_shentsize;
+    }
+
+    //Host (GNU ld): __start_binlog_fmt / __stop_binlog_fmt, ESP-IDF (linker.lf SURROUND): _binlog_fmt_start / _end
+    uint64_t start, end;
+    if (!(elf_symbol(&elf, "__start_binlog_fmt", &start) == 0 && elf_symbol(&elf, "__stop_binlog_fmt", &end) == 0) &&
+        !(elf_symbol(&elf, "_binlog_fmt_start", &start) == 0 && elf_symbol(&elf, "_binlog_fmt_end", &end) == 0)) {
+        table->count = 0;                       //no BINLOG_x call linked in (or stripped)
+        table->sites = NULL;
+        return 0;
+    }
+    if (end < start || (end - start) % BINLOG_SITE_SIZE != 0) {
+        fprintf(stderr, "%s: binlog_fmt section size %llu is not a multiple of %u\n", path,
+                (unsigned long long)(end - start), BINLOG_SITE_SIZE);
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < elf.shnum; i++) {
+        section_t sec;
+        if (elf_section(&elf, i, &sec) != 0 || !(sec.flags & SHF_ALLOC) || sec.type == SHT_NOBITS ||
+            start < sec.addr || end > sec.addr + sec.size) {
+            continue;
+        }
+        table->count = (size_t)((end - start) / BINLOG_SITE_SIZE);
+        table->sites = malloc(table->count * sizeof(binlog_site_t) + 1);
+        if (table->sites == NULL) {
+            return -1;
+        }
+        memcpy(table->sites, data + sec.offset + (start - sec.addr), table->count * sizeof(binlog_site_t));
+        for (size_t s = 0; s < table->count; s++) {
+            table->sites[s].format[sizeof(table->sites[s].format) - 1] = '\0';
+        }
+        return 0;
+    }
+    fprintf(stderr, "%s: no section holds the binlog_fmt sites\n", path);
+    return -1;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Text table file
+
+static int table_from_text(binlog_table_t *table, const char *text, const char *path)
+{
+    size_t cap = 16;
+    table->count = 0;
+    table->sites = malloc(cap * sizeof(binlog_site_t));
+
+    for (const char *line = text; table->sites != NULL && *line != '\0'; ) {
+        const char *eol = strchr(line, '\n');
+        if (eol == NULL) {
+            eol = line + strlen(line);
+        }
+        unsigned long id;
+        char level;
+        int skip = 0;
+        if (line[0] != '#' && eol != line && sscanf(line, "%lu %c %n", &id, &level, &skip) == 2 && skip > 0) {
+            if (id != table->count) {
+                fprintf(stderr, "%s: site %lu out of order\n", path, id);
+                free(table->sites);
+                table->sites = NULL;
+                return -1;
+            }
+            if (table->count == cap) {
+                cap *= 2;
+                binlog_site_t *grown = realloc(table->sites, cap * sizeof(binlog_site_t));
+                if (grown == NULL) {
+                    break;
+                }
+                table->sites = grown;
+            }
+            binlog_site_t *site = &table->sites[table->count++];
+            memset(site, 0, sizeof(*site));
+            site->level = (level == '-') ? 0 : level;
+            size_t n = 0;
+            for (const char *c = line + skip; c < eol && n < sizeof(site->format) - 1; c++) {
+                if (*c == '\\' && c + 1 < eol) {
+                    c++;
+                    site->format[n++] = (*c == 'n') ? '\n' : (*c == 't') ? '\t' : (*c == 'r') ? '\r' : *c;
+                } else {
+                    site->format[n++] = *c;
+                }
+            }
+        }
+        line = (*eol != '\0') ? eol + 1 : eol;
+    }
+    return (table->sites != NULL) ? 0 : -1;
+}
+
+int binlog_table_save(const binlog_table_t *table, FILE *out)
+{
+    fprintf(out, "# binlog string table v%u: %zu sites (<id> <level, - = printf> <format>)\n",
+            BINLOG_WIRE_VERSION, table->count);
+    for (size_t i = 0; i < table->count; i++) {
+        const binlog_site_t *site = &table->sites[i];
+        fprintf(out, "%zu %c ", i, (site->level != 0) ? site->level : '-');
+        for (const char *c = site->format; *c != '\0'; c++) {
+            switch (*c) {
+            case '\n':  fputs("\\n", out);  break;
+            case '\t':  fputs("\\t", out);  break;
+            case '\r':  fputs("\\r", out);  break;
+            case '\\':  fputs("\\\\", out); break;
+            default:    fputc(*c, out);     break;
+            }
+        }
+        fputc('\n', out);
+    }
+    return ferror(out) ? -1 : 0;
+}
+
+int binlog_table_load(binlog_table_t *table, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = (size > 0) ? malloc((size_t)size + 1) : NULL;
+    if (data == NULL || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "%s: cannot read file\n", path);
+        fclose(f);
+        free(data);
+        return -1;
+    }
+    fclose(f);
+    data[size] = '\0';
+
+    int rc;
+    if (size >= SELFMAG && memcmp(data, ELFMAG, SELFMAG) == 0) {
+        rc = table_from_elf(table, data, (size_t)size, path);
+    } else {
+        rc = table_from_text(table, (const char *)data, path);
+    }
+    free(data);
+    return rc;
+}
+
+void binlog_table_free(binlog_table_t *table)
+{
+    free(table->sites);
+    table->sites = NULL;
+    table->count = 0;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Record decoding
+
+typedef struct {
+    char text[LINE_MAX_LEN];
+    size_t len;
+} line_t;
+
+static void line_add(line_t *line, const char *s, size_t n)
+{
+    if (n > sizeof(line->text) - 1 - line->len) {
+        n = sizeof(line->text) - 1 - line->len;
+    }
+    memcpy(&line->text[line->len], s, n);
+    line->len += n;
+}
+
+//snprintf straight into the line, clipped at the end of the buffer
+#define LINE_PRINTF(line, ...)                                                                  \
+    do {                                                                                        \
+        int w = snprintf(&(line)->text[(line)->len], sizeof((line)->text) - (line)->len, __VA_ARGS__); \
+        if (w > 0) {                                                                            \
+            (line)->len += ((size_t)w < sizeof((line)->text) - (line)->len) ? (size_t)w         \
+                                                                            : sizeof((line)->text) - 1 - (line)->len; \
+        }                                                                                       \
+    } while (0)
+
+//Literal text between conversions, "%%" -> "%"
+static void line_add_literal(line_t *line, const char *from, const char *to)
+{
+    while (from < to) {
+        const char *pct = memchr(from, '%', (size_t)(to - from));
+        if (pct == NULL) {
+            line_add(line, from, (size_t)(to - from));
+            return;
+        }
+        line_add(line, from, (size_t)(pct - from) + 1);
+        from = pct + 2;
+    }
+}
+
+typedef struct {
+    const uint8_t *p;
+    size_t left;
+} cursor_t;
+
+static int get_varint(cursor_t *c, uint64_t *v)
+{
+    size_t n = binlog_get_varint(c->p, c->left, v);
+    if (n == 0) {
+        return 0;
+    }
+    c->p += n;
+    c->left -= n;
+    return 1;
+}
+
+static int get_string(cursor_t *c, char *out, size_t cap)
+{
+    uint64_t n;
+    if (!get_varint(c, &n) || n > c->left) {
+        return 0;
+    }
+    size_t copy = (n < cap - 1) ? (size_t)n : cap - 1;
+    memcpy(out, c->p, copy);
+    out[copy] = '\0';
+    c->p += n;
+    c->left -= (size_t)n;
+    return 1;
+}
+
+//Message text of a SITE record; 0 = more bytes needed
+static int render_args(cursor_t *c, const char *format, line_t *line)
+{
+    binlog_spec_t spec;
+    const char *p = format;
+    const char *literal = format;
+
+    while ((p = binlog_next_spec(p, &spec)) != NULL) {
+        line_add_literal(line, literal, spec.start);
+        if (spec.kind == BINLOG_ARG_UNSUPPORTED) {
+            line_add(line, spec.start, strlen(spec.start));     //encoder stopped here as well
+            return 1;
+        }
+
+        //Flags, width and precision from the format, '*' replaced by the values on the wire
+        char conv[48];
+        size_t n = 0;
+        for (const char *s = spec.start; s < spec.length && n < sizeof(conv) - 24; s++) {
+            if (*s == '*') {
+                uint64_t v;
+                if (!get_varint(c, &v)) {
+                    return 0;
+                }
+                n += (size_t)snprintf(&conv[n], sizeof(conv) - n, "%d", (int)binlog_unzigzag(v));
+            } else {
+                conv[n++] = *s;
+            }
+        }
+        char type = spec.end[-1];
+
+        uint64_t v = 0;
+        switch (spec.kind) {
+        case BINLOG_ARG_SIGNED:
+            if (!get_varint(c, &v)) {
+                return 0;
+            }
+            snprintf(&conv[n], sizeof(conv) - n, "ll%c", type);
+            LINE_PRINTF(line, conv, (long long)binlog_unzigzag(v));
+            break;
+        case BINLOG_ARG_UNSIGNED:
+            if (!get_varint(c, &v)) {
+                return 0;
+            }
+            snprintf(&conv[n], sizeof(conv) - n, "ll%c", type);
+            LINE_PRINTF(line, conv, (unsigned long long)v);
+            break;
+        case BINLOG_ARG_CHAR:
+            if (!get_varint(c, &v)) {
+                return 0;
+            }
+            snprintf(&conv[n], sizeof(conv) - n, "c");
+            LINE_PRINTF(line, conv, (int)v);
+            break;
+        case BINLOG_ARG_POINTER:
+            if (!get_varint(c, &v)) {
+                return 0;
+            }
+            line_add(line, "0x", 2);
+            snprintf(&conv[n], sizeof(conv) - n, "llx");
+            LINE_PRINTF(line, conv, (unsigned long long)v);
+            break;
+        case BINLOG_ARG_DOUBLE: {
+            if (c->left < sizeof(uint64_t)) {
+                return 0;
+            }
+            uint64_t bits = 0;
+            for (unsigned i = 0; i < sizeof(bits); i++) {
+                bits |= (uint64_t)c->p[i] << (8 * i);
+            }
+            c->p += sizeof(bits);
+            c->left -= sizeof(bits);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            snprintf(&conv[n], sizeof(conv) - n, "%c", type);
+            LINE_PRINTF(line, conv, d);
+            break;
+        }
+        default: {
+            char s[BINLOG_STR_MAX + 1];
+            if (!get_string(c, s, sizeof(s))) {
+                return 0;
+            }
+            snprintf(&conv[n], sizeof(conv) - n, "s");
+            LINE_PRINTF(line, conv, s);
+            break;
+        }
+        }
+        p = spec.end;
+        literal = p;
+    }
+    line_add_literal(line, literal, literal + strlen(literal));
+    return 1;
+}
+
+//Bytes used by the record at c, 0 = incomplete, -1 = not a valid record (lost sync)
+static long decode_record(binlog_decoder_t *d, cursor_t c)
+{
+    size_t start_left = c.left;
+    uint64_t type;
+    if (!get_varint(&c, &type)) {
+        return (c.left >= BINLOG_VARINT_MAX) ? -1 : 0;
+    }
+
+    if (type == BINLOG_REC_SYNC) {
+        if (c.left < BINLOG_SYNC_MAGIC_LEN) {
+            return 0;
+        }
+        if (memcmp(c.p, BINLOG_SYNC_MAGIC + 1, BINLOG_SYNC_MAGIC_LEN - 1) != 0 || c.p[3] != BINLOG_WIRE_VERSION) {
+            return -1;
+        }
+        c.p += BINLOG_SYNC_MAGIC_LEN;
+        c.left -= BINLOG_SYNC_MAGIC_LEN;
+        uint64_t now;
+        if (!get_varint(&c, &now)) {
+            return 0;
+        }
+        d->timestamp = (uint32_t)now;
+        memset(d->tags, 0, sizeof(d->tags));
+        return (long)(start_left - c.left);
+    }
+
+    if (type == BINLOG_REC_TAG) {
+        uint64_t index;
+        char tag[BINLOG_TAG_MAX + 1];
+        if (!get_varint(&c, &index) || !get_string(&c, tag, sizeof(tag))) {
+            return 0;
+        }
+        if (index == 0 || index >= BINLOG_DECODE_TAGS) {
+            return -1;
+        }
+        memcpy(d->tags[index], tag, sizeof(tag));
+        return (long)(start_left - c.left);
+    }
+
+    uint64_t id = type - BINLOG_REC_SITE_BASE;
+    if (id >= d->table->count) {
+        return -1;
+    }
+    const binlog_site_t *site = &d->table->sites[id];
+    uint64_t delta;
+    if (!get_varint(&c, &delta)) {
+        return 0;
+    }
+    char inline_tag[BINLOG_TAG_MAX + 1];
+    const char *tag = NULL;
+    if (site->level != 0) {
+        uint64_t index;
+        if (!get_varint(&c, &index)) {
+            return 0;
+        }
+        if (index == 0) {
+            if (!get_string(&c, inline_tag, sizeof(inline_tag))) {
+                return 0;
+            }
+            tag = inline_tag;
+        } else if (index < BINLOG_DECODE_TAGS && d->tags[index][0] != '\0') {
+            tag = d->tags[index];
+        } else {
+            tag = "?";                          //TAG record lost
+        }
+    }
+
+    line_t line;
+    line.len = 0;
+    uint32_t timestamp = d->timestamp + (uint32_t)delta;
+    if (site->level != 0) {
+        LINE_PRINTF(&line, "%c (%u) %s: ", site->level, (unsigned)timestamp, tag);
+    }
+    if (!render_args(&c, site->format, &line)) {
+        return 0;
+    }
+    if (site->level != 0) {
+        line_add(&line, "\n", 1);
+    }
+    fwrite(line.text, 1, line.len, d->out);
+    d->timestamp = timestamp;
+    d->records++;
+    return (long)(start_left - c.left);
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+void binlog_decoder_init(binlog_decoder_t *d, const binlog_table_t *table, FILE *out)
+{
+    memset(d, 0, sizeof(*d));
+    d->table = table;
+    d->out = out;
+}
+
+//Text until the next SYNC magic goes straight through; returns bytes used
+static size_t pass_text(binlog_decoder_t *d, const uint8_t *p, size_t len)
+{
+    for (size_t i = 0; i + BINLOG_SYNC_MAGIC_LEN <= len; i++) {
+        if (memcmp(&p[i], BINLOG_SYNC_MAGIC, BINLOG_SYNC_MAGIC_LEN) == 0) {
+            fwrite(p, 1, i, d->out);
+            d->synced = 1;
+            return i;
+        }
+    }
+    //Keep a possible partial magic at the end for the next call
+    size_t keep = (len < BINLOG_SYNC_MAGIC_LEN - 1) ? len : BINLOG_SYNC_MAGIC_LEN - 1;
+    fwrite(p, 1, len - keep, d->out);
+    return len - keep;
+}
+
+static void decode_pending(binlog_decoder_t *d)
+{
+    size_t pos = 0;
+    while (pos < d->pending) {
+        if (!d->synced) {
+            size_t used = pass_text(d, &d->buf[pos], d->pending - pos);
+            if (used == 0 && !d->synced) {
+                break;
+            }
+            pos += used;
+            continue;
+        }
+        long used = decode_record(d, (cursor_t){ &d->buf[pos], d->pending - pos });
+        if (used == 0) {
+            break;                              //incomplete, wait for more bytes
+        }
+        if (used < 0) {
+            d->synced = 0;                      //not a record: show it as text up to the next SYNC
+            d->resyncs++;
+            fputc(d->buf[pos], d->out);
+            pos++;
+            continue;
+        }
+        pos += (size_t)used;
+        d->bytes += (uint64_t)used;
+    }
+    memmove(d->buf, &d->buf[pos], d->pending - pos);
+    d->pending -= pos;
+}
+
+void binlog_decoder_feed(binlog_decoder_t *d, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t n = sizeof(d->buf) - d->pending;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&d->buf[d->pending], data, n);
+        d->pending += n;
+        data += n;
+        len -= n;
+        decode_pending(d);
+        if (d->pending == sizeof(d->buf)) {
+            d->synced = 0;                      //a full buffer without a complete record: garbage
+            d->resyncs++;
+            fwrite(d->buf, 1, 1, d->out);
+            memmove(d->buf, d->buf + 1, --d->pending);
+        }
+    }
+}
+
+void binlog_decoder_finish(binlog_decoder_t *d)
+{
+    if (d->pending > 0) {
+        fwrite(d->buf, 1, d->pending, d->out);
+        d->pending = 0;
+    }
+    fflush(d->out);
+}
+//-------------------------------------------------------------------------------------------------
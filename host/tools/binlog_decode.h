@@ -0,0 +1,54 @@
+//Host decoder for the binlog component: string table from the ELF, binary stream back to text lines
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "binlog_wire.h"
+
+typedef struct {
+    size_t count;
+    binlog_site_t *sites;                       //index = site ID
+} binlog_table_t;
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : binlog_table_load
+>> Description: Read the string table from an ELF file (host executable or ESP32 firmware.elf, not stripped)
+   or from a table file written by binlog_table_save().
+>> Returns: 0 on success, -1 with a message on stderr otherwise. An ELF without BINLOG_x calls gives an empty table.
+*/
+int binlog_table_load(binlog_table_t *table, const char *path);
+
+//Text table: one "<id> <level or -> <format with \n \t \\ escaped>" line per site.
+int binlog_table_save(const binlog_table_t *table, FILE *out);
+
+void binlog_table_free(binlog_table_t *table);
+//-------------------------------------------------------------------------------------------------
+
+
+#define BINLOG_DECODE_BUFFER        1024        //> largest record (see BINLOG_RECORD_MAX)
+#define BINLOG_DECODE_TAGS          256         //tag indexes understood (the firmware uses BINLOG_MAX_TAGS)
+
+typedef struct {
+    const binlog_table_t *table;
+    FILE *out;
+    int synced;                                 //0 = passing text through until the next SYNC record
+    uint32_t timestamp;
+    char tags[BINLOG_DECODE_TAGS][BINLOG_TAG_MAX + 1];     //index 0 unused (inline tag)
+    size_t pending;
+    uint8_t buf[BINLOG_DECODE_BUFFER];
+    //statistics
+    uint64_t bytes;                             //binary bytes consumed after the first SYNC
+    uint64_t records;                           //SITE records decoded
+    uint32_t resyncs;                           //invalid data found after a SYNC
+} binlog_decoder_t;
+
+void binlog_decoder_init(binlog_decoder_t *d, const binlog_table_t *table, FILE *out);
+
+//Decode as much of "data" as possible; incomplete records are kept for the next call.
+void binlog_decoder_feed(binlog_decoder_t *d, const uint8_t *data, size_t len);
+
+//End of input: whatever is left is printed as text.
+void binlog_decoder_finish(binlog_decoder_t *d);
@@ -0,0 +1,90 @@
+//binlog_tool: string table extraction and decoding for the binlog component
+//
+//  binlog_tool table <elf> [-o <file>]             write the string table (stdout by default)
+//  binlog_tool decode <elf|table> [<log.bin>]      binary log (stdin by default) -> text lines on stdout
+//
+//ESP32: binlog_tool decode .pio/build/esp32dev/firmware.elf < capture.bin
+//       (capture the raw UART, e.g. "stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.bin")
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "binlog_decode.h"
+
+static int usage(void)
+{
+    fprintf(stderr, "usage: binlog_tool table <elf> [-o <file>]\n"
+                    "       binlog_tool decode <elf|table> [<log.bin>]\n");
+    return 2;
+}
+
+static int cmd_table(int argc, char **argv)
+{
+    if (argc != 3 && !(argc == 5 && strcmp(argv[3], "-o") == 0)) {
+        return usage();
+    }
+    binlog_table_t table;
+    if (binlog_table_load(&table, argv[2]) != 0) {
+        return 1;
+    }
+    FILE *out = (argc == 5) ? fopen(argv[4], "w") : stdout;
+    if (out == NULL) {
+        perror(argv[4]);
+        binlog_table_free(&table);
+        return 1;
+    }
+    int rc = binlog_table_save(&table, out);
+    if (out != stdout) {
+        rc |= fclose(out);
+    }
+    binlog_table_free(&table);
+    return (rc == 0) ? 0 : 1;
+}
+
+static int cmd_decode(int argc, char **argv)
+{
+    if (argc != 3 && argc != 4) {
+        return usage();
+    }
+    binlog_table_t table;
+    if (binlog_table_load(&table, argv[2]) != 0) {
+        return 1;
+    }
+    FILE *in = (argc == 4) ? fopen(argv[3], "rb") : stdin;
+    if (in == NULL) {
+        perror(argv[3]);
+        binlog_table_free(&table);
+        return 1;
+    }
+
+    static binlog_decoder_t decoder;
+    binlog_decoder_init(&decoder, &table, stdout);
+    uint8_t chunk[256];
+    ssize_t n;
+    //read(), not fread(): a live serial port delivers a few bytes at a time and they should show up at once
+    while ((n = read(fileno(in), chunk, sizeof(chunk))) > 0) {
+        binlog_decoder_feed(&decoder, chunk, (size_t)n);
+        fflush(stdout);
+    }
+    binlog_decoder_finish(&decoder);
+
+    fprintf(stderr, "binlog: %llu records in %llu bytes (%.1f bytes/record), %u resyncs\n",
+            (unsigned long long)decoder.records, (unsigned long long)decoder.bytes,
+            decoder.records ? (double)decoder.bytes / (double)decoder.records : 0.0, (unsigned)decoder.resyncs);
+    if (in != stdin) {
+        fclose(in);
+    }
+    binlog_table_free(&table);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "table") == 0) {
+        return cmd_table(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "decode") == 0) {
+        return cmd_decode(argc, argv);
+    }
+    return usage();
+}
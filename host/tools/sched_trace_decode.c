@@ -0,0 +1,498 @@
+//Host decoder for the sched_trace component (see sched_trace_decode.h)
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sched_trace_decode.h"
+
+#define BEGIN_MARKER        "//>>> sched_trace"
+#define END_MARKER          "//<<< sched_trace"
+#define FLOW_DEPTH          64                  //sends waiting for their receive, per queue
+#define NAME_BUF            32
+#define WHAT_BUF            (UINT8_MAX + 32)    //queue name + verb
+
+
+//-------------------------------------------------------------------------------------------------
+//Binary dump -> records
+
+typedef struct {
+    int64_t ticks;
+    uint32_t seq;                               //position in the dump: keeps each core's order on equal times
+    sched_trace_record_t rec;
+} sort_entry_t;
+
+static int by_time(const void *a, const void *b)
+{
+    const sort_entry_t *x = a, *y = b;
+    if (x->ticks != y->ticks) {
+        return (x->ticks < y->ticks) ? -1 : 1;
+    }
+    return (x->seq < y->seq) ? -1 : (x->seq > y->seq);
+}
+
+static int truncated(const char *what)
+{
+    fprintf(stderr, "sched_trace: dump truncated in the %s\n", what);
+    return -1;
+}
+
+int sched_trace_decode_parse(sched_trace_decoded_t *d, const uint8_t *data, size_t len)
+{
+    memset(d, 0, sizeof(*d));
+    if (len < SCHED_TRACE_HEADER_SIZE || memcmp(data, SCHED_TRACE_MAGIC, SCHED_TRACE_MAGIC_LEN) != 0) {
+        fprintf(stderr, "sched_trace: not a sched_trace dump\n");
+        return -1;
+    }
+    if (data[4] != SCHED_TRACE_VERSION) {
+        fprintf(stderr, "sched_trace: dump version %u, this decoder reads %u\n", data[4], SCHED_TRACE_VERSION);
+        return -1;
+    }
+    d->cores = data[5];
+    d->clock_hz = sched_trace_get_u32(&data[8]);
+    if (d->cores == 0 || d->cores > SCHED_TRACE_DECODE_CORES || d->clock_hz == 0) {
+        fprintf(stderr, "sched_trace: bad header (%u cores, clock %u Hz)\n", d->cores, (unsigned)d->clock_hz);
+        return -1;
+    }
+
+    //Sizes first, so one allocation holds all cores
+    size_t at = SCHED_TRACE_HEADER_SIZE, total = 0;
+    for (uint8_t c = 0; c < d->cores; c++) {
+        if (len - at < SCHED_TRACE_CORE_HEADER) {
+            return truncated("core headers");
+        }
+        uint32_t count = sched_trace_get_u32(&data[at]);
+        if ((len - at - SCHED_TRACE_CORE_HEADER) / SCHED_TRACE_EVENT_SIZE < count) {
+            return truncated("events");
+        }
+        at += SCHED_TRACE_CORE_HEADER + (size_t)count * SCHED_TRACE_EVENT_SIZE;
+        total += count;
+    }
+    sort_entry_t *entries = malloc((total ? total : 1) * sizeof(sort_entry_t));
+    if (entries == NULL) {
+        return -1;
+    }
+
+    //Unwrap: signed differences to the previous event of the same core; the cores share one clock, so each
+    //core starts relative to the first event of the dump
+    at = SCHED_TRACE_HEADER_SIZE;
+    size_t n = 0;
+    int have_ref = 0;
+    uint32_t ref = 0;
+    for (uint8_t c = 0; c < d->cores; c++) {
+        uint32_t count = sched_trace_get_u32(&data[at]);
+        d->lost[c] = sched_trace_get_u32(&data[at + 4]);
+        at += SCHED_TRACE_CORE_HEADER;
+        int64_t ticks = 0;
+        uint32_t prev = 0;
+        for (uint32_t i = 0; i < count; i++, at += SCHED_TRACE_EVENT_SIZE) {
+            sched_trace_event_t ev;
+            sched_trace_get_event(&data[at], &ev);
+            if (!have_ref) {
+                ref = ev.time;
+                have_ref = 1;
+            }
+            ticks = (i == 0) ? (int32_t)(ev.time - ref) : ticks + (int32_t)(ev.time - prev);
+            prev = ev.time;
+            entries[n] = (sort_entry_t){ .ticks = ticks, .seq = (uint32_t)n,
+                                         .rec = { .core = c, .type = ev.type, .object = ev.object, .id = ev.id } };
+            n++;
+        }
+    }
+
+    //Names
+    if (len - at < 2) {
+        free(entries);
+        return truncated("name table");
+    }
+    size_t name_count = sched_trace_get_u16(&data[at]);
+    at += 2;
+    d->names = calloc(name_count ? name_count : 1, sizeof(sched_trace_name_t));
+    if (d->names == NULL) {
+        free(entries);
+        return -1;
+    }
+    for (size_t i = 0; i < name_count; i++) {
+        if (len - at < 4 || len - at - 4 < data[at + 3]) {
+            free(entries);
+            sched_trace_decode_free(d);
+            return truncated("name table");
+        }
+        sched_trace_name_t *name = &d->names[d->name_count++];
+        name->kind = data[at];
+        name->id = sched_trace_get_u16(&data[at + 1]);
+        memcpy(name->name, &data[at + 4], data[at + 3]);
+        name->name[data[at + 3]] = '\0';
+        at += 4u + data[at + 3];
+    }
+
+    //Merge the cores, then time in ns from the first event and the running task per core
+    qsort(entries, total, sizeof(sort_entry_t), by_time);
+    d->records = malloc((total ? total : 1) * sizeof(sched_trace_record_t));
+    if (d->records == NULL) {
+        free(entries);
+        sched_trace_decode_free(d);
+        return -1;
+    }
+    uint16_t running[SCHED_TRACE_DECODE_CORES] = { 0 };
+    for (size_t i = 0; i < total; i++) {
+        uint64_t ticks = (uint64_t)(entries[i].ticks - entries[0].ticks);
+        sched_trace_record_t *r = &d->records[i];
+        *r = entries[i].rec;
+        r->time_ns = ticks / d->clock_hz * 1000000000ull + ticks % d->clock_hz * 1000000000ull / d->clock_hz;
+        if (r->type == SCHED_TRACE_EV_SWITCH_IN) {
+            running[r->core] = r->id;
+        }
+        r->task = (r->type == SCHED_TRACE_EV_SWITCH_OUT) ? r->id : running[r->core];
+        if (r->type == SCHED_TRACE_EV_SWITCH_OUT) {
+            running[r->core] = 0;
+        }
+    }
+    d->count = total;
+    free(entries);
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Input: raw dump or console capture with hex lines
+
+static int hex_value(int ch)
+{
+    return isdigit(ch) ? ch - '0' : (ch >= 'a' && ch <= 'f') ? ch - 'a' + 10 : (ch >= 'A' && ch <= 'F') ? ch - 'A' + 10 : -1;
+}
+
+//First complete BEGIN_MARKER .. END_MARKER block; the bytes are unpacked in place (hex is twice as long)
+static int unhex_capture(uint8_t *text, size_t len, size_t *out_len)
+{
+    size_t out = 0;
+    int inside = 0;
+    for (size_t pos = 0; pos < len; ) {
+        char *line = (char *)&text[pos];
+        char *eol = memchr(line, '\n', len - pos);
+        size_t line_len = eol ? (size_t)(eol - line) : len - pos;
+        pos += line_len + 1;
+        line[line_len] = '\0';                  //the '\n' (or the terminator load_file() added)
+
+        char *marker = strstr(line, inside ? END_MARKER : BEGIN_MARKER);
+        if (marker != NULL && !inside) {
+            inside = 1;
+            out = 0;
+        } else if (marker != NULL) {
+            unsigned declared = 0;
+            if (sscanf(marker + strlen(END_MARKER), "%u", &declared) != 1 || declared != out) {
+                fprintf(stderr, "sched_trace: capture incomplete (%zu of %u bytes), lines lost?\n", out, declared);
+                return -1;
+            }
+            *out_len = out;
+            return 0;
+        } else if (inside) {
+            const char *p = line;
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            if (*p++ != ':') {
+                continue;                       //other output between the markers
+            }
+            while (hex_value(p[0]) >= 0 && hex_value(p[1]) >= 0) {
+                text[out++] = (uint8_t)(hex_value(p[0]) << 4 | hex_value(p[1]));
+                p += 2;
+            }
+        }
+    }
+    fprintf(stderr, "sched_trace: no complete \"%s\" block in the input\n", BEGIN_MARKER);
+    return -1;
+}
+
+static uint8_t *load_file(FILE *f, size_t *len)
+{
+    size_t cap = 65536, n = 0;
+    uint8_t *data = malloc(cap + 1);
+    size_t got;
+    while (data != NULL && (got = fread(&data[n], 1, cap - n, f)) > 0) {
+        n += got;
+        if (n == cap) {
+            cap *= 2;
+            uint8_t *grown = realloc(data, cap + 1);
+            if (grown == NULL) {
+                free(data);
+                return NULL;
+            }
+            data = grown;
+        }
+    }
+    if (data != NULL) {
+        data[n] = '\0';
+        *len = n;
+    }
+    return data;
+}
+
+int sched_trace_decode_load(sched_trace_decoded_t *d, const char *path)
+{
+    int from_stdin = (path == NULL || strcmp(path, "-") == 0);
+    FILE *f = from_stdin ? stdin : fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    size_t len = 0;
+    uint8_t *data = load_file(f, &len);
+    if (!from_stdin) {
+        fclose(f);
+    }
+    if (data == NULL) {
+        fprintf(stderr, "%s: cannot read input\n", from_stdin ? "stdin" : path);
+        return -1;
+    }
+
+    int rc;
+    if (len >= SCHED_TRACE_MAGIC_LEN && memcmp(data, SCHED_TRACE_MAGIC, SCHED_TRACE_MAGIC_LEN) == 0) {
+        rc = sched_trace_decode_parse(d, data, len);
+    } else {
+        rc = unhex_capture(data, len, &len);
+        rc = (rc == 0) ? sched_trace_decode_parse(d, data, len) : rc;
+    }
+    free(data);
+    return rc;
+}
+
+void sched_trace_decode_free(sched_trace_decoded_t *d)
+{
+    free(d->records);
+    free(d->names);
+    memset(d, 0, sizeof(*d));
+}
+
+const char *sched_trace_decode_name(const sched_trace_decoded_t *d, uint8_t kind, uint16_t id, char *buf,
+                                    size_t size)
+{
+    for (size_t i = 0; i < d->name_count; i++) {
+        if (d->names[i].kind == kind && d->names[i].id == id) {
+            return d->names[i].name;
+        }
+    }
+    snprintf(buf, size, "%s %u", (kind == SCHED_TRACE_NAME_TASK) ? "task" : "queue", id);
+    return buf;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Event descriptions shared by both outputs
+
+static int is_queue_event(uint8_t type)
+{
+    return type >= SCHED_TRACE_EV_SEND && type < SCHED_TRACE_EV_COUNT;
+}
+
+static int is_send(uint8_t type)
+{
+    return type == SCHED_TRACE_EV_SEND || type == SCHED_TRACE_EV_SEND_ISR;
+}
+
+static int is_receive(uint8_t type)
+{
+    return type == SCHED_TRACE_EV_RECEIVE || type == SCHED_TRACE_EV_RECEIVE_ISR;
+}
+
+//"give xSemaphore", "take xSemaphore (ISR)", "send xQueue blocks", ...
+static void describe_queue_event(const sched_trace_decoded_t *d, const sched_trace_record_t *r, char *out,
+                                 size_t size)
+{
+    static const char *const suffix[SCHED_TRACE_EV_COUNT] = {
+        [SCHED_TRACE_EV_SEND_ISR] = " (ISR)", [SCHED_TRACE_EV_RECEIVE_ISR] = " (ISR)",
+        [SCHED_TRACE_EV_BLOCK_SEND] = " blocks", [SCHED_TRACE_EV_BLOCK_RECV] = " blocks",
+    };
+    int sending = is_send(r->type) || r->type == SCHED_TRACE_EV_BLOCK_SEND;
+    int queue = (r->object == SCHED_TRACE_OBJ_QUEUE);
+    char buf[NAME_BUF];
+    snprintf(out, size, "%s %s%s", queue ? (sending ? "send" : "receive") : (sending ? "give" : "take"),
+             sched_trace_decode_name(d, SCHED_TRACE_NAME_QUEUE, r->id, buf, sizeof(buf)),
+             suffix[r->type] ? suffix[r->type] : "");
+}
+
+static const char *object_kind(uint8_t object)
+{
+    switch (object) {
+    case SCHED_TRACE_OBJ_QUEUE:     return "queue";
+    case SCHED_TRACE_OBJ_MUTEX:     return "mutex";
+    case SCHED_TRACE_OBJ_COUNTING:  return "counting semaphore";
+    case SCHED_TRACE_OBJ_BINARY:    return "binary semaphore";
+    case SCHED_TRACE_OBJ_RECURSIVE: return "recursive mutex";
+    default:                        return "unknown";
+    }
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+//Chrome trace event JSON
+
+typedef struct {
+    uint32_t ids[FLOW_DEPTH];
+    unsigned head, count;
+} flow_fifo_t;
+
+static void json_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(out, "\\%c", *s);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*s);
+        } else {
+            fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void json_slice(FILE *out, const sched_trace_decoded_t *d, uint8_t core, uint16_t task, uint64_t from,
+                       uint64_t to)
+{
+    char buf[NAME_BUF];
+    fprintf(out, ",\n{\"name\":");
+    json_string(out, sched_trace_decode_name(d, SCHED_TRACE_NAME_TASK, task, buf, sizeof(buf)));
+    fprintf(out, ",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"task\":%u}}",
+            core, (double)from / 1000.0, (double)(to - from) / 1000.0, task);
+}
+
+int sched_trace_decode_json(const sched_trace_decoded_t *d, FILE *out)
+{
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"FreeRTOS\"}}");
+    for (uint8_t c = 0; c < d->cores; c++) {
+        fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"core %u\"}}",
+                c, c);
+    }
+
+    //Slices: SWITCH_IN .. SWITCH_OUT per core. A switch out followed by a switch in of the same task (a yield
+    //with nothing else ready) continues the slice.
+    uint16_t open_task[SCHED_TRACE_DECODE_CORES] = { 0 };
+    uint64_t open_since[SCHED_TRACE_DECODE_CORES] = { 0 };
+    int open[SCHED_TRACE_DECODE_CORES] = { 0 };
+    int closing[SCHED_TRACE_DECODE_CORES] = { 0 };
+    uint64_t closed_at[SCHED_TRACE_DECODE_CORES] = { 0 };
+    uint64_t last[SCHED_TRACE_DECODE_CORES] = { 0 };
+    int seen[SCHED_TRACE_DECODE_CORES] = { 0 };
+    for (size_t i = 0; i < d->count; i++) {
+        const sched_trace_record_t *r = &d->records[i];
+        uint8_t c = r->core;
+        if (closing[c] && !(r->type == SCHED_TRACE_EV_SWITCH_IN && r->id == open_task[c])) {
+            json_slice(out, d, c, open_task[c], open_since[c], closed_at[c]);
+            open[c] = 0;
+        }
+        closing[c] = 0;
+        if (r->type == SCHED_TRACE_EV_SWITCH_IN && open[c] && r->id != open_task[c]) {
+            json_slice(out, d, c, open_task[c], open_since[c], r->time_ns);       //switch out lost
+            open[c] = 0;
+        }
+        if (r->type == SCHED_TRACE_EV_SWITCH_IN && !open[c]) {
+            open[c] = 1;
+            open_task[c] = r->id;
+            open_since[c] = r->time_ns;
+        } else if (r->type == SCHED_TRACE_EV_SWITCH_OUT) {
+            if (!open[c]) {                     //the dump starts inside this slice
+                open[c] = 1;
+                open_task[c] = r->id;
+                open_since[c] = seen[c] ? last[c] : r->time_ns;
+            }
+            closing[c] = 1;
+            closed_at[c] = r->time_ns;
+        }
+        last[c] = r->time_ns;
+        seen[c] = 1;
+    }
+    for (uint8_t c = 0; c < d->cores; c++) {
+        if (open[c]) {
+            json_slice(out, d, c, open_task[c], open_since[c], closing[c] ? closed_at[c] : last[c]);
+        }
+    }
+
+    //Queue events as instants, flows from each send to the receive that took its item
+    uint16_t max_id = 0;
+    for (size_t i = 0; i < d->count; i++) {
+        if (is_queue_event(d->records[i].type) && d->records[i].id > max_id) {
+            max_id = d->records[i].id;
+        }
+    }
+    flow_fifo_t *fifos = calloc((size_t)max_id + 1u, sizeof(flow_fifo_t));
+    if (fifos == NULL) {
+        return -1;
+    }
+    uint32_t next_flow = 1;
+    for (size_t i = 0; i < d->count; i++) {
+        const sched_trace_record_t *r = &d->records[i];
+        if (!is_queue_event(r->type)) {
+            continue;
+        }
+        char what[WHAT_BUF], buf[NAME_BUF];
+        describe_queue_event(d, r, what, sizeof(what));
+        double ts = (double)r->time_ns / 1000.0;
+        fprintf(out, ",\n{\"name\":");
+        json_string(out, what);
+        fprintf(out, ",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"object\":\"%s\",\"task\":",
+                object_kind(r->object), r->core, ts, object_kind(r->object));
+        json_string(out, r->task ? sched_trace_decode_name(d, SCHED_TRACE_NAME_TASK, r->task, buf, sizeof(buf)) : "-");
+        fprintf(out, "}}");
+
+        if (r->id == 0) {
+            continue;                           //unnamed queues share id 0: no pairing
+        }
+        flow_fifo_t *f = &fifos[r->id];
+        const char *name = sched_trace_decode_name(d, SCHED_TRACE_NAME_QUEUE, r->id, buf, sizeof(buf));
+        if (is_send(r->type)) {
+            if (f->count == FLOW_DEPTH) {       //oldest send never received (in this dump): drop it
+                f->head = (f->head + 1u) % FLOW_DEPTH;
+                f->count--;
+            }
+            uint32_t id = next_flow++;
+            f->ids[(f->head + f->count++) % FLOW_DEPTH] = id;
+            fprintf(out, ",\n{\"name\":");
+            json_string(out, name);
+            fprintf(out, ",\"cat\":\"flow\",\"ph\":\"s\",\"id\":%u,\"pid\":1,\"tid\":%u,\"ts\":%.3f}", id, r->core, ts);
+        } else if (is_receive(r->type) && f->count > 0) {
+            uint32_t id = f->ids[f->head];
+            f->head = (f->head + 1u) % FLOW_DEPTH;
+            f->count--;
+            fprintf(out, ",\n{\"name\":");
+            json_string(out, name);
+            fprintf(out, ",\"cat\":\"flow\",\"ph\":\"f\",\"bp\":\"e\",\"id\":%u,\"pid\":1,\"tid\":%u,\"ts\":%.3f}", id,
+                    r->core, ts);
+        }
+    }
+    free(fifos);
+    fprintf(out, "\n]}\n");
+    return ferror(out) ? -1 : 0;
+}
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+int sched_trace_decode_text(const sched_trace_decoded_t *d, FILE *out)
+{
+    uint64_t lost = 0;
+    for (uint8_t c = 0; c < d->cores; c++) {
+        lost += d->lost[c];
+    }
+    fprintf(out, "sched_trace: %zu events, %u core(s), clock %u Hz, %llu lost\n", d->count, d->cores,
+            (unsigned)d->clock_hz, (unsigned long long)lost);
+    fprintf(out, "%14s  %4s  %-16s  %s\n", "time us", "core", "task", "event");
+    for (size_t i = 0; i < d->count; i++) {
+        const sched_trace_record_t *r = &d->records[i];
+        char what[WHAT_BUF], buf[NAME_BUF];
+        if (r->type == SCHED_TRACE_EV_SWITCH_IN || r->type == SCHED_TRACE_EV_SWITCH_OUT) {
+            snprintf(what, sizeof(what), "%s", (r->type == SCHED_TRACE_EV_SWITCH_IN) ? "switched in" : "switched out");
+        } else if (is_queue_event(r->type)) {
+            describe_queue_event(d, r, what, sizeof(what));
+        } else {
+            snprintf(what, sizeof(what), "event type %u", r->type);
+        }
+        fprintf(out, "%14.3f  %4u  %-16s  %s\n", (double)r->time_ns / 1000.0, r->core,
+                r->task ? sched_trace_decode_name(d, SCHED_TRACE_NAME_TASK, r->task, buf, sizeof(buf)) : "-", what);
+    }
+    return ferror(out) ? -1 : 0;
+}
+//-------------------------------------------------------------------------------------------------
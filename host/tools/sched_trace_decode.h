@@ -0,0 +1,76 @@
+//Host decoder for the sched_trace component: dump -> merged event list -> Chrome trace JSON / text timeline
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "sched_trace_wire.h"
+
+#define SCHED_TRACE_DECODE_CORES    8           //cores understood (the ESP32 has 2)
+
+typedef struct {
+    uint64_t time_ns;                           //since the first event of the dump, unwrapped
+    uint8_t core;
+    uint8_t type;                               //SCHED_TRACE_EV_x
+    uint8_t object;                             //SCHED_TRACE_OBJ_x for queue events
+    uint16_t id;                                //task number (switch events) / queue number (queue events)
+    uint16_t task;                              //task running on this core at that moment, 0 = not known
+} sched_trace_record_t;
+
+typedef struct {
+    uint8_t kind;                               //SCHED_TRACE_NAME_x
+    uint16_t id;
+    char name[UINT8_MAX + 1];
+} sched_trace_name_t;
+
+typedef struct {
+    uint32_t clock_hz;
+    uint8_t cores;
+    uint32_t lost[SCHED_TRACE_DECODE_CORES];
+    size_t count;
+    sched_trace_record_t *records;              //all cores, in time order
+    size_t name_count;
+    sched_trace_name_t *names;
+} sched_trace_decoded_t;
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : sched_trace_decode_parse
+>> Description: Decodes a binary dump (sched_trace_dump() output): events of all cores merged in time order,
+                the running task filled in for every event.
+>> Returns: 0 on success, -1 with a message on stderr otherwise.
+*/
+int sched_trace_decode_parse(sched_trace_decoded_t *d, const uint8_t *data, size_t len);
+
+/*
+Function : sched_trace_decode_load
+>> Description: Reads a dump from a file (NULL or "-" = stdin): either raw binary or a console capture with
+                sched_trace_print() output somewhere in it (other lines are skipped, the first complete dump
+                is used), then sched_trace_decode_parse().
+>> Returns: 0 on success, -1 with a message on stderr otherwise.
+*/
+int sched_trace_decode_load(sched_trace_decoded_t *d, const char *path);
+
+void sched_trace_decode_free(sched_trace_decoded_t *d);
+
+//Name of a task / queue; "task <n>" / "queue <n>" (written to buf) if the dump has none.
+const char *sched_trace_decode_name(const sched_trace_decoded_t *d, uint8_t kind, uint16_t id, char *buf,
+                                    size_t size);
+//-------------------------------------------------------------------------------------------------
+
+
+//-------------------------------------------------------------------------------------------------
+/*
+Function : sched_trace_decode_json
+>> Description: Chrome trace event JSON (ui.perfetto.dev, chrome://tracing): one thread lane per core, a
+                slice per task run, an instant per queue / semaphore event and a flow arrow from every
+                send / give to the receive / take that consumed it (FIFO per named queue).
+>> Returns: 0, or -1 if writing failed.
+*/
+int sched_trace_decode_json(const sched_trace_decoded_t *d, FILE *out);
+
+//One line per event: time, core, running task, what happened.
+int sched_trace_decode_text(const sched_trace_decoded_t *d, FILE *out);
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+//sched_trace_tool: scheduler trace dumps (components/sched_trace) -> Chrome trace JSON or a text timeline
+//
+//  sched_trace_tool json [<capture>] [-o <file>]   Chrome trace JSON (stdout by default)
+//  sched_trace_tool text [<capture>]               one line per event on stdout
+//
+//<capture> (stdin by default): console output containing sched_trace_print()'s "//>>> sched_trace" block,
+//or a raw dump. ESP32: "pio device monitor | tee capture.txt", then
+//       sched_trace_tool json capture.txt -o trace.json    and open trace.json in ui.perfetto.dev
+
+#include <stdio.h>
+#include <string.h>
+#include "sched_trace_decode.h"
+
+static int usage(void)
+{
+    fprintf(stderr, "usage: sched_trace_tool json [<capture>] [-o <file>]\n"
+                    "       sched_trace_tool text [<capture>]\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || (strcmp(argv[1], "json") != 0 && strcmp(argv[1], "text") != 0)) {
+        return usage();
+    }
+    int json = (strcmp(argv[1], "json") == 0);
+    const char *in = NULL, *out_path = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (json && strcmp(argv[i], "-o") == 0 && i + 1 < argc && out_path == NULL) {
+            out_path = argv[++i];
+        } else if (in == NULL && argv[i][0] != '-') {
+            in = argv[i];
+        } else {
+            return usage();
+        }
+    }
+
+    sched_trace_decoded_t d;
+    if (sched_trace_decode_load(&d, in) != 0) {
+        return 1;
+    }
+    FILE *out = (out_path != NULL) ? fopen(out_path, "w") : stdout;
+    if (out == NULL) {
+        perror(out_path);
+        sched_trace_decode_free(&d);
+        return 1;
+    }
+    int rc = json ? sched_trace_decode_json(&d, out) : sched_trace_decode_text(&d, out);
+    if (out != stdout) {
+        rc |= fclose(out);
+    }
+    if (json) {
+        uint64_t lost = 0;
+        for (uint8_t c = 0; c < d.cores; c++) {
+            lost += d.lost[c];
+        }
+        fprintf(stderr, "sched_trace: %zu events on %u core(s), %llu lost\n", d.count, d.cores,
+                (unsigned long long)lost);
+    }
+    sched_trace_decode_free(&d);
+    return (rc == 0) ? 0 : 1;
+}